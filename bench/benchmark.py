@@ -6,7 +6,7 @@ import glob
 
 # ------------------------------------------- #
 
-def run_benchmarks(datasetDir, benchmarkTool, tempOutFile, framerate, gopSize, maxBrickgroupSize, motionVectors):
+def run_benchmarks(datasetDir, benchmarkTool, tempOutFile, framerate, gopSize, maxBrickgroupSize, motionVectors, motionSearchPreset, entropyCoder, geometryCoder, voxelOrder, brickOrder, tileSize):
 	
 	for contentDir in glob.glob(os.path.join(datasetDir, '*/')):
 		contentName = os.path.basename(os.path.normpath(contentDir))
@@ -27,6 +27,12 @@ def run_benchmarks(datasetDir, benchmarkTool, tempOutFile, framerate, gopSize, m
 				'-g', str(gopSize),
 				'-b', str(maxBrickgroupSize),
 				'-m', 'on' if motionVectors else 'off',
+				'-s', motionSearchPreset,
+				'-e', entropyCoder,
+				'-c', geometryCoder,
+				'-v', voxelOrder,
+				'-r', brickOrder,
+				'-t', str(tileSize),
 				'-i', resDir,
 				'-o', tempOutFile
 			]
@@ -64,6 +70,18 @@ def main():
 	                    help='max brickgroup size to encode with (default: 512)')
 	parser.add_argument('-m', '--use-motion-vectors', type=bool, default=True, 
 	                    help='whether or not to encode with motion vectors (default: True)')
+	parser.add_argument('-s', '--motion-search-preset', choices=['fast', 'default', 'exhaustive'], default='default', 
+	                    help='how hard to search for motion vectors (default: default)')
+	parser.add_argument('-e', '--entropy-coder', choices=['range', 'rans'], default='range', 
+	                    help='entropy coder to use, rans decodes faster (default: range)')
+	parser.add_argument('-c', '--geometry-coder', choices=['rle', 'context'], default='rle', 
+	                    help='how brick occupancy is coded, context gives smaller files (default: rle)')
+	parser.add_argument('-v', '--voxel-order', choices=['linear', 'morton'], default='linear', 
+	                    help='order voxels are traversed in within each brick (default: linear)')
+	parser.add_argument('-r', '--brick-order', choices=['linear', 'morton'], default='linear', 
+	                    help='order bricks are traversed in within each frame (default: linear)')
+	parser.add_argument('-t', '--tile-size', type=int, default=0, 
+	                    help='side length, in bricks, of independently decodable tiles, 0 disables tiling (default: 0)')
 	args = parser.parse_args()
 	
 	# ensure dataset exists:
@@ -81,7 +99,13 @@ def main():
 		args.framerate,
 		args.gop_size,
 		args.max_brickgroup_size,
-		args.use_motion_vectors
+		args.use_motion_vectors,
+		args.motion_search_preset,
+		args.entropy_coder,
+		args.geometry_coder,
+		args.voxel_order,
+		args.brick_order,
+		args.tile_size
 	)
 
 # ------------------------------------------- #
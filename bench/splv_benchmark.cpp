@@ -7,6 +7,7 @@
 #include <locale>
 #include "spatialstudio/splv_encoder.h"
 #include "spatialstudio/splv_decoder.h"
+#include "spatialstudio/splv_frame_cache.h"
 #include "spatialstudio/splv_nvdb_utils.h"
 
 //-------------------------------------------//
@@ -33,7 +34,7 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 
 //-------------------------------------------//
 
-//usage: splv_benchmark -d [width] [height] [depth] -f [framerate] -g [gop size] -b [max brick group size] -m [motion vectors] -i [input direcrory] -o [output file]
+//usage: splv_benchmark -d [width] [height] [depth] -f [framerate] -g [gop size] -b [max brick group size] -m [motion vectors] -s [motion search preset] -e [entropy coder] -c [geometry coder] -v [voxel order] -r [brick order] -t [tile size] -i [input direcrory] -o [output file]
 int main(int argc, const char** argv)
 {
 	//parse and validate command line args:
@@ -47,6 +48,12 @@ int main(int argc, const char** argv)
 	int32_t gopSize = 1;
 	int32_t maxBrickGroupSize = 256;
 	splv_bool_t motionVectors = SPLV_TRUE;
+	SPLVmotionSearchPreset motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_DEFAULT;
+	SPLVentropyCoder entropyCoder = SPLV_ENTROPY_CODER_RANGE;
+	SPLVgeometryCoder geometryCoder = SPLV_GEOMETRY_CODER_RLE;
+	SPLVvoxelOrder voxelOrder = SPLV_VOXEL_ORDER_LINEAR;
+	SPLVbrickOrder brickOrder = SPLV_BRICK_ORDER_LINEAR;
+	int32_t tileSize = 0;
 
 	std::string inDir = "";
 	std::string outPath = "";
@@ -163,6 +170,124 @@ int main(int argc, const char** argv)
 				return -1;
 			}
 		}
+		else if(arg == "-s") //motion search preset
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-s\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "fast")
+				motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_FAST;
+			else if(option == "default")
+				motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_DEFAULT;
+			else if(option == "exhaustive")
+				motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_EXHAUSTIVE;
+			else
+			{
+				std::cout << "ERROR: invalid motion search preset option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-e") //entropy coder
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-e\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "range")
+				entropyCoder = SPLV_ENTROPY_CODER_RANGE;
+			else if(option == "rans")
+				entropyCoder = SPLV_ENTROPY_CODER_RANS;
+			else
+			{
+				std::cout << "ERROR: invalid entropy coder option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-c") //geometry coder
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-c\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "rle")
+				geometryCoder = SPLV_GEOMETRY_CODER_RLE;
+			else if(option == "context")
+				geometryCoder = SPLV_GEOMETRY_CODER_CONTEXT;
+			else
+			{
+				std::cout << "ERROR: invalid geometry coder option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-v") //voxel order
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-v\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "linear")
+				voxelOrder = SPLV_VOXEL_ORDER_LINEAR;
+			else if(option == "morton")
+				voxelOrder = SPLV_VOXEL_ORDER_MORTON;
+			else
+			{
+				std::cout << "ERROR: invalid voxel order option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-r") //brick order
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-r\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "linear")
+				brickOrder = SPLV_BRICK_ORDER_LINEAR;
+			else if(option == "morton")
+				brickOrder = SPLV_BRICK_ORDER_MORTON;
+			else
+			{
+				std::cout << "ERROR: invalid brick order option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-t") //tile size
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-t\"" << std::endl;
+				return -1;
+			}
+
+			try
+			{
+				tileSize = std::stoi(argv[++i]);
+
+				if(tileSize < 0 || tileSize > UINT8_MAX)
+					throw std::invalid_argument("");
+			}
+			catch(std::exception e)
+			{
+				std::cout << "ERROR: invalid tile size" << std::endl;
+				return -1;
+			}
+		}
 		else if(arg == "-i") //input directory
 		{
 			if(i + 1 >= (uint32_t)argc)
@@ -186,7 +311,7 @@ int main(int argc, const char** argv)
 		else
 		{
 			std::cout << "ERROR: unrecognized command line argument \"" << arg << "\"" << std::endl;
-			std::cout << "VALID USAGE: splv_encoder -d [width] [height] [depth] -f [framerate] -i [input dir] -g [gop size] -b [max brickgroup size] -m [motion vectors] -o [output file]" << std::endl;
+			std::cout << "VALID USAGE: splv_encoder -d [width] [height] [depth] -f [framerate] -i [input dir] -g [gop size] -b [max brickgroup size] -m [motion vectors] -s [motion search preset] -e [entropy coder] -c [geometry coder] -v [voxel order] -r [brick order] -t [tile size] -o [output file]" << std::endl;
 			return -1;
 		}
 	}
@@ -241,6 +366,12 @@ int main(int argc, const char** argv)
 	encodingParams.gopSize = gopSize;
 	encodingParams.maxBrickGroupSize = maxBrickGroupSize;
 	encodingParams.motionVectors = motionVectors;
+	encodingParams.motionSearchPreset = (uint8_t)motionSearchPreset;
+	encodingParams.entropyCoder = (uint8_t)entropyCoder;
+	encodingParams.geometryCoder = (uint8_t)geometryCoder;
+	encodingParams.voxelOrder = (uint8_t)voxelOrder;
+	encodingParams.brickOrder = (uint8_t)brickOrder;
+	encodingParams.tileSize = (uint8_t)tileSize;
 
 	SPLVboundingBox bbox;
 	bbox.xMin = 0;
@@ -317,8 +448,6 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 
 	//encode each frame:
 	//---------------
-	std::vector<SPLVframe> prevEncodedFrames;
-
 	SPLVencoder encoder;
 	SPLVerror encoderError = splv_encoder_create(&encoder, width, height, depth, framerate, encodingParams, outFile.c_str());
 	if(encoderError != SPLV_SUCCESS)
@@ -340,8 +469,6 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 				std::to_string(nvdbError) + " (" + splv_get_error_string(nvdbError) + ")\n");
 		}
 
-		prevEncodedFrames.push_back(frame);
-
 		auto frameLoadEndTime = std::chrono::high_resolution_clock::now();
 		auto frameLoadTime = std::chrono::duration_cast<std::chrono::microseconds>(frameLoadEndTime - frameLoadStartTime);
 		totalFrameLoadTime += frameLoadTime.count() / 1000.0f;
@@ -362,12 +489,7 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 				std::to_string(encodeError) + " (" + splv_get_error_string(encodeError) + ")\n");
 		}
 
-		if(canFree)
-		{
-			for(uint32_t j = 0; j < (uint32_t)prevEncodedFrames.size(); j++)
-				splv_frame_destroy(&prevEncodedFrames[j]);
-			prevEncodedFrames.clear();
-		}
+		splv_frame_destroy(&frame);
 
 		auto encodeEndTime = std::chrono::high_resolution_clock::now();
 		auto encodeTime = std::chrono::duration_cast<std::chrono::microseconds>(encodeEndTime - encodeStartTime);
@@ -384,10 +506,6 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 			std::to_string(finishError) + " (" + splv_get_error_string(finishError) + ")\n");
 	}
 
-	for(uint32_t i = 0; i < (uint32_t)prevEncodedFrames.size(); i++)
-		splv_frame_destroy(&prevEncodedFrames[i]);
-	prevEncodedFrames.clear();
-
 	//get encoded file size:
 	//---------------
 	std::filesystem::path outPath(outFile);
@@ -395,8 +513,6 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 
 	//decode each frame:
 	//---------------
-	std::vector<SPLVframeIndexed> prevDecodedFrames;
-
 	SPLVdecoder decoder;
 	SPLVerror decoderError = splv_decoder_create_from_file(&decoder, outFile.c_str());
 	if(decoderError != SPLV_SUCCESS)
@@ -405,50 +521,22 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 			std::to_string(decoderError) + "(" + splv_get_error_string(decoderError) + ")\n");
 	}
 
-	for(uint32_t i = 0; i < inFiles.size(); i++)
+	//a budget of 0 only keeps the frames needed to decode the next one
+	SPLVframeCache frameCache;
+	SPLVerror frameCacheError = splv_frame_cache_create(&frameCache, &decoder, 0);
+	if(frameCacheError != SPLV_SUCCESS)
 	{
-		//get dependencies
-		uint64_t numDependencies;
-		splv_decoder_get_frame_dependencies(&decoder, i, &numDependencies, NULL, 0);
-
-		uint64_t* dependencies = (numDependencies > 0) ? new uint64_t[numDependencies] : NULL;
-		splv_decoder_get_frame_dependencies(&decoder, i, &numDependencies, dependencies, 0);
-
-		//free frames that are no longer needed
-		for(uint32_t j = 0; j < (uint32_t)prevDecodedFrames.size(); j++)
-		{
-			bool found = false;
-			for(uint32_t k = 0; k < (uint32_t)numDependencies; k++)
-			{
-				if(dependencies[k] == prevDecodedFrames[j].index)
-				{
-					found = true;
-					break;
-				}
-			}
-
-			if(!found)
-			{
-				splv_frame_destroy(prevDecodedFrames[j].frame);
-				delete prevDecodedFrames[j].frame;
-				prevDecodedFrames.erase(prevDecodedFrames.begin() + j);
-				j--;
-			}
-		}
-
-		//we can safely delete dependencies, since frames can always be decoded in order
-		if(numDependencies > 0)
-			delete[] dependencies;
+		throw std::runtime_error("failed to create frame cache with error code " + 
+			std::to_string(frameCacheError) + "(" + splv_get_error_string(frameCacheError) + ")\n");
+	}
 
-		//decode
-		SPLVframe* frame = new SPLVframe;
+	for(uint32_t i = 0; i < inFiles.size(); i++)
+	{
+		SPLVframeCompact* frame;
 
 		auto decodeStartTime = std::chrono::high_resolution_clock::now();
 
-		SPLVerror decodeError = splv_decoder_decode_frame(
-			&decoder, i, prevDecodedFrames.size(),
-			prevDecodedFrames.data(), frame, NULL
-		);
+		SPLVerror decodeError = splv_frame_cache_get_frame_compact(&frameCache, i, &frame);
 		if(decodeError != SPLV_SUCCESS)
 		{
 			throw std::runtime_error("failed to decode frame with code " +
@@ -459,17 +547,11 @@ BenchmarkResults run_benchmark_nvdb(uint32_t width, uint32_t height, uint32_t de
 		auto decodeTime = std::chrono::duration_cast<std::chrono::microseconds>(decodeEndTime - decodeStartTime);
 		totalDecodingTime += decodeTime.count() / 1000.0f;
 
-		//add frame to list
-		SPLVframeIndexed indexedFrame;
-		indexedFrame.frame = frame;
-		indexedFrame.index = i;
-
-		prevDecodedFrames.push_back(indexedFrame);
-
 		//update progress indicator
 		std::cout << "\rdecoded " << i + 1 << "/" << inFiles.size();
 	}
 
+	splv_frame_cache_destroy(&frameCache);
 	splv_decoder_destroy(&decoder);
 
 	//finish timing:
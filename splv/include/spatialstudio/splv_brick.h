@@ -10,6 +10,8 @@
 #include "splv_error.h"
 #include "splv_global.h"
 #include "splv_buffer_io.h"
+#include "splv_format.h"
+#include "splv_occupancy_coder.h"
 #include <stdint.h>
 
 //-------------------------------------------//
@@ -34,6 +36,49 @@ typedef struct SPLVbrick
 	uint32_t color[SPLV_BRICK_LEN]; //4 channel RGBA
 } SPLVbrick;
 
+/**
+ * the streams an encoded brick is split across. Each has very different statistics, so they are entropy coded separately
+ */
+typedef enum SPLVbrickStream
+{
+	SPLV_BRICK_STREAM_MOTION = 0, //encoding type + motion vector
+	SPLV_BRICK_STREAM_GEOMETRY,   //RLE'd occupancy bitmap, or the output of an SPLVoccupancyEncoder
+	SPLV_BRICK_STREAM_COLOR_R,    //color deltas, 1 plane per channel
+	SPLV_BRICK_STREAM_COLOR_G,
+	SPLV_BRICK_STREAM_COLOR_B,
+
+	SPLV_BRICK_STREAM_COUNT
+} SPLVbrickStream;
+
+#define SPLV_MOTION_SEARCH_MAX_PREDICTORS 4
+
+/**
+ * an offset from a brick's position into the previous frame, in voxels
+ */
+typedef struct SPLVmotionVector
+{
+	int8_t x;
+	int8_t y;
+	int8_t z;
+} SPLVmotionVector;
+
+/**
+ * controls how the motion vector is searched for when encoding a brick predictively
+ */
+typedef struct SPLVmotionSearchParams
+{
+	SPLVmotionSearchPreset preset;
+
+	//motion vectors likely to be close to the brick's, e.g. those of neighboring bricks. Only used by SPLV_MOTION_SEARCH_PRESET_FAST
+	uint32_t numPredictors;
+	SPLVmotionVector predictors[SPLV_MOTION_SEARCH_MAX_PREDICTORS];
+
+	//if set, the motion-compensated reference may only be drawn from these bricks of the previous frame (in map coordinates, inclusive),
+	//e.g. the brick's tile. Otherwise the reference may come from any neighboring brick
+	splv_bool_t constrainReference;
+	SPLVboundingBox referenceBounds;
+} SPLVmotionSearchParams;
+
 //-------------------------------------------//
 
 /**
@@ -62,27 +107,63 @@ SPLV_API splv_bool_t splv_brick_get_voxel_color(SPLVbrick* brick, uint32_t x, ui
 SPLV_API void splv_brick_clear(SPLVbrick* brick);
 
 /**
- * encodes a brick to the given buffer writer, using only intra-frame encoding
+ * encodes a brick to the given buffer writers, one per SPLVbrickStream, using only intra-frame encoding. If occupancy is not NULL,
+ * the bitmap is coded with it instead of being RLE'd. Voxels are traversed in the given order
  */
-SPLV_API SPLVerror splv_brick_encode_intra(SPLVbrick* brick, SPLVbufferWriter* out, uint32_t* numVoxels);
+SPLV_API SPLVerror splv_brick_encode_intra(SPLVbrick* brick, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy, SPLVvoxelOrder order, uint32_t* numVoxels);
 
 typedef struct SPLVframe SPLVframe;
+typedef struct SPLVframeCompact SPLVframeCompact;
 
 /**
- * encodes a brick into the given buffer writer, using information from the previous frame to predict
+ * encodes a brick into the given buffer writers, one per SPLVbrickStream, using information from the previous frame to predict. If motionSearch is NULL,
+ * no motion vector is used. If motionVector is not NULL, it is set to the motion vector that was found. If occupancy is not NULL, the bitmap is coded
+ * with it instead of being RLE'd. Voxels are traversed in the given order
  */
-SPLV_API SPLVerror splv_brick_encode_predictive(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVframe* lastFrame, uint32_t* numVoxels, splv_bool_t motionVectors);
+SPLV_API SPLVerror splv_brick_encode_predictive(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy,
+                                                SPLVvoxelOrder order, SPLVframe* lastFrame, uint32_t* numVoxels, const SPLVmotionSearchParams* motionSearch, SPLVmotionVector* motionVector);
 
 /**
- * decodes a brick from an input reader into the given pointer
+ * identical to splv_brick_encode_predictive(), but predicts from a previous frame in the compact format
  */
-SPLV_API SPLVerror splv_brick_decode(SPLVbufferReader* in, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+SPLV_API SPLVerror splv_brick_encode_predictive_from_compact(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy,
+                                                             SPLVvoxelOrder order, SPLVframeCompact* lastFrame, uint32_t* numVoxels, const SPLVmotionSearchParams* motionSearch, 
+                                                             SPLVmotionVector* motionVector);
+
+/**
+ * decodes a brick from the given input readers, one per SPLVbrickStream, into the given pointer. If occupancy is not NULL, the bitmap is
+ * decoded with it instead of from the geometry stream. order must match the one the brick was encoded with
+ */
+SPLV_API SPLVerror splv_brick_decode(SPLVbufferReader* in, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
                                      uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t* numVoxels);
 
 /**
- * decodes a brick from an input reader into the given pointer. Works for SPLVs in the previous version (not ALL previous versions)
+ * decodes a brick that was skipped by the encoder, copying the brick at the same position in the previous frame
+ */
+SPLV_API SPLVerror splv_brick_decode_skipped(SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                             uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t* numVoxels);
+
+/**
+ * identical to splv_brick_decode(), but predicts from a previous frame in the compact format
+ */
+SPLV_API SPLVerror splv_brick_decode_from_compact(SPLVbufferReader* in, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                                  uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframeCompact* lastFrame, uint32_t* numVoxels);
+
+/**
+ * identical to splv_brick_decode_skipped(), but copies from a previous frame in the compact format. out may be NULL if only outVoxels is needed
+ */
+SPLV_API SPLVerror splv_brick_decode_skipped_from_compact(SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                                          uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframeCompact* lastFrame, uint32_t* numVoxels);
+
+/**
+ * decodes a brick from an input reader into the given pointer. Works for SPLVs of the given legacy version, either 0.2.1.0 or 0.3.0.0
+ */
+SPLV_API SPLVerror splv_brick_decode_legacy(SPLVbufferReader* in, SPLVbrick* out, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t version);
+
+/**
+ * returns whether 2 bricks have the same filled voxels with the same colors
  */
-SPLV_API SPLVerror splv_brick_decode_legacy(SPLVbufferReader* in, SPLVbrick* out, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame);
+SPLV_API splv_bool_t splv_brick_equals(SPLVbrick* brick1, SPLVbrick* brick2);
 
 /**
  * returns the number of filled voxels in a brick
@@ -69,6 +69,11 @@ SPLV_API void splv_buffer_writer_destroy(SPLVbufferWriter* writer);
  */
 SPLV_API SPLVerror splv_buffer_writer_write(SPLVbufferWriter* writer, uint64_t size, void* src);
 
+/**
+ * ensures at least size more bytes can be written without reallocating, writing directly to buf + writePos is then valid
+ */
+SPLV_API SPLVerror splv_buffer_writer_reserve(SPLVbufferWriter* writer, uint64_t size);
+
 /**
  * writes a single byte to a writer
  */
@@ -15,14 +15,79 @@
 
 //-------------------------------------------//
 
-#ifndef SPLV_DECODER_THREAD_POOL_SIZE
-	#define SPLV_DECODER_THREAD_POOL_SIZE 8
-#endif
+#define SPLV_DECODER_DEFAULT_READ_AHEAD_FRAMES 8
+#define SPLV_DECODER_DEFAULT_PREFETCH_BUDGET (64ull * 1024 * 1024)
 
 //-------------------------------------------//
 
 typedef struct SPLVdecoder SPLVdecoder;
 
+/**
+ * runtime options for a decoder
+ */
+typedef struct SPLVdecoderOptions
+{
+	//an externally owned thread pool to decode with, can be shared between multiple encoders/decoders. Must outlive the decoder.
+	//if NULL, the decoder creates its own pool using the options below
+	SPLVthreadPool* threadPool;
+
+	//number of threads in the decoder's own pool, 0 uses one thread per logical CPU
+	uint32_t numThreads;
+
+	//whether to pin the decoder's own pool's threads to consecutive logical CPUs, starting at firstCpu
+	uint8_t pinThreads;
+	uint32_t firstCpu;
+
+	//for decoders created with splv_decoder_create_from_file_mmap(), the number of frames after the one being decoded that the OS
+	//is asked to start reading in the background. 0 uses SPLV_DECODER_DEFAULT_READ_AHEAD_FRAMES
+	uint32_t readAheadFrames;
+
+	//for decoders created with splv_decoder_create_from_file(), the number of upcoming frames a background thread reads ahead of
+	//the frame being decoded, so decoding doesn't wait on I/O. 0 disables prefetching
+	uint32_t prefetchFrames;
+
+	//the maximum number of bytes of compressed frames held by the prefetcher at once, 0 uses SPLV_DECODER_DEFAULT_PREFETCH_BUDGET.
+	//a single frame larger than the budget is still prefetched, but only once every frame before it has been consumed
+	uint64_t prefetchBudget;
+} SPLVdecoderOptions;
+
+/**
+ * all info needed for a thread to decode a brick group
+ */
+typedef struct SPLVbrickGroupDecodeInfo
+{
+	SPLVdecoder* decoder;
+
+	SPLVframe* outFrame; //NULL when only decoding to outFrameCompact
+	SPLVframeCompact* outFrameCompact;
+	
+	uint64_t compressedBufLen;
+	uint8_t* compressedBuf;
+	
+	uint32_t brickStartIdx;
+	uint32_t numBricks;
+	uint32_t outBrickStartIdx; //where the group's bricks are written in outFrame, SPLV_BRICK_IDX_EMPTY if outside the region being decoded
+	
+	uint64_t voxelsStartIdx; //where the group's voxels are written in outFrameCompact
+	uint64_t numVoxels;
+
+	SPLVframe* lastFrame;
+	SPLVframeCompact* lastFrameCompact; //set instead of lastFrame when decoding from compact dependencies
+	uint32_t* skipBitmap; //NULL for I-frames
+
+	SPLVbufferWriter* decompressedBufs; //1 per SPLVbrickStream, owned by the decoder, reused across frames so decoding doesn't allocate
+} SPLVbrickGroupDecodeInfo;
+
+/**
+ * a compressed frame read by a decoder's prefetch thread
+ */
+typedef struct SPLVdecoderPrefetchSlot
+{
+	uint64_t bufLen;
+	uint8_t* buf;
+	uint64_t frameLen;
+} SPLVdecoderPrefetchSlot;
+
 /**
  * all state needed by a decoder
  */
@@ -38,6 +103,7 @@ typedef struct SPLVdecoder
 	float duration;
 
 	uint64_t* frameTable;
+	uint64_t frameTablePtr; //also where the last frame's data ends
 
 	SPLVencodingParams encodingParams;
 
@@ -55,13 +121,52 @@ typedef struct SPLVdecoder
 		} inFile;
 	};
 
+	//set if created with splv_decoder_create_from_file_mmap(), inBuf then reads directly from the mapping:
+	void* fileMapping;
+	uint64_t fileMappingLen;
+	uint32_t readAheadFrames;
+	uint64_t readAheadStart; //the range of the mapping most recently passed to the OS for read-ahead, in bytes
+	uint64_t readAheadEnd;
+
+	//background prefetching for file decoders, a ring buffer of numPrefetchSlots frames starting at prefetchFirstFrame.
+	//the prefetch thread reads with its own file handle, so it never contends with inFile:
+	uint8_t prefetching;
+	FILE* prefetchFile;
+	uint64_t prefetchBudget;
+	uint32_t numPrefetchSlots;
+	SPLVdecoderPrefetchSlot* prefetchSlots;
+	SPLVthread prefetchThread;
+
+	//guarded by prefetchMutex:
+	uint32_t prefetchHeadSlot;
+	uint64_t prefetchFirstFrame;
+	uint32_t prefetchNumReady; //slots filled, starting at prefetchHeadSlot
+	uint64_t prefetchBytes;    //total frameLen of ready slots
+	uint32_t prefetchGeneration; //incremented whenever the ring is reset, so reads started before the reset are discarded
+	uint8_t prefetchShouldExit;
+	SPLVerror prefetchError;
+
+	SPLVmutex prefetchMutex;
+	SPLVconditionVariable prefetchCond;
+
+	//the map index of each brick position, in the order bricks were encoded in, split into tiles:
+	uint32_t* brickOrder;
+	uint32_t numTiles;
+	uint32_t* tileStarts; //numTiles + 1 indices into brickOrder
+
 	//scratch buffers:
 	uint64_t encodedMapLen;
 	uint32_t* scratchBufEncodedMap;
+	uint32_t* scratchBufSkipBitmap;
 	SPLVcoordinate* scratchBufBrickPositions;
+	SPLVbrickGroupDecodeInfo* scratchBufBrickGroupInfos;
+	uint32_t maxBrickGroups;
+	SPLVbufferWriter* scratchBufDecompressed; //SPLV_BRICK_STREAM_COUNT per brick group
 
 	//thread pool:
 	SPLVthreadPool* threadPool;
+	uint8_t ownsThreadPool;
+	SPLVthreadPoolGroup threadPoolGroup;
 } SPLVdecoder;
 
 /**
@@ -73,6 +178,15 @@ typedef struct SPLVframeIndexed
 	SPLVframe* frame;
 } SPLVframeIndexed;
 
+/**
+ * a compact frame paired with an index into a stream
+ */
+typedef struct SPLVframeCompactIndexed
+{
+	uint64_t index;
+	SPLVframeCompact* frame;
+} SPLVframeCompactIndexed;
+
 //-------------------------------------------//
 
 /**
@@ -85,6 +199,29 @@ SPLV_API SPLVerror splv_decoder_create_from_mem(SPLVdecoder* decoder, uint64_t e
  */
 SPLV_API SPLVerror splv_decoder_create_from_file(SPLVdecoder* decoder, const char* path);
 
+/**
+ * creates a new decoder that memory-maps a file rather than reading it, reading and verifying metadata. call splv_decoder_destroy() to free any resources
+ * 
+ * frames are decoded directly from the mapping without being copied, and the OS is asked to read upcoming frames in the background.
+ * On platforms without mmap() this is equivalent to splv_decoder_create_from_file()
+ */
+SPLV_API SPLVerror splv_decoder_create_from_file_mmap(SPLVdecoder* decoder, const char* path);
+
+/**
+ * creates a new decoder from a memory buffer with the given runtime options. call splv_decoder_destroy() to free any resources
+ */
+SPLV_API SPLVerror splv_decoder_create_from_mem_with_options(SPLVdecoder* decoder, uint64_t encodedBufLen, uint8_t* encodedBuf, SPLVdecoderOptions options);
+
+/**
+ * creates a new decoder from a file with the given runtime options. call splv_decoder_destroy() to free any resources
+ */
+SPLV_API SPLVerror splv_decoder_create_from_file_with_options(SPLVdecoder* decoder, const char* path, SPLVdecoderOptions options);
+
+/**
+ * creates a new decoder that memory-maps a file with the given runtime options. call splv_decoder_destroy() to free any resources
+ */
+SPLV_API SPLVerror splv_decoder_create_from_file_mmap_with_options(SPLVdecoder* decoder, const char* path, SPLVdecoderOptions options);
+
 /**
  * returns the required denendant frames for decoding a given frame. These are the frames that must be passed to
  * splv_decoder_decode_frame(). Passing NULL for dependencies will just return the length, allowing you to allocate the properly size array.abort
@@ -105,6 +242,29 @@ SPLV_API SPLVerror splv_decoder_get_frame_dependencies(SPLVdecoder* decoder, uin
  */
 SPLV_API SPLVerror splv_decoder_decode_frame(SPLVdecoder* decoder, uint64_t index, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVframe* frame, SPLVframeCompact* compactFrame);
 
+/**
+ * like splv_decoder_decode_frame(), but decodes into a frame (and compactFrame, if not NULL) that is either zeroed or was previously
+ * decoded/created, reusing its allocations when they are large enough. Useful for playback loops, where the same few frames
+ * can be recycled rather than allocated + freed every frame. The caller keeps ownership of the frames, even on failure.
+ * frame must not be one of the dependencies
+ */
+SPLV_API SPLVerror splv_decoder_decode_frame_into(SPLVdecoder* decoder, uint64_t index, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVframe* frame, SPLVframeCompact* compactFrame);
+
+/**
+ * like splv_decoder_decode_frame_into(), but decodes straight to a compact frame from compact dependencies, never holding the
+ * full SPLVframe. Useful for keeping decoded frames resident with much less memory. Dependencies are the same as for splv_decoder_decode_frame()
+ */
+SPLV_API SPLVerror splv_decoder_decode_frame_compact(SPLVdecoder* decoder, uint64_t index, uint64_t numDependencies, SPLVframeCompactIndexed* dependencies, SPLVframeCompact* frame);
+
+/**
+ * decodes only the tiles of a given frame that intersect region, given in voxels. Bricks in every other tile are left empty. Files encoded
+ * without tiles are a single tile, so are decoded in full if region intersects the volume at all
+ * 
+ * P-frames only reference bricks within their own tile, so the dependencies only need to have been decoded with the same region
+ */
+SPLV_API SPLVerror splv_decoder_decode_frame_region(SPLVdecoder* decoder, uint64_t index, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVboundingBox region,
+                                                    SPLVframe* frame, SPLVframeCompact* compactFrame);
+
 /**
  * returns the frame index of the first i-frame before or at the given index
  */
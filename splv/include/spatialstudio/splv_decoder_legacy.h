@@ -1,6 +1,6 @@
 /* splv_decoder_legacy.h
  *
- * contains a decoder implementation for the PREVIOUS VERSION of SPLV, used for converting old files
+ * contains a decoder implementation for PREVIOUS VERSIONS of SPLV (0.2.1.0 and 0.3.0.0), used for converting old files
  */
 
 #ifndef SPLV_DECODER_LEGACY_H
@@ -14,12 +14,6 @@
 
 //-------------------------------------------//
 
-#ifndef SPLV_DECODER_LEGACY_THREAD_POOL_SIZE
-	#define SPLV_DECODER_LEGACY_THREAD_POOL_SIZE 8
-#endif
-
-//-------------------------------------------//
-
 typedef struct SPLVdecoderLegacy SPLVdecoderLegacy;
 
 /**
@@ -29,10 +23,11 @@ typedef struct SPLVencodingParamsLegacy
 {
 	uint32_t gopSize;
 	uint32_t maxBrickGroupSize;
+	splv_bool_t motionVectors; //only stored in 0.3.0.0 files, always false for 0.2.1.0
 } SPLVencodingParamsLegacy;
 
 /**
- * header containing all metadata in a legacy splv file
+ * header containing all metadata in a legacy splv file, laid out as in 0.3.0.0. 0.2.1.0 headers lack motionVectors
  */
 typedef struct SPLVfileHeaderLegacy
 {
@@ -66,24 +61,6 @@ typedef struct SPLVbrickGroupDecodeInfoLegacy
 	SPLVframe* lastFrame;
 } SPLVbrickGroupDecodeInfoLegacy;
 
-/**
- * thread pool to accelerate decoder
- */
-typedef struct SPLVdecoderLegacyThreadPool
-{
-	uint32_t threadsShouldExit;
-	SPLVthread threads[SPLV_DECODER_LEGACY_THREAD_POOL_SIZE];
-
-	uint32_t groupStackSize;
-	SPLVbrickGroupDecodeInfoLegacy* groupStack;
-	SPLVmutex groupStackMutex;
-	SPLVconditionVariable groupStackEmptyCond;
-
-	uint32_t numGroupsDecoding;
-	SPLVmutex decodingMutex;
-	SPLVconditionVariable decodingDoneCond;
-} SPLVdecoderLegacyThreadPool;
-
 /**
  * all state needed by a decoder
  */
@@ -100,6 +77,7 @@ typedef struct SPLVdecoderLegacy
 
 	uint64_t* frameTable;
 
+	uint32_t version;
 	SPLVencodingParamsLegacy encodingParams;
 
 	//input info:
@@ -120,9 +98,12 @@ typedef struct SPLVdecoderLegacy
 	uint64_t encodedMapLen;
 	uint32_t* scratchBufEncodedMap;
 	SPLVcoordinate* scratchBufBrickPositions;
+	SPLVbrickGroupDecodeInfoLegacy* scratchBufBrickGroupInfos;
 
 	//thread pool:
-	SPLVdecoderLegacyThreadPool* threadPool;
+	SPLVthreadPool* threadPool;
+	uint8_t ownsThreadPool;
+	SPLVthreadPoolGroup threadPoolGroup;
 } SPLVdecoderLegacy;
 
 /**
@@ -146,6 +127,12 @@ SPLV_API SPLVerror splv_decoder_legacy_create_from_mem(SPLVdecoderLegacy* decode
  */
 SPLV_API SPLVerror splv_decoder_legacy_create_from_file(SPLVdecoderLegacy* decoder, const char* path);
 
+/**
+ * creates a new decoder from a file that decodes using an externally owned thread pool, which must outlive the decoder.
+ * If threadPool is NULL, the decoder creates its own. call splv_decoder_destroy() to free any resources
+ */
+SPLV_API SPLVerror splv_decoder_legacy_create_from_file_with_pool(SPLVdecoderLegacy* decoder, const char* path, SPLVthreadPool* threadPool);
+
 /**
  * returns the required denendant frames for decoding a given frame. These are the frames that must be passed to
  * splv_decoder_decode_frame(). Passing NULL for dependencies will just return the length, allowing you to allocate the properly size array.abort
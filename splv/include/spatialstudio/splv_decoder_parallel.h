@@ -0,0 +1,125 @@
+/* splv_decoder_parallel.h
+ *
+ * contains a decoder that decodes multiple GOPs of a file at once, for offline processing of whole files
+ */
+
+#ifndef SPLV_DECODER_PARALLEL_H
+#define SPLV_DECODER_PARALLEL_H
+
+#include "splv_decoder.h"
+#include "splv_decoder_legacy.h"
+
+//-------------------------------------------//
+
+#define SPLV_DECODER_PARALLEL_DEFAULT_MEMORY_BUDGET (512ull * 1024 * 1024)
+
+//-------------------------------------------//
+
+/**
+ * runtime options for a parallel decoder
+ */
+typedef struct SPLVdecoderParallelOptions
+{
+	//the number of GOPs decoded at once, each on its own thread. 0 uses one per logical CPU
+	uint32_t numWorkers;
+
+	//the maximum number of bytes of decoded compact frames waiting to be returned, 0 uses SPLV_DECODER_PARALLEL_DEFAULT_MEMORY_BUDGET.
+	//the GOP containing the next frame to be returned is always decoded, so this may be exceeded by a frame per worker
+	uint64_t memoryBudget;
+
+	//an externally owned thread pool to decode brick groups with, shared by every worker. Must outlive the decoder.
+	//if NULL, the decoder creates its own with one thread per logical CPU
+	SPLVthreadPool* threadPool;
+} SPLVdecoderParallelOptions;
+
+typedef struct SPLVdecoderParallel SPLVdecoderParallel;
+
+/**
+ * a thread decoding whole GOPs, with its own decoder
+ */
+typedef struct SPLVdecoderParallelWorker
+{
+	SPLVdecoderParallel* parent;
+
+	union
+	{
+		SPLVdecoder impl;
+		SPLVdecoderLegacy implLegacy;
+	};
+
+	SPLVthread thread;
+} SPLVdecoderParallelWorker;
+
+/**
+ * all state needed by a parallel decoder
+ */
+typedef struct SPLVdecoderParallel
+{
+	//splv info:
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+
+	float framerate;
+	uint32_t frameCount;
+
+	uint8_t legacy;
+	SPLVencodingParams encodingParams;             //only valid if !legacy
+	SPLVencodingParamsLegacy encodingParamsLegacy; //only valid if legacy
+
+	uint32_t numGops;
+	uint64_t* gopStarts; //numGops + 1 frame indices
+
+	//workers:
+	uint64_t memoryBudget;
+
+	SPLVthreadPool* threadPool;
+	uint8_t ownsThreadPool;
+
+	uint32_t numWorkers;
+	uint32_t numWorkersStarted;
+	SPLVdecoderParallelWorker* workers;
+
+	//reorder buffer, 1 compact entry per frame, guarded by mutex:
+	SPLVframeCompact* frames;
+	uint8_t* framesReady;
+
+	uint32_t nextGop;   //next GOP to be handed to a worker
+	uint64_t nextFrame; //next frame to be returned
+	uint64_t bufferedBytes;
+	SPLVerror error;
+	uint8_t shouldExit;
+
+	SPLVmutex mutex;
+	SPLVconditionVariable cond;
+} SPLVdecoderParallel;
+
+//-------------------------------------------//
+
+/**
+ * creates a parallel decoder for a file, and starts decoding. call splv_decoder_parallel_destroy() to free any resources
+ */
+SPLV_API SPLVerror splv_decoder_parallel_create(SPLVdecoderParallel* decoder, const char* path, SPLVdecoderParallelOptions options);
+
+/**
+ * creates a parallel decoder for a legacy file, and starts decoding. call splv_decoder_parallel_destroy() to free any resources
+ */
+SPLV_API SPLVerror splv_decoder_parallel_create_legacy(SPLVdecoderParallel* decoder, const char* path, SPLVdecoderParallelOptions options);
+
+/**
+ * returns the next frame of the file, in order, waiting for it to be decoded if needed. The frame is unpacked from the buffered
+ * compact frame, its ownership is transferred to the caller
+ */
+SPLV_API SPLVerror splv_decoder_parallel_next_frame(SPLVdecoderParallel* decoder, SPLVframe* frame);
+
+/**
+ * like splv_decoder_parallel_next_frame(), but returns the buffered compact frame directly. The frame's ownership is transferred to the caller
+ */
+SPLV_API SPLVerror splv_decoder_parallel_next_frame_compact(SPLVdecoderParallel* decoder, SPLVframeCompact* frame);
+
+/**
+ * stops decoding, frees any resources allocated from splv_decoder_parallel_create()
+ */
+SPLV_API void splv_decoder_parallel_destroy(SPLVdecoderParallel* decoder);
+
+#endif //#ifndef SPLV_DECODER_PARALLEL_H
@@ -7,19 +7,89 @@
 #define SPLV_ENCODER_H
 
 #include "splv_frame.h"
+#include "splv_frame_compact.h"
 #include "splv_global.h"
 #include "splv_dyn_array.h"
 #include "splv_format.h"
 #include "splv_threading.h"
+#include "splv_buffer_io.h"
 #include <stdio.h>
 
 //-------------------------------------------//
 
-#ifndef SPLV_ENCODER_THREAD_POOL_SIZE
-	#define SPLV_ENCODER_THREAD_POOL_SIZE 8
-#endif
+/**
+ * runtime options for an encoder. Unlike SPLVencodingParams, these do not affect the encoded file
+ */
+typedef struct SPLVencoderOptions
+{
+	//the maximum number of frames that can be encoding at once, across any number of GOPs. If greater than 1,
+	//splv_encoder_encode_frame() returns before the frame has been written, and the frame's entropy coding + output
+	//will overlap with the encoding of subsequent frames. 0 or 1 encodes each frame synchronously
+	uint32_t maxFramesInFlight;
 
-//-------------------------------------------//
+	//an externally owned thread pool to encode with, can be shared between multiple encoders/decoders. Must outlive the encoder.
+	//if NULL, the encoder creates its own pool using the options below
+	SPLVthreadPool* threadPool;
+
+	//number of threads in the encoder's own pool, 0 uses one thread per logical CPU
+	uint32_t numThreads;
+
+	//whether to pin the encoder's own pool's threads to consecutive logical CPUs, starting at firstCpu
+	uint8_t pinThreads;
+	uint32_t firstCpu;
+} SPLVencoderOptions;
+
+typedef struct SPLVencoder SPLVencoder;
+typedef struct SPLVencoderFrameInFlight SPLVencoderFrameInFlight;
+
+/**
+ * all info needed for a thread to encode a brick group
+ */
+typedef struct SPLVbrickGroupEncodeInfo
+{
+	SPLVencoder* encoder;
+	SPLVencoderFrameInFlight* frame;
+	
+	uint32_t brickStartIdx;
+	uint32_t numBricks; 
+	SPLVbrickCompact** bricks;
+	SPLVboundingBox tileBounds; //map-space bounds of the tile containing the group, P bricks only reference these when tiling
+	SPLVcoordinate* brickPositions;
+	SPLVmotionVector* motionVectors;
+	uint8_t* brickSkipped;
+	
+	SPLVbufferWriter* outBuf;
+	uint64_t* numVoxels;
+} SPLVbrickGroupEncodeInfo;
+
+/**
+ * a frame that has been submitted for encoding, but has not yet been written to the output file
+ */
+typedef struct SPLVencoderFrameInFlight
+{
+	SPLVframeEncodingType frameType;
+	SPLVframeCompact frame;
+	SPLVframeCompact refFrame;
+
+	uint32_t numBricks;
+	uint32_t numBrickGroups;
+
+	//scratch buffers:
+	uint32_t* mapBitmap;
+	SPLVbrickCompact** bricks;
+	SPLVcoordinate* brickPositions;
+	uint32_t* brickIndices; //the index into bricks of the brick at each map position, or SPLV_BRICK_IDX_EMPTY
+	SPLVmotionVector* motionVectors;
+	uint8_t* brickSkipped; //for P-frames, whether each brick is identical to the one at the same position in refFrame
+	uint32_t* skipBitmap;
+	SPLVbufferWriter* brickGroupWriters;
+	uint64_t* voxelCounts;
+	SPLVbrickGroupEncodeInfo* brickGroupInfos;
+
+	//progress, guarded by SPLVencoder::framesInFlightMutex:
+	uint32_t numBrickGroupsEncoding;
+	SPLVerror encodeError;
+} SPLVencoderFrameInFlight;
 
 /**
  * all state needed by an encoder
@@ -37,21 +107,40 @@ typedef struct SPLVencoder
 
 	SPLVencodingParams encodingParams;
 
-	SPLVframe lastFrame;
+	SPLVframeCompact lastFrame;
+
+	//packed copies of every frame passed in, 1 per in-flight frame + 1 for the oldest one's reference. Their allocations are
+	//reused across frames, and only hold the filled bricks + voxels:
+	uint32_t numFrameCopies;
+	SPLVframeCompact* frameCopies;
+
+	//frames passed to splv_encoder_submit_frame() are owned by the encoder, each is freed as soon as it has been packed:
+	uint8_t ownsFrames;
 
 	//output:
 	FILE* outFile;
 
-	//scartch buffers:
+	//the map index of each brick position, in the order bricks are encoded in, split into tiles:
+	uint32_t* brickOrder;
+	uint32_t numTiles;
+	uint32_t* tileStarts; //numTiles + 1 indices into brickOrder
+
+	//frames being encoded, a ring buffer of maxFramesInFlight frames:
 	uint64_t mapBitmapLen;
-	uint32_t* scratchBufMapBitmap;
-	SPLVbrick** scratchBufBricks;
-	SPLVcoordinate* scratchBufBrickPositions;
-	SPLVbufferWriter* scratchBufBrickGroupWriters;
-	uint64_t* scratchBufVoxelCounts;
+	uint32_t maxBrickGroups;
+
+	uint32_t maxFramesInFlight;
+	uint32_t numFramesInFlight;
+	uint32_t firstFrameInFlight;
+	SPLVencoderFrameInFlight* framesInFlight;
+
+	SPLVmutex framesInFlightMutex;
+	SPLVconditionVariable frameEncodedCond;
 
 	//thread pool:
 	SPLVthreadPool* threadPool;
+	uint8_t ownsThreadPool;
+	SPLVthreadPoolGroup threadPoolGroup;
 } SPLVencoder;
 
 //-------------------------------------------//
@@ -62,14 +151,35 @@ typedef struct SPLVencoder
 SPLV_API SPLVerror splv_encoder_create(SPLVencoder* encoder, uint32_t width, uint32_t height, uint32_t depth, float framerate, SPLVencodingParams encodingParams, const char* outPath);
 
 /**
- * encodes a frame to the end of the encoded stream. You MUST keep any encoded frames in memory until
- * either this function sets canFree to SPLV_TRUE, or splv_encoder_finish() is called. Once one of these
- * conditions is met you can free all frames encoded thus far.
+ * creates a new encoder with the given runtime options, call splv_encoder_finish() or splv_encoder_abort() to free any resources
+ */
+SPLV_API SPLVerror splv_encoder_create_with_options(SPLVencoder* encoder, uint32_t width, uint32_t height, uint32_t depth, float framerate, 
+                                                    SPLVencodingParams encodingParams, SPLVencoderOptions options, const char* outPath);
+
+/**
+ * encodes a frame to the end of the encoded stream. The encoder packs the frame into its own compact copy, so it can be freed
+ * as soon as this function returns. canFree is always set to SPLV_TRUE, and is kept for compatibility.
+ * 
+ * if the encoder was created with maxFramesInFlight > 1, the frame may still be encoding when this function returns,
+ * it will be written to the output file by a later call to splv_encoder_encode_frame() or splv_encoder_finish()
  */
 SPLV_API SPLVerror splv_encoder_encode_frame(SPLVencoder* encoder, SPLVframe* frame, splv_bool_t* canFree);
 
 /**
- * finishes encoding, writing metadata to the file, frees any resources from splv_encoder_create()
+ * identical to splv_encoder_encode_frame(), but encodes a compact frame. The frame is copied into the encoder's own compact copy,
+ * so it can be freed as soon as this function returns. Can be mixed with splv_encoder_encode_frame() on the same encoder
+ */
+SPLV_API SPLVerror splv_encoder_encode_frame_compact(SPLVencoder* encoder, SPLVframeCompact* frame);
+
+/**
+ * encodes a frame to the end of the encoded stream, taking ownership of it. The encoder frees the frame as soon as it has been
+ * packed into the encoder's own compact copy, even if this function fails. The output is identical to encoding the same frames with
+ * splv_encoder_encode_frame(). Cannot be mixed with splv_encoder_encode_frame() on the same encoder
+ */
+SPLV_API SPLVerror splv_encoder_submit_frame(SPLVencoder* encoder, SPLVframe* frame);
+
+/**
+ * finishes encoding, waiting for any frames still in flight, writing metadata to the file, frees any resources from splv_encoder_create()
  */
 SPLV_API SPLVerror splv_encoder_finish(SPLVencoder* encoder);
 
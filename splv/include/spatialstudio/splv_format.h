@@ -15,10 +15,66 @@
 #define SPLV_MAKE_VERSION(major, minor, patch, subpatch) (((major) << 24) | ((minor) << 16) | ((patch) << 8) | (subpatch))
 
 #define SPLV_MAGIC_WORD (('s' << 24) | ('p' << 16) | ('l' << 8) | ('v'))
-#define SPLV_VERSION (SPLV_MAKE_VERSION(0, 3, 0, 0))
+#define SPLV_VERSION (SPLV_MAKE_VERSION(0, 4, 0, 0))
 
 //-------------------------------------------//
 
+/**
+ * strategies for searching for motion vectors, trading off encoding speed for compression
+ */
+typedef enum SPLVmotionSearchPreset
+{
+	SPLV_MOTION_SEARCH_PRESET_DEFAULT    = 0, //three-step search around the zero vector
+	SPLV_MOTION_SEARCH_PRESET_FAST       = 1, //diamond search seeded with the motion vectors of neighboring bricks, for live capture
+	SPLV_MOTION_SEARCH_PRESET_EXHAUSTIVE = 2, //tests every motion vector in the search range, for offline/archival encoding
+
+	SPLV_MOTION_SEARCH_PRESET_COUNT
+} SPLVmotionSearchPreset;
+
+/**
+ * entropy coders that brick groups can be compressed with
+ */
+typedef enum SPLVentropyCoder
+{
+	SPLV_ENTROPY_CODER_RANGE = 0, //adaptive-precision range coder, slightly better compression
+	SPLV_ENTROPY_CODER_RANS  = 1, //interleaved rANS, much faster decoding
+
+	SPLV_ENTROPY_CODER_COUNT
+} SPLVentropyCoder;
+
+/**
+ * methods that brick occupancy can be coded with
+ */
+typedef enum SPLVgeometryCoder
+{
+	SPLV_GEOMETRY_CODER_RLE     = 0, //run-length coded, then entropy coded with the other streams
+	SPLV_GEOMETRY_CODER_CONTEXT = 1, //adaptive binary coding using neighboring voxels as context, smaller for surface-like content
+
+	SPLV_GEOMETRY_CODER_COUNT
+} SPLVgeometryCoder;
+
+/**
+ * orders that the voxels within a brick can be traversed in when coding occupancy and colors
+ */
+typedef enum SPLVvoxelOrder
+{
+	SPLV_VOXEL_ORDER_LINEAR = 0, //x, then y, then z
+	SPLV_VOXEL_ORDER_MORTON = 1, //z-order curve, consecutive voxels stay spatially close
+
+	SPLV_VOXEL_ORDER_COUNT
+} SPLVvoxelOrder;
+
+/**
+ * orders that the bricks of a frame can be sequenced in, brick groups are consecutive runs of this sequence
+ */
+typedef enum SPLVbrickOrder
+{
+	SPLV_BRICK_ORDER_LINEAR = 0, //nested loops over x, then y, then z, brick groups are thin slabs
+	SPLV_BRICK_ORDER_MORTON = 1, //z-order curve, brick groups are compact blocks
+
+	SPLV_BRICK_ORDER_COUNT
+} SPLVbrickOrder;
+
 /**
  * parameters used to control the encoding of SPLV
  */
@@ -27,6 +83,12 @@ typedef struct SPLVencodingParams
 	uint32_t gopSize;
 	uint32_t maxBrickGroupSize;
 	splv_bool_t motionVectors;
+	uint8_t motionSearchPreset; //an SPLVmotionSearchPreset, only used if motionVectors is set
+	uint8_t entropyCoder; //an SPLVentropyCoder
+	uint8_t geometryCoder; //an SPLVgeometryCoder
+	uint8_t voxelOrder; //an SPLVvoxelOrder
+	uint8_t brickOrder; //an SPLVbrickOrder
+	uint8_t tileSize; //side length, in bricks, of independently decodable tiles. 0 disables tiling
 } SPLVencodingParams;
 
 /**
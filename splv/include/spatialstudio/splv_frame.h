@@ -30,7 +30,7 @@ typedef struct SPLVframe
 
 	uint32_t bricksLen;
 	uint32_t bricksCap;
-	SPLVbrick* bricks;
+	SPLVbrick* bricks; //shares map's allocation
 } SPLVframe;
 
 //-------------------------------------------//
@@ -40,6 +40,12 @@ typedef struct SPLVframe
  */
 SPLV_API SPLVerror splv_frame_create(SPLVframe* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t numBricksInitial);
 
+/**
+ * like splv_frame_create(), but reuses the allocation of a previously created frame if the map is the same size and it has
+ * room for numBricksInitial bricks. frame must either be zeroed or previously created, its contents are not kept
+ */
+SPLV_API SPLVerror splv_frame_recreate(SPLVframe* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t numBricksInitial);
+
 /**
  * frees all resources allocated from splv_frame_create()
  */
@@ -50,6 +56,19 @@ SPLV_API void splv_frame_destroy(SPLVframe* frame);
  */
 SPLV_API uint32_t splv_frame_get_map_idx(SPLVframe* frame, uint32_t x, uint32_t y, uint32_t z);
 
+/**
+ * returns the number of tiles a map of the given size is split into, a tileSize of 0 means the map is untiled (a single tile)
+ */
+SPLV_API uint32_t splv_frame_get_num_tiles(uint32_t width, uint32_t height, uint32_t depth, uint32_t tileSize);
+
+/**
+ * fills outMapIndices with the map index of every position in a map of the given size, in the order bricks are sequenced in for the given
+ * SPLVbrickOrder. The map is split into tiles of tileSize^3 bricks, each tile's positions are consecutive and tiles are sequenced in the same order.
+ * If outTileStarts is not NULL, it is filled with the index into outMapIndices that each tile starts at, followed by the total number of positions
+ */
+SPLV_API void splv_frame_get_brick_order(uint32_t width, uint32_t height, uint32_t depth, SPLVbrickOrder order, uint32_t tileSize, 
+                                         uint32_t* outMapIndices, uint32_t* outTileStarts);
+
 /**
  * returns a pointer to a fresh brick. does not add this brick to the map, useful as a "scratch buffer"
  */
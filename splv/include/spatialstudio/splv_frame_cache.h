@@ -0,0 +1,75 @@
+/* splv_frame_cache.h
+ *
+ * contains a cache of decoded frames, for random access into a decoder
+ */
+
+#ifndef SPLV_FRAME_CACHE_H
+#define SPLV_FRAME_CACHE_H
+
+#include "splv_decoder.h"
+
+//-------------------------------------------//
+
+#define SPLV_FRAME_CACHE_POOL_SIZE 4
+
+//-------------------------------------------//
+
+/**
+ * a single decoded frame held by a frame cache, kept compact
+ */
+typedef struct SPLVframeCacheEntry
+{
+	uint64_t idx;
+	uint64_t gopStart; //the index of the i-frame the frame depends on
+	uint64_t size;
+
+	SPLVframeCompact frame;
+} SPLVframeCacheEntry;
+
+/**
+ * a cache of decoded frames on top of a decoder, decoding any frames needed to reach a requested frame. When over budget,
+ * the frames in GOPs farthest from the last requested frame are evicted first
+ */
+typedef struct SPLVframeCache
+{
+	SPLVdecoder* decoder;
+
+	uint64_t memoryBudget;
+	uint64_t memoryUsed;
+
+	uint32_t numEntries;
+	uint32_t maxEntries;
+	SPLVframeCacheEntry** entries;
+
+	uint32_t numFreeEntries;
+	SPLVframeCacheEntry* freeEntries[SPLV_FRAME_CACHE_POOL_SIZE]; //evicted entries, decoded into again
+
+	SPLVframe unpackedFrame; //the last frame returned by splv_frame_cache_get_frame()
+} SPLVframeCache;
+
+//-------------------------------------------//
+
+/**
+ * creates a frame cache for a decoder, holding at most memoryBudget bytes of decoded compact frames. Only the most recently requested
+ * frame is always kept, even if it exceeds the budget, its dependencies may be evicted. The decoder must outlive the cache. call splv_frame_cache_destroy() to free
+ */
+SPLV_API SPLVerror splv_frame_cache_create(SPLVframeCache* cache, SPLVdecoder* decoder, uint64_t memoryBudget);
+
+/**
+ * frees all frames held by the cache
+ */
+SPLV_API void splv_frame_cache_destroy(SPLVframeCache* cache);
+
+/**
+ * returns the decoded frame at idx, decoding it + any of its dependencies that are not cached. The frame is unpacked from the
+ * cached compact frame, is owned by the cache, and is only valid until the next call to splv_frame_cache_get_frame() or splv_frame_cache_destroy()
+ */
+SPLV_API SPLVerror splv_frame_cache_get_frame(SPLVframeCache* cache, uint64_t idx, SPLVframe** frame);
+
+/**
+ * like splv_frame_cache_get_frame(), but returns the cached compact frame directly. The frame is owned by the cache, and is only
+ * valid until the next call to splv_frame_cache_get_frame_compact() or splv_frame_cache_destroy()
+ */
+SPLV_API SPLVerror splv_frame_cache_get_frame_compact(SPLVframeCache* cache, uint64_t idx, SPLVframeCompact** frame);
+
+#endif //#ifndef SPLV_FRAME_CACHE_H
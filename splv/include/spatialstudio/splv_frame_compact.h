@@ -14,7 +14,8 @@
 //-------------------------------------------//
 
 /**
- * a BRICK_SIZE^3 bitmap of voxels, with a ptr to actual voxel data
+ * a BRICK_SIZE^3 bitmap of voxels, with an offset to its voxels' colors in the frame's voxel array. Only filled voxels have
+ * a color, stored in the same order as the bitmap's bits, so a voxel's color is at voxelsOffset + the number of filled voxels before it
  */
 typedef struct SPLVbrickCompact
 {
@@ -23,7 +24,8 @@ typedef struct SPLVbrickCompact
 } SPLVbrickCompact;
 
 /**
- * a single frame of a spatial, in a more compact format
+ * a single frame of a spatial, in a more compact format. Bricks only store the colors of their filled voxels, so this uses
+ * far less memory than an SPLVframe for sparse content
  */
 typedef struct SPLVframeCompact
 {
@@ -39,6 +41,10 @@ typedef struct SPLVframeCompact
 
 	uint64_t numVoxels;
 	uint32_t* voxels;
+
+	//map, bricks, and voxels are a single allocation starting at map
+	uint32_t bricksCap;
+	uint64_t voxelsCap;
 } SPLVframeCompact;
 
 //-------------------------------------------//
@@ -48,9 +54,82 @@ typedef struct SPLVframeCompact
  */
 SPLV_API SPLVerror splv_frame_compact_create(SPLVframeCompact* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t numBricks, uint64_t numVoxels);
 
+/**
+ * like splv_frame_compact_create(), but reuses the allocation of a previously created frame if it is large enough. frame must
+ * either be zeroed or previously created, its contents are not kept
+ */
+SPLV_API SPLVerror splv_frame_compact_recreate(SPLVframeCompact* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t numBricks, uint64_t numVoxels);
+
 /**
  * frees all resources allocated from splv_frame_compact_create()
  */
 SPLV_API void splv_frame_compact_destroy(SPLVframeCompact* frame);
 
+/**
+ * grows a compact frame's capacity to hold at least the given number of bricks + voxels, keeping its contents
+ */
+SPLV_API SPLVerror splv_frame_compact_reserve(SPLVframeCompact* frame, uint32_t bricksCap, uint64_t voxelsCap);
+
+/**
+ * gets the index into frame->map cooresponding to the given position
+ */
+SPLV_API uint32_t splv_frame_compact_get_map_idx(SPLVframeCompact* frame, uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * packs a brick's filled voxels onto the end of the frame, and adds it to the map at the given location. Useful for building a
+ * compact frame a brick at a time, starting from one created with 0 bricks + voxels
+ */
+SPLV_API SPLVerror splv_frame_compact_push_brick(SPLVframeCompact* frame, uint32_t x, uint32_t y, uint32_t z, SPLVbrick* brick);
+
+/**
+ * unpacks a brick of a compact frame into a full brick. The colors of empty voxels are left undefined
+ */
+SPLV_API void splv_frame_compact_unpack_brick(SPLVframeCompact* frame, uint32_t brickIdx, SPLVbrick* out);
+
+/**
+ * packs a frame into a compact frame, which must either be zeroed or previously created. Its allocation is reused if large enough
+ */
+SPLV_API SPLVerror splv_frame_compact_pack(SPLVframe* frame, SPLVframeCompact* compactFrame);
+
+/**
+ * unpacks a compact frame into a frame, which must either be zeroed or previously created. Its allocation is reused if large enough
+ */
+SPLV_API SPLVerror splv_frame_compact_unpack(SPLVframeCompact* compactFrame, SPLVframe* frame);
+
+/**
+ * removes all nonvisible voxels from a compact frame, returning a newly created compact frame. Equivalent to splv_frame_remove_nonvisible_voxels()
+ */
+SPLV_API SPLVerror splv_frame_compact_remove_nonvisible_voxels(SPLVframeCompact* frame, SPLVframeCompact* processedFrame);
+
+/**
+ * returns the size, in bytes, of a compact frame in memory
+ */
+SPLV_API uint64_t splv_frame_compact_get_size(SPLVframeCompact* frame);
+
+/**
+ * returns whether the voxel at the given location is filled
+ */
+SPLV_API splv_bool_t splv_brick_compact_get_voxel(SPLVbrickCompact* brick, uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * returns whether the voxel at the given location is filled, as well as its color. voxels is the voxel array of the brick's frame
+ */
+SPLV_API splv_bool_t splv_brick_compact_get_voxel_color(SPLVbrickCompact* brick, const uint32_t* voxels, uint32_t x, uint32_t y, uint32_t z,
+                                                        uint8_t* colorR, uint8_t* colorG, uint8_t* colorB);
+
+/**
+ * returns the number of filled voxels before the voxel at the given index into the bitmap, i.e. the offset of its color from voxelsOffset
+ */
+SPLV_API uint32_t splv_brick_compact_get_voxel_rank(SPLVbrickCompact* brick, uint32_t idx);
+
+/**
+ * returns the number of filled voxels in a compact brick
+ */
+SPLV_API uint32_t splv_brick_compact_get_num_voxels(SPLVbrickCompact* brick);
+
+/**
+ * returns whether two compact bricks have the same geometry and colors. voxels1 and voxels2 are the voxel arrays of each brick's frame
+ */
+SPLV_API splv_bool_t splv_brick_compact_equals(SPLVbrickCompact* brick1, const uint32_t* voxels1, SPLVbrickCompact* brick2, const uint32_t* voxels2);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+/* splv_frame_pool.h
+ *
+ * contains a pool of recycled frames, to avoid reallocating frames in decode loops
+ */
+
+#ifndef SPLV_FRAME_POOL_H
+#define SPLV_FRAME_POOL_H
+
+#include "splv_frame.h"
+
+//-------------------------------------------//
+
+/**
+ * a pool of previously used frames. Released frames keep their allocations, so acquiring one and passing it to
+ * splv_frame_recreate() or splv_decoder_decode_frame_into() will usually not allocate. Not thread-safe
+ */
+typedef struct SPLVframePool
+{
+	uint32_t maxFrames;
+	uint32_t numFrames;
+	SPLVframe* frames;
+} SPLVframePool;
+
+//-------------------------------------------//
+
+/**
+ * creates a frame pool holding at most maxFrames released frames, any beyond that are freed. call splv_frame_pool_destroy() to free
+ */
+SPLV_API SPLVerror splv_frame_pool_create(SPLVframePool* pool, uint32_t maxFrames);
+
+/**
+ * frees all frames held by the pool
+ */
+SPLV_API void splv_frame_pool_destroy(SPLVframePool* pool);
+
+/**
+ * writes a frame to be recreated into frame. This is a previously released frame if the pool has one, or a zeroed frame if not.
+ * Either way its contents are undefined until it is passed to splv_frame_recreate() or splv_decoder_decode_frame_into()
+ */
+SPLV_API void splv_frame_pool_acquire(SPLVframePool* pool, SPLVframe* frame);
+
+/**
+ * returns a frame to the pool, transferring its ownership. The frame is freed if the pool is full. frame is zeroed
+ */
+SPLV_API void splv_frame_pool_release(SPLVframePool* pool, SPLVframe* frame);
+
+#endif //#ifndef SPLV_FRAME_POOL_H
@@ -25,7 +25,8 @@
 
 //-------------------------------------------//
 
-#if !defined(SPLV) || !defined(SPLV_FREE) || !defined(QOBJ_FREE)
+//define all 3 (e.g. as compiler flags) to route every allocation through a custom allocator
+#if !defined(SPLV_MALLOC) || !defined(SPLV_FREE) || !defined(SPLV_REALLOC)
 	#include <stdlib.h>
 
 	#define SPLV_MALLOC(s) malloc(s)
@@ -7,6 +7,7 @@
 #define SPLV_NVDB_UTILS_H
 
 #include "splv_frame.h"
+#include "splv_frame_compact.h"
 #include "splv_error.h"
 #include "splv_global.h"
 
@@ -17,6 +18,11 @@
  */
 SPLV_API SPLVerror splv_nvdb_load(const char* path, SPLVframe* outFrame, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis);
 
+/**
+ * loads a frame from a .nvdb file directly into a compact frame, without ever holding the full SPLVframe. call splv_frame_compact_destroy() to free allocated memory
+ */
+SPLV_API SPLVerror splv_nvdb_load_compact(const char* path, SPLVframeCompact* outFrame, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis);
+
 /**
  * saves a frame into a .nvdb file. The voxels are written in the bounding box (0, 0, 0) to (width - 1, height - 1, depth - 1)
  */
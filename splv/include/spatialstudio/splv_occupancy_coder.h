@@ -0,0 +1,84 @@
+/* splv_occupancy_coder.h
+ *
+ * contains SPLV's context-modelled occupancy coder: an adaptive binary range coder that codes brick
+ * bitmaps using their already-coded neighbors and the motion-compensated reference as context
+ */
+
+#ifndef SPLV_OCCUPANCY_CODER_H
+#define SPLV_OCCUPANCY_CODER_H
+
+#include <stdint.h>
+#include "spatialstudio/splv_error.h"
+#include "spatialstudio/splv_log.h"
+#include "spatialstudio/splv_buffer_io.h"
+
+//----------------------------------------------------------------------//
+
+#define SPLV_OCCUPANCY_NUM_ROW_CONTEXTS 16
+#define SPLV_OCCUPANCY_NUM_VOXEL_CONTEXTS 512
+
+/**
+ * adaptive probabilities of each context, shared by every brick coded with the same coder
+ */
+typedef struct SPLVoccupancyModel
+{
+	uint16_t rows[SPLV_OCCUPANCY_NUM_ROW_CONTEXTS];
+	uint16_t voxels[SPLV_OCCUPANCY_NUM_VOXEL_CONTEXTS];
+} SPLVoccupancyModel;
+
+/**
+ * state for coding the occupancy of a sequence of bricks
+ */
+typedef struct SPLVoccupancyEncoder
+{
+	uint64_t low;
+	uint32_t range;
+	uint8_t cache;
+	uint64_t cacheSize;
+
+	SPLVoccupancyModel model;
+} SPLVoccupancyEncoder;
+
+/**
+ * state for decoding the occupancy of a sequence of bricks
+ */
+typedef struct SPLVoccupancyDecoder
+{
+	uint32_t range;
+	uint32_t code;
+
+	const uint8_t* inBuf;
+	uint64_t inBufLen;
+	uint64_t readPos;
+
+	SPLVoccupancyModel model;
+} SPLVoccupancyDecoder;
+
+//----------------------------------------------------------------------//
+
+/**
+ * initializes an occupancy encoder, must be called before any bricks are encoded
+ */
+void splv_occupancy_encoder_init(SPLVoccupancyEncoder* enc);
+
+/**
+ * encodes a brick bitmap to out. refBitmap is the motion-compensated reference for predictive bricks, or NULL for intra bricks
+ */
+SPLVerror splv_occupancy_encode(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out, const uint32_t* bitmap, const uint32_t* refBitmap);
+
+/**
+ * flushes the encoder's remaining state to out, must be called after the last brick is encoded
+ */
+SPLVerror splv_occupancy_encoder_finish(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out);
+
+/**
+ * initializes an occupancy decoder reading from inBuf, must be called before any bricks are decoded
+ */
+void splv_occupancy_decoder_init(SPLVoccupancyDecoder* dec, uint64_t inBufLen, const uint8_t* inBuf);
+
+/**
+ * decodes a brick bitmap. refBitmap must match the one passed to splv_occupancy_encode()
+ */
+SPLVerror splv_occupancy_decode(SPLVoccupancyDecoder* dec, const uint32_t* refBitmap, uint32_t* bitmap);
+
+#endif //#ifndef SPLV_OCCUPANCY_CODER_H
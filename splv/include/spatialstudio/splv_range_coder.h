@@ -23,4 +23,9 @@ SPLVerror splv_rc_encode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* ou
  */
 SPLVerror splv_rc_decode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out);
 
+/**
+ * performs range coding decoding of data encoded with an uncompressed frequency table. Works for SPLVs in the previous version
+ */
+SPLVerror splv_rc_decode_legacy(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out);
+
 #endif //#ifndef SPLV_RANGE_CODER_H
\ No newline at end of file
@@ -0,0 +1,26 @@
+/* splv_rans.h
+ *
+ * contains SPLV's alternate entropy coder implementation: an interleaved static-model rANS coder
+ */
+
+#ifndef SPLV_RANS_H
+#define SPLV_RANS_H
+
+#include <stdint.h>
+#include "spatialstudio/splv_error.h"
+#include "spatialstudio/splv_log.h"
+#include "spatialstudio/splv_buffer_io.h"
+
+//----------------------------------------------------------------------//
+
+/**
+ * performs rANS encoding, reading raw data from inBuf and outputting encoded data to out
+ */
+SPLVerror splv_rans_encode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out);
+
+/**
+ * performs rANS decoding, reading encoded data from inBuf and outputting raw data to out
+ */
+SPLVerror splv_rans_decode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out);
+
+#endif //#ifndef SPLV_RANS_H
@@ -17,6 +17,12 @@
 
 //-------------------------------------------//
 
+#ifndef SPLV_THREAD_POOL_SPIN_ITERATIONS
+	#define SPLV_THREAD_POOL_SPIN_ITERATIONS 1024
+#endif
+
+//-------------------------------------------//
+
 /**
  * thread function prototype
  */
@@ -64,27 +70,77 @@ typedef struct SPLVconditionVariable
  */
 typedef SPLVerror (*SPLVthreadPoolFunc)(void*);
 
+typedef struct SPLVthreadPool SPLVthreadPool;
+
+/**
+ * a set of work items submitted to a thread pool by a single owner, can be waited on independently of other groups
+ * sharing the same pool
+ */
+typedef struct SPLVthreadPoolGroup
+{
+	SPLVthreadPool* pool;
+	SPLVthreadPoolFunc workFunc;
+
+	volatile uint32_t numWorkPending;   //items queued or being processed
+	volatile uint32_t numWorkFinishing; //items done processing, but still touching the group
+	volatile uint32_t firstError;
+
+	SPLVmutex workDoneMutex;
+	SPLVconditionVariable workDoneCond;
+} SPLVthreadPoolGroup;
+
+/**
+ * a single work item in a thread pool
+ */
+typedef struct SPLVthreadPoolTask
+{
+	void* item;
+	SPLVthreadPoolGroup* group;
+} SPLVthreadPoolTask;
+
 /**
- * thread pool for simpler multithreading
+ * a single worker's queue of work items. the owning worker pushes/pops from the tail,
+ * other workers steal from the head
+ */
+typedef struct SPLVthreadPoolDeque
+{
+	SPLVmutex mutex;
+
+	uint64_t head;
+	uint64_t tail;
+	uint64_t cap; //always a power of 2
+	SPLVthreadPoolTask* tasks;
+} SPLVthreadPoolDeque;
+
+/**
+ * a thread pool worker
+ */
+typedef struct SPLVthreadPoolWorker
+{
+	SPLVthreadPool* pool;
+	uint32_t idx;
+	SPLVthread thread;
+} SPLVthreadPoolWorker;
+
+/**
+ * work-stealing thread pool for simpler multithreading, can be shared between any number of encoders/decoders
  */
 typedef struct SPLVthreadPool
 {
-	uint32_t threadsShouldExit;
+	volatile uint32_t threadsShouldExit;
 	uint32_t numThreads;
-	SPLVthread* threads;
+	SPLVthreadPoolWorker* workers;
+	SPLVthreadPoolDeque* deques;
+	volatile uint32_t nextDeque;
 
-	SPLVthreadPoolFunc workFunc;
+	uint8_t pinThreads;
+	uint32_t firstCpu;
 
-	uint64_t workSize;
-	int64_t workStackTop;
-	uint64_t workStackCap;
-	void* workStack;
-	SPLVmutex workStackMutex;
-	SPLVconditionVariable workStackEmptyCond;
+	volatile uint32_t numWorkQueued; //items sitting in a deque
 
-	uint32_t numWorkProcessing;
-	SPLVmutex workingMutex;
-	SPLVconditionVariable workDoneCond;
+	volatile uint32_t numSleeping;
+	SPLVmutex sleepMutex;
+	SPLVconditionVariable workAvailableCond;
 } SPLVthreadPool;
 
 //-------------------------------------------//
@@ -145,23 +201,119 @@ SPLV_NOMANGLE SPLVerror splv_condition_variable_signal_one(SPLVconditionVariable
 SPLV_NOMANGLE SPLVerror splv_condition_variable_signal_all(SPLVconditionVariable* cond);
 
 /**
- * creates a thread pool
+ * returns the number of logical CPUs available
+ */
+SPLV_API uint32_t splv_get_hardware_concurrency(void);
+
+/**
+ * creates a thread pool with numThreads threads, or one per logical CPU if numThreads is 0. If pinThreads is set,
+ * thread i is pinned to logical CPU (firstCpu + i) mod the number of CPUs, this is ignored on platforms without affinity support
+ */
+SPLV_API SPLVerror splv_thread_pool_create(SPLVthreadPool** pool, uint32_t numThreads, uint8_t pinThreads, uint32_t firstCpu);
+
+/**
+ * destroys a thread pool, all groups using the pool must be destroyed first
+ */
+SPLV_API void splv_thread_pool_destroy(SPLVthreadPool* pool);
+
+/**
+ * creates a work group on a thread pool, workFunc will be called on each item added to the group
+ */
+SPLV_NOMANGLE SPLVerror splv_thread_pool_group_create(SPLVthreadPoolGroup* group, SPLVthreadPool* pool, SPLVthreadPoolFunc workFunc);
+
+/**
+ * waits for any outstanding work, then destroys a work group
+ */
+SPLV_NOMANGLE void splv_thread_pool_group_destroy(SPLVthreadPoolGroup* group);
+
+/**
+ * adds a work item to a group. The item is not copied, it must remain valid until splv_thread_pool_wait() returns
+ */
+SPLV_NOMANGLE SPLVerror splv_thread_pool_add_work(SPLVthreadPoolGroup* group, void* workItem);
+
+/**
+ * adds numItems work items, stored contiguously itemSize bytes apart, to a group. The items are not copied,
+ * they must remain valid until splv_thread_pool_wait() returns
+ */
+SPLV_NOMANGLE SPLVerror splv_thread_pool_add_work_batch(SPLVthreadPoolGroup* group, void* workItems, uint32_t numItems, uint64_t itemSize);
+
+/**
+ * waits for all work in a group to finish, returns the first error returned by a work item since the last wait
  */
-SPLV_NOMANGLE SPLVerror splv_thread_pool_create(SPLVthreadPool** pool, uint32_t numThreads, SPLVthreadPoolFunc workFunc, uint64_t workSize);
+SPLV_NOMANGLE SPLVerror splv_thread_pool_wait(SPLVthreadPoolGroup* group);
+
+//-------------------------------------------//
 
 /**
- * destroys a thread pool
+ * atomically loads a value
  */
-SPLV_NOMANGLE void splv_thread_pool_destroy(SPLVthreadPool* pool);
+static inline uint32_t splv_atomic_load_u32(volatile uint32_t* val)
+{
+#ifdef _MSC_VER
+	return (uint32_t)InterlockedCompareExchange((volatile LONG*)val, 0, 0);
+#else
+	return __atomic_load_n(val, __ATOMIC_SEQ_CST);
+#endif
+}
 
 /**
- * pushes work on to a thread pool's stack
+ * atomically stores a value
  */
-SPLV_NOMANGLE SPLVerror splv_thread_pool_add_work(SPLVthreadPool* pool, void* workItem);
+static inline void splv_atomic_store_u32(volatile uint32_t* val, uint32_t newVal)
+{
+#ifdef _MSC_VER
+	InterlockedExchange((volatile LONG*)val, (LONG)newVal);
+#else
+	__atomic_store_n(val, newVal, __ATOMIC_SEQ_CST);
+#endif
+}
 
 /**
- * waits for all work in a thread pool to finish
+ * atomically exchanges a value, returning the old value
  */
-SPLV_NOMANGLE SPLVerror splv_thread_pool_wait(SPLVthreadPool* pool);
+static inline uint32_t splv_atomic_exchange_u32(volatile uint32_t* val, uint32_t newVal)
+{
+#ifdef _MSC_VER
+	return (uint32_t)InterlockedExchange((volatile LONG*)val, (LONG)newVal);
+#else
+	return __atomic_exchange_n(val, newVal, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * atomically adds to a value, returning the new value
+ */
+static inline uint32_t splv_atomic_add_u32(volatile uint32_t* val, uint32_t add)
+{
+#ifdef _MSC_VER
+	return (uint32_t)InterlockedExchangeAdd((volatile LONG*)val, (LONG)add) + add;
+#else
+	return __atomic_add_fetch(val, add, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * atomically subtracts from a value, returning the new value
+ */
+static inline uint32_t splv_atomic_sub_u32(volatile uint32_t* val, uint32_t sub)
+{
+#ifdef _MSC_VER
+	return (uint32_t)InterlockedExchangeAdd((volatile LONG*)val, -(LONG)sub) - sub;
+#else
+	return __atomic_sub_fetch(val, sub, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * atomically sets a value to newVal if it is equal to expected, returns whether the value was set
+ */
+static inline uint32_t splv_atomic_compare_exchange_u32(volatile uint32_t* val, uint32_t expected, uint32_t newVal)
+{
+#ifdef _MSC_VER
+	return (uint32_t)InterlockedCompareExchange((volatile LONG*)val, (LONG)newVal, (LONG)expected) == expected;
+#else
+	return __atomic_compare_exchange_n(val, &expected, newVal, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
 
 #endif //#ifndef SPLV_THREADING_H
\ No newline at end of file
@@ -41,7 +41,7 @@ SPLV_API SPLVerror splv_file_concat(uint32_t numPaths, const char** paths, const
 SPLV_API SPLVerror splv_file_split(const char* path, float splitLength, const char* outDir, uint32_t* numSplits);
 
 /**
- * upgrades an splv file to the latest version
+ * upgrades an splv file from an older version (0.2.1.0 or 0.3.0.0) to the latest version
  */
 SPLV_API SPLVerror splv_file_upgrade(const char* path, const char* outPath);
 
@@ -7,6 +7,7 @@
 #define SPLV_VOX_UTILS_H
 
 #include "splv_frame.h"
+#include "splv_frame_compact.h"
 #include "splv_error.h"
 #include "splv_global.h"
 
@@ -26,6 +27,16 @@ SPLV_API SPLVerror splv_vox_load(const char* path, SPLVframe*** outFrames, uint3
  */
 SPLV_API void splv_vox_frames_destroy(SPLVframe** frames, uint32_t numFrames);
 
+/**
+ * identical to splv_vox_load(), but loads directly into compact frames, call splv_vox_frames_compact_destroy() to free allocated memory
+ */
+SPLV_API SPLVerror splv_vox_load_compact(const char* path, SPLVframeCompact*** outFrames, uint32_t* numOutFrames, SPLVboundingBox* bbox);
+
+/**
+ * destroys all frames allocated from splv_vox_load_compact()
+ */
+SPLV_API void splv_vox_frames_compact_destroy(SPLVframeCompact** frames, uint32_t numFrames);
+
 /**
  * returns the maximum dimension out of all frames in a .vox file.
  * 
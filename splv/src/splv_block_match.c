@@ -0,0 +1,377 @@
+#include "splv_block_match.h"
+
+#include "splv_simd.h"
+#include <string.h>
+
+#if defined(SPLV_SIMD_X86)
+	#include <immintrin.h>
+#endif
+
+//-------------------------------------------//
+
+#define SPLV_BLOCK_MATCH_RGB_MASK 0xFFFFFF00
+
+//-------------------------------------------//
+
+static void _splv_block_match_select_kernel(SPLVblockMatchNeighborhood* neighborhood);
+
+static uint64_t _splv_block_match_cost_scalar(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ);
+
+#if defined(SPLV_SIMD_X86)
+	static uint64_t _splv_block_match_cost_sse4(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ);
+	static uint64_t _splv_block_match_cost_avx2(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ);
+	static uint64_t _splv_block_match_cost_avx512(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ);
+#endif
+
+//-------------------------------------------//
+
+void splv_block_match_neighborhood_init(SPLVblockMatchNeighborhood* neighborhood, SPLVframe* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap)
+{
+	//gather bricks:
+	//-----------------
+	memset(neighborhood->occupancy, 0, sizeof(neighborhood->occupancy));
+
+	for(uint32_t zNeighbor = 0; zNeighbor < 3; zNeighbor++)
+	for(uint32_t yNeighbor = 0; yNeighbor < 3; yNeighbor++)
+	for(uint32_t xNeighbor = 0; xNeighbor < 3; xNeighbor++)
+	{
+		int32_t mapX = (int32_t)xMap + (int32_t)xNeighbor - 1;
+		int32_t mapY = (int32_t)yMap + (int32_t)yNeighbor - 1;
+		int32_t mapZ = (int32_t)zMap + (int32_t)zNeighbor - 1;
+
+		//missing bricks are left empty, their colors are always masked out
+		if(mapX < 0 || mapX >= (int32_t)lastFrame->width  ||
+		   mapY < 0 || mapY >= (int32_t)lastFrame->height ||
+		   mapZ < 0 || mapZ >= (int32_t)lastFrame->depth)
+			continue;
+
+		uint32_t brickIdx = lastFrame->map[splv_frame_get_map_idx(lastFrame, mapX, mapY, mapZ)];
+		if(brickIdx == SPLV_BRICK_IDX_EMPTY)
+			continue;
+
+		const SPLVbrick* lastBrick = &lastFrame->bricks[brickIdx];
+
+		for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+		for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+		{
+			uint32_t neighborhoodY = yNeighbor * SPLV_BRICK_SIZE + y;
+			uint32_t neighborhoodZ = zNeighbor * SPLV_BRICK_SIZE + z;
+			uint32_t rowIdx = neighborhoodY + SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * neighborhoodZ;
+
+			//each bitmap word holds 4 rows along x
+			uint32_t brickRowIdx = y + SPLV_BRICK_SIZE * z;
+			uint32_t lastRow = (lastBrick->bitmap[brickRowIdx / 4] >> ((brickRowIdx % 4) * SPLV_BRICK_SIZE)) & 0xFF;
+
+			neighborhood->occupancy[rowIdx] |= lastRow << (xNeighbor * SPLV_BRICK_SIZE);
+			memcpy(
+				&neighborhood->color[xNeighbor * SPLV_BRICK_SIZE + SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * rowIdx],
+				&lastBrick->color[SPLV_BRICK_SIZE * (y + SPLV_BRICK_SIZE * z)],
+				SPLV_BRICK_SIZE * sizeof(uint32_t)
+			);
+		}
+	}
+
+	//select kernel:
+	//-----------------
+	_splv_block_match_select_kernel(neighborhood);
+}
+
+void splv_block_match_neighborhood_init_compact(SPLVblockMatchNeighborhood* neighborhood, SPLVframeCompact* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap)
+{
+	//gather bricks:
+	//-----------------
+	memset(neighborhood->occupancy, 0, sizeof(neighborhood->occupancy));
+
+	for(uint32_t zNeighbor = 0; zNeighbor < 3; zNeighbor++)
+	for(uint32_t yNeighbor = 0; yNeighbor < 3; yNeighbor++)
+	for(uint32_t xNeighbor = 0; xNeighbor < 3; xNeighbor++)
+	{
+		int32_t mapX = (int32_t)xMap + (int32_t)xNeighbor - 1;
+		int32_t mapY = (int32_t)yMap + (int32_t)yNeighbor - 1;
+		int32_t mapZ = (int32_t)zMap + (int32_t)zNeighbor - 1;
+
+		//missing bricks are left empty, their colors are always masked out
+		if(mapX < 0 || mapX >= (int32_t)lastFrame->width  ||
+		   mapY < 0 || mapY >= (int32_t)lastFrame->height ||
+		   mapZ < 0 || mapZ >= (int32_t)lastFrame->depth)
+			continue;
+
+		uint32_t brickIdx = lastFrame->map[splv_frame_compact_get_map_idx(lastFrame, mapX, mapY, mapZ)];
+		if(brickIdx == SPLV_BRICK_IDX_EMPTY)
+			continue;
+
+		//colors are packed in bitmap order, so each row's colors follow the previous row's
+		const SPLVbrickCompact* lastBrick = &lastFrame->bricks[brickIdx];
+		const uint32_t* lastColors = &lastFrame->voxels[lastBrick->voxelsOffset];
+
+		for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+		for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+		{
+			uint32_t neighborhoodY = yNeighbor * SPLV_BRICK_SIZE + y;
+			uint32_t neighborhoodZ = zNeighbor * SPLV_BRICK_SIZE + z;
+			uint32_t rowIdx = neighborhoodY + SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * neighborhoodZ;
+
+			//each bitmap word holds 4 rows along x
+			uint32_t brickRowIdx = y + SPLV_BRICK_SIZE * z;
+			uint32_t lastRow = (lastBrick->bitmap[brickRowIdx / 4] >> ((brickRowIdx % 4) * SPLV_BRICK_SIZE)) & 0xFF;
+
+			neighborhood->occupancy[rowIdx] |= lastRow << (xNeighbor * SPLV_BRICK_SIZE);
+
+			uint32_t* dstColors = &neighborhood->color[xNeighbor * SPLV_BRICK_SIZE + SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * rowIdx];
+			while(lastRow)
+			{
+				dstColors[splv_ctz64(lastRow)] = *lastColors++;
+				lastRow &= lastRow - 1;
+			}
+		}
+	}
+
+	//select kernel:
+	//-----------------
+	_splv_block_match_select_kernel(neighborhood);
+}
+
+//-------------------------------------------//
+
+static void _splv_block_match_select_kernel(SPLVblockMatchNeighborhood* neighborhood)
+{
+	neighborhood->costFunc = _splv_block_match_cost_scalar;
+
+#if defined(SPLV_SIMD_X86)
+	switch(splv_simd_get_level())
+	{
+	case SPLV_SIMD_LEVEL_AVX512:
+		neighborhood->costFunc = _splv_block_match_cost_avx512;
+		break;
+	case SPLV_SIMD_LEVEL_AVX2:
+		neighborhood->costFunc = _splv_block_match_cost_avx2;
+		break;
+	case SPLV_SIMD_LEVEL_SSE4:
+		neighborhood->costFunc = _splv_block_match_cost_sse4;
+		break;
+	default:
+		break;
+	}
+#endif
+}
+
+//-------------------------------------------//
+
+/**
+ * returns the occupancy of the z-slice of the candidate block as a 64-bit mask, laid out the same as a brick's bitmap
+ */
+static inline uint64_t _splv_block_match_ref_slice(const SPLVblockMatchNeighborhood* neighborhood, uint32_t neighborhoodX, uint32_t neighborhoodY, uint32_t neighborhoodZ)
+{
+	const uint32_t* rows = &neighborhood->occupancy[neighborhoodY + SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * neighborhoodZ];
+
+	uint64_t slice = 0;
+	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+		slice |= (uint64_t)((rows[y] >> neighborhoodX) & 0xFF) << (y * SPLV_BRICK_SIZE);
+
+	return slice;
+}
+
+static inline uint64_t _splv_block_match_cur_slice(const SPLVbrick* brick, uint32_t z)
+{
+	return (uint64_t)brick->bitmap[2 * z] | ((uint64_t)brick->bitmap[2 * z + 1] << 32);
+}
+
+static inline const uint32_t* _splv_block_match_ref_color_row(const SPLVblockMatchNeighborhood* neighborhood, uint32_t neighborhoodX, uint32_t neighborhoodY, uint32_t neighborhoodZ)
+{
+	return &neighborhood->color[neighborhoodX + SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * (neighborhoodY + SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * neighborhoodZ)];
+}
+
+//-------------------------------------------//
+
+static uint64_t _splv_block_match_cost_scalar(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ)
+{
+	uint32_t startX = (uint32_t)(SPLV_BRICK_SIZE + offX);
+	uint32_t startY = (uint32_t)(SPLV_BRICK_SIZE + offY);
+	uint32_t startZ = (uint32_t)(SPLV_BRICK_SIZE + offZ);
+
+	uint64_t numMismatched = 0;
+	uint64_t colorCost = 0;
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	{
+		uint64_t cur = _splv_block_match_cur_slice(brick, z);
+		uint64_t ref = _splv_block_match_ref_slice(neighborhood, startX, startY, startZ + z);
+
+		numMismatched += splv_popcount64(cur ^ ref);
+
+		uint64_t both = cur & ref;
+		while(both)
+		{
+			uint32_t idx = splv_ctz64(both);
+			both &= both - 1;
+
+			uint32_t x = idx % SPLV_BRICK_SIZE;
+			uint32_t y = idx / SPLV_BRICK_SIZE;
+
+			uint32_t color1 = brick->color[idx + SPLV_BRICK_SIZE * SPLV_BRICK_SIZE * z];
+			uint32_t color2 = _splv_block_match_ref_color_row(neighborhood, startX, startY + y, startZ + z)[x];
+
+			for(uint32_t shift = 8; shift < 32; shift += 8)
+			{
+				int32_t channel1 = (int32_t)((color1 >> shift) & 0xFF);
+				int32_t channel2 = (int32_t)((color2 >> shift) & 0xFF);
+				colorCost += (uint64_t)(channel1 > channel2 ? channel1 - channel2 : channel2 - channel1);
+			}
+		}
+	}
+
+	return numMismatched * SPLV_BLOCK_MATCH_GEOM_MISMATCH_COST + colorCost;
+}
+
+#if defined(SPLV_SIMD_X86)
+
+SPLV_SIMD_TARGET("sse4.1,popcnt")
+static uint64_t _splv_block_match_cost_sse4(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ)
+{
+	uint32_t startX = (uint32_t)(SPLV_BRICK_SIZE + offX);
+	uint32_t startY = (uint32_t)(SPLV_BRICK_SIZE + offY);
+	uint32_t startZ = (uint32_t)(SPLV_BRICK_SIZE + offZ);
+
+	const __m128i laneBitsLo = _mm_setr_epi32(1, 2, 4, 8);
+	const __m128i laneBitsHi = _mm_setr_epi32(16, 32, 64, 128);
+	const __m128i rgbMask = _mm_set1_epi32((int32_t)SPLV_BLOCK_MATCH_RGB_MASK);
+
+	uint64_t numMismatched = 0;
+	__m128i colorCost = _mm_setzero_si128();
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	{
+		uint64_t cur = _splv_block_match_cur_slice(brick, z);
+		uint64_t ref = _splv_block_match_ref_slice(neighborhood, startX, startY, startZ + z);
+
+		numMismatched += splv_popcount64(cur ^ ref);
+
+		uint64_t both = cur & ref;
+		for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+		{
+			uint32_t rowMask = (uint32_t)(both >> (y * SPLV_BRICK_SIZE)) & 0xFF;
+			if(rowMask == 0)
+				continue;
+
+			const uint32_t* row1 = &brick->color[SPLV_BRICK_SIZE * (y + SPLV_BRICK_SIZE * z)];
+			const uint32_t* row2 = _splv_block_match_ref_color_row(neighborhood, startX, startY + y, startZ + z);
+
+			//expand bit mask to a lane mask, then only keep RGB
+			__m128i rowMaskVec = _mm_set1_epi32((int32_t)rowMask);
+			__m128i maskLo = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(rowMaskVec, laneBitsLo), laneBitsLo), rgbMask);
+			__m128i maskHi = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(rowMaskVec, laneBitsHi), laneBitsHi), rgbMask);
+
+			__m128i color1Lo = _mm_and_si128(_mm_loadu_si128((const __m128i*)row1      ), maskLo);
+			__m128i color1Hi = _mm_and_si128(_mm_loadu_si128((const __m128i*)(row1 + 4)), maskHi);
+			__m128i color2Lo = _mm_and_si128(_mm_loadu_si128((const __m128i*)row2      ), maskLo);
+			__m128i color2Hi = _mm_and_si128(_mm_loadu_si128((const __m128i*)(row2 + 4)), maskHi);
+
+			colorCost = _mm_add_epi64(colorCost, _mm_sad_epu8(color1Lo, color2Lo));
+			colorCost = _mm_add_epi64(colorCost, _mm_sad_epu8(color1Hi, color2Hi));
+		}
+	}
+
+	//total color cost is at most 512 * 3 * 255, so the low 32 bits of each lane suffice
+	uint64_t colorCostSum = (uint64_t)(uint32_t)_mm_cvtsi128_si32(colorCost) +
+	                        (uint64_t)(uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(colorCost, 8));
+
+	return numMismatched * SPLV_BLOCK_MATCH_GEOM_MISMATCH_COST + colorCostSum;
+}
+
+SPLV_SIMD_TARGET("avx2,popcnt")
+static uint64_t _splv_block_match_cost_avx2(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ)
+{
+	uint32_t startX = (uint32_t)(SPLV_BRICK_SIZE + offX);
+	uint32_t startY = (uint32_t)(SPLV_BRICK_SIZE + offY);
+	uint32_t startZ = (uint32_t)(SPLV_BRICK_SIZE + offZ);
+
+	const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m256i rgbMask = _mm256_set1_epi32((int32_t)SPLV_BLOCK_MATCH_RGB_MASK);
+
+	uint64_t numMismatched = 0;
+	__m256i colorCost = _mm256_setzero_si256();
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	{
+		uint64_t cur = _splv_block_match_cur_slice(brick, z);
+		uint64_t ref = _splv_block_match_ref_slice(neighborhood, startX, startY, startZ + z);
+
+		numMismatched += splv_popcount64(cur ^ ref);
+
+		uint64_t both = cur & ref;
+		for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+		{
+			uint32_t rowMask = (uint32_t)(both >> (y * SPLV_BRICK_SIZE)) & 0xFF;
+			if(rowMask == 0)
+				continue;
+
+			const uint32_t* row1 = &brick->color[SPLV_BRICK_SIZE * (y + SPLV_BRICK_SIZE * z)];
+			const uint32_t* row2 = _splv_block_match_ref_color_row(neighborhood, startX, startY + y, startZ + z);
+
+			//expand bit mask to a lane mask, then only keep RGB
+			__m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int32_t)rowMask), laneBits), laneBits);
+			mask = _mm256_and_si256(mask, rgbMask);
+
+			__m256i color1 = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)row1), mask);
+			__m256i color2 = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)row2), mask);
+
+			colorCost = _mm256_add_epi64(colorCost, _mm256_sad_epu8(color1, color2));
+		}
+	}
+
+	//total color cost is at most 512 * 3 * 255, so the low 32 bits of each lane suffice
+	__m128i colorCost128 = _mm_add_epi64(_mm256_castsi256_si128(colorCost), _mm256_extracti128_si256(colorCost, 1));
+	uint64_t colorCostSum = (uint64_t)(uint32_t)_mm_cvtsi128_si32(colorCost128) +
+	                        (uint64_t)(uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(colorCost128, 8));
+
+	return numMismatched * SPLV_BLOCK_MATCH_GEOM_MISMATCH_COST + colorCostSum;
+}
+
+SPLV_SIMD_TARGET("avx512f,avx512bw,popcnt")
+static uint64_t _splv_block_match_cost_avx512(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ)
+{
+	uint32_t startX = (uint32_t)(SPLV_BRICK_SIZE + offX);
+	uint32_t startY = (uint32_t)(SPLV_BRICK_SIZE + offY);
+	uint32_t startZ = (uint32_t)(SPLV_BRICK_SIZE + offZ);
+
+	const __m512i rgbMask = _mm512_set1_epi32((int32_t)SPLV_BLOCK_MATCH_RGB_MASK);
+
+	uint64_t numMismatched = 0;
+	__m512i colorCost = _mm512_setzero_si512();
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	{
+		uint64_t cur = _splv_block_match_cur_slice(brick, z);
+		uint64_t ref = _splv_block_match_ref_slice(neighborhood, startX, startY, startZ + z);
+
+		numMismatched += splv_popcount64(cur ^ ref);
+
+		//2 rows at a time, the current brick's rows are contiguous but the neighborhood's are not
+		uint64_t both = cur & ref;
+		for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y += 2)
+		{
+			__mmask16 rowMask = (__mmask16)((both >> (y * SPLV_BRICK_SIZE)) & 0xFFFF);
+			if(rowMask == 0)
+				continue;
+
+			const uint32_t* row1 = &brick->color[SPLV_BRICK_SIZE * (y + SPLV_BRICK_SIZE * z)];
+			const uint32_t* row2 = _splv_block_match_ref_color_row(neighborhood, startX, startY + y    , startZ + z);
+			const uint32_t* row3 = _splv_block_match_ref_color_row(neighborhood, startX, startY + y + 1, startZ + z);
+
+			__m512i color1 = _mm512_maskz_and_epi32(rowMask, _mm512_loadu_si512((const void*)row1), rgbMask);
+			__m512i color2 = _mm512_inserti64x4(
+				_mm512_castsi256_si512(_mm256_loadu_si256((const __m256i*)row2)),
+				_mm256_loadu_si256((const __m256i*)row3), 1
+			);
+			color2 = _mm512_maskz_and_epi32(rowMask, color2, rgbMask);
+
+			colorCost = _mm512_add_epi64(colorCost, _mm512_sad_epu8(color1, color2));
+		}
+	}
+
+	uint64_t colorCostSum = (uint64_t)_mm512_reduce_add_epi64(colorCost);
+
+	return numMismatched * SPLV_BLOCK_MATCH_GEOM_MISMATCH_COST + colorCostSum;
+}
+
+#endif //#if defined(SPLV_SIMD_X86)
@@ -0,0 +1,65 @@
+/* splv_block_match.h
+ *
+ * contains the block-matching cost kernels used for motion estimation
+ */
+
+#ifndef SPLV_BLOCK_MATCH_H
+#define SPLV_BLOCK_MATCH_H
+
+#include <stdint.h>
+#include "spatialstudio/splv_brick.h"
+#include "spatialstudio/splv_frame.h"
+#include "spatialstudio/splv_frame_compact.h"
+
+//-------------------------------------------//
+
+//TODO: finetune
+#define SPLV_BLOCK_MATCH_GEOM_MISMATCH_COST (256 * 3)
+
+//motion vectors can't exceed this in any axis, so any candidate block lies within the 3x3x3 bricks around the brick being matched
+#define SPLV_BLOCK_MATCH_MAX_OFFSET (SPLV_BRICK_SIZE - 1)
+#define SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE (3 * SPLV_BRICK_SIZE)
+
+//-------------------------------------------//
+
+typedef struct SPLVblockMatchNeighborhood SPLVblockMatchNeighborhood;
+
+typedef uint64_t (*SPLVblockMatchCostFunc)(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ);
+
+/**
+ * the voxels of the previous frame surrounding a brick, gathered into a dense grid for fast block matching
+ */
+typedef struct SPLVblockMatchNeighborhood
+{
+	//one bit per voxel, each entry is a row along x, indexed by y + NEIGHBORHOOD_SIZE * z
+	uint32_t occupancy[SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE];
+
+	//packed RGBA, indexed by x + NEIGHBORHOOD_SIZE * (y + NEIGHBORHOOD_SIZE * z). Empty voxels have unspecified colors
+	uint32_t color[SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE * SPLV_BLOCK_MATCH_NEIGHBORHOOD_SIZE];
+
+	SPLVblockMatchCostFunc costFunc;
+} SPLVblockMatchNeighborhood;
+
+//-------------------------------------------//
+
+/**
+ * gathers the voxels of lastFrame surrounding the brick at (xMap, yMap, zMap), and selects the fastest cost kernel for the current CPU
+ */
+void splv_block_match_neighborhood_init(SPLVblockMatchNeighborhood* neighborhood, SPLVframe* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap);
+
+/**
+ * identical to splv_block_match_neighborhood_init(), but gathers from a compact frame
+ */
+void splv_block_match_neighborhood_init_compact(SPLVblockMatchNeighborhood* neighborhood, SPLVframeCompact* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap);
+
+/**
+ * returns the cost of predicting brick from the previous frame, offset by the given motion vector. Each voxel whose
+ * occupancy doesn't match costs SPLV_BLOCK_MATCH_GEOM_MISMATCH_COST, each voxel filled in both costs the sum of absolute
+ * differences of its RGB channels
+ */
+static inline uint64_t splv_block_match_cost(const SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, int32_t offX, int32_t offY, int32_t offZ)
+{
+	return neighborhood->costFunc(brick, neighborhood, offX, offY, offZ);
+}
+
+#endif //#ifndef SPLV_BLOCK_MATCH_H
@@ -1,8 +1,11 @@
 #include "spatialstudio/splv_brick.h"
 
 #include "spatialstudio/splv_frame.h"
+#include "spatialstudio/splv_frame_compact.h"
 #include "spatialstudio/splv_log.h"
 #include "splv_morton_lut.h"
+#include "splv_block_match.h"
+#include "splv_simd.h"
 #include <string.h>
 #include <math.h>
 
@@ -10,9 +13,17 @@
 
 #define SPLV_BRICK_GEOM_DIFF_SIZE (1 + 3 * SPLV_BRICK_SIZE_LOG_2)
 
-//TODO: finetune
-#define SPLV_BRICK_BLOCK_MATCH_GEOM_MISMATCH_COST 256 * 3
 #define SPLV_BRICK_BLOCK_MATCH_SEARCH_PARAM 7
+#define SPLV_BRICK_DIAMOND_SEARCH_MAX_STEPS 8
+
+#if SPLV_BRICK_BLOCK_MATCH_SEARCH_PARAM > SPLV_BLOCK_MATCH_MAX_OFFSET
+	#error "motion vector search range must fit in the block matching neighborhood"
+#endif
+
+//the word-level kernels treat each row of voxels along x as a single byte of the bitmap
+#if SPLV_BRICK_SIZE != 8
+	#error "word-level brick kernels assume a brick size of 8"
+#endif
 
 //-------------------------------------------//
 
@@ -24,19 +35,47 @@ typedef enum SPLVbrickEncodingType
 
 //-------------------------------------------//
 
-static SPLVerror _splv_brick_decode_intra(SPLVbufferReader* reader, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen, uint32_t* numVoxels);
-static SPLVerror _splv_brick_decode_predictive(SPLVbufferReader* in, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
-                                               uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t* numVoxels);
+static SPLVerror _splv_brick_encode_predictive(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy,
+                                               SPLVvoxelOrder order, SPLVframe* lastFrame, SPLVframeCompact* lastFrameCompact, uint32_t* numVoxels, 
+                                               const SPLVmotionSearchParams* motionSearch, SPLVmotionVector* motionVector);
+
+static SPLVerror _splv_brick_decode_intra(SPLVbufferReader* reader, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen, uint32_t* numVoxels);
+static SPLVerror _splv_brick_decode_predictive(SPLVbufferReader* in, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                               uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, SPLVframeCompact* lastFrameCompact, uint32_t* numVoxels);
 
 static SPLVerror _splv_brick_decode_intra_legacy(SPLVbufferReader* in, SPLVbrick* out);
 static SPLVerror _splv_brick_decode_predictive_legacy(SPLVbufferReader* in, SPLVbrick* out, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame);
+static SPLVerror _splv_brick_decode_intra_legacy_0_3(SPLVbufferReader* in, SPLVbrick* out);
+static SPLVerror _splv_brick_decode_predictive_legacy_0_3(SPLVbufferReader* in, SPLVbrick* out, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame);
+static SPLVerror _splv_brick_decode_bitmap_rle_legacy_0_3(SPLVbufferReader* in, SPLVbrick* out);
 
 static inline splv_bool_t _splv_frame_get_voxel(SPLVframe* frame, int32_t x, int32_t y, int32_t z, uint8_t* r, uint8_t* g, uint8_t* b);
-static uint64_t _splv_brick_block_match_cost(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, int32_t offX, int32_t offY, int32_t offZ);
-static void _splv_brick_block_match_neighborhood(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap,
-                                                 SPLVframe* lastFrame, int32_t centerX, int32_t centerY, int32_t centerZ, uint32_t searchDist, splv_bool_t includeCenter,
+static void _splv_brick_gather_reference(SPLVframe* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap, int32_t xOff, int32_t yOff, int32_t zOff, SPLVbrick* out);
+static void _splv_brick_gather_reference_compact(SPLVframeCompact* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap, int32_t xOff, int32_t yOff, int32_t zOff, SPLVbrick* out);
+static inline uint64_t _splv_brick_bitmap_word64(const uint32_t* bitmap, uint32_t idx);
+static inline uint32_t _splv_brick_predict_color(const uint32_t* bitmap, const uint32_t* colors, uint32_t idx, uint32_t fallback);
+static inline uint32_t _splv_brick_voxel_idx(SPLVvoxelOrder order, uint32_t pos);
+static void _splv_brick_bitmap_to_morton(const uint32_t* bitmap, uint32_t* out);
+static void _splv_brick_bitmap_from_morton(const uint32_t* bitmap, uint32_t* out);
+static inline void _splv_brick_bitmap_swap_index_bits_word(uint64_t* words, uint32_t shift, uint64_t mask);
+static inline void _splv_brick_bitmap_swap_index_bits_cross(uint64_t* words, uint32_t wordStride, uint32_t shift, uint64_t mask);
+static void _splv_brick_write_voxels(const SPLVbrick* brick, uint32_t* outVoxels);
+static uint32_t _splv_brick_rle_encode(const uint32_t* bitmap, uint8_t* out);
+static SPLVerror _splv_brick_rle_decode(SPLVbufferReader* in, uint32_t* bitmap);
+static SPLVerror _splv_brick_write_colors(SPLVbufferWriter* out, uint8_t colorBytes[3][SPLV_BRICK_LEN], uint32_t numColors);
+static SPLVerror _splv_brick_read_colors(SPLVbufferReader* in, uint32_t numColors, const uint8_t** colorBytes);
+static void _splv_brick_block_match_neighborhood(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                                 int32_t centerX, int32_t centerY, int32_t centerZ, uint32_t searchDist, splv_bool_t includeCenter,
                                                  uint64_t* minCost, int32_t* bestOffX, int32_t* bestOffY, int32_t* bestOffZ);
-static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, int32_t* offX, int32_t* offY, int32_t* offZ);
+static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, SPLVframeCompact* lastFrameCompact,
+                                              const SPLVmotionSearchParams* params, int32_t* offX, int32_t* offY, int32_t* offZ);
+static void _splv_brick_motion_search_three_step(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                                 int32_t* offX, int32_t* offY, int32_t* offZ);
+static void _splv_brick_motion_search_diamond(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                              const SPLVmotionVector* predictors, uint32_t numPredictors, int32_t* offX, int32_t* offY, int32_t* offZ);
+static void _splv_brick_motion_search_exhaustive(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                                 int32_t* offX, int32_t* offY, int32_t* offZ);
+static inline splv_bool_t _splv_brick_offset_in_range(const SPLVboundingBox* range, int32_t offX, int32_t offY, int32_t offZ);
 
 static inline uint8_t _splv_brick_geom_diff_position_decode(uint8_t* buf, uint32_t* bitIdx);
 static inline void _splv_brick_diff_encode(splv_bool_t add, uint32_t x, uint32_t y, uint32_t z, uint8_t* buf, uint32_t* bitIdx);
@@ -90,89 +129,64 @@ void splv_brick_clear(SPLVbrick* brick)
 	memset(brick->bitmap, 0, sizeof(brick->bitmap));
 }
 
-SPLVerror splv_brick_encode_intra(SPLVbrick* brick, SPLVbufferWriter* out, uint32_t* numVoxels)
+SPLVerror splv_brick_encode_intra(SPLVbrick* brick, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy, SPLVvoxelOrder order, uint32_t* numVoxels)
 {
-	//initialize bytes:
+	//get bitmap in traversal order:
 	//---------------
-	uint32_t voxelCount = 0;
-
-	uint8_t bitmapBytes[SPLV_BRICK_LEN]; //1 byte per voxel (worst case)
-	uint32_t numBitmapBytes = 0;
-	uint8_t colorBytes[SPLV_BRICK_LEN * 3]; //all colors stored (worst case)
-	uint32_t numColorBytes = 0;
-
-	uint8_t curBitmapByte; //for RLE
-	if((brick->bitmap[0] & 1) != 0)
-		curBitmapByte = 0x80;
-	else
-		curBitmapByte = 0x00;
+	uint32_t mortonBitmap[SPLV_BRICK_LEN / 32];
+	const uint32_t* orderBitmap = brick->bitmap;
+	if(order == SPLV_VOXEL_ORDER_MORTON)
+	{
+		_splv_brick_bitmap_to_morton(brick->bitmap, mortonBitmap);
+		orderBitmap = mortonBitmap;
+	}
 
-	//iterate over brick, perform RLE on bitmap and get colors:
+	//encode each color as a difference from its prediction:
 	//---------------
-	uint8_t rChannels[SPLV_BRICK_LEN];
-	uint8_t gChannels[SPLV_BRICK_LEN];
-	uint8_t bChannels[SPLV_BRICK_LEN];
+	uint32_t voxelCount = 0;
 
-	//we do RLE in linear order, we MUST make sure to read it back in the same order
-	for(uint32_t i = 0; i < SPLV_BRICK_LEN; i++)
-	{
-		uint32_t idxArr = i >> 5;
-		uint32_t idxBit = i & 31;
+	uint8_t colorBytes[3][SPLV_BRICK_LEN]; //1 plane per channel, all colors stored (worst case)
 
-		//update RLE
-		uint8_t filled = (brick->bitmap[idxArr] & (1u << idxBit)) != 0;
-		if(filled != ((curBitmapByte & (1 << 7u)) != 0) || (curBitmapByte & 0x7f) == 127)
+	uint32_t prevColor = 0;
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		uint64_t filled = _splv_brick_bitmap_word64(orderBitmap, i);
+		while(filled)
 		{
-			bitmapBytes[numBitmapBytes++] = curBitmapByte;
-
-			if(filled)
-				curBitmapByte = 0x80;
-			else
-				curBitmapByte = 0x00;
-		}
-
-		curBitmapByte++;
+			uint32_t idx = _splv_brick_voxel_idx(order, 64 * i + splv_ctz64(filled));
+			filled &= filled - 1;
 
-		//add color if filled
-		if(filled)
-		{
-			uint32_t color = brick->color[i];
-			uint8_t r = (uint8_t)(color >> 24);
-			uint8_t g = (uint8_t)((color >> 16) & 0xFF);
-			uint8_t b = (uint8_t)((color >> 8 ) & 0xFF);
+			uint32_t color = brick->color[idx];
+			uint32_t predColor = _splv_brick_predict_color(brick->bitmap, brick->color, idx, prevColor);
 
-			rChannels[voxelCount] = r;
-			gChannels[voxelCount] = g;
-			bChannels[voxelCount] = b;
+			colorBytes[0][voxelCount] = (uint8_t)((color >> 24)         - (predColor >> 24));
+			colorBytes[1][voxelCount] = (uint8_t)(((color >> 16) & 0xFF) - ((predColor >> 16) & 0xFF));
+			colorBytes[2][voxelCount] = (uint8_t)(((color >> 8 ) & 0xFF) - ((predColor >> 8 ) & 0xFF));
 
+			prevColor = color;
 			voxelCount++;
 		}
 	}
 
-	bitmapBytes[numBitmapBytes++] = curBitmapByte;
-
-	//encode each color as a difference from previous:
+	//write:
 	//---------------
-	numColorBytes = voxelCount * 3;
-
-	colorBytes[0] = rChannels[0];
-	colorBytes[1] = gChannels[0];
-	colorBytes[2] = bChannels[0];
+	uint8_t encodingType = (uint8_t)SPLV_BRICK_ENCODING_TYPE_I;
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(&out[SPLV_BRICK_STREAM_MOTION], sizeof(uint8_t), &encodingType));
 
-	for(uint32_t i = 1; i < voxelCount; i++)
+	if(occupancy)
 	{
-		colorBytes[i * 3 + 0] = rChannels[i] - rChannels[i - 1];
-		colorBytes[i * 3 + 1] = gChannels[i] - gChannels[i - 1];
-		colorBytes[i * 3 + 2] = bChannels[i] - bChannels[i - 1];
+		SPLV_ERROR_PROPAGATE(splv_occupancy_encode(occupancy, &out[SPLV_BRICK_STREAM_GEOMETRY], brick->bitmap, NULL));
 	}
+	else
+	{
+		//we do RLE in traversal order, we MUST make sure to read it back in the same order
+		uint8_t bitmapBytes[SPLV_BRICK_LEN]; //1 byte per voxel (worst case)
+		uint32_t numBitmapBytes = _splv_brick_rle_encode(orderBitmap, bitmapBytes);
 
-	//write:
-	//---------------
-	uint8_t encodingType = (uint8_t)SPLV_BRICK_ENCODING_TYPE_I;
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, sizeof(uint8_t), &encodingType));
+		SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(&out[SPLV_BRICK_STREAM_GEOMETRY], numBitmapBytes * sizeof(uint8_t), bitmapBytes));
+	}
 
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, numBitmapBytes * sizeof(uint8_t), bitmapBytes));
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, numColorBytes * sizeof(uint8_t), colorBytes));
+	SPLV_ERROR_PROPAGATE(_splv_brick_write_colors(out, colorBytes, voxelCount));
 
 	//return:
 	//---------------
@@ -181,155 +195,168 @@ SPLVerror splv_brick_encode_intra(SPLVbrick* brick, SPLVbufferWriter* out, uint3
 	return SPLV_SUCCESS;
 }
 
-SPLVerror splv_brick_encode_predictive(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVframe* lastFrame, uint32_t* numVoxels, splv_bool_t motionVectors)
+SPLVerror splv_brick_encode_predictive(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy,
+                                       SPLVvoxelOrder order, SPLVframe* lastFrame, uint32_t* numVoxels, const SPLVmotionSearchParams* motionSearch, SPLVmotionVector* motionVector)
 {
-	//estimate motion:
-	//---------------
-	int32_t xOff = 0;
-	int32_t yOff = 0;
-	int32_t zOff = 0;
-
-	if(motionVectors)
-		_splv_brick_compute_motion_vector(brick, xMap, yMap, zMap, lastFrame, &xOff, &yOff, &zOff);
-
-	//find number of diffs in geometry:
-	//---------------
-
-	//TODO: optimize with xor and bitcounting
+	return _splv_brick_encode_predictive(brick, xMap, yMap, zMap, out, occupancy, order, lastFrame, NULL, numVoxels, motionSearch, motionVector);
+}
 
-	uint32_t numGeomDiff = 0;
-	uint32_t voxelCount = 0;
+SPLVerror splv_brick_encode_predictive_from_compact(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy,
+                                                    SPLVvoxelOrder order, SPLVframeCompact* lastFrame, uint32_t* numVoxels, const SPLVmotionSearchParams* motionSearch, 
+                                                    SPLVmotionVector* motionVector)
+{
+	return _splv_brick_encode_predictive(brick, xMap, yMap, zMap, out, occupancy, order, NULL, lastFrame, numVoxels, motionSearch, motionVector);
+}
 
-	SPLVbrick lastBrick;
-	splv_brick_clear(&lastBrick);
+SPLVerror splv_brick_decode(SPLVbufferReader* in, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                            uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t* numVoxels)
+{
+	uint8_t encodingType;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&in[SPLV_BRICK_STREAM_MOTION], sizeof(uint8_t), &encodingType));
 
-	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
-	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
-	for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+	if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_I)
+		return _splv_brick_decode_intra(in, occupancy, order, out, outVoxels, outVoxelsLen, numVoxels);
+	else if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_P)
+		return _splv_brick_decode_predictive(in, occupancy, order, out, outVoxels, outVoxelsLen, xMap, yMap, zMap, lastFrame, NULL, numVoxels);
+	else
 	{
-		int32_t lastX = xMap * SPLV_BRICK_SIZE + x + xOff;
-		int32_t lastY = yMap * SPLV_BRICK_SIZE + y + yOff;
-		int32_t lastZ = zMap * SPLV_BRICK_SIZE + z + zOff;
-
-		uint8_t lastR, lastG, lastB;
-
-		splv_bool_t filled = splv_brick_get_voxel(brick, x, y, z);
-		splv_bool_t wasFilled = _splv_frame_get_voxel(lastFrame, lastX, lastY, lastZ, &lastR, &lastG, &lastB);
-
-		if(filled != wasFilled)
-			numGeomDiff++;
-
-		if(filled)
-			voxelCount++;
-
-		if(wasFilled)
-			splv_brick_set_voxel_filled(&lastBrick, x, y, z, lastR, lastG, lastB);
+		SPLV_LOG_ERROR("invalid brick encoding type");
+		return SPLV_ERROR_INVALID_INPUT;
 	}
+}
 
-	//determine if we should encode as I-frame:
-	//---------------
-
-	//TODO: finetune this
-	if(numGeomDiff >= voxelCount / 2)
-		return splv_brick_encode_intra(brick, out, numVoxels);
+SPLVerror splv_brick_decode_skipped(SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                    uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t* numVoxels)
+{
+	//find brick in last frame:
+	//-----------------
+	if(xMap >= lastFrame->width || yMap >= lastFrame->height || zMap >= lastFrame->depth)
+	{
+		SPLV_LOG_ERROR("skipped brick is outside of the previous frame, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
 
-	//encode diffs in geom + color:
-	//---------------
-	uint32_t numBitmapBytes = 0;
-	uint8_t bitmapBytes[SPLV_BRICK_LEN]; //1 byte per voxel (worst case)
-	uint32_t numColorBytes = 0;
-	uint8_t colorBytes[SPLV_BRICK_LEN * 3];
-
-	uint8_t curBitmapByte; //for RLE
-	if(((brick->bitmap[0] ^ lastBrick.bitmap[0]) & 1) != 0)
-		curBitmapByte = 0x80;
-	else
-		curBitmapByte = 0x00;
+	uint32_t lastBrickIdx = lastFrame->map[splv_frame_get_map_idx(lastFrame, xMap, yMap, zMap)];
+	if(lastBrickIdx == SPLV_BRICK_IDX_EMPTY)
+	{
+		SPLV_LOG_ERROR("skipped brick is empty in the previous frame, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
 
-	//TODO: merge this loop with previous
+	//copy:
+	//-----------------
+	memcpy(out, &lastFrame->bricks[lastBrickIdx], sizeof(SPLVbrick));
 
-	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
-	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
-	for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+	*numVoxels = 0;
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
 	{
-		splv_bool_t filled = splv_brick_get_voxel(brick, x, y, z);
-		splv_bool_t wasFilled = splv_brick_get_voxel(&lastBrick, x, y, z);
-
-		if(filled)
+		uint64_t filled = (uint64_t)out->bitmap[2 * i] | ((uint64_t)out->bitmap[2 * i + 1] << 32);
+		if(outVoxels == NULL)
 		{
-			uint8_t r, g, b;
-			splv_brick_get_voxel_color(brick, x, y, z, &r, &g, &b);
+			*numVoxels += splv_popcount64(filled);
+			continue;
+		}
 
-			uint8_t encodeR, encodeG, encodeB;
-			if(wasFilled)
-			{
-				uint8_t lastR, lastG, lastB;
-				splv_brick_get_voxel_color(&lastBrick, x, y, z, &lastR, &lastG, &lastB);
+		while(filled)
+		{
+			uint32_t idx = 64 * i + splv_ctz64(filled);
+			filled &= filled - 1;
 
-				encodeR = r - lastR;
-				encodeG = g - lastG;
-				encodeB = b - lastB;
-			}
-			else
+			if(*numVoxels >= outVoxelsLen)
 			{
-				encodeR = r;
-				encodeG = g;
-				encodeB = b;
+				SPLV_LOG_ERROR("not enough space in out voxel array to hold brick's voxels");
+				return SPLV_ERROR_INVALID_INPUT;
 			}
 
-			colorBytes[numColorBytes++] = encodeR;
-			colorBytes[numColorBytes++] = encodeG;
-			colorBytes[numColorBytes++] = encodeB;
+			outVoxels[(*numVoxels)++] = out->color[idx];
 		}
+	}
 
-		splv_bool_t diff = filled != wasFilled;
-		if(diff != ((curBitmapByte & (1 << 7u)) != 0) || (curBitmapByte & 0x7f) == 127)
-		{
-			bitmapBytes[numBitmapBytes++] = curBitmapByte;
+	return SPLV_SUCCESS;
+}
 
-			if(diff)
-				curBitmapByte = 0x80;
-			else
-				curBitmapByte = 0x00;
-		}
+SPLVerror splv_brick_decode_from_compact(SPLVbufferReader* in, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                         uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframeCompact* lastFrame, uint32_t* numVoxels)
+{
+	uint8_t encodingType;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&in[SPLV_BRICK_STREAM_MOTION], sizeof(uint8_t), &encodingType));
 
-		curBitmapByte++;
+	if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_I)
+		return _splv_brick_decode_intra(in, occupancy, order, out, outVoxels, outVoxelsLen, numVoxels);
+	else if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_P)
+		return _splv_brick_decode_predictive(in, occupancy, order, out, outVoxels, outVoxelsLen, xMap, yMap, zMap, NULL, lastFrame, numVoxels);
+	else
+	{
+		SPLV_LOG_ERROR("invalid brick encoding type");
+		return SPLV_ERROR_INVALID_INPUT;
 	}
+}
 
-	bitmapBytes[numBitmapBytes++] = curBitmapByte;
+SPLVerror splv_brick_decode_skipped_from_compact(SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                                 uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframeCompact* lastFrame, uint32_t* numVoxels)
+{
+	//find brick in last frame:
+	//-----------------
+	if(xMap >= lastFrame->width || yMap >= lastFrame->height || zMap >= lastFrame->depth)
+	{
+		SPLV_LOG_ERROR("skipped brick is outside of the previous frame, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
 
-	//write:
-	//---------------
-	uint8_t encodingType = (uint8_t)SPLV_BRICK_ENCODING_TYPE_P;
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, sizeof(uint8_t), &encodingType));
+	uint32_t lastBrickIdx = lastFrame->map[splv_frame_compact_get_map_idx(lastFrame, xMap, yMap, zMap)];
+	if(lastBrickIdx == SPLV_BRICK_IDX_EMPTY)
+	{
+		SPLV_LOG_ERROR("skipped brick is empty in the previous frame, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	SPLVbrickCompact* lastBrick = &lastFrame->bricks[lastBrickIdx];
 
-	int8_t xOffEncode = (int8_t)xOff;
-	int8_t yOffEncode = (int8_t)yOff;
-	int8_t zOffEncode = (int8_t)zOff;
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, sizeof(int8_t), &xOffEncode));
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, sizeof(int8_t), &yOffEncode));
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, sizeof(int8_t), &zOffEncode));
+	//copy, the packed colors are already in linear order:
+	//-----------------
+	*numVoxels = splv_brick_compact_get_num_voxels(lastBrick);
+	if(outVoxels != NULL)
+	{
+		if(*numVoxels > outVoxelsLen)
+		{
+			SPLV_LOG_ERROR("not enough space in out voxel array to hold brick's voxels");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
 
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, numBitmapBytes * sizeof(uint8_t), bitmapBytes));
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, numColorBytes * sizeof(uint8_t), colorBytes));
+		memcpy(outVoxels, &lastFrame->voxels[lastBrick->voxelsOffset], *numVoxels * sizeof(uint32_t));
+	}
 
-	//return:
-	//---------------
-	*numVoxels = voxelCount;
+	if(out != NULL)
+		splv_frame_compact_unpack_brick(lastFrame, lastBrickIdx, out);
 
 	return SPLV_SUCCESS;
 }
 
-SPLVerror splv_brick_decode(SPLVbufferReader* in, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
-                            uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t* numVoxels)
+SPLVerror splv_brick_decode_legacy(SPLVbufferReader* in, SPLVbrick* out, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t version)
 {
+	if(version != SPLV_MAKE_VERSION(0, 2, 1, 0) && version != SPLV_MAKE_VERSION(0, 3, 0, 0))
+	{
+		SPLV_LOG_ERROR("unsupported legacy brick version");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
 	uint8_t encodingType;
 	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(uint8_t), &encodingType));
 
 	if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_I)
-		return _splv_brick_decode_intra(in, out, outVoxels, outVoxelsLen, numVoxels);
+	{
+		if(version == SPLV_MAKE_VERSION(0, 3, 0, 0))
+			return _splv_brick_decode_intra_legacy_0_3(in, out);
+		else
+			return _splv_brick_decode_intra_legacy(in, out);
+	}
 	else if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_P)
-		return _splv_brick_decode_predictive(in, out, outVoxels, outVoxelsLen, xMap, yMap, zMap, lastFrame, numVoxels);
+	{
+		if(version == SPLV_MAKE_VERSION(0, 3, 0, 0))
+			return _splv_brick_decode_predictive_legacy_0_3(in, out, xMap, yMap, zMap, lastFrame);
+		else
+			return _splv_brick_decode_predictive_legacy(in, out, xMap, yMap, zMap, lastFrame);
+	}
 	else
 	{
 		SPLV_LOG_ERROR("invalid brick encoding type");
@@ -337,224 +364,332 @@ SPLVerror splv_brick_decode(SPLVbufferReader* in, SPLVbrick* out, uint32_t* outV
 	}
 }
 
-SPLVerror splv_brick_decode_legacy(SPLVbufferReader* in, SPLVbrick* out, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame)
+splv_bool_t splv_brick_equals(SPLVbrick* brick1, SPLVbrick* brick2)
 {
-	uint8_t encodingType;
-	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(uint8_t), &encodingType));
+	if(memcmp(brick1->bitmap, brick2->bitmap, sizeof(brick1->bitmap)) != 0)
+		return SPLV_FALSE;
 
-	if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_I)
-		return _splv_brick_decode_intra_legacy(in, out);
-	else if((SPLVbrickEncodingType)encodingType == SPLV_BRICK_ENCODING_TYPE_P)
-		return _splv_brick_decode_predictive_legacy(in, out, xMap, yMap, zMap, lastFrame);
-	else
+	//only compare colors of filled voxels, empty voxels have unspecified colors
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
 	{
-		SPLV_LOG_ERROR("invalid brick encoding type");
-		return SPLV_ERROR_INVALID_INPUT;
+		uint64_t filled = (uint64_t)brick1->bitmap[2 * i] | ((uint64_t)brick1->bitmap[2 * i + 1] << 32);
+		while(filled)
+		{
+			uint32_t idx = 64 * i + splv_ctz64(filled);
+			filled &= filled - 1;
+
+			if(brick1->color[idx] != brick2->color[idx])
+				return SPLV_FALSE;
+		}
 	}
+
+	return SPLV_TRUE;
 }
 
 uint32_t splv_brick_get_num_voxels(SPLVbrick* brick)
 {
 	uint32_t numVoxels = 0;
-	for(uint32_t i = 0; i < SPLV_BRICK_LEN; i++)
-	{
-		if((brick->bitmap[i >> 5] & (1 << (i & 31))) != 0)
-			numVoxels++;
-	}
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+		numVoxels += splv_popcount64((uint64_t)brick->bitmap[2 * i] | ((uint64_t)brick->bitmap[2 * i + 1] << 32));
 
 	return numVoxels;
 }
 
 //-------------------------------------------//
 
-static SPLVerror _splv_brick_decode_intra(SPLVbufferReader* in, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen, uint32_t* numVoxels)
+static SPLVerror _splv_brick_encode_predictive(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbufferWriter* out, SPLVoccupancyEncoder* occupancy,
+                                               SPLVvoxelOrder order, SPLVframe* lastFrame, SPLVframeCompact* lastFrameCompact, uint32_t* numVoxels, 
+                                               const SPLVmotionSearchParams* motionSearch, SPLVmotionVector* motionVector)
 {
-	//decode bitmap:
-	//-----------------
-	splv_brick_clear(out);
-	*numVoxels = 0;
-
-	uint32_t i = 0;
-	while(i < SPLV_BRICK_SIZE * SPLV_BRICK_SIZE * SPLV_BRICK_SIZE)
-	{
-		uint8_t curByte;
-		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(uint8_t), &curByte));
-		
-		if((curByte & (1u << 7)) != 0)
-		{
-			curByte = curByte & 0x7F;
+	//estimate motion:
+	//---------------
+	int32_t xOff = 0;
+	int32_t yOff = 0;
+	int32_t zOff = 0;
 
-			while(curByte > 0)
-			{
-				uint32_t idxArr = i / 32;
-				uint32_t idxBit = i % 32;
+	if(motionSearch)
+		_splv_brick_compute_motion_vector(brick, xMap, yMap, zMap, lastFrame, lastFrameCompact, motionSearch, &xOff, &yOff, &zOff);
 
-				out->bitmap[idxArr] |= 1u << idxBit;
+	if(motionVector)
+		*motionVector = (SPLVmotionVector){ (int8_t)xOff, (int8_t)yOff, (int8_t)zOff };
 
-				i++;
-				curByte--;
+	//gather motion-compensated reference, find number of diffs in geometry:
+	//---------------
+	SPLVbrick lastBrick;
+	if(lastFrameCompact)
+		_splv_brick_gather_reference_compact(lastFrameCompact, xMap, yMap, zMap, xOff, yOff, zOff, &lastBrick);
+	else
+		_splv_brick_gather_reference(lastFrame, xMap, yMap, zMap, xOff, yOff, zOff, &lastBrick);
 
-				(*numVoxels)++;
-			}
-		}
-		else
-			i += curByte;
-	}
+	uint32_t diffBitmap[SPLV_BRICK_LEN / 32];
+	uint32_t numGeomDiff = 0;
+	uint32_t voxelCount = 0;
 
-	if(i != SPLV_BRICK_SIZE * SPLV_BRICK_SIZE * SPLV_BRICK_SIZE)
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
 	{
-		SPLV_LOG_ERROR("brick bitmap decoding had incorrect number of voxels, possibly corrupted data");
-		return SPLV_ERROR_INVALID_INPUT;
+		uint64_t filled    = _splv_brick_bitmap_word64(brick->bitmap, i);
+		uint64_t wasFilled = _splv_brick_bitmap_word64(lastBrick.bitmap, i);
+
+		diffBitmap[2 * i    ] = brick->bitmap[2 * i    ] ^ lastBrick.bitmap[2 * i    ];
+		diffBitmap[2 * i + 1] = brick->bitmap[2 * i + 1] ^ lastBrick.bitmap[2 * i + 1];
+
+		numGeomDiff += splv_popcount64(filled ^ wasFilled);
+		voxelCount += splv_popcount64(filled);
 	}
 
-	if(outVoxels != NULL && *numVoxels > outVoxelsLen)
+	//determine if we should encode as I-frame:
+	//---------------
+
+	//TODO: finetune this
+	if(numGeomDiff >= voxelCount / 2)
+		return splv_brick_encode_intra(brick, out, occupancy, order, numVoxels);
+
+	//get bitmaps in traversal order:
+	//---------------
+	uint32_t mortonBitmap[SPLV_BRICK_LEN / 32];
+	const uint32_t* orderBitmap = brick->bitmap;
+	if(order == SPLV_VOXEL_ORDER_MORTON)
 	{
-		SPLV_LOG_ERROR("not enough space in out voxel array to hold brick's voxels");
-		return SPLV_ERROR_INVALID_INPUT;
+		_splv_brick_bitmap_to_morton(diffBitmap, diffBitmap);
+		_splv_brick_bitmap_to_morton(brick->bitmap, mortonBitmap);
+		orderBitmap = mortonBitmap;
 	}
 
-	//loop over every voxel, add to color buffer if present
-	//-----------------
-	uint8_t prevRgb[3] = {0, 0, 0};
+	//encode diffs in color:
+	//---------------
+	uint32_t numColors = 0;
+	uint8_t colorBytes[3][SPLV_BRICK_LEN];
 
-	uint32_t readVoxels = 0;
-	for(uint32_t i = 0; i < SPLV_BRICK_SIZE * SPLV_BRICK_SIZE * SPLV_BRICK_SIZE; i++)
+	//colors are written in traversal order, voxels that were filled in the reference are predicted from it, new voxels from their neighbors
+	uint32_t prevColor = 0;
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
 	{
-		//we are reading in linear order since we encode in that order
-		uint32_t arrIdx = i / 32;
-		uint32_t bitIdx = i % 32;
-
-		if((out->bitmap[arrIdx] & (uint32_t)(1 << bitIdx)) != 0)
+		uint64_t filled = _splv_brick_bitmap_word64(orderBitmap, i);
+		while(filled)
 		{
-			uint8_t rgb[3];
-			SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, 3 * sizeof(uint8_t), rgb));
+			uint32_t idx = _splv_brick_voxel_idx(order, 64 * i + splv_ctz64(filled));
+			filled &= filled - 1;
 
-			rgb[0] += prevRgb[0];
-			rgb[1] += prevRgb[1];
-			rgb[2] += prevRgb[2];
+			uint32_t color = brick->color[idx];
+			uint32_t predColor = ((lastBrick.bitmap[idx / 32] >> (idx % 32)) & 1) ? lastBrick.color[idx] :
+			                     _splv_brick_predict_color(brick->bitmap, brick->color, idx, prevColor);
 
-			uint32_t packedColor = (rgb[0] << 24) | (rgb[1] << 16) | (rgb[2] << 8) | 255;
-			out->color[i] = packedColor;
-
-			if(outVoxels != NULL)
-				outVoxels[readVoxels] = packedColor;
+			colorBytes[0][numColors] = (uint8_t)((color >> 24)         - (predColor >> 24));
+			colorBytes[1][numColors] = (uint8_t)(((color >> 16) & 0xFF) - ((predColor >> 16) & 0xFF));
+			colorBytes[2][numColors] = (uint8_t)(((color >> 8 ) & 0xFF) - ((predColor >> 8 ) & 0xFF));
 
-			readVoxels++;
-
-			prevRgb[0] = rgb[0];
-			prevRgb[1] = rgb[1];
-			prevRgb[2] = rgb[2];
+			prevColor = color;
+			numColors++;
 		}
 	}
 
-	if(readVoxels != *numVoxels)
+	//write:
+	//---------------
+	int8_t motion[4] = { (int8_t)SPLV_BRICK_ENCODING_TYPE_P, (int8_t)xOff, (int8_t)yOff, (int8_t)zOff };
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(&out[SPLV_BRICK_STREAM_MOTION], sizeof(motion), motion));
+
+	//the occupancy coder predicts from the reference itself, RLE codes the diffs against it
+	if(occupancy)
 	{
-		SPLV_LOG_ERROR("brick had incorrect number of voxels, possibly corrupted data");
-		return SPLV_ERROR_INVALID_INPUT;
+		SPLV_ERROR_PROPAGATE(splv_occupancy_encode(occupancy, &out[SPLV_BRICK_STREAM_GEOMETRY], brick->bitmap, lastBrick.bitmap));
+	}
+	else
+	{
+		uint8_t bitmapBytes[SPLV_BRICK_LEN]; //1 byte per voxel (worst case)
+		uint32_t numBitmapBytes = _splv_brick_rle_encode(diffBitmap, bitmapBytes);
+
+		SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(&out[SPLV_BRICK_STREAM_GEOMETRY], numBitmapBytes * sizeof(uint8_t), bitmapBytes));
 	}
 
+	SPLV_ERROR_PROPAGATE(_splv_brick_write_colors(out, colorBytes, numColors));
+
+	//return:
+	//---------------
+	*numVoxels = voxelCount;
+
 	return SPLV_SUCCESS;
 }
 
-static SPLVerror _splv_brick_decode_predictive(SPLVbufferReader* in, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
-                                               uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, uint32_t* numVoxels)
+static SPLVerror _splv_brick_decode_intra(SPLVbufferReader* in, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen, uint32_t* numVoxels)
 {
-	//read motion vector:
-	//-----------------
-	int8_t xOff, yOff, zOff;
-	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(int8_t), &xOff));
-	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(int8_t), &yOff));
-	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(int8_t), &zOff));
-
-	//copy last frame
+	//decode bitmap, and get it in traversal order:
 	//-----------------
-	memset(out, 0, sizeof(SPLVbrick));
+	uint32_t mortonBitmap[SPLV_BRICK_LEN / 32];
+	const uint32_t* orderBitmap = out->bitmap;
 
-	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
-	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
-	for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+	if(occupancy)
 	{
-		uint32_t lastX = xMap * SPLV_BRICK_SIZE + x + xOff;
-		uint32_t lastY = yMap * SPLV_BRICK_SIZE + y + yOff;
-		uint32_t lastZ = zMap * SPLV_BRICK_SIZE + z + zOff;
-
-		uint8_t lastR, lastG, lastB;
-		splv_bool_t filled = _splv_frame_get_voxel(lastFrame, lastX, lastY, lastZ, &lastR, &lastG, &lastB);
-
-		if(filled)
-			splv_brick_set_voxel_filled(out, x, y, z, lastR, lastG, lastB);
+		SPLV_ERROR_PROPAGATE(splv_occupancy_decode(occupancy, NULL, out->bitmap));
+		if(order == SPLV_VOXEL_ORDER_MORTON)
+			_splv_brick_bitmap_to_morton(out->bitmap, mortonBitmap);
 	}
-
-	//decode geom diffs:
-	//-----------------
-	uint32_t i = 0;
-	while(i < SPLV_BRICK_SIZE * SPLV_BRICK_SIZE * SPLV_BRICK_SIZE)
+	else if(order == SPLV_VOXEL_ORDER_MORTON)
 	{
-		uint8_t curByte;
-		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(uint8_t), &curByte));
-		
-		if((curByte & (1u << 7)) != 0)
+		SPLV_ERROR_PROPAGATE(_splv_brick_rle_decode(&in[SPLV_BRICK_STREAM_GEOMETRY], mortonBitmap));
+		_splv_brick_bitmap_from_morton(mortonBitmap, out->bitmap);
+	}
+	else
+	{
+		SPLV_ERROR_PROPAGATE(_splv_brick_rle_decode(&in[SPLV_BRICK_STREAM_GEOMETRY], out->bitmap));
+	}
+
+	if(order == SPLV_VOXEL_ORDER_MORTON)
+		orderBitmap = mortonBitmap;
+
+	//validate space for colors:
+	//-----------------
+	*numVoxels = splv_brick_get_num_voxels(out);
+
+	if(outVoxels != NULL && *numVoxels > outVoxelsLen)
+	{
+		SPLV_LOG_ERROR("not enough space in out voxel array to hold brick's voxels");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	const uint8_t* colorBytes[3];
+	SPLV_ERROR_PROPAGATE(_splv_brick_read_colors(in, *numVoxels, colorBytes));
+
+	//read colors, each is a difference from its prediction:
+	//-----------------
+
+	//we are reading in traversal order since we encode in that order, so every voxel's predictors are already decoded
+	uint32_t prevColor = 0;
+
+	uint32_t readVoxels = 0;
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		uint64_t filled = _splv_brick_bitmap_word64(orderBitmap, i);
+		while(filled)
 		{
-			curByte = curByte & 0x7F;
+			uint32_t idx = _splv_brick_voxel_idx(order, 64 * i + splv_ctz64(filled));
+			filled &= filled - 1;
 
-			while(curByte > 0)
-			{
-				uint32_t idxArr = i / 32;
-				uint32_t idxBit = i % 32;
+			uint32_t predColor = _splv_brick_predict_color(out->bitmap, out->color, idx, prevColor);
 
-				out->bitmap[idxArr] ^= 1u << idxBit;
+			uint8_t r = (uint8_t)((predColor >> 24)         + colorBytes[0][readVoxels]);
+			uint8_t g = (uint8_t)(((predColor >> 16) & 0xFF) + colorBytes[1][readVoxels]);
+			uint8_t b = (uint8_t)(((predColor >> 8 ) & 0xFF) + colorBytes[2][readVoxels]);
 
-				i++;
-				curByte--;
-			}
+			uint32_t packedColor = ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8) | 255;
+			prevColor = packedColor;
+			out->color[idx] = packedColor;
+
+			if(outVoxels != NULL && order == SPLV_VOXEL_ORDER_LINEAR)
+				outVoxels[readVoxels] = packedColor;
+
+			readVoxels++;
 		}
-		else
-			i += curByte;
 	}
 
-	if(i != SPLV_BRICK_SIZE * SPLV_BRICK_SIZE * SPLV_BRICK_SIZE)
+	//out voxels are always in linear order
+	if(outVoxels != NULL && order != SPLV_VOXEL_ORDER_LINEAR)
+		_splv_brick_write_voxels(out, outVoxels);
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_brick_decode_predictive(SPLVbufferReader* in, SPLVoccupancyDecoder* occupancy, SPLVvoxelOrder order, SPLVbrick* out, uint32_t* outVoxels, uint64_t outVoxelsLen,
+                                               uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, SPLVframeCompact* lastFrameCompact, uint32_t* numVoxels)
+{
+	//read motion vector:
+	//-----------------
+	int8_t xOff, yOff, zOff;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&in[SPLV_BRICK_STREAM_MOTION], sizeof(int8_t), &xOff));
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&in[SPLV_BRICK_STREAM_MOTION], sizeof(int8_t), &yOff));
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&in[SPLV_BRICK_STREAM_MOTION], sizeof(int8_t), &zOff));
+
+	if(abs(xOff) > SPLV_BLOCK_MATCH_MAX_OFFSET || abs(yOff) > SPLV_BLOCK_MATCH_MAX_OFFSET || abs(zOff) > SPLV_BLOCK_MATCH_MAX_OFFSET)
 	{
-		SPLV_LOG_ERROR("brick bitmap decoding had incorrect number of voxels, possibly corrupted data");
+		SPLV_LOG_ERROR("brick motion vector out of range, possibly corrupted data");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	//read colors
+	//copy last frame
 	//-----------------
-	*numVoxels = 0;
+	if(lastFrameCompact)
+		_splv_brick_gather_reference_compact(lastFrameCompact, xMap, yMap, zMap, xOff, yOff, zOff, out);
+	else
+		_splv_brick_gather_reference(lastFrame, xMap, yMap, zMap, xOff, yOff, zOff, out);
 
-	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
-	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
-	for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+	uint32_t lastBitmap[SPLV_BRICK_LEN / 32];
+	memcpy(lastBitmap, out->bitmap, sizeof(lastBitmap));
+
+	//decode geom:
+	//-----------------
+	if(occupancy)
 	{
-		uint32_t idx = x | (y << SPLV_BRICK_SIZE_LOG_2) | (z << SPLV_BRICK_SIZE_2_LOG_2);
-		if((out->bitmap[idx >> 5] & (1 << (idx & 31))) == 0)
-			continue;
+		SPLV_ERROR_PROPAGATE(splv_occupancy_decode(occupancy, lastBitmap, out->bitmap));
+	}
+	else
+	{
+		uint32_t diffBitmap[SPLV_BRICK_LEN / 32];
+		SPLV_ERROR_PROPAGATE(_splv_brick_rle_decode(&in[SPLV_BRICK_STREAM_GEOMETRY], diffBitmap));
 
-		uint8_t rgb[3];
-		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, 3 * sizeof(uint8_t), rgb));
+		if(order == SPLV_VOXEL_ORDER_MORTON)
+			_splv_brick_bitmap_from_morton(diffBitmap, diffBitmap);
 
-		uint32_t oldColor = out->color[idx];
-		uint8_t r = (oldColor >> 24) + rgb[0];
-		uint8_t g = ((oldColor >> 16) & 0xFF) + rgb[1];
-		uint8_t b = ((oldColor >> 8 ) & 0xFF) + rgb[2];
+		for(uint32_t i = 0; i < SPLV_BRICK_LEN / 32; i++)
+			out->bitmap[i] ^= diffBitmap[i];
+	}
 
-		uint32_t color = (r << 24) | (g << 16) | (b << 8) | 255;
-		out->color[idx] = color;
+	uint32_t mortonBitmap[SPLV_BRICK_LEN / 32];
+	const uint32_t* orderBitmap = out->bitmap;
+	if(order == SPLV_VOXEL_ORDER_MORTON)
+	{
+		_splv_brick_bitmap_to_morton(out->bitmap, mortonBitmap);
+		orderBitmap = mortonBitmap;
+	}
+
+	//validate space for colors:
+	//-----------------
+	*numVoxels = splv_brick_get_num_voxels(out);
+
+	if(outVoxels != NULL && *numVoxels > outVoxelsLen)
+	{
+		SPLV_LOG_ERROR("not enough space in out voxel array to hold brick's voxels");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	const uint8_t* colorBytes[3];
+	SPLV_ERROR_PROPAGATE(_splv_brick_read_colors(in, *numVoxels, colorBytes));
+
+	//read colors, each is a difference from the last frame's color, or from the neighbors' for new voxels:
+	//-----------------
 
-		if(outVoxels != NULL)
+	//out->color holds the reference until a voxel is decoded, only voxels before the current one are used as neighbors
+	uint32_t prevColor = 0;
+
+	uint32_t readVoxels = 0;
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		uint64_t filled = _splv_brick_bitmap_word64(orderBitmap, i);
+		while(filled)
 		{
-			if(*numVoxels >= outVoxelsLen)
-			{
-				SPLV_LOG_ERROR("not enough space in out voxel array to hold brick's voxels");
-				return SPLV_ERROR_INVALID_INPUT;
-			}
+			uint32_t idx = _splv_brick_voxel_idx(order, 64 * i + splv_ctz64(filled));
+			filled &= filled - 1;
 
-			outVoxels[*numVoxels] = color;
-		}
+			uint32_t predColor = ((lastBitmap[idx / 32] >> (idx % 32)) & 1) ? out->color[idx] :
+			                     _splv_brick_predict_color(out->bitmap, out->color, idx, prevColor);
+
+			uint8_t r = (uint8_t)((predColor >> 24)         + colorBytes[0][readVoxels]);
+			uint8_t g = (uint8_t)(((predColor >> 16) & 0xFF) + colorBytes[1][readVoxels]);
+			uint8_t b = (uint8_t)(((predColor >> 8 ) & 0xFF) + colorBytes[2][readVoxels]);
 
-		(*numVoxels)++;
+			uint32_t color = ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8) | 255;
+			out->color[idx] = color;
+			prevColor = color;
+
+			if(outVoxels != NULL && order == SPLV_VOXEL_ORDER_LINEAR)
+				outVoxels[readVoxels] = color;
+
+			readVoxels++;
+		}
 	}
 
+	//out voxels are always in linear order
+	if(outVoxels != NULL && order != SPLV_VOXEL_ORDER_LINEAR)
+		_splv_brick_write_voxels(out, outVoxels);
+
 	return SPLV_SUCCESS;
 }
 
@@ -701,6 +836,128 @@ static SPLVerror _splv_brick_decode_predictive_legacy(SPLVbufferReader* in, SPLV
 	return SPLV_SUCCESS;
 }
 
+static SPLVerror _splv_brick_decode_intra_legacy_0_3(SPLVbufferReader* in, SPLVbrick* out)
+{
+	//decode bitmap:
+	//-----------------
+	splv_brick_clear(out);
+	SPLV_ERROR_PROPAGATE(_splv_brick_decode_bitmap_rle_legacy_0_3(in, out));
+
+	//read colors, each is a delta from the previous voxel in linear order:
+	//-----------------
+	uint8_t prevRgb[3] = {0, 0, 0};
+
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN; i++)
+	{
+		if((out->bitmap[i / 32] & (1u << (i % 32))) == 0)
+			continue;
+
+		uint8_t rgb[3];
+		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, 3 * sizeof(uint8_t), rgb));
+
+		rgb[0] += prevRgb[0];
+		rgb[1] += prevRgb[1];
+		rgb[2] += prevRgb[2];
+
+		out->color[i] = ((uint32_t)rgb[0] << 24) | ((uint32_t)rgb[1] << 16) | ((uint32_t)rgb[2] << 8) | 255;
+
+		prevRgb[0] = rgb[0];
+		prevRgb[1] = rgb[1];
+		prevRgb[2] = rgb[2];
+	}
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_brick_decode_predictive_legacy_0_3(SPLVbufferReader* in, SPLVbrick* out, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame)
+{
+	//read motion vector:
+	//-----------------
+	int8_t xOff, yOff, zOff;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(int8_t), &xOff));
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(int8_t), &yOff));
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(int8_t), &zOff));
+
+	//copy offset block from last frame, newly filled voxels are predicted as black:
+	//-----------------
+	memset(out, 0, sizeof(SPLVbrick));
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+	for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+	{
+		int32_t lastX = (int32_t)(xMap * SPLV_BRICK_SIZE + x) + xOff;
+		int32_t lastY = (int32_t)(yMap * SPLV_BRICK_SIZE + y) + yOff;
+		int32_t lastZ = (int32_t)(zMap * SPLV_BRICK_SIZE + z) + zOff;
+
+		uint8_t lastR, lastG, lastB;
+		if(_splv_frame_get_voxel(lastFrame, lastX, lastY, lastZ, &lastR, &lastG, &lastB))
+			splv_brick_set_voxel_filled(out, x, y, z, lastR, lastG, lastB);
+	}
+
+	//decode geometry, stored as a run-length coded xor against the prediction:
+	//-----------------
+	SPLVbrick diff;
+	SPLV_ERROR_PROPAGATE(_splv_brick_decode_bitmap_rle_legacy_0_3(in, &diff));
+
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 32; i++)
+		out->bitmap[i] ^= diff.bitmap[i];
+
+	//read color deltas:
+	//-----------------
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN; i++)
+	{
+		if((out->bitmap[i / 32] & (1u << (i % 32))) == 0)
+			continue;
+
+		uint8_t rgb[3];
+		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, 3 * sizeof(uint8_t), rgb));
+
+		uint32_t oldColor = out->color[i];
+		uint8_t r = (uint8_t)(oldColor >> 24) + rgb[0];
+		uint8_t g = (uint8_t)(oldColor >> 16) + rgb[1];
+		uint8_t b = (uint8_t)(oldColor >> 8 ) + rgb[2];
+
+		out->color[i] = ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8) | 255;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_brick_decode_bitmap_rle_legacy_0_3(SPLVbufferReader* in, SPLVbrick* out)
+{
+	//each byte is a run of up to 127 voxels, the top bit marks filled runs:
+	//-----------------
+	memset(out->bitmap, 0, sizeof(out->bitmap));
+
+	uint32_t i = 0;
+	while(i < SPLV_BRICK_LEN)
+	{
+		uint8_t curByte;
+		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(uint8_t), &curByte));
+
+		uint32_t runLen = curByte & 0x7F;
+		if(i + runLen > SPLV_BRICK_LEN)
+			break;
+
+		if((curByte & (1u << 7)) != 0)
+		{
+			for(uint32_t j = i; j < i + runLen; j++)
+				out->bitmap[j / 32] |= 1u << (j % 32);
+		}
+
+		i += runLen;
+	}
+
+	if(i != SPLV_BRICK_LEN)
+	{
+		SPLV_LOG_ERROR("brick bitmap decoding had incorrect number of voxels, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	return SPLV_SUCCESS;
+}
+
 //-------------------------------------------//
 
 static inline splv_bool_t _splv_frame_get_voxel(SPLVframe* frame, int32_t x, int32_t y, int32_t z, uint8_t* r, uint8_t* g, uint8_t* b)
@@ -741,100 +998,8 @@ static inline splv_bool_t _splv_frame_get_voxel(SPLVframe* frame, int32_t x, int
 	return splv_brick_get_voxel_color(&frame->bricks[brickIdx], xBrick, yBrick, zBrick, r, g, b);
 }
 
-static uint64_t _splv_brick_block_match_cost(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, int32_t offX, int32_t offY, int32_t offZ)
-{
-	uint64_t cost = 0;
-
-	//compute start/end brick:
-	//-----------------
-	int32_t mapStartX = (xMap * SPLV_BRICK_SIZE + offX);
-	int32_t mapStartY = (yMap * SPLV_BRICK_SIZE + offY);
-	int32_t mapStartZ = (zMap * SPLV_BRICK_SIZE + offZ);
-	if(mapStartX < 0) mapStartX -= SPLV_BRICK_SIZE;
-	if(mapStartY < 0) mapStartY -= SPLV_BRICK_SIZE;
-	if(mapStartZ < 0) mapStartZ -= SPLV_BRICK_SIZE;
-	mapStartX /= SPLV_BRICK_SIZE;
-	mapStartY /= SPLV_BRICK_SIZE;
-	mapStartZ /= SPLV_BRICK_SIZE;
-
-	int32_t mapEndX = (xMap * SPLV_BRICK_SIZE + (SPLV_BRICK_SIZE - 1) + offX) / SPLV_BRICK_SIZE;
-	int32_t mapEndY = (yMap * SPLV_BRICK_SIZE + (SPLV_BRICK_SIZE - 1) + offY) / SPLV_BRICK_SIZE;
-	int32_t mapEndZ = (zMap * SPLV_BRICK_SIZE + (SPLV_BRICK_SIZE - 1) + offZ) / SPLV_BRICK_SIZE;
-
-	//loop over bricks:
-	//-----------------
-	for(int32_t mapZ = mapStartZ; mapZ <= mapEndZ; mapZ++)
-	for(int32_t mapY = mapStartY; mapY <= mapEndY; mapY++)
-	for(int32_t mapX = mapStartX; mapX <= mapEndX; mapX++)
-	{
-		//compute start/end voxels:
-		//-----------------
-		int32_t voxStartX = (mapX == mapStartX) ? offX % SPLV_BRICK_SIZE : 0;
-		int32_t voxStartY = (mapY == mapStartY) ? offY % SPLV_BRICK_SIZE : 0;
-		int32_t voxStartZ = (mapZ == mapStartZ) ? offZ % SPLV_BRICK_SIZE : 0;
-		if(voxStartX < 0) voxStartX += SPLV_BRICK_SIZE;
-		if(voxStartY < 0) voxStartY += SPLV_BRICK_SIZE;
-		if(voxStartZ < 0) voxStartZ += SPLV_BRICK_SIZE;
-		
-		int32_t voxEndX = (mapX == mapEndX) ? (mapX * SPLV_BRICK_SIZE + SPLV_BRICK_SIZE - 1 + offX) % SPLV_BRICK_SIZE : SPLV_BRICK_SIZE - 1;
-		int32_t voxEndY = (mapY == mapEndY) ? (mapY * SPLV_BRICK_SIZE + SPLV_BRICK_SIZE - 1 + offY) % SPLV_BRICK_SIZE : SPLV_BRICK_SIZE - 1;
-		int32_t voxEndZ = (mapZ == mapEndZ) ? (mapZ * SPLV_BRICK_SIZE + SPLV_BRICK_SIZE - 1 + offZ) % SPLV_BRICK_SIZE : SPLV_BRICK_SIZE - 1;
-		
-		//get brick:
-		//-----------------
-		SPLVbrick* lastBrick = NULL;
-		if(mapX >= 0 && mapX < (int32_t)lastFrame->width  && 
-		   mapY >= 0 && mapY < (int32_t)lastFrame->height && 
-		   mapZ >= 0 && mapZ < (int32_t)lastFrame->depth)
-		{
-			uint32_t mapIdx = splv_frame_get_map_idx(lastFrame, mapX, mapY, mapZ);
-			uint32_t brickIdx = lastFrame->map[mapIdx];
-	
-			if(brickIdx != SPLV_BRICK_IDX_EMPTY)
-				lastBrick = &lastFrame->bricks[brickIdx];
-		}
-		
-		//check each voxel:
-		//-----------------
-		for(int32_t z = voxStartZ; z <= voxEndZ; z++)
-		for(int32_t y = voxStartY; y <= voxEndY; y++)
-		for(int32_t x = voxStartX; x <= voxEndX; x++)
-		{
-			int32_t srcX = x - voxStartX + (SPLV_BRICK_SIZE - voxEndX - 1);
-			int32_t srcY = y - voxStartY + (SPLV_BRICK_SIZE - voxEndY - 1);
-			int32_t srcZ = z - voxStartZ + (SPLV_BRICK_SIZE - voxEndZ - 1);
-
-			uint8_t r1, g1, b1;
-			splv_bool_t filled1 = splv_brick_get_voxel_color(brick, srcX, srcY, srcZ, &r1, &g1, &b1);
-
-			uint8_t r2, g2, b2;
-			splv_bool_t filled2;
-			if(lastBrick)
-				filled2 = splv_brick_get_voxel_color(lastBrick, x, y, z, &r2, &g2, &b2);
-			else
-			{
-				filled2 = SPLV_FALSE;
-				r2 = 0;
-				g2 = 0;
-				b2 = 0;
-			}
-
-			if(filled1 != filled2)
-				cost += SPLV_BRICK_BLOCK_MATCH_GEOM_MISMATCH_COST;
-			else if(filled1 != SPLV_FALSE)
-			{
-				cost += llabs((int64_t)r1 - (int64_t)r2);
-				cost += llabs((int64_t)g1 - (int64_t)g2);
-				cost += llabs((int64_t)b1 - (int64_t)b2);
-			}
-		}
-	}
-
-	return cost;
-}
-
-static void _splv_brick_block_match_neighborhood(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap,
-                                                 SPLVframe* lastFrame, int32_t centerX, int32_t centerY, int32_t centerZ, uint32_t searchDist, splv_bool_t includeCenter,
+static void _splv_brick_block_match_neighborhood(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                                 int32_t centerX, int32_t centerY, int32_t centerZ, uint32_t searchDist, splv_bool_t includeCenter,
                                                  uint64_t* minCost, int32_t* bestOffX, int32_t* bestOffY, int32_t* bestOffZ)
 {
 	for(int32_t z = -1; z <= 1; z++)
@@ -848,7 +1013,10 @@ static void _splv_brick_block_match_neighborhood(SPLVbrick* brick, uint32_t xMap
 		int32_t offY = centerY + y * searchDist;
 		int32_t offZ = centerZ + z * searchDist;
 
-		uint64_t cost = _splv_brick_block_match_cost(brick, xMap, yMap, zMap, lastFrame, offX, offY, offZ);
+		if(!_splv_brick_offset_in_range(range, offX, offY, offZ))
+			continue;
+
+		uint64_t cost = splv_block_match_cost(brick, neighborhood, offX, offY, offZ);
 		if(cost < *minCost || (cost == *minCost && x == 0 && y == 0 && z == 0))
 		{
 			*minCost = cost;
@@ -859,7 +1027,47 @@ static void _splv_brick_block_match_neighborhood(SPLVbrick* brick, uint32_t xMap
 	}
 }
 
-static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, int32_t* bestOffX, int32_t* bestOffY, int32_t* bestOffZ)
+static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVframe* lastFrame, SPLVframeCompact* lastFrameCompact,
+                                              const SPLVmotionSearchParams* params, int32_t* bestOffX, int32_t* bestOffY, int32_t* bestOffZ)
+{
+	//the neighborhood is gathered once, every candidate offset is then matched against it
+	SPLVblockMatchNeighborhood neighborhood;
+	if(lastFrameCompact)
+		splv_block_match_neighborhood_init_compact(&neighborhood, lastFrameCompact, xMap, yMap, zMap);
+	else
+		splv_block_match_neighborhood_init(&neighborhood, lastFrame, xMap, yMap, zMap);
+
+	//offsets are smaller than a brick, so a reference only leaves the allowed bricks if it is offset past an edge of them
+	const int32_t SEARCH_RANGE = SPLV_BRICK_BLOCK_MATCH_SEARCH_PARAM;
+	SPLVboundingBox range = { -SEARCH_RANGE, -SEARCH_RANGE, -SEARCH_RANGE, SEARCH_RANGE, SEARCH_RANGE, SEARCH_RANGE };
+	if(params->constrainReference)
+	{
+		const SPLVboundingBox* bounds = &params->referenceBounds;
+
+		range.xMin = (int32_t)xMap <= bounds->xMin ? 0 : range.xMin;
+		range.yMin = (int32_t)yMap <= bounds->yMin ? 0 : range.yMin;
+		range.zMin = (int32_t)zMap <= bounds->zMin ? 0 : range.zMin;
+		range.xMax = (int32_t)xMap >= bounds->xMax ? 0 : range.xMax;
+		range.yMax = (int32_t)yMap >= bounds->yMax ? 0 : range.yMax;
+		range.zMax = (int32_t)zMap >= bounds->zMax ? 0 : range.zMax;
+	}
+
+	switch(params->preset)
+	{
+	case SPLV_MOTION_SEARCH_PRESET_FAST:
+		_splv_brick_motion_search_diamond(brick, &neighborhood, &range, params->predictors, params->numPredictors, bestOffX, bestOffY, bestOffZ);
+		break;
+	case SPLV_MOTION_SEARCH_PRESET_EXHAUSTIVE:
+		_splv_brick_motion_search_exhaustive(brick, &neighborhood, &range, bestOffX, bestOffY, bestOffZ);
+		break;
+	default:
+		_splv_brick_motion_search_three_step(brick, &neighborhood, &range, bestOffX, bestOffY, bestOffZ);
+		break;
+	}
+}
+
+static void _splv_brick_motion_search_three_step(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                                 int32_t* bestOffX, int32_t* bestOffY, int32_t* bestOffZ)
 {
 	//initialize:
 	//-----------------
@@ -871,7 +1079,7 @@ static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, u
 	//search local area:
 	//-----------------
 	_splv_brick_block_match_neighborhood(
-		brick, xMap, yMap, zMap, lastFrame,
+		brick, neighborhood, range,
 		0, 0, 0, 1, SPLV_TRUE,
 		&minCost, bestOffX, bestOffY, bestOffZ
 	);
@@ -879,7 +1087,7 @@ static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, u
 	//search macro area:
 	//-----------------
 	_splv_brick_block_match_neighborhood(
-		brick, xMap, yMap, zMap, lastFrame,
+		brick, neighborhood, range,
 		0, 0, 0, searchDist, SPLV_FALSE,
 		&minCost, bestOffX, bestOffY, bestOffZ
 	);
@@ -909,7 +1117,10 @@ static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, u
 			if(abs(offX) <= 1 && abs(offY) <= 1 && abs(offZ) <= 1)
 				continue;
 
-			uint64_t cost = _splv_brick_block_match_cost(brick, xMap, yMap, zMap, lastFrame, offX, offY, offZ);
+			if(!_splv_brick_offset_in_range(range, offX, offY, offZ))
+				continue;
+
+			uint64_t cost = splv_block_match_cost(brick, neighborhood, offX, offY, offZ);
 			if(cost < minCost)
 			{
 				minCost = cost;
@@ -929,13 +1140,121 @@ static void _splv_brick_compute_motion_vector(SPLVbrick* brick, uint32_t xMap, u
 		searchDist /= 2;
 
 		_splv_brick_block_match_neighborhood(
-			brick, xMap, yMap, zMap, lastFrame,
+			brick, neighborhood, range,
 			*bestOffX, *bestOffY, *bestOffZ, searchDist, SPLV_FALSE,
 			&minCost, bestOffX, bestOffY, bestOffZ
 		);
 	}
 }
 
+static void _splv_brick_motion_search_diamond(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                              const SPLVmotionVector* predictors, uint32_t numPredictors, int32_t* bestOffX, int32_t* bestOffY, int32_t* bestOffZ)
+{
+	//seed with the zero vector and predictors:
+	//-----------------
+	uint64_t minCost = splv_block_match_cost(brick, neighborhood, 0, 0, 0);
+	*bestOffX = 0;
+	*bestOffY = 0;
+	*bestOffZ = 0;
+
+	for(uint32_t i = 0; i < numPredictors; i++)
+	{
+		int32_t offX = predictors[i].x;
+		int32_t offY = predictors[i].y;
+		int32_t offZ = predictors[i].z;
+
+		if(!_splv_brick_offset_in_range(range, offX, offY, offZ))
+			continue;
+
+		uint64_t cost = splv_block_match_cost(brick, neighborhood, offX, offY, offZ);
+		if(cost < minCost)
+		{
+			minCost = cost;
+			*bestOffX = offX;
+			*bestOffY = offY;
+			*bestOffZ = offZ;
+		}
+	}
+
+	//descend with a large diamond until the center is best, then refine with a small one:
+	//-----------------
+	const int32_t DIAMOND[6][3] = {
+		{-1, 0, 0}, {1, 0, 0},
+		{ 0,-1, 0}, {0, 1, 0},
+		{ 0, 0,-1}, {0, 0, 1}
+	};
+
+	int32_t searchDist = 2;
+	for(uint32_t step = 0; step < SPLV_BRICK_DIAMOND_SEARCH_MAX_STEPS && minCost > 0; step++)
+	{
+		int32_t centerX = *bestOffX;
+		int32_t centerY = *bestOffY;
+		int32_t centerZ = *bestOffZ;
+
+		for(uint32_t i = 0; i < 6; i++)
+		{
+			int32_t offX = centerX + DIAMOND[i][0] * searchDist;
+			int32_t offY = centerY + DIAMOND[i][1] * searchDist;
+			int32_t offZ = centerZ + DIAMOND[i][2] * searchDist;
+
+			if(!_splv_brick_offset_in_range(range, offX, offY, offZ))
+				continue;
+
+			uint64_t cost = splv_block_match_cost(brick, neighborhood, offX, offY, offZ);
+			if(cost < minCost)
+			{
+				minCost = cost;
+				*bestOffX = offX;
+				*bestOffY = offY;
+				*bestOffZ = offZ;
+			}
+		}
+
+		splv_bool_t centerIsBest = (*bestOffX == centerX && *bestOffY == centerY && *bestOffZ == centerZ);
+		if(centerIsBest)
+		{
+			if(searchDist == 1)
+				break;
+
+			searchDist = 1;
+		}
+	}
+}
+
+static void _splv_brick_motion_search_exhaustive(SPLVbrick* brick, const SPLVblockMatchNeighborhood* neighborhood, const SPLVboundingBox* range, 
+                                                 int32_t* bestOffX, int32_t* bestOffY, int32_t* bestOffZ)
+{
+	//start at the zero vector so that it wins any ties
+	uint64_t minCost = splv_block_match_cost(brick, neighborhood, 0, 0, 0);
+	*bestOffX = 0;
+	*bestOffY = 0;
+	*bestOffZ = 0;
+
+	for(int32_t z = range->zMin; z <= range->zMax; z++)
+	for(int32_t y = range->yMin; y <= range->yMax; y++)
+	for(int32_t x = range->xMin; x <= range->xMax; x++)
+	{
+		if(minCost == 0)
+			return;
+
+		uint64_t cost = splv_block_match_cost(brick, neighborhood, x, y, z);
+		if(cost < minCost)
+		{
+			minCost = cost;
+			*bestOffX = x;
+			*bestOffY = y;
+			*bestOffZ = z;
+		}
+	}
+}
+
+static inline splv_bool_t _splv_brick_offset_in_range(const SPLVboundingBox* range, int32_t offX, int32_t offY, int32_t offZ)
+{
+	return offX >= range->xMin && offX <= range->xMax &&
+	       offY >= range->yMin && offY <= range->yMax &&
+	       offZ >= range->zMin && offZ <= range->zMax;
+}
+
 //-------------------------------------------//
 
 static inline void _splv_brick_diff_encode(splv_bool_t add, uint32_t x, uint32_t y, uint32_t z, uint8_t* buf, uint32_t* bitIdx)
@@ -973,4 +1292,416 @@ static inline uint8_t _splv_brick_geom_diff_position_decode(uint8_t* buf, uint32
 	}
 
 	return pos;
-}
\ No newline at end of file
+}
+
+//-------------------------------------------//
+
+static void _splv_brick_gather_reference(SPLVframe* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap, int32_t xOff, int32_t yOff, int32_t zOff, SPLVbrick* out)
+{
+	//the reference block spans at most 2x2x2 bricks of the last frame, find them up front:
+	//-----------------
+	int32_t baseX = (int32_t)xMap * SPLV_BRICK_SIZE + xOff;
+	int32_t baseY = (int32_t)yMap * SPLV_BRICK_SIZE + yOff;
+	int32_t baseZ = (int32_t)zMap * SPLV_BRICK_SIZE + zOff;
+
+	//offsets are > -SPLV_BRICK_SIZE, so bias by a brick to floor-divide negative coordinates
+	int32_t firstBrickX = (baseX + SPLV_BRICK_SIZE) / SPLV_BRICK_SIZE - 1;
+	int32_t firstBrickY = (baseY + SPLV_BRICK_SIZE) / SPLV_BRICK_SIZE - 1;
+	int32_t firstBrickZ = (baseZ + SPLV_BRICK_SIZE) / SPLV_BRICK_SIZE - 1;
+
+	uint32_t shiftX = (uint32_t)(baseX - firstBrickX * SPLV_BRICK_SIZE);
+	uint32_t shiftY = (uint32_t)(baseY - firstBrickY * SPLV_BRICK_SIZE);
+	uint32_t shiftZ = (uint32_t)(baseZ - firstBrickZ * SPLV_BRICK_SIZE);
+
+	SPLVbrick* srcBricks[2][2][2]; //indexed [z][y][x]
+	for(int32_t z = 0; z < 2; z++)
+	for(int32_t y = 0; y < 2; y++)
+	for(int32_t x = 0; x < 2; x++)
+	{
+		int32_t srcX = firstBrickX + x;
+		int32_t srcY = firstBrickY + y;
+		int32_t srcZ = firstBrickZ + z;
+
+		srcBricks[z][y][x] = NULL;
+		if(srcX < 0 || (uint32_t)srcX >= lastFrame->width  ||
+		   srcY < 0 || (uint32_t)srcY >= lastFrame->height ||
+		   srcZ < 0 || (uint32_t)srcZ >= lastFrame->depth)
+			continue;
+
+		uint32_t brickIdx = lastFrame->map[splv_frame_get_map_idx(lastFrame, srcX, srcY, srcZ)];
+		if(brickIdx != SPLV_BRICK_IDX_EMPTY)
+			srcBricks[z][y][x] = &lastFrame->bricks[brickIdx];
+	}
+
+	//copy each row along x, as a byte of the bitmap + a run of colors:
+	//-----------------
+	memset(out->bitmap, 0, sizeof(out->bitmap));
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+	{
+		uint32_t srcZ = shiftZ + z;
+		uint32_t srcY = shiftY + y;
+
+		SPLVbrick* srcLo = srcBricks[srcZ / SPLV_BRICK_SIZE][srcY / SPLV_BRICK_SIZE][0];
+		SPLVbrick* srcHi = srcBricks[srcZ / SPLV_BRICK_SIZE][srcY / SPLV_BRICK_SIZE][1];
+
+		uint32_t srcRow = (srcY % SPLV_BRICK_SIZE) | ((srcZ % SPLV_BRICK_SIZE) << SPLV_BRICK_SIZE_LOG_2);
+		uint32_t dstRow = y | (z << SPLV_BRICK_SIZE_LOG_2);
+
+		uint32_t row = 0;
+		if(srcLo)
+		{
+			row |= ((srcLo->bitmap[srcRow / 4] >> (8 * (srcRow % 4))) & 0xFF) >> shiftX;
+			memcpy(&out->color[dstRow * SPLV_BRICK_SIZE], &srcLo->color[srcRow * SPLV_BRICK_SIZE + shiftX], (SPLV_BRICK_SIZE - shiftX) * sizeof(uint32_t));
+		}
+		if(srcHi && shiftX > 0)
+		{
+			row |= (((srcHi->bitmap[srcRow / 4] >> (8 * (srcRow % 4))) & 0xFF) << (SPLV_BRICK_SIZE - shiftX)) & 0xFF;
+			memcpy(&out->color[dstRow * SPLV_BRICK_SIZE + SPLV_BRICK_SIZE - shiftX], &srcHi->color[srcRow * SPLV_BRICK_SIZE], shiftX * sizeof(uint32_t));
+		}
+
+		out->bitmap[dstRow / 4] |= row << (8 * (dstRow % 4));
+	}
+}
+
+static void _splv_brick_gather_reference_compact(SPLVframeCompact* lastFrame, uint32_t xMap, uint32_t yMap, uint32_t zMap, int32_t xOff, int32_t yOff, int32_t zOff, SPLVbrick* out)
+{
+	//the reference block spans at most 2x2x2 bricks of the last frame, find them up front:
+	//-----------------
+	int32_t baseX = (int32_t)xMap * SPLV_BRICK_SIZE + xOff;
+	int32_t baseY = (int32_t)yMap * SPLV_BRICK_SIZE + yOff;
+	int32_t baseZ = (int32_t)zMap * SPLV_BRICK_SIZE + zOff;
+
+	int32_t firstBrickX = (baseX + SPLV_BRICK_SIZE) / SPLV_BRICK_SIZE - 1;
+	int32_t firstBrickY = (baseY + SPLV_BRICK_SIZE) / SPLV_BRICK_SIZE - 1;
+	int32_t firstBrickZ = (baseZ + SPLV_BRICK_SIZE) / SPLV_BRICK_SIZE - 1;
+
+	uint32_t shiftX = (uint32_t)(baseX - firstBrickX * SPLV_BRICK_SIZE);
+	uint32_t shiftY = (uint32_t)(baseY - firstBrickY * SPLV_BRICK_SIZE);
+	uint32_t shiftZ = (uint32_t)(baseZ - firstBrickZ * SPLV_BRICK_SIZE);
+
+	SPLVbrickCompact* srcBricks[2][2][2]; //indexed [z][y][x]
+	for(int32_t z = 0; z < 2; z++)
+	for(int32_t y = 0; y < 2; y++)
+	for(int32_t x = 0; x < 2; x++)
+	{
+		int32_t srcX = firstBrickX + x;
+		int32_t srcY = firstBrickY + y;
+		int32_t srcZ = firstBrickZ + z;
+
+		srcBricks[z][y][x] = NULL;
+		if(srcX < 0 || (uint32_t)srcX >= lastFrame->width  ||
+		   srcY < 0 || (uint32_t)srcY >= lastFrame->height ||
+		   srcZ < 0 || (uint32_t)srcZ >= lastFrame->depth)
+			continue;
+
+		uint32_t brickIdx = lastFrame->map[splv_frame_compact_get_map_idx(lastFrame, srcX, srcY, srcZ)];
+		if(brickIdx != SPLV_BRICK_IDX_EMPTY)
+			srcBricks[z][y][x] = &lastFrame->bricks[brickIdx];
+	}
+
+	//copy each row along x, as a byte of the bitmap + the colors of its filled voxels, found by rank:
+	//-----------------
+
+	//only filled voxels are written, matching _splv_brick_gather_reference() wherever the bitmap is set
+	memset(out->bitmap, 0, sizeof(out->bitmap));
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+	{
+		uint32_t srcZ = shiftZ + z;
+		uint32_t srcY = shiftY + y;
+
+		SPLVbrickCompact* srcLo = srcBricks[srcZ / SPLV_BRICK_SIZE][srcY / SPLV_BRICK_SIZE][0];
+		SPLVbrickCompact* srcHi = srcBricks[srcZ / SPLV_BRICK_SIZE][srcY / SPLV_BRICK_SIZE][1];
+
+		uint32_t srcRow = (srcY % SPLV_BRICK_SIZE) | ((srcZ % SPLV_BRICK_SIZE) << SPLV_BRICK_SIZE_LOG_2);
+		uint32_t dstRow = y | (z << SPLV_BRICK_SIZE_LOG_2);
+		uint32_t* dstColors = &out->color[dstRow * SPLV_BRICK_SIZE];
+
+		uint32_t row = 0;
+		if(srcLo)
+		{
+			uint32_t srcBits = ((srcLo->bitmap[srcRow / 4] >> (8 * (srcRow % 4))) & 0xFF) >> shiftX;
+			const uint32_t* srcColors = &lastFrame->voxels[srcLo->voxelsOffset + 
+				splv_brick_compact_get_voxel_rank(srcLo, srcRow * SPLV_BRICK_SIZE + shiftX)];
+
+			row |= srcBits;
+			while(srcBits)
+			{
+				dstColors[splv_ctz64(srcBits)] = *srcColors++;
+				srcBits &= srcBits - 1;
+			}
+		}
+		if(srcHi && shiftX > 0)
+		{
+			uint32_t srcBits = ((srcHi->bitmap[srcRow / 4] >> (8 * (srcRow % 4))) & 0xFF) & ((1u << shiftX) - 1);
+			const uint32_t* srcColors = &lastFrame->voxels[srcHi->voxelsOffset + 
+				splv_brick_compact_get_voxel_rank(srcHi, srcRow * SPLV_BRICK_SIZE)];
+
+			row |= srcBits << (SPLV_BRICK_SIZE - shiftX);
+			while(srcBits)
+			{
+				dstColors[SPLV_BRICK_SIZE - shiftX + splv_ctz64(srcBits)] = *srcColors++;
+				srcBits &= srcBits - 1;
+			}
+		}
+
+		out->bitmap[dstRow / 4] |= row << (8 * (dstRow % 4));
+	}
+}
+
+static inline uint64_t _splv_brick_bitmap_word64(const uint32_t* bitmap, uint32_t idx)
+{
+	return (uint64_t)bitmap[2 * idx] | ((uint64_t)bitmap[2 * idx + 1] << 32);
+}
+
+static inline uint32_t _splv_brick_predict_color(const uint32_t* bitmap, const uint32_t* colors, uint32_t idx, uint32_t fallback)
+{
+	uint32_t x = idx & (SPLV_BRICK_SIZE - 1);
+	uint32_t y = (idx >> SPLV_BRICK_SIZE_LOG_2) & (SPLV_BRICK_SIZE - 1);
+	uint32_t z = idx >> SPLV_BRICK_SIZE_2_LOG_2;
+
+	//gather the neighbors at x-1, y-1, z-1, these always precede idx in both linear and morton order:
+	//-----------------
+	uint32_t hasX = x != 0;
+	uint32_t hasY = y != 0;
+	uint32_t hasZ = z != 0;
+
+	uint32_t idxX = idx - hasX;
+	uint32_t idxY = idx - hasY * SPLV_BRICK_SIZE;
+	uint32_t idxZ = idx - hasZ * SPLV_BRICK_SIZE * SPLV_BRICK_SIZE;
+
+	uint32_t filledMask = (((bitmap[idxX / 32] >> (idxX % 32)) & hasX)     ) |
+	                      (((bitmap[idxY / 32] >> (idxY % 32)) & hasY) << 1) |
+	                      (((bitmap[idxZ / 32] >> (idxZ % 32)) & hasZ) << 2);
+
+	//predict, selecting branchlessly since filled neighbors are hard to predict:
+	//-----------------
+
+	//the median of the 3 selected values is: the fallback with no neighbors, the single neighbor with 1, 
+	//the median of both neighbors and the fallback with 2, and the median of all neighbors with 3
+	static const uint8_t SELECT[8][3] = {
+		{ 3, 3, 3 }, { 0, 0, 3 }, { 1, 1, 3 }, { 0, 1, 3 },
+		{ 2, 2, 3 }, { 0, 2, 3 }, { 1, 2, 3 }, { 0, 1, 2 }
+	};
+
+	const uint32_t values[4] = { colors[idxX], colors[idxY], colors[idxZ], fallback };
+	uint32_t v0 = values[SELECT[filledMask][0]];
+	uint32_t v1 = values[SELECT[filledMask][1]];
+	uint32_t v2 = values[SELECT[filledMask][2]];
+
+	//per-channel median of 3, alpha is left as 0 since it is never coded
+	uint32_t pred = 0;
+	for(uint32_t shift = 8; shift < 32; shift += 8)
+	{
+		uint32_t a = (v0 >> shift) & 0xFF;
+		uint32_t b = (v1 >> shift) & 0xFF;
+		uint32_t c = (v2 >> shift) & 0xFF;
+
+		uint32_t lo = a < b ? a : b;
+		uint32_t hi = a < b ? b : a;
+		pred |= (c < lo ? lo : (c > hi ? hi : c)) << shift;
+	}
+
+	return pred;
+}
+
+static inline uint32_t _splv_brick_voxel_idx(SPLVvoxelOrder order, uint32_t pos)
+{
+	return order == SPLV_VOXEL_ORDER_MORTON ? MORTON_TO_IDX[pos] : pos;
+}
+
+static void _splv_brick_bitmap_to_morton(const uint32_t* bitmap, uint32_t* out)
+{
+	//out may alias bitmap. linear indices are x0 x1 x2 y0 y1 y2 z0 z1 z2 (lsb first), morton indices are x0 y0 z0 x1 y1 z1 x2 y2 z2,
+	//so we can permute with 3 swaps of index bits: (1, 3), (2, 6), (5, 7). each 64-bit word holds one z slice
+	uint64_t words[SPLV_BRICK_LEN / 64];
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+		words[i] = _splv_brick_bitmap_word64(bitmap, i);
+
+	_splv_brick_bitmap_swap_index_bits_word(words, 6, 0x00CC00CC00CC00CCull);
+	_splv_brick_bitmap_swap_index_bits_cross(words, 1, 4, 0x0F0F0F0F0F0F0F0Full);
+	_splv_brick_bitmap_swap_index_bits_cross(words, 2, 32, 0x00000000FFFFFFFFull);
+
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		out[2 * i    ] = (uint32_t)words[i];
+		out[2 * i + 1] = (uint32_t)(words[i] >> 32);
+	}
+}
+
+static void _splv_brick_bitmap_from_morton(const uint32_t* bitmap, uint32_t* out)
+{
+	//each swap is its own inverse, so we just apply them in reverse order
+	uint64_t words[SPLV_BRICK_LEN / 64];
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+		words[i] = _splv_brick_bitmap_word64(bitmap, i);
+
+	_splv_brick_bitmap_swap_index_bits_cross(words, 2, 32, 0x00000000FFFFFFFFull);
+	_splv_brick_bitmap_swap_index_bits_cross(words, 1, 4, 0x0F0F0F0F0F0F0F0Full);
+	_splv_brick_bitmap_swap_index_bits_word(words, 6, 0x00CC00CC00CC00CCull);
+
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		out[2 * i    ] = (uint32_t)words[i];
+		out[2 * i + 1] = (uint32_t)(words[i] >> 32);
+	}
+}
+
+static inline void _splv_brick_bitmap_swap_index_bits_word(uint64_t* words, uint32_t shift, uint64_t mask)
+{
+	//mask holds the positions whose bits are exchanged with the ones shift above them
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		uint64_t t = (words[i] ^ (words[i] >> shift)) & mask;
+		words[i] ^= t ^ (t << shift);
+	}
+}
+
+static inline void _splv_brick_bitmap_swap_index_bits_cross(uint64_t* words, uint32_t wordStride, uint32_t shift, uint64_t mask)
+{
+	//swaps the bits shift above mask in the lower word with the bits in mask in the upper word, for each pair of words wordStride apart
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		if((i & wordStride) != 0)
+			continue;
+
+		uint64_t t = ((words[i] >> shift) ^ words[i + wordStride]) & mask;
+		words[i + wordStride] ^= t;
+		words[i] ^= t << shift;
+	}
+}
+
+static void _splv_brick_write_voxels(const SPLVbrick* brick, uint32_t* outVoxels)
+{
+	uint32_t numVoxels = 0;
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		uint64_t filled = _splv_brick_bitmap_word64(brick->bitmap, i);
+		while(filled)
+		{
+			uint32_t idx = 64 * i + splv_ctz64(filled);
+			filled &= filled - 1;
+
+			outVoxels[numVoxels++] = brick->color[idx];
+		}
+	}
+}
+
+static uint32_t _splv_brick_rle_encode(const uint32_t* bitmap, uint8_t* out)
+{
+	//each byte is a run of up to 127 voxels, with the top bit set if they are filled
+	uint32_t numBytes = 0;
+	uint32_t pos = 0;
+
+	while(pos < SPLV_BRICK_LEN)
+	{
+		uint32_t wordIdx = pos / 64;
+		uint64_t word = _splv_brick_bitmap_word64(bitmap, wordIdx);
+		uint64_t filled = (word >> (pos % 64)) & 1;
+
+		//find end of run, the first bit after pos that differs:
+		uint64_t ends = (filled ? ~word : word) & (~0ull << (pos % 64));
+		while(ends == 0 && ++wordIdx < SPLV_BRICK_LEN / 64)
+		{
+			word = _splv_brick_bitmap_word64(bitmap, wordIdx);
+			ends = filled ? ~word : word;
+		}
+
+		uint32_t end = ends == 0 ? SPLV_BRICK_LEN : 64 * wordIdx + splv_ctz64(ends);
+
+		//write run:
+		uint32_t runLen = end - pos;
+		while(runLen > 0)
+		{
+			uint32_t len = runLen < 127 ? runLen : 127;
+			out[numBytes++] = (uint8_t)((filled << 7) | len);
+			runLen -= len;
+		}
+
+		pos = end;
+	}
+
+	return numBytes;
+}
+
+static SPLVerror _splv_brick_rle_decode(SPLVbufferReader* in, uint32_t* bitmap)
+{
+	memset(bitmap, 0, (SPLV_BRICK_LEN / 32) * sizeof(uint32_t));
+
+	const uint8_t* runs = in->buf + in->readPos;
+	uint64_t numRunsAvailable = in->len - in->readPos;
+	uint64_t numRuns = 0;
+
+	uint32_t pos = 0;
+	while(pos < SPLV_BRICK_LEN)
+	{
+		if(numRuns >= numRunsAvailable)
+		{
+			SPLV_LOG_ERROR("brick bitmap extends past end of buffer, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+
+		uint8_t run = runs[numRuns++];
+		uint32_t runLen = run & 0x7F;
+		if(pos + runLen > SPLV_BRICK_LEN)
+		{
+			SPLV_LOG_ERROR("brick bitmap decoding had incorrect number of voxels, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+
+		//fill runs of filled voxels a word at a time:
+		if((run & 0x80) != 0)
+		{
+			uint32_t fillPos = pos;
+			uint32_t fillLen = runLen;
+			while(fillLen > 0)
+			{
+				uint32_t bit = fillPos % 32;
+				uint32_t len = fillLen < 32 - bit ? fillLen : 32 - bit;
+				uint32_t mask = len == 32 ? 0xFFFFFFFF : ((1u << len) - 1) << bit;
+
+				bitmap[fillPos / 32] |= mask;
+
+				fillPos += len;
+				fillLen -= len;
+			}
+		}
+
+		pos += runLen;
+	}
+
+	in->readPos += numRuns;
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_brick_write_colors(SPLVbufferWriter* out, uint8_t colorBytes[3][SPLV_BRICK_LEN], uint32_t numColors)
+{
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(&out[SPLV_BRICK_STREAM_COLOR_R], numColors * sizeof(uint8_t), colorBytes[0]));
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(&out[SPLV_BRICK_STREAM_COLOR_G], numColors * sizeof(uint8_t), colorBytes[1]));
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(&out[SPLV_BRICK_STREAM_COLOR_B], numColors * sizeof(uint8_t), colorBytes[2]));
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_brick_read_colors(SPLVbufferReader* in, uint32_t numColors, const uint8_t** colorBytes)
+{
+	//colors are read in place, just validate + advance each plane
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		SPLVbufferReader* plane = &in[SPLV_BRICK_STREAM_COLOR_R + i];
+		if(plane->readPos + numColors > plane->len)
+		{
+			SPLV_LOG_ERROR("brick colors extend past end of buffer, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+
+		colorBytes[i] = plane->buf + plane->readPos;
+		plane->readPos += numColors;
+	}
+
+	return SPLV_SUCCESS;
+}
@@ -69,25 +69,38 @@ void splv_buffer_writer_destroy(SPLVbufferWriter* writer)
 
 SPLVerror splv_buffer_writer_write(SPLVbufferWriter* writer, uint64_t size, void* src)
 {
-	if(writer->writePos + size > writer->len)
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_reserve(writer, size));
+
+	memcpy(writer->buf + writer->writePos, src, size);
+	writer->writePos += size;
+
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_buffer_writer_reserve(SPLVbufferWriter* writer, uint64_t size)
+{
+	if(size > UINT64_MAX / 2 - writer->writePos)
 	{
-		uint64_t newLen = writer->len;
-		while(writer->writePos + size > newLen)
-			newLen *= 2;
+		SPLV_LOG_ERROR("buffer writer size too large");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
 
-		uint8_t* newBuf = (uint8_t*)SPLV_REALLOC(writer->buf, newLen);
-		if(!newBuf)
-		{
-			SPLV_LOG_ERROR("failed to realloc buffer to write to");
-			return SPLV_ERROR_OUT_OF_MEMORY;
-		}
+	if(writer->writePos + size <= writer->len)
+		return SPLV_SUCCESS;
 
-		writer->buf = newBuf;
-		writer->len = newLen;
+	uint64_t newLen = writer->len;
+	while(writer->writePos + size > newLen)
+		newLen *= 2;
+
+	uint8_t* newBuf = (uint8_t*)SPLV_REALLOC(writer->buf, newLen);
+	if(!newBuf)
+	{
+		SPLV_LOG_ERROR("failed to realloc buffer to write to");
+		return SPLV_ERROR_OUT_OF_MEMORY;
 	}
 
-	memcpy(writer->buf + writer->writePos, src, size);
-	writer->writePos += size;
+	writer->buf = newBuf;
+	writer->len = newLen;
 
 	return SPLV_SUCCESS;
 }
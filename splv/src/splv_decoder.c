@@ -1,6 +1,12 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+	#define _GNU_SOURCE //for mmap() + madvise()
+#endif
+
 #include "spatialstudio/splv_decoder.h"
 
 #include "spatialstudio/splv_range_coder.h"
+#include "spatialstudio/splv_rans.h"
+#include "spatialstudio/splv_occupancy_coder.h"
 #include "spatialstudio/splv_log.h"
 #include <math.h>
 
@@ -10,38 +16,37 @@
 	#define SPLV_DECODER_MULTITHREADING
 #endif
 
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	#define SPLV_DECODER_MMAP
+
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
 #define max(a,b) (((a) > (b)) ? (a) : (b))
 #define min(a,b) (((a) < (b)) ? (a) : (b))
 
 //-------------------------------------------//
 
-/**
- * all info needed for a thread to decode a brick group
- */
-typedef struct SPLVbrickGroupDecodeInfo
-{
-	SPLVdecoder* decoder;
-
-	SPLVframe* outFrame;
-	SPLVframeCompact* outFrameCompact;
-	
-	uint64_t compressedBufLen;
-	uint8_t* compressedBuf;
-	
-	uint32_t brickStartIdx;
-	uint32_t numBricks;
-	
-	uint64_t voxelsStartIdx;
-	uint64_t numVoxels;
-
-	SPLVframe* lastFrame;
-} SPLVbrickGroupDecodeInfo;
+static SPLVerror _splv_decoder_create(SPLVdecoder* decoder, SPLVdecoderOptions options);
 
-//-------------------------------------------//
+static SPLVerror _splv_decoder_decode_frame(SPLVdecoder* decoder, uint64_t idx, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVframeCompactIndexed* dependenciesCompact,
+                                            SPLVboundingBox region, SPLVframe* frame, SPLVframeCompact* compactFrame, splv_bool_t reuse);
+static SPLVerror _splv_decoder_decode_brick_group(void* info);
+static splv_bool_t _splv_decoder_tile_intersects(SPLVdecoder* decoder, SPLVcoordinate brickPos, SPLVboundingBox region);
+static void _splv_decoder_read_ahead(SPLVdecoder* decoder, uint64_t idx);
 
-static SPLVerror _splv_decoder_create(SPLVdecoder* decoder);
+static SPLVerror _splv_decoder_get_frame_range(SPLVdecoder* decoder, uint64_t idx, uint64_t* framePtr, uint64_t* frameLen);
+static SPLVerror _splv_decoder_read_frame(SPLVdecoder* decoder, FILE* file, uint64_t idx, uint8_t** buf, uint64_t* bufLen, uint64_t* frameLen);
 
-static SPLVerror _splv_decoder_decode_brick_group(void* info);
+static SPLVerror _splv_decoder_prefetch_start(SPLVdecoder* decoder, const char* path, SPLVdecoderOptions options);
+static void _splv_decoder_prefetch_stop(SPLVdecoder* decoder);
+static void _splv_decoder_prefetch_free_slots(SPLVdecoder* decoder);
+static SPLVerror _splv_decoder_prefetch_acquire(SPLVdecoder* decoder, uint64_t idx, uint8_t** frame, uint64_t* frameLen);
+static splv_bool_t _splv_decoder_prefetch_can_read(SPLVdecoder* decoder);
+static void* _splv_decoder_prefetch_thread(void* arg);
 
 static inline SPLVerror _splv_decoder_read(SPLVdecoder* decoder, uint64_t size, void* dst);
 static inline SPLVerror _splv_decoder_seek(SPLVdecoder* decoder, uint64_t pos);
@@ -49,6 +54,24 @@ static inline SPLVerror _splv_decoder_seek(SPLVdecoder* decoder, uint64_t pos);
 //-------------------------------------------//
 
 SPLVerror splv_decoder_create_from_mem(SPLVdecoder* decoder, uint64_t encodedBufLen, uint8_t* encodedBuf)
+{
+	SPLVdecoderOptions options = {0};
+	return splv_decoder_create_from_mem_with_options(decoder, encodedBufLen, encodedBuf, options);
+}
+
+SPLVerror splv_decoder_create_from_file(SPLVdecoder* decoder, const char* path)
+{
+	SPLVdecoderOptions options = {0};
+	return splv_decoder_create_from_file_with_options(decoder, path, options);
+}
+
+SPLVerror splv_decoder_create_from_file_mmap(SPLVdecoder* decoder, const char* path)
+{
+	SPLVdecoderOptions options = {0};
+	return splv_decoder_create_from_file_mmap_with_options(decoder, path, options);
+}
+
+SPLVerror splv_decoder_create_from_mem_with_options(SPLVdecoder* decoder, uint64_t encodedBufLen, uint8_t* encodedBuf, SPLVdecoderOptions options)
 {
 	//initialize:
 	//---------------
@@ -62,10 +85,10 @@ SPLVerror splv_decoder_create_from_mem(SPLVdecoder* decoder, uint64_t encodedBuf
 
 	//create general decoder:
 	//---------------
-	return _splv_decoder_create(decoder);
+	return _splv_decoder_create(decoder, options);
 }
 
-SPLVerror splv_decoder_create_from_file(SPLVdecoder* decoder, const char* path)
+SPLVerror splv_decoder_create_from_file_with_options(SPLVdecoder* decoder, const char* path, SPLVdecoderOptions options)
 {
 	//initialize:
 	//---------------
@@ -98,7 +121,79 @@ SPLVerror splv_decoder_create_from_file(SPLVdecoder* decoder, const char* path)
 
 	//create general decoder:
 	//---------------
-	return _splv_decoder_create(decoder);
+	SPLV_ERROR_PROPAGATE(_splv_decoder_create(decoder, options));
+
+	//start prefetching:
+	//---------------
+#ifdef SPLV_DECODER_MULTITHREADING
+	if(options.prefetchFrames > 0)
+	{
+		SPLVerror prefetchError = _splv_decoder_prefetch_start(decoder, path, options);
+		if(prefetchError != SPLV_SUCCESS)
+		{
+			splv_decoder_destroy(decoder);
+			return prefetchError;
+		}
+	}
+#endif
+
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_decoder_create_from_file_mmap_with_options(SPLVdecoder* decoder, const char* path, SPLVdecoderOptions options)
+{
+#ifdef SPLV_DECODER_MMAP
+	//initialize:
+	//---------------
+	memset(decoder, 0, sizeof(SPLVdecoder)); //clear any ptrs to NULL
+
+	decoder->fromFile = 0;
+	decoder->readAheadFrames = options.readAheadFrames > 0 ? options.readAheadFrames : SPLV_DECODER_DEFAULT_READ_AHEAD_FRAMES;
+
+	//map file:
+	//---------------
+	int fd = open(path, O_RDONLY);
+	if(fd == -1)
+	{
+		SPLV_LOG_ERROR("failed to open input file for decoding");
+		return SPLV_ERROR_FILE_OPEN;
+	}
+
+	struct stat fileStat;
+	if(fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+	{
+		close(fd);
+
+		SPLV_LOG_ERROR("failed to get size of input file");
+		return SPLV_ERROR_FILE_READ;
+	}
+
+	void* mapping = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); //mapping stays valid after the fd is closed
+	if(mapping == MAP_FAILED)
+	{
+		SPLV_LOG_ERROR("failed to memory-map input file");
+		return SPLV_ERROR_FILE_READ;
+	}
+
+	decoder->fileMapping = mapping;
+	decoder->fileMappingLen = (uint64_t)fileStat.st_size;
+
+	//create buffer reader:
+	//---------------
+	SPLVerror readerError = splv_buffer_reader_create(&decoder->inBuf, (uint8_t*)mapping, decoder->fileMappingLen);
+	if(readerError != SPLV_SUCCESS)
+	{
+		munmap(mapping, (size_t)decoder->fileMappingLen);
+		return readerError;
+	}
+
+	//create general decoder:
+	//---------------
+	return _splv_decoder_create(decoder, options);
+#else
+	return splv_decoder_create_from_file_with_options(decoder, path, options);
+#endif
 }
 
 SPLVerror splv_decoder_get_frame_dependencies(SPLVdecoder* decoder, uint64_t idx, uint64_t* numDependencies, uint64_t* dependencies, uint8_t recursive)
@@ -152,446 +247,206 @@ SPLVerror splv_decoder_get_frame_dependencies(SPLVdecoder* decoder, uint64_t idx
 
 SPLVerror splv_decoder_decode_frame(SPLVdecoder* decoder, uint64_t idx, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVframe* frame, SPLVframeCompact* compactFrame)
 {
-	//validate:
-	//-----------------
-	SPLV_ASSERT(idx < decoder->frameCount, "out of bounds frame index");
-
-	//get frame pointer:
-	//-----------------
-	uint64_t frameTableEntry = decoder->frameTable[idx];
-	SPLVframeEncodingType encodingType = (SPLVframeEncodingType)(frameTableEntry >> 56);
-	uint64_t framePtr = frameTableEntry & 0x00FFFFFFFFFFFFFF;
-
-	//read compressed frame data:
-	//-----------------
-	uint8_t* compressedFrame;
-	uint64_t compressedFrameLen;
-	if(decoder->fromFile)
-	{
-		//get ptr to next frame
-		uint64_t nextFramePtr;
-		if(idx == decoder->frameCount - 1)
-		{
-			if(fseek(decoder->inFile.file, 0, SEEK_END) != 0)
-			{
-				SPLV_LOG_ERROR("failed to seek to end of file");
-				return SPLV_ERROR_FILE_READ;
-			}
+	SPLVboundingBox volume = { 0, 0, 0, (int32_t)decoder->width - 1, (int32_t)decoder->height - 1, (int32_t)decoder->depth - 1 };
+	return _splv_decoder_decode_frame(decoder, idx, numDependencies, dependencies, NULL, volume, frame, compactFrame, SPLV_FALSE);
+}
 
-			long fileSize = ftell(decoder->inFile.file);
-			if(fileSize == -1)
-			{
-				SPLV_LOG_ERROR("failed to get file size");
-				return SPLV_ERROR_FILE_READ;
-			}
+SPLVerror splv_decoder_decode_frame_into(SPLVdecoder* decoder, uint64_t idx, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVframe* frame, SPLVframeCompact* compactFrame)
+{
+	SPLVboundingBox volume = { 0, 0, 0, (int32_t)decoder->width - 1, (int32_t)decoder->height - 1, (int32_t)decoder->depth - 1 };
+	return _splv_decoder_decode_frame(decoder, idx, numDependencies, dependencies, NULL, volume, frame, compactFrame, SPLV_TRUE);
+}
 
-			nextFramePtr = fileSize - (decoder->frameCount * sizeof(uint64_t));
-		}
-		else
-		{
-			uint64_t nextFrameTableEntry = decoder->frameTable[idx + 1];
-			nextFramePtr = nextFrameTableEntry & 0x00FFFFFFFFFFFFFF;
-		}
+SPLVerror splv_decoder_decode_frame_compact(SPLVdecoder* decoder, uint64_t idx, uint64_t numDependencies, SPLVframeCompactIndexed* dependencies, SPLVframeCompact* frame)
+{
+	SPLVboundingBox volume = { 0, 0, 0, (int32_t)decoder->width - 1, (int32_t)decoder->height - 1, (int32_t)decoder->depth - 1 };
+	return _splv_decoder_decode_frame(decoder, idx, numDependencies, NULL, dependencies, volume, NULL, frame, SPLV_TRUE);
+}
 
-		//potentially resize scratch buffer
-		compressedFrameLen = nextFramePtr - framePtr;
-		if(compressedFrameLen > decoder->inFile.scrathBufLen)
-		{
-			uint64_t newScratchBufLen = decoder->inFile.scrathBufLen;
-			while(compressedFrameLen > newScratchBufLen)
-				newScratchBufLen *= 2;
+SPLVerror splv_decoder_decode_frame_region(SPLVdecoder* decoder, uint64_t idx, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVboundingBox region,
+                                           SPLVframe* frame, SPLVframeCompact* compactFrame)
+{
+	return _splv_decoder_decode_frame(decoder, idx, numDependencies, dependencies, NULL, region, frame, compactFrame, SPLV_FALSE);
+}
 
-			uint8_t* newScatchBuf = (uint8_t*)SPLV_REALLOC(decoder->inFile.scratchBuf, newScratchBufLen);
-			if(!newScatchBuf)
-			{
-				SPLV_LOG_ERROR("failed to realloc decoder file scratch buf");
-				return SPLV_ERROR_OUT_OF_MEMORY;
-			}
+int64_t splv_decoder_get_prev_i_frame_idx(SPLVdecoder* decoder, uint64_t idx)
+{
+	SPLV_ASSERT(idx < decoder->frameCount, "out of bounds frame index");
 
-			decoder->inFile.scratchBuf = newScatchBuf;
-			decoder->inFile.scrathBufLen = newScratchBufLen;
-		}
+	int64_t frameIdx = idx;
+	SPLVframeEncodingType encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
 
-		//get ptrs to compressed frame
-		SPLV_ERROR_PROPAGATE(_splv_decoder_seek(decoder, framePtr));
-		SPLV_ERROR_PROPAGATE(_splv_decoder_read(decoder, compressedFrameLen, decoder->inFile.scratchBuf));
-		compressedFrame = decoder->inFile.scratchBuf;
-	}
-	else
+	while(encodingType != SPLV_FRAME_ENCODING_TYPE_I && frameIdx > 0)
 	{
-		SPLV_ERROR_PROPAGATE(_splv_decoder_seek(decoder, framePtr));
-		compressedFrame = decoder->inBuf.buf + decoder->inBuf.readPos;
-		compressedFrameLen = decoder->inBuf.len - decoder->inBuf.readPos;
+		frameIdx--;
+		encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
 	}
 
-	//ensure dependencies are present:
-	//-----------------
-	SPLVframe* lastFrame = NULL;
-	uint8_t foundDependencies = 0;
+	if(encodingType != SPLV_FRAME_ENCODING_TYPE_I)
+		return -1;
+	else
+		return frameIdx;
+}
 
-	if(encodingType == SPLV_FRAME_ENCODING_TYPE_I)
-		foundDependencies = 1;
-	else if(encodingType == SPLV_FRAME_ENCODING_TYPE_P)
-	{
-		if(idx == 0)
-		{
-			SPLV_LOG_ERROR("invalid SPLV file - first frame cannot be a p-frame");
-			return SPLV_ERROR_INVALID_INPUT;
-		}
+int64_t splv_decoder_get_next_i_frame_idx(SPLVdecoder* decoder, uint64_t idx)
+{
+	SPLV_ASSERT(idx < decoder->frameCount, "out of bounds frame index");
 
-		for(uint32_t i = 0; i < numDependencies; i++)
-		{
-			if(dependencies[i].index == idx - 1)
-			{
-				lastFrame = dependencies[i].frame;
-				foundDependencies = 1;
-				break;
-			}
-		}
-	}
-	else
-	{
-		SPLV_LOG_ERROR("invalid SPLV file - unknown frame encoding type");
-		return SPLV_ERROR_INVALID_INPUT;
-	}
+	int64_t frameIdx = idx;
+	SPLVframeEncodingType encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
 
-	//TODO change to an assert
-	if(!foundDependencies)
+	while(encodingType != SPLV_FRAME_ENCODING_TYPE_I && frameIdx < (int64_t)decoder->frameCount - 1)
 	{
-		SPLV_LOG_ERROR("neccesary dependencies were not supplied for decoding frame");
-		return SPLV_ERROR_RUNTIME;
+		frameIdx++;
+		encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
 	}
 
-	//create compressed reader, read num bricks:
-	//-----------------
-	SPLVbufferReader compressedReader;
-	SPLV_ERROR_PROPAGATE(splv_buffer_reader_create(&compressedReader, compressedFrame, compressedFrameLen));
+	if(encodingType != SPLV_FRAME_ENCODING_TYPE_I)
+		return -1;
+	else
+		return frameIdx;
+}
 
-	uint32_t numBricks;
-	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&compressedReader, sizeof(uint32_t), &numBricks));
+void splv_decoder_destroy(SPLVdecoder* decoder)
+{
+	if(decoder->prefetching)
+		_splv_decoder_prefetch_stop(decoder);
 
-	uint64_t numVoxels;
-	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &numVoxels));
+#ifdef SPLV_DECODER_MULTITHREADING
+	splv_thread_pool_group_destroy(&decoder->threadPoolGroup);
+	if(decoder->ownsThreadPool)
+		splv_thread_pool_destroy(decoder->threadPool);
+#endif
 
-	if(compactFrame && numVoxels > UINT32_MAX)
+	if(decoder->frameTable)
+		SPLV_FREE(decoder->frameTable);
+
+	if(decoder->brickOrder)
+		SPLV_FREE(decoder->brickOrder);
+	if(decoder->tileStarts)
+		SPLV_FREE(decoder->tileStarts);
+
+	if(decoder->scratchBufEncodedMap)
+		SPLV_FREE(decoder->scratchBufEncodedMap);
+	if(decoder->scratchBufSkipBitmap)
+		SPLV_FREE(decoder->scratchBufSkipBitmap);
+	if(decoder->scratchBufBrickPositions)
+		SPLV_FREE(decoder->scratchBufBrickPositions);
+	if(decoder->scratchBufBrickGroupInfos)
+		SPLV_FREE(decoder->scratchBufBrickGroupInfos);
+	if(decoder->scratchBufDecompressed)
 	{
-		SPLV_LOG_ERROR("too many voxels to fit in SPLVframeCompact, more than UINT32_MAX");
-		return SPLV_ERROR_INVALID_INPUT;
+		for(uint32_t i = 0; i < decoder->maxBrickGroups * SPLV_BRICK_STREAM_COUNT; i++)
+			splv_buffer_writer_destroy(&decoder->scratchBufDecompressed[i]);
+
+		SPLV_FREE(decoder->scratchBufDecompressed);
 	}
 
-	//create frame:
-	//-----------------
-	uint32_t mapWidth  = decoder->width  / SPLV_BRICK_SIZE;
-	uint32_t mapHeight = decoder->height / SPLV_BRICK_SIZE;
-	uint32_t mapDepth  = decoder->depth  / SPLV_BRICK_SIZE;
+	if(decoder->fromFile)
+	{
+		fclose(decoder->inFile.file);
+		SPLV_FREE(decoder->inFile.scratchBuf);
+	}
 
-	SPLV_ERROR_PROPAGATE(splv_frame_create(
-		frame,
-		mapWidth,
-		mapHeight,
-		mapDepth,
-		numBricks
-	));
+#ifdef SPLV_DECODER_MMAP
+	if(decoder->fileMapping)
+		munmap(decoder->fileMapping, (size_t)decoder->fileMappingLen);
+#endif
+}
 
-	if(compactFrame)
+//-------------------------------------------//
+
+static SPLVerror _splv_decoder_create(SPLVdecoder* decoder, SPLVdecoderOptions options)
+{
+	//read header + validate:
+	//-----------------
+	SPLVfileHeader header;
+	SPLVerror readHeaderError = _splv_decoder_read(decoder, sizeof(SPLVfileHeader), &header);
+	if(readHeaderError != SPLV_SUCCESS)
 	{
-		SPLVerror compactFrameError = splv_frame_compact_create(
-			compactFrame,
-			mapWidth,
-			mapHeight,
-			mapDepth,
-			numBricks,
-			numVoxels
-		);
+		splv_decoder_destroy(decoder);
 
-		if(compactFrameError != SPLV_SUCCESS)
-		{
-			splv_frame_destroy(frame);
-			return compactFrameError;
-		}
+		SPLV_LOG_ERROR("failed to read file header");
+		return readHeaderError;
 	}
 
-	//read compressed map, generate full map:
-	//-----------------	
-	SPLVerror readMapError = splv_buffer_reader_read(
-		&compressedReader, 
-		decoder->encodedMapLen * sizeof(uint32_t), decoder->scratchBufEncodedMap
-	);
-	if(readMapError != SPLV_SUCCESS)
+	if(header.magicWord != SPLV_MAGIC_WORD)
 	{
-		splv_frame_destroy(frame);
-		if(compactFrame)
-			splv_frame_compact_destroy(compactFrame);
+		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("failed to read encoded map from decompressed stream");
-		return readMapError;
+		SPLV_LOG_ERROR("invalid SPLV file - mismatched magic word");
+		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	uint32_t curBrickIdx = 0;
-	for(uint32_t x = 0; x < mapWidth ; x++)
-	for(uint32_t y = 0; y < mapHeight; y++)
-	for(uint32_t z = 0; z < mapDepth ; z++)
+	if(header.version != SPLV_VERSION)
 	{
-		uint32_t idx = splv_frame_get_map_idx(frame, x, y, z);
-		uint32_t idxArr = idx / 32;
-		uint32_t idxBit = idx % 32;
-
-		if((decoder->scratchBufEncodedMap[idxArr] & (1u << idxBit)) != 0)
-		{
-			decoder->scratchBufBrickPositions[curBrickIdx] = (SPLVcoordinate){ x, y, z };
-			
-			frame->map[idx] = curBrickIdx;
-			if(compactFrame)
-				compactFrame->map[idx] = curBrickIdx;
+		splv_decoder_destroy(decoder);
 
-			curBrickIdx++;
-		}
-		else
-		{
-			frame->map[idx] = SPLV_BRICK_IDX_EMPTY;
-			if(compactFrame)
-				compactFrame->map[idx] = SPLV_BRICK_IDX_EMPTY;
-		}
+		SPLV_LOG_ERROR("invalid SPLV file - mismatched version, files from older versions must be converted with splv_file_upgrade()");
+		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	//sanity check
-	if(curBrickIdx != numBricks)
+	if(header.width == 0 || header.height == 0 || header.width == 0)
 	{
-		splv_frame_destroy(frame);
-		if(compactFrame)
-			splv_frame_compact_destroy(compactFrame);
+		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("invalid SPLV file - given number of bricks did not match contents of map");
+		SPLV_LOG_ERROR("invalid SPLV file - dimensions must be positive");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	//decode each brick group:
-	//-----------------
-	uint32_t maxBrickGroupSize;
-	if(decoder->encodingParams.maxBrickGroupSize == 0)
-		maxBrickGroupSize = max(numBricks, 1);
-	else
-		maxBrickGroupSize = decoder->encodingParams.maxBrickGroupSize;
-
-	uint32_t numBrickGroups = (numBricks + maxBrickGroupSize - 1) / maxBrickGroupSize;
-	uint32_t baseBrickGroupSize      = numBricks / max(numBrickGroups, 1);
-	uint32_t brickGroupSizeRemainder = numBricks % max(numBrickGroups, 1);
-
-	uint8_t* brickGroupsStart = compressedReader.buf + compressedReader.readPos + numBrickGroups * (2 * sizeof(uint64_t));
-	uint64_t brickGroupsLen   = compressedReader.len - compressedReader.readPos - numBrickGroups * (2 * sizeof(uint64_t));
-
-	uint64_t sumVoxelsGroup = 0;
-
-	for(uint32_t i = 0; i < numBrickGroups; i++)
-	{
-		uint32_t startBrick = i * baseBrickGroupSize + min(i, brickGroupSizeRemainder);
-		uint32_t numBricks = baseBrickGroupSize + (i < brickGroupSizeRemainder ? 1 : 0);
-
-		uint64_t offset;
-		SPLVerror readOffsetError = splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &offset);
-		if(readOffsetError != SPLV_SUCCESS)
-		{
-			splv_frame_destroy(frame);
-			if(compactFrame)
-				splv_frame_compact_destroy(compactFrame);
-
-			SPLV_LOG_ERROR("failed to read brick group offset from decompressed stream");
-			return readOffsetError;
-		}
-
-		uint64_t numVoxelsGroup;
-		SPLVerror readNumVoxelsError = splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &numVoxelsGroup);
-		if(readNumVoxelsError != SPLV_SUCCESS)
-		{
-			splv_frame_destroy(frame);
-			if(compactFrame)
-				splv_frame_compact_destroy(compactFrame);
-
-			SPLV_LOG_ERROR("failed to read brick group voxel count from decompressed stream");
-			return readNumVoxelsError;
-		}
-
-		uint8_t* groupBuf = brickGroupsStart + offset;
-		uint64_t groupSize = brickGroupsLen - offset;
-
-		SPLVbrickGroupDecodeInfo decodeInfo;
-		decodeInfo.decoder = decoder;
-		decodeInfo.outFrame = frame;
-		decodeInfo.outFrameCompact = compactFrame;
-		decodeInfo.compressedBufLen = groupSize;
-		decodeInfo.compressedBuf = groupBuf;
-		decodeInfo.brickStartIdx = startBrick;
-		decodeInfo.numBricks = numBricks;
-		decodeInfo.lastFrame = lastFrame;
-		decodeInfo.voxelsStartIdx = sumVoxelsGroup;
-		decodeInfo.numVoxels = numVoxelsGroup;
-
-	#ifdef SPLV_DECODER_MULTITHREADING
-		SPLVerror addWorkError = splv_thread_pool_add_work(decoder->threadPool, &decodeInfo);
-		if(addWorkError != SPLV_SUCCESS)
-		{
-			splv_frame_destroy(frame);
-			if(compactFrame)
-				splv_frame_compact_destroy(compactFrame);
-
-			SPLV_LOG_ERROR("failed to add work to thread pool");
-			return addWorkError;
-		}
-	#else
-		_splv_decoder_decode_brick_group(&decodeInfo);
-	#endif
-
-		sumVoxelsGroup += numVoxelsGroup;
-	}
-
-	if(sumVoxelsGroup != numVoxels)
-	{
-		splv_frame_destroy(frame);
-		if(compactFrame)
-			splv_frame_compact_destroy(compactFrame);
-
-		SPLV_LOG_ERROR("sum of group voxel counts did not match given given voxel count");
-		return SPLV_ERROR_INVALID_INPUT;
-	}
-
-	//wait for all threads to exit:
-	//-----------------
-#ifdef SPLV_DECODER_MULTITHREADING
-	SPLVerror waitError = splv_thread_pool_wait(decoder->threadPool);
-	if(waitError != SPLV_SUCCESS)
-	{
-		splv_frame_destroy(frame);
-		if(compactFrame)
-			splv_frame_compact_destroy(compactFrame);
-
-		SPLV_LOG_ERROR("failed to wait on thread pool");
-		return waitError;
-	}
-#endif
-
-	//return:
-	//-----------------
-	return SPLV_SUCCESS;
-}
-
-int64_t splv_decoder_get_prev_i_frame_idx(SPLVdecoder* decoder, uint64_t idx)
-{
-	SPLV_ASSERT(idx < decoder->frameCount, "out of bounds frame index");
-
-	int64_t frameIdx = idx;
-	SPLVframeEncodingType encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
-
-	while(encodingType != SPLV_FRAME_ENCODING_TYPE_I && frameIdx > 0)
-	{
-		frameIdx--;
-		encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
-	}
-
-	if(encodingType != SPLV_FRAME_ENCODING_TYPE_I)
-		return -1;
-	else
-		return frameIdx;
-}
-
-int64_t splv_decoder_get_next_i_frame_idx(SPLVdecoder* decoder, uint64_t idx)
-{
-	SPLV_ASSERT(idx < decoder->frameCount, "out of bounds frame index");
-
-	int64_t frameIdx = idx;
-	SPLVframeEncodingType encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
-
-	while(encodingType != SPLV_FRAME_ENCODING_TYPE_I && frameIdx < (int64_t)decoder->frameCount - 1)
-	{
-		frameIdx++;
-		encodingType = (SPLVframeEncodingType)(decoder->frameTable[frameIdx] >> 56);
-	}
-
-	if(encodingType != SPLV_FRAME_ENCODING_TYPE_I)
-		return -1;
-	else
-		return frameIdx;
-}
-
-void splv_decoder_destroy(SPLVdecoder* decoder)
-{
-#ifdef SPLV_DECODER_MULTITHREADING
-	if(decoder->threadPool)
-		splv_thread_pool_destroy(decoder->threadPool);
-#endif
-
-	if(decoder->scratchBufEncodedMap)
-		SPLV_FREE(decoder->scratchBufEncodedMap);
-	if(decoder->scratchBufBrickPositions)
-		SPLV_FREE(decoder->scratchBufBrickPositions);
-
-	if(decoder->fromFile)
-	{
-		fclose(decoder->inFile.file);
-		SPLV_FREE(decoder->inFile.scratchBuf);
-	}
-}
-
-//-------------------------------------------//
-
-static SPLVerror _splv_decoder_create(SPLVdecoder* decoder)
-{
-	//read header + validate:
-	//-----------------
-	SPLVfileHeader header;
-	SPLVerror readHeaderError = _splv_decoder_read(decoder, sizeof(SPLVfileHeader), &header);
-	if(readHeaderError != SPLV_SUCCESS)
+	if(header.width % SPLV_BRICK_SIZE > 0 || header.height % SPLV_BRICK_SIZE > 0 || header.width % SPLV_BRICK_SIZE > 0)
 	{
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("failed to read file header");
-		return readHeaderError;
+		SPLV_LOG_ERROR("invalid SPLV file - dimensions must be a multiple of SPLV_BRICK_SIZE");
+		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	if(header.magicWord != SPLV_MAGIC_WORD)
+	if(header.framerate <= 0.0f)
 	{
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("invalid SPLV file - mismatched magic word");
+		SPLV_LOG_ERROR("invalid SPLV file - framerate must be positive");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	if(header.version != SPLV_VERSION)
+	if(header.frameCount == 0)
 	{
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("invalid SPLV file - mismatched version");
+		SPLV_LOG_ERROR("invalid SPLV file - framecount must be positive");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	if(header.width == 0 || header.height == 0 || header.width == 0)
+	if(header.encodingParams.entropyCoder >= SPLV_ENTROPY_CODER_COUNT)
 	{
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("invalid SPLV file - dimensions must be positive");
+		SPLV_LOG_ERROR("invalid SPLV file - unknown entropy coder");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	if(header.width % SPLV_BRICK_SIZE > 0 || header.height % SPLV_BRICK_SIZE > 0 || header.width % SPLV_BRICK_SIZE > 0)
+	if(header.encodingParams.geometryCoder >= SPLV_GEOMETRY_CODER_COUNT)
 	{
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("invalid SPLV file - dimensions must be a multiple of SPLV_BRICK_SIZE");
+		SPLV_LOG_ERROR("invalid SPLV file - unknown geometry coder");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	if(header.framerate <= 0.0f)
+	if(header.encodingParams.voxelOrder >= SPLV_VOXEL_ORDER_COUNT)
 	{
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("invalid SPLV file - framerate must be positive");
+		SPLV_LOG_ERROR("invalid SPLV file - unknown voxel order");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	if(header.frameCount == 0)
+	if(header.encodingParams.brickOrder >= SPLV_BRICK_ORDER_COUNT)
 	{
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("invalid SPLV file - framecount must be positive");
+		SPLV_LOG_ERROR("invalid SPLV file - unknown brick order");
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
@@ -613,6 +468,7 @@ static SPLVerror _splv_decoder_create(SPLVdecoder* decoder)
 	decoder->frameCount     = header.frameCount;
 	decoder->duration       = header.duration;
 	decoder->encodingParams = header.encodingParams;
+	decoder->frameTablePtr  = header.frameTablePtr;
 
 	//read frame pointers:
 	//-----------------
@@ -656,9 +512,38 @@ static SPLVerror _splv_decoder_create(SPLVdecoder* decoder)
 
 	decoder->encodedMapLen = encodedMapLen;
 
+	decoder->numTiles = splv_frame_get_num_tiles(mapWidth, mapHeight, mapDepth, decoder->encodingParams.tileSize);
+	decoder->brickOrder = (uint32_t*)SPLV_MALLOC(mapLen * sizeof(uint32_t));
+	decoder->tileStarts = (uint32_t*)SPLV_MALLOC((decoder->numTiles + 1) * sizeof(uint32_t));
+	if(!decoder->brickOrder || !decoder->tileStarts)
+	{
+		splv_decoder_destroy(decoder);
+
+		SPLV_LOG_ERROR("failed to allocate decoder brick order");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	splv_frame_get_brick_order(
+		mapWidth, mapHeight, mapDepth, (SPLVbrickOrder)decoder->encodingParams.brickOrder, decoder->encodingParams.tileSize, 
+		decoder->brickOrder, decoder->tileStarts
+	);
+
+	//brick groups never span tiles, so each tile is split into groups separately
+	uint32_t maxBrickGroups = 0;
+	for(uint32_t i = 0; i < decoder->numTiles; i++)
+	{
+		uint32_t tileLen = decoder->tileStarts[i + 1] - decoder->tileStarts[i];
+		if(decoder->encodingParams.maxBrickGroupSize == 0)
+			maxBrickGroups += 1;
+		else
+			maxBrickGroups += (tileLen + decoder->encodingParams.maxBrickGroupSize - 1) / decoder->encodingParams.maxBrickGroupSize;
+	}
+
 	decoder->scratchBufEncodedMap = (uint32_t*)SPLV_MALLOC(encodedMapLen * sizeof(uint32_t));
+	decoder->scratchBufSkipBitmap = (uint32_t*)SPLV_MALLOC(encodedMapLen * sizeof(uint32_t));
 	decoder->scratchBufBrickPositions = (SPLVcoordinate*)SPLV_MALLOC(mapLen * sizeof(SPLVcoordinate));
-	if(!decoder->scratchBufEncodedMap || !decoder->scratchBufBrickPositions)
+	decoder->scratchBufBrickGroupInfos = (SPLVbrickGroupDecodeInfo*)SPLV_MALLOC(maxBrickGroups * sizeof(SPLVbrickGroupDecodeInfo));
+	if(!decoder->scratchBufEncodedMap || !decoder->scratchBufSkipBitmap || !decoder->scratchBufBrickPositions || !decoder->scratchBufBrickGroupInfos)
 	{
 		splv_decoder_destroy(decoder);
 
@@ -666,22 +551,66 @@ static SPLVerror _splv_decoder_create(SPLVdecoder* decoder)
 		return SPLV_ERROR_OUT_OF_MEMORY;
 	}
 
+	//decompressed buffers start empty and grow to fit their group, after the first few frames decoding no longer allocates
+	uint32_t numDecompressedBufs = maxBrickGroups * SPLV_BRICK_STREAM_COUNT;
+	decoder->scratchBufDecompressed = (SPLVbufferWriter*)SPLV_MALLOC(numDecompressedBufs * sizeof(SPLVbufferWriter));
+	if(!decoder->scratchBufDecompressed)
+	{
+		splv_decoder_destroy(decoder);
+
+		SPLV_LOG_ERROR("failed to allocate decoder decompression buffers");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	memset(decoder->scratchBufDecompressed, 0, numDecompressedBufs * sizeof(SPLVbufferWriter));
+	decoder->maxBrickGroups = maxBrickGroups;
+
+	for(uint32_t i = 0; i < numDecompressedBufs; i++)
+	{
+		SPLVerror writerError = splv_buffer_writer_create(&decoder->scratchBufDecompressed[i], 0);
+		if(writerError != SPLV_SUCCESS)
+		{
+			splv_decoder_destroy(decoder);
+
+			SPLV_LOG_ERROR("failed to create decoder decompression buffer");
+			return writerError;
+		}
+	}
+
 	//initialize thread pool:
 	//-----------------
 #ifdef SPLV_DECODER_MULTITHREADING
-	SPLVerror threadPoolError = splv_thread_pool_create(
-		&decoder->threadPool, SPLV_DECODER_THREAD_POOL_SIZE, 
-		_splv_decoder_decode_brick_group, sizeof(SPLVbrickGroupDecodeInfo)
+	if(options.threadPool)
+		decoder->threadPool = options.threadPool;
+	else
+	{
+		SPLVerror threadPoolError = splv_thread_pool_create(
+			&decoder->threadPool, options.numThreads, options.pinThreads, options.firstCpu
+		);
+		if(threadPoolError != SPLV_SUCCESS)
+		{
+			decoder->threadPool = NULL;
+			splv_decoder_destroy(decoder);
+
+			SPLV_LOG_ERROR("failed to create decoder thread pool");
+			return threadPoolError;
+		}
+
+		decoder->ownsThreadPool = 1;
+	}
+
+	SPLVerror threadPoolGroupError = splv_thread_pool_group_create(
+		&decoder->threadPoolGroup, decoder->threadPool, _splv_decoder_decode_brick_group
 	);
-	if(threadPoolError != SPLV_SUCCESS)
+	if(threadPoolGroupError != SPLV_SUCCESS)
 	{
-		decoder->threadPool = NULL;
-		SPLV_FREE(decoder->threadPool);
 		splv_decoder_destroy(decoder);
 
-		SPLV_LOG_ERROR("failed to create decoder thread pool");
-		return threadPoolError;
+		SPLV_LOG_ERROR("failed to create decoder thread pool group");
+		return threadPoolGroupError;
 	}
+#else
+	(void)options;
 #endif
 
 	//return:
@@ -691,87 +620,911 @@ static SPLVerror _splv_decoder_create(SPLVdecoder* decoder)
 
 //-------------------------------------------//
 
-static SPLVerror _splv_decoder_decode_brick_group(void* arg)
+static SPLVerror _splv_decoder_decode_frame(SPLVdecoder* decoder, uint64_t idx, uint64_t numDependencies, SPLVframeIndexed* dependencies, SPLVframeCompactIndexed* dependenciesCompact,
+                                            SPLVboundingBox region, SPLVframe* frame, SPLVframeCompact* compactFrame, splv_bool_t reuse)
 {
-	//get info:
+	//validate:
 	//-----------------
-	SPLVbrickGroupDecodeInfo* info = (SPLVbrickGroupDecodeInfo*)arg;
+	SPLV_ASSERT(idx < decoder->frameCount, "out of bounds frame index");
 
-	//create decompressed buffer writer:
+	//frame is NULL when decoding straight to a compact frame, from compact dependencies
+	SPLV_ASSERT(frame != NULL || compactFrame != NULL, "must decode to at least one frame");
+
+	//get frame pointer:
 	//-----------------
-	SPLVbufferWriter decompressedWriter;
-	SPLVerror writerError = splv_buffer_writer_create(&decompressedWriter, 0);
-	if(writerError != SPLV_SUCCESS)
-		return writerError;
+	uint64_t frameTableEntry = decoder->frameTable[idx];
+	SPLVframeEncodingType encodingType = (SPLVframeEncodingType)(frameTableEntry >> 56);
+	uint64_t framePtr = frameTableEntry & 0x00FFFFFFFFFFFFFF;
 
-	//decompress:
+	//read compressed frame data:
 	//-----------------
-	SPLVerror decodeError = splv_rc_decode(info->compressedBufLen, info->compressedBuf, &decompressedWriter);
-	if(decodeError != SPLV_SUCCESS)
+	uint8_t* compressedFrame;
+	uint64_t compressedFrameLen;
+	if(decoder->fromFile)
 	{
-		splv_buffer_writer_destroy(&decompressedWriter);
-
-		SPLV_LOG_ERROR("error decompressing frame");
-		return decodeError;
+		if(decoder->prefetching)
+		{
+			SPLV_ERROR_PROPAGATE(_splv_decoder_prefetch_acquire(decoder, idx, &compressedFrame, &compressedFrameLen));
+		}
+		else
+		{
+			SPLV_ERROR_PROPAGATE(_splv_decoder_read_frame(
+				decoder, decoder->inFile.file, idx, &decoder->inFile.scratchBuf, &decoder->inFile.scrathBufLen, &compressedFrameLen
+			));
+			compressedFrame = decoder->inFile.scratchBuf;
+		}
 	}
-
-	SPLVbufferReader decompressedReader;
-	SPLVerror readerError = splv_buffer_reader_create(&decompressedReader, decompressedWriter.buf, decompressedWriter.writePos);
-	if(readerError != SPLV_SUCCESS)
+	else
 	{
-		splv_buffer_writer_destroy(&decompressedWriter);
+		SPLV_ERROR_PROPAGATE(_splv_decoder_seek(decoder, framePtr));
+		compressedFrame = decoder->inBuf.buf + decoder->inBuf.readPos;
+		compressedFrameLen = decoder->inBuf.len - decoder->inBuf.readPos;
 
-		SPLV_LOG_ERROR("failed to create decompressed frame reader");
-		return readerError;
+		if(decoder->fileMapping)
+			_splv_decoder_read_ahead(decoder, idx);
 	}
 
-	//read each brick:
-	//-----------------	
-	uint64_t voxelsWritten = 0;
+	//ensure dependencies are present:
+	//-----------------
+	SPLVframe* lastFrame = NULL;
+	SPLVframeCompact* lastFrameCompact = NULL;
+	uint8_t foundDependencies = 0;
 
-	for(uint32_t i = 0; i < info->numBricks; i++)
+	if(encodingType == SPLV_FRAME_ENCODING_TYPE_I)
+		foundDependencies = 1;
+	else if(encodingType == SPLV_FRAME_ENCODING_TYPE_P)
 	{
-		uint32_t idx = info->brickStartIdx + i;
-
-		uint32_t numVoxelsBrick;
-		SPLVerror brickDecodeError = splv_brick_decode(
-			&decompressedReader,
-			&info->outFrame->bricks[idx],
-			info->outFrameCompact ? 
-				&info->outFrameCompact->voxels[info->voxelsStartIdx + voxelsWritten] : NULL,
-			info->numVoxels - voxelsWritten,
-			info->decoder->scratchBufBrickPositions[idx].x, 
-			info->decoder->scratchBufBrickPositions[idx].y,
-			info->decoder->scratchBufBrickPositions[idx].z,
-			info->lastFrame,
-			&numVoxelsBrick
-		);
-
-		if(info->outFrameCompact)
+		if(idx == 0)
 		{
-			SPLVbrick* brick = &info->outFrame->bricks[idx];
-			SPLVbrickCompact* brickCompact = &info->outFrameCompact->bricks[idx];
-			
-			memcpy(brickCompact->bitmap, brick->bitmap, sizeof(brick->bitmap));
-			brickCompact->voxelsOffset = (uint32_t)(info->voxelsStartIdx + voxelsWritten);
+			SPLV_LOG_ERROR("invalid SPLV file - first frame cannot be a p-frame");
+			return SPLV_ERROR_INVALID_INPUT;
 		}
 
-		if(brickDecodeError != SPLV_SUCCESS)
+		for(uint32_t i = 0; i < numDependencies; i++)
 		{
-			splv_buffer_writer_destroy(&decompressedWriter);
+			uint64_t depIdx = dependenciesCompact ? dependenciesCompact[i].index : dependencies[i].index;
+			if(depIdx == idx - 1)
+			{
+				if(dependenciesCompact)
+					lastFrameCompact = dependenciesCompact[i].frame;
+				else
+					lastFrame = dependencies[i].frame;
 
-			SPLV_LOG_ERROR("error while decoding brick");
-			return brickDecodeError;
+				foundDependencies = 1;
+				break;
+			}
 		}
+	}
+	else
+	{
+		SPLV_LOG_ERROR("invalid SPLV file - unknown frame encoding type");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
 
-		voxelsWritten += numVoxelsBrick;
+	//TODO change to an assert
+	if(!foundDependencies)
+	{
+		SPLV_LOG_ERROR("neccesary dependencies were not supplied for decoding frame");
+		return SPLV_ERROR_RUNTIME;
 	}
 
-	//cleanup + return:
-	//-----------------	
-	splv_buffer_writer_destroy(&decompressedWriter);
+	SPLV_ASSERT((lastFrame == NULL || lastFrame != frame) && (lastFrameCompact == NULL || lastFrameCompact != compactFrame), 
+		"cannot decode into a frame's own dependency");
 
-	return SPLV_SUCCESS;
+	//create compressed reader, read num bricks:
+	//-----------------
+	SPLVbufferReader compressedReader;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_create(&compressedReader, compressedFrame, compressedFrameLen));
+
+	uint32_t numBricks;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&compressedReader, sizeof(uint32_t), &numBricks));
+
+	uint64_t numVoxels;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &numVoxels));
+
+	if(compactFrame && numVoxels > UINT32_MAX)
+	{
+		SPLV_LOG_ERROR("too many voxels to fit in SPLVframeCompact, more than UINT32_MAX");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	//read compressed map:
+	//-----------------	
+	SPLVerror readMapError = splv_buffer_reader_read(
+		&compressedReader, 
+		decoder->encodedMapLen * sizeof(uint32_t), decoder->scratchBufEncodedMap
+	);
+	if(readMapError != SPLV_SUCCESS)
+	{
+		SPLV_LOG_ERROR("failed to read encoded map from decompressed stream");
+		return readMapError;
+	}
+
+	//find brick positions, split each tile into brick groups:
+	//-----------------
+	uint32_t mapWidth  = decoder->width  / SPLV_BRICK_SIZE;
+	uint32_t mapHeight = decoder->height / SPLV_BRICK_SIZE;
+	uint32_t mapDepth  = decoder->depth  / SPLV_BRICK_SIZE;
+
+	uint32_t curBrickIdx = 0;
+	uint32_t numBrickGroups = 0;
+	uint32_t numBricksDecoded = 0;
+
+	for(uint32_t tile = 0; tile < decoder->numTiles; tile++)
+	{
+		uint32_t tileStartBrick = curBrickIdx;
+
+		for(uint32_t i = decoder->tileStarts[tile]; i < decoder->tileStarts[tile + 1]; i++)
+		{
+			uint32_t idx = decoder->brickOrder[i];
+			uint32_t idxArr = idx / 32;
+			uint32_t idxBit = idx % 32;
+
+			if((decoder->scratchBufEncodedMap[idxArr] & (1u << idxBit)) != 0)
+			{
+				uint32_t x = idx % mapWidth;
+				uint32_t y = (idx / mapWidth) % mapHeight;
+				uint32_t z = idx / (mapWidth * mapHeight);
+
+				decoder->scratchBufBrickPositions[curBrickIdx++] = (SPLVcoordinate){ x, y, z };
+			}
+		}
+
+		uint32_t tileNumBricks = curBrickIdx - tileStartBrick;
+		if(tileNumBricks == 0)
+			continue;
+
+		splv_bool_t decodeTile = _splv_decoder_tile_intersects(decoder, decoder->scratchBufBrickPositions[tileStartBrick], region);
+
+		uint32_t maxBrickGroupSize;
+		if(decoder->encodingParams.maxBrickGroupSize == 0)
+			maxBrickGroupSize = tileNumBricks;
+		else
+			maxBrickGroupSize = decoder->encodingParams.maxBrickGroupSize;
+
+		uint32_t tileNumBrickGroups = (tileNumBricks + maxBrickGroupSize - 1) / maxBrickGroupSize;
+		uint32_t baseBrickGroupSize      = tileNumBricks / tileNumBrickGroups;
+		uint32_t brickGroupSizeRemainder = tileNumBricks % tileNumBrickGroups;
+
+		for(uint32_t i = 0; i < tileNumBrickGroups; i++)
+		{
+			SPLVbrickGroupDecodeInfo* decodeInfo = &decoder->scratchBufBrickGroupInfos[numBrickGroups++];
+			decodeInfo->brickStartIdx = tileStartBrick + i * baseBrickGroupSize + min(i, brickGroupSizeRemainder);
+			decodeInfo->numBricks = baseBrickGroupSize + (i < brickGroupSizeRemainder ? 1 : 0);
+
+			if(decodeTile)
+			{
+				decodeInfo->outBrickStartIdx = numBricksDecoded;
+				numBricksDecoded += decodeInfo->numBricks;
+			}
+			else
+				decodeInfo->outBrickStartIdx = SPLV_BRICK_IDX_EMPTY;
+		}
+	}
+
+	//sanity check
+	if(curBrickIdx != numBricks)
+	{
+		SPLV_LOG_ERROR("invalid SPLV file - given number of bricks did not match contents of map");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	//read skip bitmap:
+	//-----------------
+	uint32_t* skipBitmap = NULL;
+	if(encodingType == SPLV_FRAME_ENCODING_TYPE_P && numBricks > 0)
+	{
+		SPLVerror readSkipBitmapError = splv_buffer_reader_read(
+			&compressedReader,
+			((numBricks + 31) / 32) * sizeof(uint32_t), decoder->scratchBufSkipBitmap
+		);
+		if(readSkipBitmapError != SPLV_SUCCESS)
+		{
+			SPLV_LOG_ERROR("failed to read skip bitmap from decompressed stream");
+			return readSkipBitmapError;
+		}
+
+		skipBitmap = decoder->scratchBufSkipBitmap;
+	}
+
+	//read brick group offsets + voxel counts:
+	//-----------------
+	uint64_t groupTableLen = (uint64_t)numBrickGroups * (2 * sizeof(uint64_t));
+	if(groupTableLen > compressedReader.len - compressedReader.readPos)
+	{
+		SPLV_LOG_ERROR("invalid SPLV file - brick group table extends past end of frame");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	uint8_t* brickGroupsStart = compressedReader.buf + compressedReader.readPos + groupTableLen;
+	uint64_t brickGroupsLen   = compressedReader.len - compressedReader.readPos - groupTableLen;
+
+	uint64_t sumVoxelsGroup = 0;
+	uint64_t numVoxelsDecoded = 0;
+
+	for(uint32_t i = 0; i < numBrickGroups; i++)
+	{
+		//the table's length was validated above, these reads can't fail
+		uint64_t offset;
+		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &offset));
+
+		uint64_t numVoxelsGroup;
+		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &numVoxelsGroup));
+
+		if(offset > brickGroupsLen || numVoxelsGroup > numVoxels)
+		{
+			SPLV_LOG_ERROR("invalid SPLV file - brick group offset or voxel count out of range");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+
+		SPLVbrickGroupDecodeInfo* decodeInfo = &decoder->scratchBufBrickGroupInfos[i];
+		decodeInfo->compressedBufLen = brickGroupsLen - offset;
+		decodeInfo->compressedBuf = brickGroupsStart + offset;
+		decodeInfo->numVoxels = numVoxelsGroup;
+
+		if(decodeInfo->outBrickStartIdx != SPLV_BRICK_IDX_EMPTY)
+		{
+			decodeInfo->voxelsStartIdx = numVoxelsDecoded;
+			numVoxelsDecoded += numVoxelsGroup;
+		}
+
+		sumVoxelsGroup += numVoxelsGroup;
+	}
+
+	if(sumVoxelsGroup != numVoxels)
+	{
+		SPLV_LOG_ERROR("sum of group voxel counts did not match given given voxel count");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	//create frame, holding only the bricks being decoded:
+	//-----------------
+	if(frame == NULL)
+	{
+		//only decoding to compactFrame
+	}
+	else if(reuse)
+	{
+		SPLV_ERROR_PROPAGATE(splv_frame_recreate(
+			frame,
+			mapWidth,
+			mapHeight,
+			mapDepth,
+			numBricksDecoded
+		));
+	}
+	else
+	{
+		SPLV_ERROR_PROPAGATE(splv_frame_create(
+			frame,
+			mapWidth,
+			mapHeight,
+			mapDepth,
+			numBricksDecoded
+		));
+	}
+
+	if(compactFrame)
+	{
+		SPLVerror compactFrameError;
+		if(reuse)
+			compactFrameError = splv_frame_compact_recreate(compactFrame, mapWidth, mapHeight, mapDepth, numBricksDecoded, numVoxelsDecoded);
+		else
+			compactFrameError = splv_frame_compact_create(compactFrame, mapWidth, mapHeight, mapDepth, numBricksDecoded, numVoxelsDecoded);
+
+		if(compactFrameError != SPLV_SUCCESS)
+		{
+			if(!reuse && frame)
+				splv_frame_destroy(frame);
+
+			return compactFrameError;
+		}
+	}
+
+	uint32_t mapLen = mapWidth * mapHeight * mapDepth;
+	for(uint32_t i = 0; i < mapLen; i++)
+	{
+		if(frame)
+			frame->map[i] = SPLV_BRICK_IDX_EMPTY;
+		if(compactFrame)
+			compactFrame->map[i] = SPLV_BRICK_IDX_EMPTY;
+	}
+
+	//gather the groups being decoded at the front, fill in their part of the map:
+	//-----------------
+	uint32_t numBrickGroupsDecoded = 0;
+	for(uint32_t i = 0; i < numBrickGroups; i++)
+	{
+		if(decoder->scratchBufBrickGroupInfos[i].outBrickStartIdx == SPLV_BRICK_IDX_EMPTY)
+			continue;
+
+		SPLVbrickGroupDecodeInfo* decodeInfo = &decoder->scratchBufBrickGroupInfos[numBrickGroupsDecoded];
+		*decodeInfo = decoder->scratchBufBrickGroupInfos[i];
+		decodeInfo->decoder = decoder;
+		decodeInfo->outFrame = frame;
+		decodeInfo->outFrameCompact = compactFrame;
+		decodeInfo->lastFrame = lastFrame;
+		decodeInfo->lastFrameCompact = lastFrameCompact;
+		decodeInfo->skipBitmap = skipBitmap;
+		decodeInfo->decompressedBufs = &decoder->scratchBufDecompressed[numBrickGroupsDecoded * SPLV_BRICK_STREAM_COUNT];
+
+		for(uint32_t j = 0; j < decodeInfo->numBricks; j++)
+		{
+			SPLVcoordinate pos = decoder->scratchBufBrickPositions[decodeInfo->brickStartIdx + j];
+			uint32_t mapIdx = pos.x + mapWidth * (pos.y + mapHeight * pos.z);
+
+			if(frame)
+				frame->map[mapIdx] = decodeInfo->outBrickStartIdx + j;
+			if(compactFrame)
+				compactFrame->map[mapIdx] = decodeInfo->outBrickStartIdx + j;
+		}
+
+		numBrickGroupsDecoded++;
+	}
+
+	//decode each brick group:
+	//-----------------
+
+	//the voxel counts were validated above, so a group can't write outside of the compact frame's voxel array
+#ifdef SPLV_DECODER_MULTITHREADING
+	SPLVerror addWorkError = splv_thread_pool_add_work_batch(
+		&decoder->threadPoolGroup, decoder->scratchBufBrickGroupInfos, numBrickGroupsDecoded, sizeof(SPLVbrickGroupDecodeInfo)
+	);
+	SPLVerror decodeError = splv_thread_pool_wait(&decoder->threadPoolGroup);
+	if(addWorkError != SPLV_SUCCESS)
+		decodeError = addWorkError;
+#else
+	SPLVerror decodeError = SPLV_SUCCESS;
+	for(uint32_t i = 0; i < numBrickGroupsDecoded && decodeError == SPLV_SUCCESS; i++)
+		decodeError = _splv_decoder_decode_brick_group(&decoder->scratchBufBrickGroupInfos[i]);
+#endif
+
+	if(decodeError != SPLV_SUCCESS)
+	{
+		//reused frames are still owned by the caller
+		if(!reuse)
+		{
+			if(frame)
+				splv_frame_destroy(frame);
+			if(compactFrame)
+				splv_frame_compact_destroy(compactFrame);
+		}
+
+		SPLV_LOG_ERROR("failed to decode brick groups");
+		return decodeError;
+	}
+
+	//return:
+	//-----------------
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_decoder_decode_brick_group(void* arg)
+{
+	//get info:
+	//-----------------
+	SPLVbrickGroupDecodeInfo* info = (SPLVbrickGroupDecodeInfo*)arg;
+
+	//read stream lengths:
+	//-----------------
+	uint64_t streamLens[SPLV_BRICK_STREAM_COUNT];
+	if(info->compressedBufLen < sizeof(streamLens))
+	{
+		SPLV_LOG_ERROR("brick group too small to hold stream lengths, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	memcpy(streamLens, info->compressedBuf, sizeof(streamLens));
+
+	//decompress each stream:
+	//-----------------
+	uint8_t* streamBuf = info->compressedBuf + sizeof(streamLens);
+	uint64_t streamBufLen = info->compressedBufLen - sizeof(streamLens);
+
+	splv_bool_t contextGeometry = info->decoder->encodingParams.geometryCoder == SPLV_GEOMETRY_CODER_CONTEXT;
+	SPLVoccupancyDecoder occupancyDecoder;
+
+	SPLVbufferReader decompressedReaders[SPLV_BRICK_STREAM_COUNT];
+	for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT; i++)
+	{
+		if(streamLens[i] > streamBufLen)
+		{
+			SPLV_LOG_ERROR("brick group stream extends past end of buffer, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+
+		SPLVbufferWriter* decompressedWriter = &info->decompressedBufs[i];
+		splv_buffer_writer_reset(decompressedWriter);
+
+		SPLVerror decodeError = SPLV_SUCCESS;
+		if(i == SPLV_BRICK_STREAM_GEOMETRY && contextGeometry)
+		{
+			//the occupancy coder's output is decoded in place, as each brick is decoded
+			splv_occupancy_decoder_init(&occupancyDecoder, streamLens[i], streamBuf);
+		}
+		else if(streamLens[i] > 0) //empty streams are stored with no data
+		{
+			if(info->decoder->encodingParams.entropyCoder == SPLV_ENTROPY_CODER_RANS)
+				decodeError = splv_rans_decode(streamLens[i], streamBuf, decompressedWriter);
+			else
+				decodeError = splv_rc_decode(streamLens[i], streamBuf, decompressedWriter);
+		}
+
+		if(decodeError != SPLV_SUCCESS)
+		{
+			SPLV_LOG_ERROR("error decompressing frame");
+			return decodeError;
+		}
+
+		SPLVerror readerError = splv_buffer_reader_create(&decompressedReaders[i], decompressedWriter->buf, decompressedWriter->writePos);
+		if(readerError != SPLV_SUCCESS)
+		{
+			SPLV_LOG_ERROR("failed to create decompressed frame reader");
+			return readerError;
+		}
+
+		streamBuf += streamLens[i];
+		streamBufLen -= streamLens[i];
+	}
+
+	//read each brick:
+	//-----------------	
+	uint64_t voxelsWritten = 0;
+
+	//bricks are decoded to scratch when only writing to outFrameCompact
+	SPLVbrick scratchBrick;
+
+	for(uint32_t i = 0; i < info->numBricks; i++)
+	{
+		uint32_t idx = info->brickStartIdx + i;
+		uint32_t outIdx = info->outBrickStartIdx + i;
+		SPLVbrick* brick = info->outFrame ? &info->outFrame->bricks[outIdx] : &scratchBrick;
+
+		uint32_t numVoxelsBrick;
+		SPLVerror brickDecodeError;
+
+		if(info->skipBitmap && (info->skipBitmap[idx / 32] & (1u << (idx % 32))) != 0 && info->lastFrameCompact)
+		{
+			brickDecodeError = splv_brick_decode_skipped_from_compact(
+				brick,
+				info->outFrameCompact ? 
+					&info->outFrameCompact->voxels[info->voxelsStartIdx + voxelsWritten] : NULL,
+				info->numVoxels - voxelsWritten,
+				info->decoder->scratchBufBrickPositions[idx].x, 
+				info->decoder->scratchBufBrickPositions[idx].y,
+				info->decoder->scratchBufBrickPositions[idx].z,
+				info->lastFrameCompact,
+				&numVoxelsBrick
+			);
+		}
+		else if(info->skipBitmap && (info->skipBitmap[idx / 32] & (1u << (idx % 32))) != 0)
+		{
+			brickDecodeError = splv_brick_decode_skipped(
+				brick,
+				info->outFrameCompact ? 
+					&info->outFrameCompact->voxels[info->voxelsStartIdx + voxelsWritten] : NULL,
+				info->numVoxels - voxelsWritten,
+				info->decoder->scratchBufBrickPositions[idx].x, 
+				info->decoder->scratchBufBrickPositions[idx].y,
+				info->decoder->scratchBufBrickPositions[idx].z,
+				info->lastFrame,
+				&numVoxelsBrick
+			);
+		}
+		else if(info->lastFrameCompact)
+		{
+			brickDecodeError = splv_brick_decode_from_compact(
+				decompressedReaders,
+				contextGeometry ? &occupancyDecoder : NULL,
+				(SPLVvoxelOrder)info->decoder->encodingParams.voxelOrder,
+				brick,
+				info->outFrameCompact ? 
+					&info->outFrameCompact->voxels[info->voxelsStartIdx + voxelsWritten] : NULL,
+				info->numVoxels - voxelsWritten,
+				info->decoder->scratchBufBrickPositions[idx].x, 
+				info->decoder->scratchBufBrickPositions[idx].y,
+				info->decoder->scratchBufBrickPositions[idx].z,
+				info->lastFrameCompact,
+				&numVoxelsBrick
+			);
+		}
+		else
+		{
+			brickDecodeError = splv_brick_decode(
+				decompressedReaders,
+				contextGeometry ? &occupancyDecoder : NULL,
+				(SPLVvoxelOrder)info->decoder->encodingParams.voxelOrder,
+				brick,
+				info->outFrameCompact ? 
+					&info->outFrameCompact->voxels[info->voxelsStartIdx + voxelsWritten] : NULL,
+				info->numVoxels - voxelsWritten,
+				info->decoder->scratchBufBrickPositions[idx].x, 
+				info->decoder->scratchBufBrickPositions[idx].y,
+				info->decoder->scratchBufBrickPositions[idx].z,
+				info->lastFrame,
+				&numVoxelsBrick
+			);
+		}
+
+		if(info->outFrameCompact)
+		{
+			SPLVbrickCompact* brickCompact = &info->outFrameCompact->bricks[outIdx];
+			
+			memcpy(brickCompact->bitmap, brick->bitmap, sizeof(brick->bitmap));
+			brickCompact->voxelsOffset = (uint32_t)(info->voxelsStartIdx + voxelsWritten);
+		}
+
+		if(brickDecodeError != SPLV_SUCCESS)
+		{
+			SPLV_LOG_ERROR("error while decoding brick");
+			return brickDecodeError;
+		}
+
+		voxelsWritten += numVoxelsBrick;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+static splv_bool_t _splv_decoder_tile_intersects(SPLVdecoder* decoder, SPLVcoordinate brickPos, SPLVboundingBox region)
+{
+	//find the bounds of the tile containing the brick, in voxels. An untiled file is a single tile covering the whole volume:
+	//-----------------
+	SPLVboundingBox tile = { 0, 0, 0, (int32_t)decoder->width - 1, (int32_t)decoder->height - 1, (int32_t)decoder->depth - 1 };
+
+	uint32_t tileSize = decoder->encodingParams.tileSize;
+	if(tileSize > 0)
+	{
+		int32_t tileSizeVoxels = (int32_t)(tileSize * SPLV_BRICK_SIZE);
+
+		tile.xMin = (int32_t)(brickPos.x / tileSize) * tileSizeVoxels;
+		tile.yMin = (int32_t)(brickPos.y / tileSize) * tileSizeVoxels;
+		tile.zMin = (int32_t)(brickPos.z / tileSize) * tileSizeVoxels;
+		tile.xMax = min(tile.xMax, tile.xMin + tileSizeVoxels - 1);
+		tile.yMax = min(tile.yMax, tile.yMin + tileSizeVoxels - 1);
+		tile.zMax = min(tile.zMax, tile.zMin + tileSizeVoxels - 1);
+	}
+
+	//test for overlap:
+	//-----------------
+	return region.xMin <= tile.xMax && region.xMax >= tile.xMin &&
+	       region.yMin <= tile.yMax && region.yMax >= tile.yMin &&
+	       region.zMin <= tile.zMax && region.zMax >= tile.zMin;
+}
+
+static void _splv_decoder_read_ahead(SPLVdecoder* decoder, uint64_t idx)
+{
+#ifdef SPLV_DECODER_MMAP
+	//get range spanning the frame being decoded + the next readAheadFrames:
+	//-----------------
+	uint64_t lastIdx = min(idx + decoder->readAheadFrames, (uint64_t)decoder->frameCount - 1);
+
+	uint64_t start = decoder->frameTable[idx] & 0x00FFFFFFFFFFFFFF;
+	uint64_t lastPtr, lastLen;
+	if(_splv_decoder_get_frame_range(decoder, lastIdx, &lastPtr, &lastLen) != SPLV_SUCCESS)
+		return;
+
+	uint64_t end = min(lastPtr + lastLen, decoder->fileMappingLen);
+
+	//skip anything already advised, unless we seeked outside of the advised range:
+	//-----------------
+	if(start >= decoder->readAheadStart && start <= decoder->readAheadEnd)
+		start = decoder->readAheadEnd;
+	else
+		decoder->readAheadStart = start;
+
+	if(end <= start)
+		return;
+
+	//advise (start must be page-aligned):
+	//-----------------
+	uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+	uint64_t alignedStart = start - (start % pageSize);
+
+	madvise((uint8_t*)decoder->fileMapping + alignedStart, (size_t)(end - alignedStart), MADV_WILLNEED);
+	decoder->readAheadEnd = end;
+#endif
+}
+
+static SPLVerror _splv_decoder_get_frame_range(SPLVdecoder* decoder, uint64_t idx, uint64_t* framePtr, uint64_t* frameLen)
+{
+	//frames are stored contiguously, the last one is followed by the frame table
+	*framePtr = decoder->frameTable[idx] & 0x00FFFFFFFFFFFFFF;
+
+	uint64_t nextFramePtr;
+	if(idx == decoder->frameCount - 1)
+		nextFramePtr = decoder->frameTablePtr;
+	else
+		nextFramePtr = decoder->frameTable[idx + 1] & 0x00FFFFFFFFFFFFFF;
+
+	if(nextFramePtr < *framePtr)
+	{
+		SPLV_LOG_ERROR("invalid SPLV file - frame pointers out of order");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	*frameLen = nextFramePtr - *framePtr;
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_decoder_read_frame(SPLVdecoder* decoder, FILE* file, uint64_t idx, uint8_t** buf, uint64_t* bufLen, uint64_t* frameLen)
+{
+	//get frame range:
+	//-----------------
+	uint64_t framePtr;
+	SPLV_ERROR_PROPAGATE(_splv_decoder_get_frame_range(decoder, idx, &framePtr, frameLen));
+
+	//potentially resize buffer:
+	//-----------------
+	if(*frameLen > *bufLen)
+	{
+		uint64_t newBufLen = *bufLen;
+		while(*frameLen > newBufLen)
+			newBufLen *= 2;
+
+		uint8_t* newBuf = (uint8_t*)SPLV_REALLOC(*buf, newBufLen);
+		if(!newBuf)
+		{
+			SPLV_LOG_ERROR("failed to realloc decoder file scratch buf");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+
+		*buf = newBuf;
+		*bufLen = newBufLen;
+	}
+
+	//read:
+	//-----------------
+	if(fseek(file, (long)framePtr, SEEK_SET) != 0)
+	{
+		SPLV_LOG_ERROR("failed to seek in file");
+		return SPLV_ERROR_FILE_READ;
+	}
+
+	if(*frameLen > 0 && fread(*buf, *frameLen, 1, file) < 1)
+	{
+		SPLV_LOG_ERROR("failed to read from file");
+		return SPLV_ERROR_FILE_READ;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+//-------------------------------------------//
+
+static SPLVerror _splv_decoder_prefetch_start(SPLVdecoder* decoder, const char* path, SPLVdecoderOptions options)
+{
+	//open a second handle to the file, for the prefetch thread:
+	//-----------------
+	decoder->prefetchFile = fopen(path, "rb");
+	if(!decoder->prefetchFile)
+	{
+		SPLV_LOG_ERROR("failed to open input file for prefetching");
+		return SPLV_ERROR_FILE_OPEN;
+	}
+
+	//create slots (1 for the frame being decoded + prefetchFrames ahead of it):
+	//-----------------
+	const uint64_t INITIAL_SLOT_BUF_LEN = 1024;
+
+	decoder->prefetchBudget = options.prefetchBudget > 0 ? options.prefetchBudget : SPLV_DECODER_DEFAULT_PREFETCH_BUDGET;
+	decoder->numPrefetchSlots = options.prefetchFrames + 1;
+	decoder->prefetchSlots = (SPLVdecoderPrefetchSlot*)SPLV_MALLOC(decoder->numPrefetchSlots * sizeof(SPLVdecoderPrefetchSlot));
+	if(!decoder->prefetchSlots)
+	{
+		fclose(decoder->prefetchFile);
+
+		SPLV_LOG_ERROR("failed to allocate prefetch slots");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	memset(decoder->prefetchSlots, 0, decoder->numPrefetchSlots * sizeof(SPLVdecoderPrefetchSlot));
+
+	for(uint32_t i = 0; i < decoder->numPrefetchSlots; i++)
+	{
+		decoder->prefetchSlots[i].bufLen = INITIAL_SLOT_BUF_LEN;
+		decoder->prefetchSlots[i].buf = (uint8_t*)SPLV_MALLOC(INITIAL_SLOT_BUF_LEN);
+		if(!decoder->prefetchSlots[i].buf)
+		{
+			for(uint32_t j = 0; j < i; j++)
+				SPLV_FREE(decoder->prefetchSlots[j].buf);
+			SPLV_FREE(decoder->prefetchSlots);
+			fclose(decoder->prefetchFile);
+
+			SPLV_LOG_ERROR("failed to allocate prefetch slot buffer");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	//initialize state + start thread:
+	//-----------------
+	decoder->prefetchHeadSlot = 0;
+	decoder->prefetchFirstFrame = 0;
+	decoder->prefetchNumReady = 0;
+	decoder->prefetchBytes = 0;
+	decoder->prefetchGeneration = 0;
+	decoder->prefetchShouldExit = 0;
+	decoder->prefetchError = SPLV_SUCCESS;
+
+	SPLVerror mutexError = splv_mutex_init(&decoder->prefetchMutex);
+	if(mutexError != SPLV_SUCCESS)
+	{
+		_splv_decoder_prefetch_free_slots(decoder);
+
+		SPLV_LOG_ERROR("failed to initialize prefetch mutex");
+		return mutexError;
+	}
+
+	SPLVerror condError = splv_condition_variable_init(&decoder->prefetchCond);
+	if(condError != SPLV_SUCCESS)
+	{
+		splv_mutex_destroy(&decoder->prefetchMutex);
+		_splv_decoder_prefetch_free_slots(decoder);
+
+		SPLV_LOG_ERROR("failed to initialize prefetch condition variable");
+		return condError;
+	}
+
+	SPLVerror threadError = splv_thread_create(&decoder->prefetchThread, _splv_decoder_prefetch_thread, decoder);
+	if(threadError != SPLV_SUCCESS)
+	{
+		splv_mutex_destroy(&decoder->prefetchMutex);
+		splv_condition_variable_destroy(&decoder->prefetchCond);
+		_splv_decoder_prefetch_free_slots(decoder);
+
+		SPLV_LOG_ERROR("failed to start prefetch thread");
+		return threadError;
+	}
+
+	decoder->prefetching = 1;
+	return SPLV_SUCCESS;
+}
+
+static void _splv_decoder_prefetch_stop(SPLVdecoder* decoder)
+{
+	splv_mutex_lock(&decoder->prefetchMutex);
+	decoder->prefetchShouldExit = 1;
+	splv_condition_variable_signal_all(&decoder->prefetchCond);
+	splv_mutex_unlock(&decoder->prefetchMutex);
+
+	splv_thread_join(&decoder->prefetchThread, NULL);
+
+	_splv_decoder_prefetch_free_slots(decoder);
+
+	splv_mutex_destroy(&decoder->prefetchMutex);
+	splv_condition_variable_destroy(&decoder->prefetchCond);
+
+	decoder->prefetching = 0;
+}
+
+static void _splv_decoder_prefetch_free_slots(SPLVdecoder* decoder)
+{
+	for(uint32_t i = 0; i < decoder->numPrefetchSlots; i++)
+		SPLV_FREE(decoder->prefetchSlots[i].buf);
+	SPLV_FREE(decoder->prefetchSlots);
+	fclose(decoder->prefetchFile);
+}
+
+static SPLVerror _splv_decoder_prefetch_acquire(SPLVdecoder* decoder, uint64_t idx, uint8_t** frame, uint64_t* frameLen)
+{
+	splv_mutex_lock(&decoder->prefetchMutex);
+
+	//release frames before idx, they will not be needed again in playback order:
+	//-----------------
+	uint8_t released = 0;
+	while(decoder->prefetchNumReady > 0 && decoder->prefetchFirstFrame < idx)
+	{
+		decoder->prefetchBytes -= decoder->prefetchSlots[decoder->prefetchHeadSlot].frameLen;
+		decoder->prefetchHeadSlot = (decoder->prefetchHeadSlot + 1) % decoder->numPrefetchSlots;
+		decoder->prefetchFirstFrame++;
+		decoder->prefetchNumReady--;
+
+		released = 1;
+	}
+
+	if(released)
+		splv_condition_variable_signal_all(&decoder->prefetchCond);
+
+	//wait for the frame if the prefetch thread is about to read it:
+	//-----------------
+	while(decoder->prefetchNumReady == 0 && decoder->prefetchFirstFrame == idx && decoder->prefetchError == SPLV_SUCCESS)
+		splv_condition_variable_wait(&decoder->prefetchCond, &decoder->prefetchMutex);
+
+	if(decoder->prefetchNumReady > 0 && decoder->prefetchFirstFrame == idx)
+	{
+		//ready slots are never written by the prefetch thread, so the buffer is safe to use until the next acquire
+		SPLVdecoderPrefetchSlot* slot = &decoder->prefetchSlots[decoder->prefetchHeadSlot];
+		*frame = slot->buf;
+		*frameLen = slot->frameLen;
+
+		splv_mutex_unlock(&decoder->prefetchMutex);
+		return SPLV_SUCCESS;
+	}
+
+	//otherwise we seeked (or prefetching failed), restart prefetching after idx and read idx ourselves:
+	//-----------------
+	decoder->prefetchGeneration++;
+	decoder->prefetchHeadSlot = 0;
+	decoder->prefetchFirstFrame = idx + 1;
+	decoder->prefetchNumReady = 0;
+	decoder->prefetchBytes = 0;
+	decoder->prefetchError = SPLV_SUCCESS;
+	splv_condition_variable_signal_all(&decoder->prefetchCond);
+
+	splv_mutex_unlock(&decoder->prefetchMutex);
+
+	SPLV_ERROR_PROPAGATE(_splv_decoder_read_frame(
+		decoder, decoder->inFile.file, idx, &decoder->inFile.scratchBuf, &decoder->inFile.scrathBufLen, frameLen
+	));
+	*frame = decoder->inFile.scratchBuf;
+
+	return SPLV_SUCCESS;
+}
+
+static splv_bool_t _splv_decoder_prefetch_can_read(SPLVdecoder* decoder)
+{
+	uint64_t frameIdx = decoder->prefetchFirstFrame + decoder->prefetchNumReady;
+	if(frameIdx >= decoder->frameCount || decoder->prefetchNumReady >= decoder->numPrefetchSlots || 
+	   decoder->prefetchError != SPLV_SUCCESS)
+		return SPLV_FALSE;
+
+	//always read at least 1 frame, even if it exceeds the budget, otherwise it could never be read
+	if(decoder->prefetchNumReady == 0)
+		return SPLV_TRUE;
+
+	uint64_t framePtr, frameLen;
+	if(_splv_decoder_get_frame_range(decoder, frameIdx, &framePtr, &frameLen) != SPLV_SUCCESS)
+		return SPLV_TRUE; //let the read report the error
+
+	return decoder->prefetchBytes + frameLen <= decoder->prefetchBudget;
+}
+
+static void* _splv_decoder_prefetch_thread(void* arg)
+{
+	SPLVdecoder* decoder = (SPLVdecoder*)arg;
+
+	splv_mutex_lock(&decoder->prefetchMutex);
+	while(1)
+	{
+		//wait until there is a frame to read that fits in the ring + budget:
+		//-----------------
+		while(!decoder->prefetchShouldExit && !_splv_decoder_prefetch_can_read(decoder))
+			splv_condition_variable_wait(&decoder->prefetchCond, &decoder->prefetchMutex);
+
+		if(decoder->prefetchShouldExit)
+			break;
+
+		uint64_t frameIdx = decoder->prefetchFirstFrame + decoder->prefetchNumReady;
+		uint32_t slotIdx = (decoder->prefetchHeadSlot + decoder->prefetchNumReady) % decoder->numPrefetchSlots;
+		uint32_t generation = decoder->prefetchGeneration;
+
+		//read frame, without holding the lock. The slot isn't ready so the decoding thread won't touch it:
+		//-----------------
+		splv_mutex_unlock(&decoder->prefetchMutex);
+
+		SPLVdecoderPrefetchSlot* slot = &decoder->prefetchSlots[slotIdx];
+		SPLVerror readError = _splv_decoder_read_frame(decoder, decoder->prefetchFile, frameIdx, &slot->buf, &slot->bufLen, &slot->frameLen);
+
+		splv_mutex_lock(&decoder->prefetchMutex);
+
+		//publish, unless the ring was reset while reading:
+		//-----------------
+		if(generation == decoder->prefetchGeneration)
+		{
+			if(readError == SPLV_SUCCESS)
+			{
+				decoder->prefetchNumReady++;
+				decoder->prefetchBytes += slot->frameLen;
+			}
+			else
+				decoder->prefetchError = readError;
+
+			splv_condition_variable_signal_all(&decoder->prefetchCond);
+		}
+	}
+	splv_mutex_unlock(&decoder->prefetchMutex);
+
+	return NULL;
 }
 
 //-------------------------------------------//
@@ -3,6 +3,7 @@
 #include "spatialstudio/splv_range_coder.h"
 #include "spatialstudio/splv_log.h"
 #include <math.h>
+#include <stddef.h>
 
 //-------------------------------------------//
 
@@ -15,12 +16,30 @@
 
 //-------------------------------------------//
 
-static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder);
+/**
+ * the encoding params of a 0.2.1.0 file, as stored in its header
+ */
+typedef struct SPLVencodingParamsLegacy_0_2_1
+{
+	uint32_t gopSize;
+	uint32_t maxBrickGroupSize;
+} SPLVencodingParamsLegacy_0_2_1;
 
-static SPLVerror _splv_decoder_legacy_thread_pool_create(SPLVdecoderLegacyThreadPool** pool, uint32_t maxBrickGroups);
-static void _splv_decoder_legacy_thread_pool_destroy(SPLVdecoderLegacyThreadPool* pool);
-static void* _splv_decode_legacy_thread_pool_thread_entry(void* pool);
-static SPLVerror _splv_decoder_legacy_decode_brick_group(SPLVbrickGroupDecodeInfoLegacy info);
+/**
+ * the remainder of a 0.2.1.0 file's header, after the fields shared by all versions
+ */
+typedef struct SPLVfileHeaderLegacyTail_0_2_1
+{
+	SPLVencodingParamsLegacy_0_2_1 encodingParams;
+
+	uint64_t frameTablePtr;
+} SPLVfileHeaderLegacyTail_0_2_1;
+
+//-------------------------------------------//
+
+static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder, SPLVthreadPool* threadPool);
+
+static SPLVerror _splv_decoder_legacy_decode_brick_group(void* info);
 
 static inline SPLVerror _splv_decoder_legacy_read(SPLVdecoderLegacy* decoder, uint64_t size, void* dst);
 static inline SPLVerror _splv_decoder_legacy_seek(SPLVdecoderLegacy* decoder, uint64_t pos);
@@ -41,10 +60,15 @@ SPLVerror splv_decoder_legacy_create_from_mem(SPLVdecoderLegacy* decoder, uint64
 
 	//create general decoder:
 	//---------------
-	return _splv_decoder_legacy_create(decoder);
+	return _splv_decoder_legacy_create(decoder, NULL);
 }
 
 SPLVerror splv_decoder_legacy_create_from_file(SPLVdecoderLegacy* decoder, const char* path)
+{
+	return splv_decoder_legacy_create_from_file_with_pool(decoder, path, NULL);
+}
+
+SPLVerror splv_decoder_legacy_create_from_file_with_pool(SPLVdecoderLegacy* decoder, const char* path, SPLVthreadPool* threadPool)
 {
 	//initialize:
 	//---------------
@@ -77,7 +101,7 @@ SPLVerror splv_decoder_legacy_create_from_file(SPLVdecoderLegacy* decoder, const
 
 	//create general decoder:
 	//---------------
-	return _splv_decoder_legacy_create(decoder);
+	return _splv_decoder_legacy_create(decoder, threadPool);
 }
 
 SPLVerror splv_decoder_legacy_get_frame_dependencies(SPLVdecoderLegacy* decoder, uint64_t idx, uint64_t* numDependencies, uint64_t* dependencies, uint8_t recursive)
@@ -324,16 +348,6 @@ SPLVerror splv_decoder_legacy_decode_frame(SPLVdecoderLegacy* decoder, uint64_t
 	uint8_t* brickGroupsStart = compressedReader.buf + compressedReader.readPos + numBrickGroups * (2 * sizeof(uint64_t));
 	uint64_t brickGroupsLen   = compressedReader.len - compressedReader.readPos - numBrickGroups * (2 * sizeof(uint64_t));
 
-	//TODO: error checking for mutex/cond vars? (dont think they can ever fail except for programmer error)
-
-#ifdef SPLV_DECODER_MULTITHREADING
-	splv_mutex_lock(&decoder->threadPool->decodingMutex);
-	decoder->threadPool->numGroupsDecoding = numBrickGroups;
-	splv_mutex_unlock(&decoder->threadPool->decodingMutex);
-
-	splv_mutex_lock(&decoder->threadPool->groupStackMutex);
-#endif
-
 	uint64_t sumVoxelsGroup = 0;
 
 	for(uint32_t i = 0; i < numBrickGroups; i++)
@@ -345,9 +359,6 @@ SPLVerror splv_decoder_legacy_decode_frame(SPLVdecoderLegacy* decoder, uint64_t
 		SPLVerror readOffsetError = splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &offset);
 		if(readOffsetError != SPLV_SUCCESS)
 		{
-		#ifdef SPLV_DECODER_MULTITHREADING
-			splv_mutex_unlock(&decoder->threadPool->groupStackMutex);
-		#endif
 			splv_frame_destroy(frame);
 
 			SPLV_LOG_ERROR("failed to read brick group offset from decompressed stream");
@@ -358,9 +369,6 @@ SPLVerror splv_decoder_legacy_decode_frame(SPLVdecoderLegacy* decoder, uint64_t
 		SPLVerror readNumVoxelsError = splv_buffer_reader_read(&compressedReader, sizeof(uint64_t), &numVoxelsGroup);
 		if(readNumVoxelsError != SPLV_SUCCESS)
 		{
-		#ifdef SPLV_DECODER_MULTITHREADING
-			splv_mutex_unlock(&decoder->threadPool->groupStackMutex);
-		#endif
 			splv_frame_destroy(frame);
 
 			SPLV_LOG_ERROR("failed to read brick group voxel count from decompressed stream");
@@ -370,30 +378,20 @@ SPLVerror splv_decoder_legacy_decode_frame(SPLVdecoderLegacy* decoder, uint64_t
 		uint8_t* groupBuf = brickGroupsStart + offset;
 		uint64_t groupSize = brickGroupsLen - offset;
 
-		SPLVbrickGroupDecodeInfoLegacy decodeInfo;
-		decodeInfo.decoder = decoder;
-		decodeInfo.outFrame = frame;
-		decodeInfo.compressedBufLen = groupSize;
-		decodeInfo.compressedBuf = groupBuf;
-		decodeInfo.brickStartIdx = startBrick;
-		decodeInfo.numBricks = numBricks;
-		decodeInfo.lastFrame = lastFrame;
-
-	#ifdef SPLV_DECODER_MULTITHREADING
-		decoder->threadPool->groupStack[decoder->threadPool->groupStackSize] = decodeInfo;
-		decoder->threadPool->groupStackSize++;
-	#else
-		_splv_decoder_decode_brick_group(decodeInfo);
-	#endif
+		SPLVbrickGroupDecodeInfoLegacy* decodeInfo = &decoder->scratchBufBrickGroupInfos[i];
+		decodeInfo->decoder = decoder;
+		decodeInfo->outFrame = frame;
+		decodeInfo->compressedBufLen = groupSize;
+		decodeInfo->compressedBuf = groupBuf;
+		decodeInfo->brickStartIdx = startBrick;
+		decodeInfo->numBricks = numBricks;
+		decodeInfo->lastFrame = lastFrame;
 
 		sumVoxelsGroup += numVoxelsGroup;
 	}
 
 	if(sumVoxelsGroup != numVoxels)
 	{
-	#ifdef SPLV_DECODER_MULTITHREADING
-		splv_mutex_unlock(&decoder->threadPool->groupStackMutex);
-	#endif
 		splv_frame_destroy(frame);
 
 		SPLV_LOG_ERROR("sum of group voxel counts did not match given given voxel count");
@@ -401,19 +399,25 @@ SPLVerror splv_decoder_legacy_decode_frame(SPLVdecoderLegacy* decoder, uint64_t
 	}
 
 #ifdef SPLV_DECODER_MULTITHREADING
-	splv_condition_variable_signal_all(&decoder->threadPool->groupStackEmptyCond);
-
-	splv_mutex_unlock(&decoder->threadPool->groupStackMutex);
-
-	//wait for all threads to exit:
-	//-----------------
-	splv_mutex_lock(&decoder->threadPool->decodingMutex);
+	SPLVerror addWorkError = splv_thread_pool_add_work_batch(
+		&decoder->threadPoolGroup, decoder->scratchBufBrickGroupInfos, numBrickGroups, sizeof(SPLVbrickGroupDecodeInfoLegacy)
+	);
+	SPLVerror decodeError = splv_thread_pool_wait(&decoder->threadPoolGroup);
+	if(addWorkError != SPLV_SUCCESS)
+		decodeError = addWorkError;
+#else
+	SPLVerror decodeError = SPLV_SUCCESS;
+	for(uint32_t i = 0; i < numBrickGroups && decodeError == SPLV_SUCCESS; i++)
+		decodeError = _splv_decoder_legacy_decode_brick_group(&decoder->scratchBufBrickGroupInfos[i]);
+#endif
 
-	while(decoder->threadPool->numGroupsDecoding > 0)
-		splv_condition_variable_wait(&decoder->threadPool->decodingDoneCond, &decoder->threadPool->decodingMutex);
+	if(decodeError != SPLV_SUCCESS)
+	{
+		splv_frame_destroy(frame);
 
-	splv_mutex_unlock(&decoder->threadPool->decodingMutex);
-#endif
+		SPLV_LOG_ERROR("failed to decode brick groups");
+		return decodeError;
+	}
 
 	//return:
 	//-----------------
@@ -461,13 +465,20 @@ int64_t splv_decoder_legacy_get_next_i_frame_idx(SPLVdecoderLegacy* decoder, uin
 void splv_decoder_legacy_destroy(SPLVdecoderLegacy* decoder)
 {
 #ifdef SPLV_DECODER_MULTITHREADING
-	_splv_decoder_legacy_thread_pool_destroy(decoder->threadPool);
+	splv_thread_pool_group_destroy(&decoder->threadPoolGroup);
+	if(decoder->ownsThreadPool)
+		splv_thread_pool_destroy(decoder->threadPool);
 #endif
 
+	if(decoder->frameTable)
+		SPLV_FREE(decoder->frameTable);
+
 	if(decoder->scratchBufEncodedMap)
 		SPLV_FREE(decoder->scratchBufEncodedMap);
 	if(decoder->scratchBufBrickPositions)
 		SPLV_FREE(decoder->scratchBufBrickPositions);
+	if(decoder->scratchBufBrickGroupInfos)
+		SPLV_FREE(decoder->scratchBufBrickGroupInfos);
 
 	if(decoder->fromFile)
 	{
@@ -478,12 +489,14 @@ void splv_decoder_legacy_destroy(SPLVdecoderLegacy* decoder)
 
 //-------------------------------------------//
 
-static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder)
+static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder, SPLVthreadPool* threadPool)
 {
-	//read header + validate:
+	//read header + validate, the fields up to encodingParams are shared by all legacy versions:
 	//-----------------
 	SPLVfileHeaderLegacy header;
-	SPLVerror readHeaderError = _splv_decoder_legacy_read(decoder, sizeof(SPLVfileHeaderLegacy), &header);
+	uint64_t sharedHeaderSize = offsetof(SPLVfileHeaderLegacy, encodingParams);
+
+	SPLVerror readHeaderError = _splv_decoder_legacy_read(decoder, sharedHeaderSize, &header);
 	if(readHeaderError != SPLV_SUCCESS)
 	{
 		splv_decoder_legacy_destroy(decoder);
@@ -500,7 +513,23 @@ static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder)
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
-	if(header.version != SPLV_MAKE_VERSION(0, 2, 1, 0))
+	if(header.version == SPLV_MAKE_VERSION(0, 3, 0, 0))
+	{
+		readHeaderError = _splv_decoder_legacy_read(
+			decoder, sizeof(SPLVfileHeaderLegacy) - sharedHeaderSize, (uint8_t*)&header + sharedHeaderSize
+		);
+	}
+	else if(header.version == SPLV_MAKE_VERSION(0, 2, 1, 0))
+	{
+		SPLVfileHeaderLegacyTail_0_2_1 tail;
+		readHeaderError = _splv_decoder_legacy_read(decoder, sizeof(SPLVfileHeaderLegacyTail_0_2_1), &tail);
+
+		header.encodingParams.gopSize = tail.encodingParams.gopSize;
+		header.encodingParams.maxBrickGroupSize = tail.encodingParams.maxBrickGroupSize;
+		header.encodingParams.motionVectors = SPLV_FALSE;
+		header.frameTablePtr = tail.frameTablePtr;
+	}
+	else
 	{
 		splv_decoder_legacy_destroy(decoder);
 
@@ -508,6 +537,14 @@ static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder)
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
+	if(readHeaderError != SPLV_SUCCESS)
+	{
+		splv_decoder_legacy_destroy(decoder);
+
+		SPLV_LOG_ERROR("failed to read file header");
+		return readHeaderError;
+	}
+
 	if(header.width == 0 || header.height == 0 || header.width == 0)
 	{
 		splv_decoder_legacy_destroy(decoder);
@@ -557,6 +594,7 @@ static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder)
 	decoder->framerate      = header.framerate;
 	decoder->frameCount     = header.frameCount;
 	decoder->duration       = header.duration;
+	decoder->version        = header.version;
 	decoder->encodingParams = header.encodingParams;
 
 	//read frame pointers:
@@ -601,9 +639,16 @@ static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder)
 
 	decoder->encodedMapLen = encodedMapLen;
 
+	uint32_t maxBrickGroups;
+	if(decoder->encodingParams.maxBrickGroupSize == 0)
+		maxBrickGroups = 1;
+	else
+		maxBrickGroups = (uint32_t)((mapLen + decoder->encodingParams.maxBrickGroupSize - 1) / decoder->encodingParams.maxBrickGroupSize);
+
 	decoder->scratchBufEncodedMap = (uint32_t*)SPLV_MALLOC(encodedMapLen * sizeof(uint32_t));
 	decoder->scratchBufBrickPositions = (SPLVcoordinate*)SPLV_MALLOC(mapLen * sizeof(SPLVcoordinate));
-	if(!decoder->scratchBufEncodedMap || !decoder->scratchBufBrickPositions)
+	decoder->scratchBufBrickGroupInfos = (SPLVbrickGroupDecodeInfoLegacy*)SPLV_MALLOC(maxBrickGroups * sizeof(SPLVbrickGroupDecodeInfoLegacy));
+	if(!decoder->scratchBufEncodedMap || !decoder->scratchBufBrickPositions || !decoder->scratchBufBrickGroupInfos)
 	{
 		splv_decoder_legacy_destroy(decoder);
 
@@ -614,20 +659,32 @@ static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder)
 	//initialize thread pool:
 	//-----------------
 #ifdef SPLV_DECODER_MULTITHREADING
-	uint32_t maxBrickGroups;
-	if(decoder->encodingParams.maxBrickGroupSize == 0)
-		maxBrickGroups = 1;
+	if(threadPool)
+		decoder->threadPool = threadPool;
 	else
-		maxBrickGroups = (uint32_t)((mapLen + decoder->encodingParams.maxBrickGroupSize - 1) / decoder->encodingParams.maxBrickGroupSize);
+	{
+		SPLVerror threadPoolError = splv_thread_pool_create(&decoder->threadPool, 0, 0, 0);
+		if(threadPoolError != SPLV_SUCCESS)
+		{
+			decoder->threadPool = NULL;
+			splv_decoder_legacy_destroy(decoder);
 
-	SPLVerror threadPoolError = _splv_decoder_legacy_thread_pool_create(&decoder->threadPool, maxBrickGroups);
-	if(threadPoolError != SPLV_SUCCESS)
+			SPLV_LOG_ERROR("failed to create decoder thread pool");
+			return threadPoolError;
+		}
+
+		decoder->ownsThreadPool = 1;
+	}
+
+	SPLVerror threadPoolGroupError = splv_thread_pool_group_create(
+		&decoder->threadPoolGroup, decoder->threadPool, _splv_decoder_legacy_decode_brick_group
+	);
+	if(threadPoolGroupError != SPLV_SUCCESS)
 	{
-		decoder->threadPool = NULL;
 		splv_decoder_legacy_destroy(decoder);
 
-		SPLV_LOG_ERROR("failed to create decoder thread pool");
-		return threadPoolError;
+		SPLV_LOG_ERROR("failed to create decoder thread pool group");
+		return threadPoolGroupError;
 	}
 #endif
 
@@ -638,177 +695,13 @@ static SPLVerror _splv_decoder_legacy_create(SPLVdecoderLegacy* decoder)
 
 //-------------------------------------------//
 
-static SPLVerror _splv_decoder_legacy_thread_pool_create(SPLVdecoderLegacyThreadPool** p, uint32_t maxBrickGroups)
+static SPLVerror _splv_decoder_legacy_decode_brick_group(void* arg)
 {
-	//alloc struct:
+	//get info:
 	//-----------------
-	*p = (SPLVdecoderLegacyThreadPool*)SPLV_MALLOC(sizeof(SPLVdecoderLegacyThreadPool));
-	SPLVdecoderLegacyThreadPool* pool = *p;
-	if(!pool)
-	{
-		_splv_decoder_legacy_thread_pool_destroy(pool);
-
-		SPLV_LOG_ERROR("failed to allocate thread pool struct");
-		return SPLV_ERROR_OUT_OF_MEMORY;
-	}
+	SPLVbrickGroupDecodeInfoLegacy* info = (SPLVbrickGroupDecodeInfoLegacy*)arg;
 
-	//create group stack:
-	//-----------------
-	pool->groupStackSize = 0;
-	pool->groupStack = (SPLVbrickGroupDecodeInfoLegacy*)SPLV_MALLOC(maxBrickGroups * sizeof(SPLVbrickGroupDecodeInfoLegacy));
-	if(!pool->groupStack)
-	{
-		_splv_decoder_legacy_thread_pool_destroy(pool);
 
-		SPLV_LOG_ERROR("failed to allocate thread pool stack");
-		return SPLV_ERROR_OUT_OF_MEMORY;
-	}
-
-	SPLVerror groupMutexError = splv_mutex_init(&pool->groupStackMutex);
-	if(groupMutexError != SPLV_SUCCESS)
-	{
-		_splv_decoder_legacy_thread_pool_destroy(pool);
-
-		SPLV_LOG_ERROR("failed to create brick group mutex");
-		return groupMutexError;
-	}
-
-	SPLVerror groupCondError = splv_condition_variable_init(&pool->groupStackEmptyCond);
-	if(groupCondError != SPLV_SUCCESS)
-	{
-		_splv_decoder_legacy_thread_pool_destroy(pool);
-
-		SPLV_LOG_ERROR("failed to create brick group empty condition variable");
-		return groupCondError;
-	}
-
-	//create decoding threads cond:
-	//-----------------
-	pool->numGroupsDecoding = 0;
-
-	SPLVerror decodingMutexError = splv_mutex_init(&pool->decodingMutex);
-	if(decodingMutexError != SPLV_SUCCESS)
-	{
-		_splv_decoder_legacy_thread_pool_destroy(pool);
-
-		SPLV_LOG_ERROR("failed to create decoding mutex");
-		return decodingMutexError;
-	}
-
-	SPLVerror decodingCondError = splv_condition_variable_init(&pool->decodingDoneCond);
-	if(decodingCondError != SPLV_SUCCESS)
-	{
-		_splv_decoder_legacy_thread_pool_destroy(pool);
-
-		SPLV_LOG_ERROR("failed to create decoding done condition variable");
-		return decodingCondError;
-	}
-
-	//start threads:
-	//-----------------
-	pool->threadsShouldExit = 0;
-	for(uint32_t i = 0; i < SPLV_DECODER_LEGACY_THREAD_POOL_SIZE; i++)
-	{
-		SPLVerror threadError = splv_thread_create(&pool->threads[i], _splv_decode_legacy_thread_pool_thread_entry, pool);
-		if(threadError != SPLV_SUCCESS)
-		{
-			_splv_decoder_legacy_thread_pool_destroy(pool);
-
-			SPLV_LOG_ERROR("failed to create decoder thread pool thread");
-			return threadError;
-		}
-	}
-
-	return SPLV_SUCCESS;
-}
-
-static void _splv_decoder_legacy_thread_pool_destroy(SPLVdecoderLegacyThreadPool* pool)
-{
-	if(!pool)
-		return;
-
-	pool->threadsShouldExit = 1;
-	if(splv_condition_variable_signal_all(&pool->groupStackEmptyCond) != SPLV_SUCCESS)
-	{
-		SPLV_LOG_ERROR("failed to cleanup thread pool - could not notify cond var");
-		return;
-	}
-
-	for(uint32_t i = 0; i < SPLV_DECODER_LEGACY_THREAD_POOL_SIZE; i++)
-	{
-		if(splv_thread_join(&pool->threads[i], NULL) != SPLV_SUCCESS)
-			SPLV_LOG_ERROR("failed to cleanup thread pool - could not join with thread");
-	}
-
-	if(splv_mutex_destroy(&pool->groupStackMutex) != SPLV_SUCCESS)
-	{
-		SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy mutex");
-		return;
-	}
-	
-	if(splv_condition_variable_destroy(&pool->groupStackEmptyCond) != SPLV_SUCCESS)
-	{
-		SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy cond var");
-		return;
-	}
-
-	if(splv_mutex_destroy(&pool->decodingMutex) != SPLV_SUCCESS)
-	{
-		SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy mutex");
-		return;
-	}
-
-	if(splv_condition_variable_destroy(&pool->decodingDoneCond) != SPLV_SUCCESS)
-	{
-		SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy cond var");
-		return;
-	}
-
-	SPLV_FREE(pool->groupStack);
-	SPLV_FREE(pool);
-}
-
-static void* _splv_decode_legacy_thread_pool_thread_entry(void* arg)
-{
-	//TODO: we are not yet handling failure conditions. how to do this?
-
-	SPLVdecoderLegacyThreadPool* pool = (SPLVdecoderLegacyThreadPool*)arg;
-
-	while(1)
-	{
-		splv_mutex_lock(&pool->groupStackMutex);
-		while(pool->groupStackSize == 0 && pool->threadsShouldExit == 0)
-			splv_condition_variable_wait(&pool->groupStackEmptyCond, &pool->groupStackMutex);
-
-		if(pool->threadsShouldExit)
-		{
-			splv_mutex_unlock(&pool->groupStackMutex);
-			break;
-		}
-
-		SPLVbrickGroupDecodeInfoLegacy decodeInfo = pool->groupStack[pool->groupStackSize - 1];
-		pool->groupStackSize--;
-
-		splv_mutex_unlock(&pool->groupStackMutex);
-
-		SPLVerror decodeError = _splv_decoder_legacy_decode_brick_group(decodeInfo);
-		if(decodeError != SPLV_SUCCESS)
-			SPLV_LOG_ERROR("failed to decode brick group");
-
-		splv_mutex_lock(&pool->decodingMutex);
-		
-		pool->numGroupsDecoding--;
-		if(pool->numGroupsDecoding == 0)
-			splv_condition_variable_signal_one(&pool->decodingDoneCond);
-
-		splv_mutex_unlock(&pool->decodingMutex);
-	}
-
-	return NULL;
-}
-
-static SPLVerror _splv_decoder_legacy_decode_brick_group(SPLVbrickGroupDecodeInfoLegacy info)
-{
 	//create decompressed buffer writer:
 	//-----------------
 	SPLVbufferWriter decompressedWriter;
@@ -818,7 +711,7 @@ static SPLVerror _splv_decoder_legacy_decode_brick_group(SPLVbrickGroupDecodeInf
 
 	//decompress:
 	//-----------------
-	SPLVerror decodeError = splv_rc_decode(info.compressedBufLen, info.compressedBuf, &decompressedWriter);
+	SPLVerror decodeError = splv_rc_decode_legacy(info->compressedBufLen, info->compressedBuf, &decompressedWriter);
 	if(decodeError != SPLV_SUCCESS)
 	{
 		splv_buffer_writer_destroy(&decompressedWriter);
@@ -839,17 +732,18 @@ static SPLVerror _splv_decoder_legacy_decode_brick_group(SPLVbrickGroupDecodeInf
 
 	//read each brick:
 	//-----------------	
-	for(uint32_t i = 0; i < info.numBricks; i++)
+	for(uint32_t i = 0; i < info->numBricks; i++)
 	{
-		uint32_t idx = info.brickStartIdx + i;
+		uint32_t idx = info->brickStartIdx + i;
 
 		SPLVerror brickDecodeError = splv_brick_decode_legacy(
 			&decompressedReader, 
-			&info.outFrame->bricks[idx], 
-			info.decoder->scratchBufBrickPositions[idx].x, 
-			info.decoder->scratchBufBrickPositions[idx].y,
-			info.decoder->scratchBufBrickPositions[idx].z, 
-			info.lastFrame
+			&info->outFrame->bricks[idx], 
+			info->decoder->scratchBufBrickPositions[idx].x, 
+			info->decoder->scratchBufBrickPositions[idx].y,
+			info->decoder->scratchBufBrickPositions[idx].z, 
+			info->lastFrame,
+			info->decoder->version
 		);
 
 		if(brickDecodeError != SPLV_SUCCESS)
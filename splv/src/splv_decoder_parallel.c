@@ -0,0 +1,659 @@
+#include "spatialstudio/splv_decoder_parallel.h"
+
+#include "spatialstudio/splv_log.h"
+
+//-------------------------------------------//
+
+#ifndef __EMSCRIPTEN__
+	#define SPLV_DECODER_MULTITHREADING
+#endif
+
+#define min(a,b) (((a) < (b)) ? (a) : (b))
+
+//-------------------------------------------//
+
+static SPLVerror _splv_decoder_parallel_create(SPLVdecoderParallel* decoder, const char* path, uint8_t legacy, SPLVdecoderParallelOptions options);
+static SPLVerror _splv_decoder_parallel_find_gops(SPLVdecoderParallel* decoder);
+
+static SPLVerror _splv_decoder_parallel_worker_create(SPLVdecoderParallel* decoder, SPLVdecoderParallelWorker* worker, const char* path);
+static void _splv_decoder_parallel_worker_destroy(SPLVdecoderParallelWorker* worker);
+static SPLVerror _splv_decoder_parallel_worker_get_dependencies(SPLVdecoderParallelWorker* worker, uint64_t idx, uint64_t* numDependencies, uint64_t* dependencies);
+static SPLVerror _splv_decoder_parallel_worker_decode_gop(SPLVdecoderParallelWorker* worker, uint32_t gop);
+static splv_bool_t _splv_decoder_parallel_publish(SPLVdecoderParallel* decoder, uint32_t gop, uint64_t idx, SPLVframeCompact* frame);
+
+#ifdef SPLV_DECODER_MULTITHREADING
+static void* _splv_decoder_parallel_worker_thread(void* arg);
+#endif
+
+//-------------------------------------------//
+
+SPLVerror splv_decoder_parallel_create(SPLVdecoderParallel* decoder, const char* path, SPLVdecoderParallelOptions options)
+{
+	return _splv_decoder_parallel_create(decoder, path, 0, options);
+}
+
+SPLVerror splv_decoder_parallel_create_legacy(SPLVdecoderParallel* decoder, const char* path, SPLVdecoderParallelOptions options)
+{
+	return _splv_decoder_parallel_create(decoder, path, 1, options);
+}
+
+SPLVerror splv_decoder_parallel_next_frame(SPLVdecoderParallel* decoder, SPLVframe* frame)
+{
+	SPLVframeCompact compactFrame;
+	SPLV_ERROR_PROPAGATE(splv_decoder_parallel_next_frame_compact(decoder, &compactFrame));
+
+	//unpack into a new frame for the caller:
+	//---------------
+	memset(frame, 0, sizeof(SPLVframe));
+	SPLVerror unpackError = splv_frame_compact_unpack(&compactFrame, frame);
+	splv_frame_compact_destroy(&compactFrame);
+
+	if(unpackError != SPLV_SUCCESS)
+	{
+		SPLV_LOG_ERROR("failed to unpack decoded frame");
+		return unpackError;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_decoder_parallel_next_frame_compact(SPLVdecoderParallel* decoder, SPLVframeCompact* frame)
+{
+	SPLV_ASSERT(decoder->nextFrame < decoder->frameCount, "no frames left to decode");
+
+#ifdef SPLV_DECODER_MULTITHREADING
+	//wait for frame:
+	//---------------
+	splv_mutex_lock(&decoder->mutex);
+
+	while(!decoder->framesReady[decoder->nextFrame] && decoder->error == SPLV_SUCCESS)
+		splv_condition_variable_wait(&decoder->cond, &decoder->mutex);
+
+	if(!decoder->framesReady[decoder->nextFrame])
+	{
+		SPLVerror error = decoder->error;
+		splv_mutex_unlock(&decoder->mutex);
+
+		return error;
+	}
+#else
+	//decode next GOP if frame not decoded yet, GOPs are always decoded in order:
+	//---------------
+	if(!decoder->framesReady[decoder->nextFrame])
+	{
+		SPLV_ERROR_PROPAGATE(_splv_decoder_parallel_worker_decode_gop(&decoder->workers[0], decoder->nextGop));
+		decoder->nextGop++;
+	}
+#endif
+
+	//take frame:
+	//---------------
+	*frame = decoder->frames[decoder->nextFrame];
+	decoder->framesReady[decoder->nextFrame] = 0;
+	decoder->bufferedBytes -= splv_frame_compact_get_size(frame);
+	decoder->nextFrame++;
+
+#ifdef SPLV_DECODER_MULTITHREADING
+	splv_condition_variable_signal_all(&decoder->cond);
+	splv_mutex_unlock(&decoder->mutex);
+#endif
+
+	return SPLV_SUCCESS;
+}
+
+void splv_decoder_parallel_destroy(SPLVdecoderParallel* decoder)
+{
+#ifdef SPLV_DECODER_MULTITHREADING
+	//stop workers:
+	//---------------
+	splv_mutex_lock(&decoder->mutex);
+	decoder->shouldExit = 1;
+	splv_condition_variable_signal_all(&decoder->cond);
+	splv_mutex_unlock(&decoder->mutex);
+
+	for(uint32_t i = 0; i < decoder->numWorkersStarted; i++)
+		splv_thread_join(&decoder->workers[i].thread, NULL);
+
+	splv_mutex_destroy(&decoder->mutex);
+	splv_condition_variable_destroy(&decoder->cond);
+#endif
+
+	//free frames that were never returned:
+	//---------------
+	if(decoder->frames && decoder->framesReady)
+	{
+		for(uint64_t i = 0; i < decoder->frameCount; i++)
+		{
+			if(decoder->framesReady[i])
+				splv_frame_compact_destroy(&decoder->frames[i]);
+		}
+	}
+
+	if(decoder->frames)
+		SPLV_FREE(decoder->frames);
+	if(decoder->framesReady)
+		SPLV_FREE(decoder->framesReady);
+
+	//free workers:
+	//---------------
+	if(decoder->workers)
+	{
+		for(uint32_t i = 0; i < decoder->numWorkers; i++)
+			_splv_decoder_parallel_worker_destroy(&decoder->workers[i]);
+
+		SPLV_FREE(decoder->workers);
+	}
+
+#ifdef SPLV_DECODER_MULTITHREADING
+	if(decoder->ownsThreadPool)
+		splv_thread_pool_destroy(decoder->threadPool);
+#endif
+
+	if(decoder->gopStarts)
+		SPLV_FREE(decoder->gopStarts);
+}
+
+//-------------------------------------------//
+
+static SPLVerror _splv_decoder_parallel_create(SPLVdecoderParallel* decoder, const char* path, uint8_t legacy, SPLVdecoderParallelOptions options)
+{
+	//initialize:
+	//---------------
+	memset(decoder, 0, sizeof(SPLVdecoderParallel)); //clear any ptrs to NULL
+
+	decoder->legacy = legacy;
+	decoder->memoryBudget = options.memoryBudget > 0 ? options.memoryBudget : SPLV_DECODER_PARALLEL_DEFAULT_MEMORY_BUDGET;
+
+	uint32_t maxWorkers = options.numWorkers;
+
+#ifdef SPLV_DECODER_MULTITHREADING
+	SPLVerror mutexError = splv_mutex_init(&decoder->mutex);
+	if(mutexError != SPLV_SUCCESS)
+	{
+		SPLV_LOG_ERROR("failed to create parallel decoder mutex");
+		return mutexError;
+	}
+
+	SPLVerror condError = splv_condition_variable_init(&decoder->cond);
+	if(condError != SPLV_SUCCESS)
+	{
+		splv_mutex_destroy(&decoder->mutex);
+
+		SPLV_LOG_ERROR("failed to create parallel decoder condition variable");
+		return condError;
+	}
+
+	if(maxWorkers == 0)
+		maxWorkers = splv_get_hardware_concurrency();
+
+	//create thread pool, shared by all workers:
+	//---------------
+	if(options.threadPool)
+		decoder->threadPool = options.threadPool;
+	else
+	{
+		SPLVerror threadPoolError = splv_thread_pool_create(&decoder->threadPool, 0, 0, 0);
+		if(threadPoolError != SPLV_SUCCESS)
+		{
+			decoder->threadPool = NULL;
+			splv_decoder_parallel_destroy(decoder);
+
+			SPLV_LOG_ERROR("failed to create parallel decoder thread pool");
+			return threadPoolError;
+		}
+
+		decoder->ownsThreadPool = 1;
+	}
+#else
+	maxWorkers = 1;
+#endif
+
+	//create first worker, read metadata + GOPs from it:
+	//---------------
+	decoder->workers = (SPLVdecoderParallelWorker*)SPLV_MALLOC(maxWorkers * sizeof(SPLVdecoderParallelWorker));
+	if(!decoder->workers)
+	{
+		splv_decoder_parallel_destroy(decoder);
+
+		SPLV_LOG_ERROR("failed to allocate parallel decoder workers");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	SPLVerror firstWorkerError = _splv_decoder_parallel_worker_create(decoder, &decoder->workers[0], path);
+	if(firstWorkerError != SPLV_SUCCESS)
+	{
+		splv_decoder_parallel_destroy(decoder);
+		return firstWorkerError;
+	}
+
+	decoder->numWorkers = 1;
+
+	if(legacy)
+	{
+		SPLVdecoderLegacy* impl = &decoder->workers[0].implLegacy;
+
+		decoder->width = impl->width;
+		decoder->height = impl->height;
+		decoder->depth = impl->depth;
+		decoder->framerate = impl->framerate;
+		decoder->frameCount = impl->frameCount;
+		decoder->encodingParamsLegacy = impl->encodingParams;
+	}
+	else
+	{
+		SPLVdecoder* impl = &decoder->workers[0].impl;
+
+		decoder->width = impl->width;
+		decoder->height = impl->height;
+		decoder->depth = impl->depth;
+		decoder->framerate = impl->framerate;
+		decoder->frameCount = impl->frameCount;
+		decoder->encodingParams = impl->encodingParams;
+	}
+
+	SPLVerror gopError = _splv_decoder_parallel_find_gops(decoder);
+	if(gopError != SPLV_SUCCESS)
+	{
+		splv_decoder_parallel_destroy(decoder);
+		return gopError;
+	}
+
+	//create remaining workers, no more than 1 per GOP:
+	//---------------
+	uint32_t numWorkers = min(maxWorkers, decoder->numGops);
+	while(decoder->numWorkers < numWorkers)
+	{
+		SPLVerror workerError = _splv_decoder_parallel_worker_create(decoder, &decoder->workers[decoder->numWorkers], path);
+		if(workerError != SPLV_SUCCESS)
+		{
+			splv_decoder_parallel_destroy(decoder);
+			return workerError;
+		}
+
+		decoder->numWorkers++;
+	}
+
+	//create reorder buffer:
+	//---------------
+	if(decoder->frameCount > 0)
+	{
+		decoder->frames = (SPLVframeCompact*)SPLV_MALLOC(decoder->frameCount * sizeof(SPLVframeCompact));
+		decoder->framesReady = (uint8_t*)SPLV_MALLOC(decoder->frameCount * sizeof(uint8_t));
+		if(!decoder->frames || !decoder->framesReady)
+		{
+			splv_decoder_parallel_destroy(decoder);
+
+			SPLV_LOG_ERROR("failed to allocate parallel decoder reorder buffer");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+
+		memset(decoder->framesReady, 0, decoder->frameCount * sizeof(uint8_t));
+	}
+
+	//start workers:
+	//---------------
+#ifdef SPLV_DECODER_MULTITHREADING
+	for(uint32_t i = 0; i < decoder->numWorkers; i++)
+	{
+		SPLVerror threadError = splv_thread_create(&decoder->workers[i].thread, _splv_decoder_parallel_worker_thread, &decoder->workers[i]);
+		if(threadError != SPLV_SUCCESS)
+		{
+			splv_decoder_parallel_destroy(decoder);
+
+			SPLV_LOG_ERROR("failed to start parallel decoder worker thread");
+			return threadError;
+		}
+
+		decoder->numWorkersStarted++;
+	}
+#endif
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_decoder_parallel_find_gops(SPLVdecoderParallel* decoder)
+{
+	decoder->gopStarts = (uint64_t*)SPLV_MALLOC((decoder->frameCount + 1) * sizeof(uint64_t));
+	if(!decoder->gopStarts)
+	{
+		SPLV_LOG_ERROR("failed to allocate parallel decoder GOP array");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	//each frame without dependencies begins a new GOP:
+	//---------------
+	decoder->numGops = 0;
+	for(uint64_t i = 0; i < decoder->frameCount; i++)
+	{
+		uint64_t numDependencies;
+		SPLV_ERROR_PROPAGATE(_splv_decoder_parallel_worker_get_dependencies(&decoder->workers[0], i, &numDependencies, NULL));
+
+		if(numDependencies == 0)
+			decoder->gopStarts[decoder->numGops++] = i;
+		else if(i == 0)
+		{
+			SPLV_LOG_ERROR("invalid SPLV file - first frame has dependencies");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+	}
+
+	decoder->gopStarts[decoder->numGops] = decoder->frameCount;
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_decoder_parallel_worker_create(SPLVdecoderParallel* decoder, SPLVdecoderParallelWorker* worker, const char* path)
+{
+	worker->parent = decoder;
+
+	if(decoder->legacy)
+		return splv_decoder_legacy_create_from_file_with_pool(&worker->implLegacy, path, decoder->threadPool);
+	else
+	{
+		SPLVdecoderOptions options = {0};
+		options.threadPool = decoder->threadPool;
+
+		return splv_decoder_create_from_file_mmap_with_options(&worker->impl, path, options);
+	}
+}
+
+static void _splv_decoder_parallel_worker_destroy(SPLVdecoderParallelWorker* worker)
+{
+	if(worker->parent->legacy)
+		splv_decoder_legacy_destroy(&worker->implLegacy);
+	else
+		splv_decoder_destroy(&worker->impl);
+}
+
+static SPLVerror _splv_decoder_parallel_worker_get_dependencies(SPLVdecoderParallelWorker* worker, uint64_t idx, uint64_t* numDependencies, uint64_t* dependencies)
+{
+	if(worker->parent->legacy)
+		return splv_decoder_legacy_get_frame_dependencies(&worker->implLegacy, idx, numDependencies, dependencies, 0);
+	else
+		return splv_decoder_get_frame_dependencies(&worker->impl, idx, numDependencies, dependencies, 0);
+}
+
+static SPLVerror _splv_decoder_parallel_worker_decode_gop(SPLVdecoderParallelWorker* worker, uint32_t gop)
+{
+	SPLVdecoderParallel* decoder = worker->parent;
+
+	uint64_t gopStart = decoder->gopStarts[gop];
+	uint64_t gopLen = decoder->gopStarts[gop + 1] - gopStart;
+
+	//allocate:
+	//---------------
+	SPLVframeCompact* frames = (SPLVframeCompact*)SPLV_MALLOC(gopLen * sizeof(SPLVframeCompact));
+	uint64_t* lastUses = (uint64_t*)SPLV_MALLOC(gopLen * sizeof(uint64_t));
+	uint8_t* decoded = (uint8_t*)SPLV_MALLOC(gopLen * sizeof(uint8_t));
+
+	//legacy frames can only be decoded in full, they are packed once no longer needed as a dependency
+	SPLVframe* framesLegacy = NULL;
+	if(decoder->legacy)
+		framesLegacy = (SPLVframe*)SPLV_MALLOC(gopLen * sizeof(SPLVframe));
+
+	if(!frames || !lastUses || !decoded || (decoder->legacy && !framesLegacy))
+	{
+		if(frames)
+			SPLV_FREE(frames);
+		if(framesLegacy)
+			SPLV_FREE(framesLegacy);
+		if(lastUses)
+			SPLV_FREE(lastUses);
+		if(decoded)
+			SPLV_FREE(decoded);
+
+		SPLV_LOG_ERROR("failed to allocate GOP decoding state");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	memset(frames, 0, gopLen * sizeof(SPLVframeCompact));
+	memset(decoded, 0, gopLen * sizeof(uint8_t));
+
+	uint64_t maxDependencies = 0;
+	uint64_t* dependencies = NULL;
+	SPLVframeCompactIndexed* indexedFrames = NULL;
+	SPLVframeIndexedLegacy* indexedFramesLegacy = NULL;
+
+	SPLVerror error = SPLV_SUCCESS;
+	splv_bool_t aborted = SPLV_FALSE;
+	uint64_t firstUnpublished = 0;
+
+	//find the last frame using each frame, so each can be published as soon as nothing else in the GOP needs it:
+	//---------------
+	for(uint64_t i = 0; i < gopLen && error == SPLV_SUCCESS; i++)
+	{
+		lastUses[i] = i;
+
+		uint64_t numDependencies;
+		error = _splv_decoder_parallel_worker_get_dependencies(worker, gopStart + i, &numDependencies, NULL);
+		if(error != SPLV_SUCCESS)
+			break;
+
+		if(numDependencies > maxDependencies)
+		{
+			uint64_t* newDependencies = (uint64_t*)SPLV_REALLOC(dependencies, numDependencies * sizeof(uint64_t));
+			if(newDependencies)
+				dependencies = newDependencies;
+
+			SPLVframeCompactIndexed* newIndexedFrames = (SPLVframeCompactIndexed*)SPLV_REALLOC(indexedFrames, numDependencies * sizeof(SPLVframeCompactIndexed));
+			if(newIndexedFrames)
+				indexedFrames = newIndexedFrames;
+
+			SPLVframeIndexedLegacy* newIndexedFramesLegacy = (SPLVframeIndexedLegacy*)SPLV_REALLOC(indexedFramesLegacy, numDependencies * sizeof(SPLVframeIndexedLegacy));
+			if(newIndexedFramesLegacy)
+				indexedFramesLegacy = newIndexedFramesLegacy;
+
+			if(!newDependencies || !newIndexedFrames || !newIndexedFramesLegacy)
+			{
+				SPLV_LOG_ERROR("failed to realloc frame dependencies");
+				error = SPLV_ERROR_OUT_OF_MEMORY;
+				break;
+			}
+
+			maxDependencies = numDependencies;
+		}
+
+		error = _splv_decoder_parallel_worker_get_dependencies(worker, gopStart + i, &numDependencies, dependencies);
+		if(error != SPLV_SUCCESS)
+			break;
+
+		for(uint64_t j = 0; j < numDependencies; j++)
+		{
+			if(dependencies[j] < gopStart || dependencies[j] >= gopStart + i)
+			{
+				SPLV_LOG_ERROR("invalid SPLV file - frame depends on a frame outside of its GOP");
+				error = SPLV_ERROR_INVALID_INPUT;
+				break;
+			}
+
+			lastUses[dependencies[j] - gopStart] = i;
+		}
+	}
+
+	//decode frames in order:
+	//---------------
+	for(uint64_t i = 0; i < gopLen && error == SPLV_SUCCESS && !aborted; i++)
+	{
+		uint64_t numDependencies;
+		error = _splv_decoder_parallel_worker_get_dependencies(worker, gopStart + i, &numDependencies, dependencies);
+		if(error != SPLV_SUCCESS)
+			break;
+
+		if(decoder->legacy)
+		{
+			for(uint64_t j = 0; j < numDependencies; j++)
+			{
+				indexedFramesLegacy[j].index = dependencies[j];
+				indexedFramesLegacy[j].frame = &framesLegacy[dependencies[j] - gopStart];
+			}
+
+			error = splv_decoder_legacy_decode_frame(
+				&worker->implLegacy, gopStart + i,
+				numDependencies, indexedFramesLegacy, &framesLegacy[i]
+			);
+		}
+		else
+		{
+			for(uint64_t j = 0; j < numDependencies; j++)
+			{
+				indexedFrames[j].index = dependencies[j];
+				indexedFrames[j].frame = &frames[dependencies[j] - gopStart];
+			}
+
+			error = splv_decoder_decode_frame_compact(
+				&worker->impl, gopStart + i,
+				numDependencies, indexedFrames, &frames[i]
+			);
+
+			//decoding into a zeroed frame may have allocated it even on failure
+			if(error != SPLV_SUCCESS)
+				splv_frame_compact_destroy(&frames[i]);
+		}
+
+		if(error != SPLV_SUCCESS)
+			break;
+
+		decoded[i] = 1;
+
+		//publish every frame no longer needed:
+		//---------------
+		for(uint64_t j = firstUnpublished; j <= i; j++)
+		{
+			if(!decoded[j] || lastUses[j] > i)
+				continue;
+
+			decoded[j] = 0;
+			if(decoder->legacy)
+			{
+				error = splv_frame_compact_pack(&framesLegacy[j], &frames[j]);
+				splv_frame_destroy(&framesLegacy[j]);
+
+				if(error != SPLV_SUCCESS)
+				{
+					splv_frame_compact_destroy(&frames[j]);
+
+					SPLV_LOG_ERROR("failed to pack decoded legacy frame");
+					break;
+				}
+			}
+
+			if(!_splv_decoder_parallel_publish(decoder, gop, gopStart + j, &frames[j]))
+			{
+				splv_frame_compact_destroy(&frames[j]);
+
+				aborted = SPLV_TRUE;
+				break;
+			}
+		}
+
+		while(firstUnpublished <= i && !decoded[firstUnpublished] && lastUses[firstUnpublished] <= i)
+			firstUnpublished++;
+	}
+
+	//cleanup + return:
+	//---------------
+	for(uint64_t i = 0; i < gopLen; i++)
+	{
+		if(!decoded[i])
+			continue;
+
+		if(decoder->legacy)
+			splv_frame_destroy(&framesLegacy[i]);
+		else
+			splv_frame_compact_destroy(&frames[i]);
+	}
+
+	if(dependencies)
+		SPLV_FREE(dependencies);
+	if(indexedFrames)
+		SPLV_FREE(indexedFrames);
+	if(indexedFramesLegacy)
+		SPLV_FREE(indexedFramesLegacy);
+
+	SPLV_FREE(frames);
+	if(framesLegacy)
+		SPLV_FREE(framesLegacy);
+	SPLV_FREE(lastUses);
+	SPLV_FREE(decoded);
+
+	return error;
+}
+
+static splv_bool_t _splv_decoder_parallel_publish(SPLVdecoderParallel* decoder, uint32_t gop, uint64_t idx, SPLVframeCompact* frame)
+{
+	uint64_t size = splv_frame_compact_get_size(frame);
+
+#ifdef SPLV_DECODER_MULTITHREADING
+	splv_mutex_lock(&decoder->mutex);
+
+	//wait for space in reorder buffer, the GOP holding the next frame to return never waits so decoding always progresses:
+	//---------------
+	while(!decoder->shouldExit && decoder->error == SPLV_SUCCESS && decoder->gopStarts[gop] > decoder->nextFrame &&
+	      decoder->bufferedBytes + size > decoder->memoryBudget)
+		splv_condition_variable_wait(&decoder->cond, &decoder->mutex);
+
+	if(decoder->shouldExit || decoder->error != SPLV_SUCCESS)
+	{
+		splv_mutex_unlock(&decoder->mutex);
+		return SPLV_FALSE;
+	}
+#endif
+
+	//add to reorder buffer:
+	//---------------
+	decoder->frames[idx] = *frame;
+	decoder->framesReady[idx] = 1;
+	decoder->bufferedBytes += size;
+
+#ifdef SPLV_DECODER_MULTITHREADING
+	splv_condition_variable_signal_all(&decoder->cond);
+	splv_mutex_unlock(&decoder->mutex);
+#endif
+
+	return SPLV_TRUE;
+}
+
+#ifdef SPLV_DECODER_MULTITHREADING
+
+static void* _splv_decoder_parallel_worker_thread(void* arg)
+{
+	SPLVdecoderParallelWorker* worker = (SPLVdecoderParallelWorker*)arg;
+	SPLVdecoderParallel* decoder = worker->parent;
+
+	while(1)
+	{
+		//claim next GOP:
+		//---------------
+		splv_mutex_lock(&decoder->mutex);
+
+		if(decoder->shouldExit || decoder->error != SPLV_SUCCESS || decoder->nextGop >= decoder->numGops)
+		{
+			splv_mutex_unlock(&decoder->mutex);
+			break;
+		}
+
+		uint32_t gop = decoder->nextGop++;
+
+		splv_mutex_unlock(&decoder->mutex);
+
+		//decode:
+		//---------------
+		SPLVerror error = _splv_decoder_parallel_worker_decode_gop(worker, gop);
+		if(error != SPLV_SUCCESS)
+		{
+			splv_mutex_lock(&decoder->mutex);
+
+			if(decoder->error == SPLV_SUCCESS)
+				decoder->error = error;
+
+			splv_condition_variable_signal_all(&decoder->cond);
+			splv_mutex_unlock(&decoder->mutex);
+
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include "spatialstudio/splv_encoder.h"
 
 #include "spatialstudio/splv_range_coder.h"
+#include "spatialstudio/splv_rans.h"
+#include "spatialstudio/splv_occupancy_coder.h"
 #include "spatialstudio/splv_log.h"
 #include "spatialstudio/splv_buffer_io.h"
 
@@ -11,43 +13,43 @@
 
 //-------------------------------------------//
 
-/**
- * all info needed for a thread to encode a brick group
- */
-typedef struct SPLVbrickGroupEncodeInfo
-{
-	SPLVencoder* encoder;
-
-	SPLVframe* frame; 
-	SPLVframeEncodingType frameType; 
-	
-	uint32_t numBricks; 
-	SPLVbrick** bricks;
-	SPLVcoordinate* brickPositions;
-	
-	SPLVbufferWriter* outBuf;
-	uint64_t* numVoxels;
-} SPLVbrickGroupEncodeInfo;
-
-//-------------------------------------------//
-
+static SPLVerror _splv_encoder_add_frame(SPLVencoder* encoder, SPLVframe* frame, SPLVframeCompact* compactFrame);
+static SPLVerror _splv_encoder_copy_frame(SPLVframeCompact* dst, SPLVframeCompact* src);
 static SPLVerror _splv_encoder_encode_brick_group(void* info);
+static SPLVerror _splv_encoder_encode_brick_group_impl(SPLVbrickGroupEncodeInfo* info);
+static void _splv_encoder_destroy_brick_writers(SPLVbufferWriter* writers);
+static SPLVerror _splv_encoder_write_frame(SPLVencoder* encoder);
+static SPLVerror _splv_encoder_write_frame_impl(SPLVencoder* encoder, SPLVencoderFrameInFlight* frame);
+static void _splv_encoder_get_motion_predictors(SPLVbrickGroupEncodeInfo* info, uint32_t brickIdx, SPLVmotionSearchParams* params);
 
 static void _splv_encoder_destroy(SPLVencoder* encoder);
 
 //-------------------------------------------//
 
 SPLVerror splv_encoder_create(SPLVencoder* encoder, uint32_t width, uint32_t height, uint32_t depth, float framerate, SPLVencodingParams encodingParams, const char* outPath)
+{
+	SPLVencoderOptions options = {0};
+	options.maxFramesInFlight = 1;
+
+	return splv_encoder_create_with_options(encoder, width, height, depth, framerate, encodingParams, options, outPath);
+}
+
+SPLVerror splv_encoder_create_with_options(SPLVencoder* encoder, uint32_t width, uint32_t height, uint32_t depth, float framerate, 
+                                           SPLVencodingParams encodingParams, SPLVencoderOptions options, const char* outPath)
 {
 	//validate params:
 	//---------------
 	SPLV_ASSERT(width > 0 && height > 0 && depth > 0, 
 		"volume dimensions must be positive");
-	SPLV_ASSERT(width % SPLV_BRICK_SIZE == 0 && height % SPLV_BRICK_SIZE == 0 && depth == SPLV_BRICK_SIZE == 0, 
+	SPLV_ASSERT(width % SPLV_BRICK_SIZE == 0 && height % SPLV_BRICK_SIZE == 0 && depth % SPLV_BRICK_SIZE == 0, 
 		"volume dimensions must be a multiple of SPLV_BRICK_SIZE");
 	SPLV_ASSERT(framerate > 0.0f, "framerate must be positive");
 	SPLV_ASSERT(encodingParams.gopSize > 0, "gop size must be positive");
-	SPLV_ASSERT(encodingParams.maxRegionDim % SPLV_BRICK_SIZE == 0, "maxRegionDim must be a multiple of SPLV_BRICK_SIZE");
+	SPLV_ASSERT(encodingParams.motionSearchPreset < SPLV_MOTION_SEARCH_PRESET_COUNT, "invalid motion search preset");
+	SPLV_ASSERT(encodingParams.entropyCoder < SPLV_ENTROPY_CODER_COUNT, "invalid entropy coder");
+	SPLV_ASSERT(encodingParams.geometryCoder < SPLV_GEOMETRY_CODER_COUNT, "invalid geometry coder");
+	SPLV_ASSERT(encodingParams.voxelOrder < SPLV_VOXEL_ORDER_COUNT, "invalid voxel order");
+	SPLV_ASSERT(encodingParams.brickOrder < SPLV_BRICK_ORDER_COUNT, "invalid brick order");
 
 	if(encodingParams.maxBrickGroupSize > 0 && encodingParams.maxBrickGroupSize < 128)
 		SPLV_LOG_WARNING("small values of maxBrickGroupSize can significantly reduce efficiency and decoding speed");
@@ -63,6 +65,7 @@ SPLVerror splv_encoder_create(SPLVencoder* encoder, uint32_t width, uint32_t hei
 	encoder->frameCount = 0;
 	encoder->frameTable = (SPLVdynArrayUint64){0};
 	encoder->encodingParams = encodingParams;
+	encoder->maxFramesInFlight = max(options.maxFramesInFlight, 1);
 
 	//create frame table:
 	//---------------
@@ -98,236 +101,213 @@ SPLVerror splv_encoder_create(SPLVencoder* encoder, uint32_t width, uint32_t hei
 	mapLenBitmap /= 4; //4 bytes per uint32_t
 	mapLenBitmap /= 8; //8 bits per byte
 
-	uint32_t maxBrickGroups;
-	if(encoder->encodingParams.maxBrickGroupSize == 0)
-		maxBrickGroups = 1;
-	else
-		maxBrickGroups = (mapLen + encoder->encodingParams.maxBrickGroupSize - 1) / encoder->encodingParams.maxBrickGroupSize;
-
-	encoder->mapBitmapLen = mapLenBitmap;
-
-	encoder->scratchBufMapBitmap = (uint32_t*)SPLV_MALLOC(mapLenBitmap * sizeof(uint32_t));
-	encoder->scratchBufBricks = (SPLVbrick**)SPLV_MALLOC(mapLen * sizeof(SPLVbrick*));
-	encoder->scratchBufBrickPositions = (SPLVcoordinate*)SPLV_MALLOC(mapLen * sizeof(SPLVcoordinate));
-	encoder->scratchBufBrickGroupWriters = (SPLVbufferWriter*)SPLV_MALLOC(maxBrickGroups * sizeof(SPLVbufferWriter));
-	encoder->scratchBufVoxelCounts = (uint64_t*)SPLV_MALLOC(maxBrickGroups * sizeof(uint64_t));
-	
-	if(!encoder->scratchBufMapBitmap || !encoder->scratchBufBricks || !encoder->scratchBufBrickPositions || !encoder->scratchBufBrickGroupWriters)
+	encoder->numTiles = splv_frame_get_num_tiles(widthMap, heightMap, depthMap, encodingParams.tileSize);
+	encoder->brickOrder = (uint32_t*)SPLV_MALLOC(mapLen * sizeof(uint32_t));
+	encoder->tileStarts = (uint32_t*)SPLV_MALLOC((encoder->numTiles + 1) * sizeof(uint32_t));
+	if(!encoder->brickOrder || !encoder->tileStarts)
 	{
 		_splv_encoder_destroy(encoder);
 
-		SPLV_LOG_ERROR("failed to allocate encoder scratch buffers");
+		SPLV_LOG_ERROR("failed to allocate encoder brick order");
 		return SPLV_ERROR_OUT_OF_MEMORY;
 	}
 
-	//create thread pool:
-	//---------------
-	SPLVerror threadPoolError = splv_thread_pool_create(
-		&encoder->threadPool, SPLV_ENCODER_THREAD_POOL_SIZE,
-		_splv_encoder_encode_brick_group, sizeof(SPLVbrickGroupEncodeInfo)
+	splv_frame_get_brick_order(
+		widthMap, heightMap, depthMap, (SPLVbrickOrder)encodingParams.brickOrder, encodingParams.tileSize, 
+		encoder->brickOrder, encoder->tileStarts
 	);
-	if(threadPoolError != SPLV_SUCCESS)
-	{
-		_splv_encoder_destroy(encoder);
 
-		SPLV_LOG_ERROR("failed to create encoder thread pool");
-		return threadPoolError;	
+	//brick groups never span tiles, so each tile is split into groups separately
+	uint32_t maxBrickGroups = 0;
+	for(uint32_t i = 0; i < encoder->numTiles; i++)
+	{
+		uint32_t tileLen = encoder->tileStarts[i + 1] - encoder->tileStarts[i];
+		if(encoder->encodingParams.maxBrickGroupSize == 0)
+			maxBrickGroups += 1;
+		else
+			maxBrickGroups += (tileLen + encoder->encodingParams.maxBrickGroupSize - 1) / encoder->encodingParams.maxBrickGroupSize;
 	}
 
-	//write empty header (will write over with complete header when encoding is finished):
-	//---------------
-	SPLVfileHeader emptyHeader = {0};
-	if(fwrite(&emptyHeader, sizeof(SPLVfileHeader), 1, encoder->outFile) < 1)
+	encoder->mapBitmapLen = mapLenBitmap;
+	encoder->maxBrickGroups = maxBrickGroups;
+
+	encoder->framesInFlight = (SPLVencoderFrameInFlight*)SPLV_MALLOC(encoder->maxFramesInFlight * sizeof(SPLVencoderFrameInFlight));
+	if(!encoder->framesInFlight)
 	{
 		_splv_encoder_destroy(encoder);
 
-		SPLV_LOG_ERROR("failed to write empty header to output file");
-		return SPLV_ERROR_FILE_WRITE;
+		SPLV_LOG_ERROR("failed to allocate encoder in-flight frames");
+		return SPLV_ERROR_OUT_OF_MEMORY;
 	}
 
-	return SPLV_SUCCESS;
-}
+	memset(encoder->framesInFlight, 0, encoder->maxFramesInFlight * sizeof(SPLVencoderFrameInFlight));
 
-SPLVerror splv_encoder_encode_frame(SPLVencoder* encoder, SPLVframe* frame, splv_bool_t* canFree)
-{
-	//validate:
-	//---------------
-	uint32_t widthMap  = encoder->width  / SPLV_BRICK_SIZE;
-	uint32_t heightMap = encoder->height / SPLV_BRICK_SIZE;
-	uint32_t depthMap  = encoder->depth  / SPLV_BRICK_SIZE;
+	//each in-flight frame needs its own copy, plus the oldest one's reference. Their buffers are allocated on first use
+	encoder->numFrameCopies = encoder->maxFramesInFlight + 1;
+	encoder->frameCopies = (SPLVframeCompact*)SPLV_MALLOC(encoder->numFrameCopies * sizeof(SPLVframeCompact));
+	if(!encoder->frameCopies)
+	{
+		_splv_encoder_destroy(encoder);
 
-	SPLV_ASSERT(widthMap == frame->width && heightMap == frame->height && depthMap == frame->depth,
-		"frame dimensions must match those specified in splv_encoder_create()");
+		SPLV_LOG_ERROR("failed to allocate encoder frame copies");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
 
-	//determine frame type:
-	//---------------
-	SPLVframeEncodingType frameType;
-	if(encoder->frameCount % encoder->encodingParams.gopSize == 0)
-		frameType = SPLV_FRAME_ENCODING_TYPE_I;
-	else
-		frameType = SPLV_FRAME_ENCODING_TYPE_P;
+	memset(encoder->frameCopies, 0, encoder->numFrameCopies * sizeof(SPLVframeCompact));
 
-	//get frame ptr:
-	//---------------
-	long framePtr = ftell(encoder->outFile);
-	if(framePtr	== -1L)
+	SPLVerror framesMutexError = splv_mutex_init(&encoder->framesInFlightMutex);
+	SPLVerror framesCondError = splv_condition_variable_init(&encoder->frameEncodedCond);
+	if(framesMutexError != SPLV_SUCCESS || framesCondError != SPLV_SUCCESS)
 	{
-		SPLV_LOG_ERROR("error getting file write position");
-		return SPLV_ERROR_FILE_WRITE;
-	}
-
-	uint64_t frameTableEntry = ((uint64_t)frameType << 56) | (uint64_t)framePtr;
-	SPLV_ERROR_PROPAGATE(splv_dyn_array_uint64_push(&encoder->frameTable, frameTableEntry));
+		//TODO: this leaks whichever one succeeded, but neither can fail except for programmer error
+		SPLV_FREE(encoder->framesInFlight);
+		encoder->framesInFlight = NULL;
+		_splv_encoder_destroy(encoder);
 
-	//compress map (convert to bitmap):
-	//---------------
-	uint32_t numBricksOrdered = 0;
+		SPLV_LOG_ERROR("failed to create encoder in-flight frame synchronization primitives");
+		return SPLV_ERROR_THREADING;
+	}
 
-	//we are writing bricks in xyz order, we MUST make sure to read them back in the same order
-	for(uint32_t xMap = 0; xMap < widthMap ; xMap++)
-	for(uint32_t yMap = 0; yMap < heightMap; yMap++)
-	for(uint32_t zMap = 0; zMap < depthMap ; zMap++)
+	for(uint32_t i = 0; i < encoder->maxFramesInFlight; i++)
 	{
-		uint32_t mapIdxRead = splv_frame_get_map_idx(frame, xMap, yMap, zMap);
-
-		uint32_t mapIdxWrite = xMap + widthMap * (yMap + heightMap * zMap);
-		uint32_t mapIdxWriteArr = mapIdxWrite / 32;
-		uint32_t mapIdxWriteBit = mapIdxWrite % 32;
-		
-		if(frame->map[mapIdxRead] != SPLV_BRICK_IDX_EMPTY)
+		SPLVencoderFrameInFlight* frame = &encoder->framesInFlight[i];
+
+		frame->mapBitmap = (uint32_t*)SPLV_MALLOC(mapLenBitmap * sizeof(uint32_t));
+		frame->bricks = (SPLVbrickCompact**)SPLV_MALLOC(mapLen * sizeof(SPLVbrickCompact*));
+		frame->brickPositions = (SPLVcoordinate*)SPLV_MALLOC(mapLen * sizeof(SPLVcoordinate));
+		frame->brickIndices = (uint32_t*)SPLV_MALLOC(mapLen * sizeof(uint32_t));
+		frame->motionVectors = (SPLVmotionVector*)SPLV_MALLOC(mapLen * sizeof(SPLVmotionVector));
+		frame->brickSkipped = (uint8_t*)SPLV_MALLOC(mapLen * sizeof(uint8_t));
+		frame->skipBitmap = (uint32_t*)SPLV_MALLOC(mapLenBitmap * sizeof(uint32_t));
+		frame->brickGroupWriters = (SPLVbufferWriter*)SPLV_MALLOC(maxBrickGroups * sizeof(SPLVbufferWriter));
+		frame->voxelCounts = (uint64_t*)SPLV_MALLOC(maxBrickGroups * sizeof(uint64_t));
+		frame->brickGroupInfos = (SPLVbrickGroupEncodeInfo*)SPLV_MALLOC(maxBrickGroups * sizeof(SPLVbrickGroupEncodeInfo));
+
+		if(!frame->mapBitmap || !frame->bricks || !frame->brickPositions || !frame->brickIndices || !frame->motionVectors || !frame->brickSkipped || 
+		   !frame->skipBitmap || !frame->brickGroupWriters || !frame->voxelCounts || !frame->brickGroupInfos)
 		{
-			encoder->scratchBufMapBitmap[mapIdxWriteArr] |= (1u << mapIdxWriteBit);
+			_splv_encoder_destroy(encoder);
 
-			encoder->scratchBufBricks[numBricksOrdered] = &frame->bricks[frame->map[mapIdxRead]];
-			encoder->scratchBufBrickPositions[numBricksOrdered] = (SPLVcoordinate){ xMap, yMap, zMap };
-			numBricksOrdered++;
+			SPLV_LOG_ERROR("failed to allocate encoder scratch buffers");
+			return SPLV_ERROR_OUT_OF_MEMORY;
 		}
-		else
-			encoder->scratchBufMapBitmap[mapIdxWriteArr] &= ~(1u << mapIdxWriteBit);
-	}
 
-	//sanity check
-	SPLV_ASSERT(frame->bricksLen == numBricksOrdered, "number of ordered bricks does not match original brick count, sanity check failed");
+		memset(frame->brickGroupWriters, 0, maxBrickGroups * sizeof(SPLVbufferWriter));
+	}
 
-	//encode each brick group:
+	//create thread pool:
 	//---------------
-	uint32_t maxBrickGroupSize;
-	if(encoder->encodingParams.maxBrickGroupSize == 0)
-		maxBrickGroupSize = max(numBricksOrdered, 1);
+	if(options.threadPool)
+		encoder->threadPool = options.threadPool;
 	else
-		maxBrickGroupSize = encoder->encodingParams.maxBrickGroupSize;
+	{
+		SPLVerror threadPoolError = splv_thread_pool_create(
+			&encoder->threadPool, options.numThreads, options.pinThreads, options.firstCpu
+		);
+		if(threadPoolError != SPLV_SUCCESS)
+		{
+			encoder->threadPool = NULL;
+			_splv_encoder_destroy(encoder);
 
-	uint32_t numBrickGroups = (numBricksOrdered + maxBrickGroupSize - 1) / maxBrickGroupSize;
-	uint32_t baseBrickGroupSize      = numBricksOrdered / max(numBrickGroups, 1);
-	uint32_t brickGroupSizeRemainder = numBricksOrdered % max(numBrickGroups, 1);
+			SPLV_LOG_ERROR("failed to create encoder thread pool");
+			return threadPoolError;	
+		}
 
-	for(uint32_t i = 0; i < numBrickGroups; i++)
-	{
-		uint32_t startBrick = i * baseBrickGroupSize + min(i, brickGroupSizeRemainder);
-		uint32_t numBricks = baseBrickGroupSize + (i < brickGroupSizeRemainder ? 1 : 0);
+		encoder->ownsThreadPool = 1;
+	}
 
-		SPLVbrickGroupEncodeInfo encodeInfo;
-		encodeInfo.encoder = encoder;
-		encodeInfo.frame = frame;
-		encodeInfo.frameType = frameType;
-		encodeInfo.numBricks = numBricks;
-		encodeInfo.bricks = &encoder->scratchBufBricks[startBrick];
-		encodeInfo.brickPositions = &encoder->scratchBufBrickPositions[startBrick];
-		encodeInfo.outBuf = &encoder->scratchBufBrickGroupWriters[i];
-		encodeInfo.numVoxels = &encoder->scratchBufVoxelCounts[i];
+	SPLVerror threadPoolGroupError = splv_thread_pool_group_create(
+		&encoder->threadPoolGroup, encoder->threadPool, _splv_encoder_encode_brick_group
+	);
+	if(threadPoolGroupError != SPLV_SUCCESS)
+	{
+		_splv_encoder_destroy(encoder);
 
-		SPLVerror addWorkError = splv_thread_pool_add_work(encoder->threadPool, &encodeInfo);
-		if(addWorkError != SPLV_SUCCESS)
-		{
-			SPLV_LOG_ERROR("failed to add work to thread pool");
-			return addWorkError;
-		}
+		SPLV_LOG_ERROR("failed to create encoder thread pool group");
+		return threadPoolGroupError;
 	}
 
-	//wait for encoding threads:
+	//write empty header (will write over with complete header when encoding is finished):
 	//---------------
-	SPLVerror waitError = splv_thread_pool_wait(encoder->threadPool);
-	if(waitError != SPLV_SUCCESS)
+	SPLVfileHeader emptyHeader = {0};
+	if(fwrite(&emptyHeader, sizeof(SPLVfileHeader), 1, encoder->outFile) < 1)
 	{
-		SPLV_LOG_ERROR("failed to wait on thread pool");
-		return waitError;
+		_splv_encoder_destroy(encoder);
+
+		SPLV_LOG_ERROR("failed to write empty header to output file");
+		return SPLV_ERROR_FILE_WRITE;
 	}
 
-	//get total voxel count:
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_encoder_encode_frame(SPLVencoder* encoder, SPLVframe* frame, splv_bool_t* canFree)
+{
+	SPLV_ASSERT(!encoder->ownsFrames, "splv_encoder_encode_frame() cannot be mixed with splv_encoder_submit_frame()");
+
+	//start encoding:
 	//---------------
-	uint64_t numVoxels = 0;
-	for(uint32_t i = 0; i < numBrickGroups; i++)
-		numVoxels += encoder->scratchBufVoxelCounts[i];
+	SPLV_ERROR_PROPAGATE(_splv_encoder_add_frame(encoder, frame, NULL));
 
-	//write num bricks, num voxels, map:
+	//write finished frames:
 	//---------------
-	if(fwrite(&numBricksOrdered, sizeof(uint32_t), 1, encoder->outFile) < 1)
+	while(encoder->numFramesInFlight >= encoder->maxFramesInFlight)
 	{
-		SPLV_LOG_ERROR("error writing brick count to output file");
-		return SPLV_ERROR_FILE_WRITE;
+		SPLV_ERROR_PROPAGATE(_splv_encoder_write_frame(encoder));
 	}
 
-	if(fwrite(&numVoxels, sizeof(uint64_t), 1, encoder->outFile) < 1)
-	{
-		SPLV_LOG_ERROR("error writing voxel count to output file");
-		return SPLV_ERROR_FILE_WRITE;
-	}
+	//the encoder only references its own copy of the frame
+	*canFree = SPLV_TRUE;
+	return SPLV_SUCCESS;
+}
 
-	if(fwrite(encoder->scratchBufMapBitmap, encoder->mapBitmapLen * sizeof(uint32_t), 1, encoder->outFile) < 1)
-	{
-		SPLV_LOG_ERROR("error writing map bitmap to output file");
-		return SPLV_ERROR_FILE_WRITE;
-	}
+SPLVerror splv_encoder_encode_frame_compact(SPLVencoder* encoder, SPLVframeCompact* frame)
+{
+	SPLV_ASSERT(!encoder->ownsFrames, "splv_encoder_encode_frame_compact() cannot be mixed with splv_encoder_submit_frame()");
 
-	//write encoded groups to output file:
+	//start encoding:
 	//---------------
-	uint64_t curGroupOffset = 0;
+	SPLV_ERROR_PROPAGATE(_splv_encoder_add_frame(encoder, NULL, frame));
 
-	for(uint32_t i = 0; i < numBrickGroups; i++)
+	//write finished frames:
+	//---------------
+	while(encoder->numFramesInFlight >= encoder->maxFramesInFlight)
 	{
-		if(fwrite(&curGroupOffset, sizeof(uint64_t), 1, encoder->outFile) < 1)
-		{
-			SPLV_LOG_ERROR("failed to write group offset to output file");
-			return SPLV_ERROR_FILE_WRITE;
-		}
-
-		uint64_t numVoxelsGroup = encoder->scratchBufVoxelCounts[i];
-		if(fwrite(&numVoxelsGroup, sizeof(uint64_t), 1, encoder->outFile) < 1)
-		{
-			SPLV_LOG_ERROR("failed to write group voxel count to output file");
-			return SPLV_ERROR_FILE_WRITE;
-		}
-
-		curGroupOffset += encoder->scratchBufBrickGroupWriters[i].writePos;
+		SPLV_ERROR_PROPAGATE(_splv_encoder_write_frame(encoder));
 	}
 
-	for(uint32_t i = 0; i < numBrickGroups; i++)
-	{
-		uint8_t* buf  = encoder->scratchBufBrickGroupWriters[i].buf;
-		uint64_t size = encoder->scratchBufBrickGroupWriters[i].writePos;
+	return SPLV_SUCCESS;
+}
 
-		if(fwrite(buf, size, 1, encoder->outFile) < 1)
-		{
-			SPLV_LOG_ERROR("failed to write brick group to output file");
-			return SPLV_ERROR_FILE_WRITE;
-		}
+SPLVerror splv_encoder_submit_frame(SPLVencoder* encoder, SPLVframe* frame)
+{
+	SPLV_ASSERT(encoder->ownsFrames || encoder->frameCount == 0, "splv_encoder_submit_frame() cannot be mixed with splv_encoder_encode_frame()");
 
-		//cleanup
-		splv_buffer_writer_destroy(&encoder->scratchBufBrickGroupWriters[i]);
-	}
+	encoder->ownsFrames = 1;
 
-	//cleanup + return:
+	//start encoding:
 	//---------------
-	encoder->frameCount++;
-	encoder->lastFrame = *frame;
+	SPLV_ERROR_PROPAGATE(_splv_encoder_add_frame(encoder, frame, NULL));
+
+	//write finished frames:
+	//---------------
+	while(encoder->numFramesInFlight >= encoder->maxFramesInFlight)
+	{
+		SPLV_ERROR_PROPAGATE(_splv_encoder_write_frame(encoder));
+	}
 
-	//can only free previous frames if at end of GOP
-	*canFree = (encoder->frameCount % encoder->encodingParams.gopSize) == 0;
 	return SPLV_SUCCESS;
 }
 
 SPLVerror splv_encoder_finish(SPLVencoder* encoder)
 {
+	//write any frames still in flight:
+	//---------------
+	while(encoder->numFramesInFlight > 0)
+	{
+		SPLV_ERROR_PROPAGATE(_splv_encoder_write_frame(encoder));
+	}
+
 	//write frame table:
 	//---------------
 	long frameTablePtr = ftell(encoder->outFile);
@@ -391,45 +371,325 @@ void splv_encoder_abort(SPLVencoder* encoder)
 
 //-------------------------------------------//
 
+static SPLVerror _splv_encoder_add_frame(SPLVencoder* encoder, SPLVframe* frame, SPLVframeCompact* compactFrame)
+{
+	//validate:
+	//---------------
+	uint32_t widthMap  = encoder->width  / SPLV_BRICK_SIZE;
+	uint32_t heightMap = encoder->height / SPLV_BRICK_SIZE;
+	uint32_t depthMap  = encoder->depth  / SPLV_BRICK_SIZE;
+
+	//compactFrame is only given when frames are not owned, as the caller keeps it
+	SPLV_ASSERT((frame == NULL) != (compactFrame == NULL) && (compactFrame == NULL || !encoder->ownsFrames), 
+		"must add exactly one of frame, compactFrame");
+
+	if(frame)
+	{
+		SPLV_ASSERT(widthMap == frame->width && heightMap == frame->height && depthMap == frame->depth,
+			"frame dimensions must match those specified in splv_encoder_create()");
+	}
+	else
+	{
+		SPLV_ASSERT(widthMap == compactFrame->width && heightMap == compactFrame->height && depthMap == compactFrame->depth,
+			"frame dimensions must match those specified in splv_encoder_create()");
+	}
+
+	//wait for a free slot:
+	//---------------
+	if(encoder->numFramesInFlight >= encoder->maxFramesInFlight)
+	{
+		SPLVerror writeError = _splv_encoder_write_frame(encoder);
+		if(writeError != SPLV_SUCCESS)
+		{
+			if(encoder->ownsFrames)
+				splv_frame_destroy(frame);
+
+			return writeError;
+		}
+	}
+
+	//pack frame into the encoder's copy, the copy it replaces was last referenced by a frame that has already been written:
+	//---------------
+	SPLVframeCompact* frameCopy = &encoder->frameCopies[encoder->frameCount % encoder->numFrameCopies];
+
+	SPLVerror copyError;
+	if(compactFrame)
+		copyError = _splv_encoder_copy_frame(frameCopy, compactFrame);
+	else
+		copyError = splv_frame_compact_pack(frame, frameCopy);
+
+	//owned frames are only needed until they are packed
+	if(encoder->ownsFrames)
+		splv_frame_destroy(frame);
+
+	if(copyError != SPLV_SUCCESS)
+	{
+		SPLV_LOG_ERROR("failed to copy frame into encoder frame copy");
+		return copyError;
+	}
+
+	uint32_t slotIdx = (encoder->firstFrameInFlight + encoder->numFramesInFlight) % encoder->maxFramesInFlight;
+	SPLVencoderFrameInFlight* slot = &encoder->framesInFlight[slotIdx];
+
+	//determine frame type:
+	//---------------
+	if(encoder->frameCount % encoder->encodingParams.gopSize == 0)
+		slot->frameType = SPLV_FRAME_ENCODING_TYPE_I;
+	else
+		slot->frameType = SPLV_FRAME_ENCODING_TYPE_P;
+
+	//frames encoded before this one may still be in flight, so we need our own copy of the reference
+	slot->refFrame = encoder->lastFrame;
+
+	//compress map (convert to bitmap), split each tile into brick groups:
+	//---------------
+	uint32_t numBricksOrdered = 0;
+	uint32_t numBrickGroups = 0;
+
+	for(uint32_t tile = 0; tile < encoder->numTiles; tile++)
+	{
+		uint32_t tileStartBrick = numBricksOrdered;
+
+		//we are writing bricks in the encoder's brick order, we MUST make sure to read them back in the same order
+		for(uint32_t i = encoder->tileStarts[tile]; i < encoder->tileStarts[tile + 1]; i++)
+		{
+			uint32_t mapIdx = encoder->brickOrder[i];
+			uint32_t mapIdxArr = mapIdx / 32;
+			uint32_t mapIdxBit = mapIdx % 32;
+			
+			if(frameCopy->map[mapIdx] != SPLV_BRICK_IDX_EMPTY)
+			{
+				slot->mapBitmap[mapIdxArr] |= (1u << mapIdxBit);
+
+				uint32_t xMap = mapIdx % widthMap;
+				uint32_t yMap = (mapIdx / widthMap) % heightMap;
+				uint32_t zMap = mapIdx / (widthMap * heightMap);
+
+				slot->bricks[numBricksOrdered] = &frameCopy->bricks[frameCopy->map[mapIdx]];
+				slot->brickPositions[numBricksOrdered] = (SPLVcoordinate){ xMap, yMap, zMap };
+				slot->brickIndices[mapIdx] = numBricksOrdered;
+				numBricksOrdered++;
+			}
+			else
+			{
+				slot->mapBitmap[mapIdxArr] &= ~(1u << mapIdxBit);
+				slot->brickIndices[mapIdx] = SPLV_BRICK_IDX_EMPTY;
+			}
+		}
+
+		uint32_t tileNumBricks = numBricksOrdered - tileStartBrick;
+		if(tileNumBricks == 0)
+			continue;
+
+		//every position in a tile shares the same tile coordinates, find its bounds from the first:
+		SPLVboundingBox tileBounds = { 0, 0, 0, (int32_t)widthMap - 1, (int32_t)heightMap - 1, (int32_t)depthMap - 1 };
+		uint32_t tileSize = encoder->encodingParams.tileSize;
+		if(tileSize > 0)
+		{
+			SPLVcoordinate tilePos = slot->brickPositions[tileStartBrick];
+			tileBounds.xMin = (int32_t)(tilePos.x / tileSize * tileSize);
+			tileBounds.yMin = (int32_t)(tilePos.y / tileSize * tileSize);
+			tileBounds.zMin = (int32_t)(tilePos.z / tileSize * tileSize);
+			tileBounds.xMax = min(tileBounds.xMin + (int32_t)tileSize, (int32_t)widthMap ) - 1;
+			tileBounds.yMax = min(tileBounds.yMin + (int32_t)tileSize, (int32_t)heightMap) - 1;
+			tileBounds.zMax = min(tileBounds.zMin + (int32_t)tileSize, (int32_t)depthMap ) - 1;
+		}
+
+		uint32_t maxBrickGroupSize;
+		if(encoder->encodingParams.maxBrickGroupSize == 0)
+			maxBrickGroupSize = tileNumBricks;
+		else
+			maxBrickGroupSize = encoder->encodingParams.maxBrickGroupSize;
+
+		uint32_t tileNumBrickGroups = (tileNumBricks + maxBrickGroupSize - 1) / maxBrickGroupSize;
+		uint32_t baseBrickGroupSize      = tileNumBricks / tileNumBrickGroups;
+		uint32_t brickGroupSizeRemainder = tileNumBricks % tileNumBrickGroups;
+
+		for(uint32_t i = 0; i < tileNumBrickGroups; i++)
+		{
+			uint32_t startBrick = tileStartBrick + i * baseBrickGroupSize + min(i, brickGroupSizeRemainder);
+			uint32_t numBricks = baseBrickGroupSize + (i < brickGroupSizeRemainder ? 1 : 0);
+
+			SPLVbrickGroupEncodeInfo* encodeInfo = &slot->brickGroupInfos[numBrickGroups];
+			encodeInfo->encoder = encoder;
+			encodeInfo->frame = slot;
+			encodeInfo->brickStartIdx = startBrick;
+			encodeInfo->numBricks = numBricks;
+			encodeInfo->bricks = &slot->bricks[startBrick];
+			encodeInfo->tileBounds = tileBounds;
+			encodeInfo->brickPositions = &slot->brickPositions[startBrick];
+			encodeInfo->motionVectors = &slot->motionVectors[startBrick];
+			encodeInfo->brickSkipped = &slot->brickSkipped[startBrick];
+			encodeInfo->outBuf = &slot->brickGroupWriters[numBrickGroups];
+			encodeInfo->numVoxels = &slot->voxelCounts[numBrickGroups];
+
+			numBrickGroups++;
+		}
+	}
+
+	//sanity check
+	SPLV_ASSERT(frameCopy->numBricks == numBricksOrdered, "number of ordered bricks does not match original brick count, sanity check failed");
+
+	//encode each brick group:
+	//---------------
+	slot->numBricks = numBricksOrdered;
+	slot->numBrickGroups = numBrickGroups;
+	slot->numBrickGroupsEncoding = numBrickGroups;
+	slot->encodeError = SPLV_SUCCESS;
+
+	slot->frame = *frameCopy;
+
+	encoder->numFramesInFlight++;
+	encoder->frameCount++;
+	encoder->lastFrame = *frameCopy;
+
+	SPLVerror addWorkError = splv_thread_pool_add_work_batch(
+		&encoder->threadPoolGroup, slot->brickGroupInfos, numBrickGroups, sizeof(SPLVbrickGroupEncodeInfo)
+	);
+	if(addWorkError != SPLV_SUCCESS)
+	{
+		//the pool doesn't tell us which groups were submitted, wait for any that were and fail the frame
+		splv_thread_pool_wait(&encoder->threadPoolGroup);
+
+		splv_mutex_lock(&encoder->framesInFlightMutex);
+		slot->numBrickGroupsEncoding = 0;
+		slot->encodeError = addWorkError;
+		splv_mutex_unlock(&encoder->framesInFlightMutex);
+
+		SPLV_LOG_ERROR("failed to add work to thread pool");
+		return addWorkError;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+static SPLVerror _splv_encoder_copy_frame(SPLVframeCompact* dst, SPLVframeCompact* src)
+{
+	//reuses the copy's allocation, so copies stop allocating once they fit the largest frame:
+	//---------------
+	SPLVerror createError = splv_frame_compact_recreate(dst, src->width, src->height, src->depth, src->numBricks, src->numVoxels);
+	if(createError != SPLV_SUCCESS)
+	{
+		SPLV_LOG_ERROR("failed to create encoder frame copy");
+		return createError;
+	}
+
+	//copy, already packed so only filled voxels are copied:
+	//---------------
+	memcpy(dst->map, src->map, src->width * src->height * src->depth * sizeof(uint32_t));
+	memcpy(dst->bricks, src->bricks, src->numBricks * sizeof(SPLVbrickCompact));
+	memcpy(dst->voxels, src->voxels, src->numVoxels * sizeof(uint32_t));
+
+	return SPLV_SUCCESS;
+}
+
 static SPLVerror _splv_encoder_encode_brick_group(void* arg)
 {
-	//get info:
-	//-----------------
 	SPLVbrickGroupEncodeInfo* info = (SPLVbrickGroupEncodeInfo*)arg;
+	SPLVencoder* encoder = info->encoder;
+
+	SPLVerror error = _splv_encoder_encode_brick_group_impl(info);
 
+	//mark group as done:
+	//---------------
+	splv_mutex_lock(&encoder->framesInFlightMutex);
+
+	if(error != SPLV_SUCCESS && info->frame->encodeError == SPLV_SUCCESS)
+		info->frame->encodeError = error;
+
+	info->frame->numBrickGroupsEncoding--;
+	if(info->frame->numBrickGroupsEncoding == 0)
+		splv_condition_variable_signal_all(&encoder->frameEncodedCond);
+
+	splv_mutex_unlock(&encoder->framesInFlightMutex);
+
+	return error;
+}
+
+static SPLVerror _splv_encoder_encode_brick_group_impl(SPLVbrickGroupEncodeInfo* info)
+{
 	//encode bricks:
 	//---------------
-	SPLVbufferWriter brickWriter;
-	SPLVerror brickWriterError = splv_buffer_writer_create(&brickWriter, 0);
-	if(brickWriterError != SPLV_SUCCESS)
-		return brickWriterError;
+	SPLVbufferWriter brickWriters[SPLV_BRICK_STREAM_COUNT] = {0};
+	for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT; i++)
+	{
+		SPLVerror brickWriterError = splv_buffer_writer_create(&brickWriters[i], 0);
+		if(brickWriterError != SPLV_SUCCESS)
+		{
+			_splv_encoder_destroy_brick_writers(brickWriters);
+			return brickWriterError;
+		}
+	}
 
 	*info->numVoxels = 0;
 
+	//the occupancy coder adapts across every brick in the group:
+	SPLVoccupancyEncoder occupancyEncoder;
+	SPLVoccupancyEncoder* occupancy = NULL;
+	if(info->encoder->encodingParams.geometryCoder == SPLV_GEOMETRY_CODER_CONTEXT)
+	{
+		splv_occupancy_encoder_init(&occupancyEncoder);
+		occupancy = &occupancyEncoder;
+	}
+
+	SPLVvoxelOrder voxelOrder = (SPLVvoxelOrder)info->encoder->encodingParams.voxelOrder;
+
+	SPLVmotionSearchParams motionSearch = {0};
+	motionSearch.preset = (SPLVmotionSearchPreset)info->encoder->encodingParams.motionSearchPreset;
+	motionSearch.constrainReference = info->encoder->encodingParams.tileSize > 0;
+	motionSearch.referenceBounds = info->tileBounds;
+
+	SPLVframeCompact* frame = &info->frame->frame;
+	SPLVframeCompact* refFrame = &info->frame->refFrame;
+
+	//bricks are only unpacked while being encoded
+	SPLVbrick brick;
+
 	for(uint32_t i = 0; i < info->numBricks; i++)
 	{
 		SPLVerror brickEncodeError;
 		uint32_t brickNumVoxels;
 
-		if(info->frameType == SPLV_FRAME_ENCODING_TYPE_P)
+		info->brickSkipped[i] = SPLV_FALSE;
+
+		if(info->frame->frameType == SPLV_FRAME_ENCODING_TYPE_P)
 		{
+			//skip bricks that haven't changed since the last frame, before doing any motion search:
 			SPLVcoordinate brickPos = info->brickPositions[i];
-			brickEncodeError = splv_brick_encode_predictive(
-				info->bricks[i], brickPos.x, brickPos.y, brickPos.z, 
-				&brickWriter, &info->encoder->lastFrame, &brickNumVoxels,
-				info->encoder->encodingParams.motionVectors
+
+			uint32_t refBrickIdx = refFrame->map[splv_frame_compact_get_map_idx(refFrame, brickPos.x, brickPos.y, brickPos.z)];
+			if(refBrickIdx != SPLV_BRICK_IDX_EMPTY && 
+			   splv_brick_compact_equals(info->bricks[i], frame->voxels, &refFrame->bricks[refBrickIdx], refFrame->voxels))
+			{
+				info->brickSkipped[i] = SPLV_TRUE;
+				info->motionVectors[i] = (SPLVmotionVector){ 0, 0, 0 };
+				*info->numVoxels += splv_brick_compact_get_num_voxels(info->bricks[i]);
+
+				continue;
+			}
+
+			if(motionSearch.preset == SPLV_MOTION_SEARCH_PRESET_FAST)
+				_splv_encoder_get_motion_predictors(info, i, &motionSearch);
+
+			splv_frame_compact_unpack_brick(frame, (uint32_t)(info->bricks[i] - frame->bricks), &brick);
+			brickEncodeError = splv_brick_encode_predictive_from_compact(
+				&brick, brickPos.x, brickPos.y, brickPos.z, 
+				brickWriters, occupancy, voxelOrder, refFrame, &brickNumVoxels,
+				info->encoder->encodingParams.motionVectors ? &motionSearch : NULL,
+				&info->motionVectors[i]
 			);
 		}
 		else
 		{
+			splv_frame_compact_unpack_brick(frame, (uint32_t)(info->bricks[i] - frame->bricks), &brick);
 			brickEncodeError = splv_brick_encode_intra(
-				info->bricks[i], &brickWriter, &brickNumVoxels
+				&brick, brickWriters, occupancy, voxelOrder, &brickNumVoxels
 			);
 		}
 
 		if(brickEncodeError != SPLV_SUCCESS)
 		{
-			splv_buffer_writer_destroy(&brickWriter);
+			_splv_encoder_destroy_brick_writers(brickWriters);
 
 			SPLV_LOG_ERROR("error encoding brick");
 			return brickEncodeError;
@@ -438,32 +698,244 @@ static SPLVerror _splv_encoder_encode_brick_group(void* arg)
 		*info->numVoxels += brickNumVoxels;
 	}
 
-	//entropy code group:
+	//every encoded brick writes its type to the motion stream, if none were (all skipped) the occupancy stream is left empty
+	if(occupancy && brickWriters[SPLV_BRICK_STREAM_MOTION].writePos > 0)
+	{
+		SPLVerror occupancyError = splv_occupancy_encoder_finish(occupancy, &brickWriters[SPLV_BRICK_STREAM_GEOMETRY]);
+		if(occupancyError != SPLV_SUCCESS)
+		{
+			_splv_encoder_destroy_brick_writers(brickWriters);
+
+			SPLV_LOG_ERROR("error encoding brick occupancy");
+			return occupancyError;
+		}
+	}
+
+	//entropy code each stream, prefixed by their lengths:
 	//---------------
 	SPLVerror encodedWriterError = splv_buffer_writer_create(info->outBuf, 0);
 	if(encodedWriterError != SPLV_SUCCESS)
 	{
-		splv_buffer_writer_destroy(&brickWriter);
+		_splv_encoder_destroy_brick_writers(brickWriters);
 
 		return encodedWriterError;
 	}
 
-	SPLVerror encodeError = splv_rc_encode(
-		brickWriter.writePos, brickWriter.buf, info->outBuf
-	);
+	uint64_t streamLens[SPLV_BRICK_STREAM_COUNT] = {0};
+	SPLVerror encodeError = splv_buffer_writer_write(info->outBuf, sizeof(streamLens), streamLens);
+
+	for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT && encodeError == SPLV_SUCCESS; i++)
+	{
+		uint64_t streamStart = info->outBuf->writePos;
+
+		//empty streams (e.g. no motion vectors in an I-frame) are stored with length 0 and no data
+		if(brickWriters[i].writePos == 0)
+			continue;
+
+		//the occupancy coder's output is already entropy coded
+		if(i == SPLV_BRICK_STREAM_GEOMETRY && occupancy)
+			encodeError = splv_buffer_writer_write(info->outBuf, brickWriters[i].writePos, brickWriters[i].buf);
+		else if(info->encoder->encodingParams.entropyCoder == SPLV_ENTROPY_CODER_RANS)
+			encodeError = splv_rans_encode(brickWriters[i].writePos, brickWriters[i].buf, info->outBuf);
+		else
+			encodeError = splv_rc_encode(brickWriters[i].writePos, brickWriters[i].buf, info->outBuf);
+
+		streamLens[i] = info->outBuf->writePos - streamStart;
+	}
 
 	if(encodeError != SPLV_SUCCESS)
 	{
 		splv_buffer_writer_destroy(info->outBuf);
-		splv_buffer_writer_destroy(&brickWriter);
+		info->outBuf->buf = NULL;
+		_splv_encoder_destroy_brick_writers(brickWriters);
 
-		SPLV_LOG_ERROR("error range coding brick group");
+		SPLV_LOG_ERROR("error entropy coding brick group");
 		return encodeError;
 	}
 
+	memcpy(info->outBuf->buf, streamLens, sizeof(streamLens));
+
 	//cleanup + return:
 	//---------------
-	splv_buffer_writer_destroy(&brickWriter);
+	_splv_encoder_destroy_brick_writers(brickWriters);
+
+	return SPLV_SUCCESS;
+}
+
+static void _splv_encoder_destroy_brick_writers(SPLVbufferWriter* writers)
+{
+	for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT; i++)
+		splv_buffer_writer_destroy(&writers[i]);
+}
+
+static void _splv_encoder_get_motion_predictors(SPLVbrickGroupEncodeInfo* info, uint32_t brickIdx, SPLVmotionSearchParams* params)
+{
+	//only bricks earlier in the same group have their motion vectors yet, and using other groups' would make the output
+	//depend on thread scheduling. Both brick orders place the -z, -y, and -x neighbors before a brick
+	SPLVcoordinate pos = info->brickPositions[brickIdx];
+	params->numPredictors = 0;
+
+	SPLVcoordinate neighbors[3];
+	uint32_t numNeighbors = 0;
+	if(pos.z > 0)
+		neighbors[numNeighbors++] = (SPLVcoordinate){ pos.x, pos.y, pos.z - 1 };
+	if(pos.y > 0)
+		neighbors[numNeighbors++] = (SPLVcoordinate){ pos.x, pos.y - 1, pos.z };
+	if(pos.x > 0)
+		neighbors[numNeighbors++] = (SPLVcoordinate){ pos.x - 1, pos.y, pos.z };
+
+	uint32_t widthMap  = info->encoder->width  / SPLV_BRICK_SIZE;
+	uint32_t heightMap = info->encoder->height / SPLV_BRICK_SIZE;
+
+	splv_bool_t prevIsNeighbor = SPLV_FALSE;
+	for(uint32_t i = 0; i < numNeighbors; i++)
+	{
+		SPLVcoordinate neighbor = neighbors[i];
+		uint32_t neighborIdx = info->frame->brickIndices[neighbor.x + widthMap * (neighbor.y + heightMap * neighbor.z)];
+
+		//empty bricks are SPLV_BRICK_IDX_EMPTY, which is never in range
+		if(neighborIdx < info->brickStartIdx || neighborIdx >= info->brickStartIdx + brickIdx)
+			continue;
+
+		params->predictors[params->numPredictors++] = info->motionVectors[neighborIdx - info->brickStartIdx];
+		if(neighborIdx - info->brickStartIdx == brickIdx - 1)
+			prevIsNeighbor = SPLV_TRUE;
+	}
+
+	//the previous brick is nearby even when it isn't adjacent
+	if(brickIdx > 0 && !prevIsNeighbor)
+		params->predictors[params->numPredictors++] = info->motionVectors[brickIdx - 1];
+}
+
+//-------------------------------------------//
+
+static SPLVerror _splv_encoder_write_frame(SPLVencoder* encoder)
+{
+	SPLVencoderFrameInFlight* frame = &encoder->framesInFlight[encoder->firstFrameInFlight];
+
+	//wait for all groups to finish encoding:
+	//---------------
+	splv_mutex_lock(&encoder->framesInFlightMutex);
+	while(frame->numBrickGroupsEncoding > 0)
+		splv_condition_variable_wait(&encoder->frameEncodedCond, &encoder->framesInFlightMutex);
+	splv_mutex_unlock(&encoder->framesInFlightMutex);
+
+	//remove from ring, the brick group writers are cleaned up regardless of whether we succeed
+	encoder->firstFrameInFlight = (encoder->firstFrameInFlight + 1) % encoder->maxFramesInFlight;
+	encoder->numFramesInFlight--;
+
+	SPLVerror error = frame->encodeError;
+	if(error != SPLV_SUCCESS)
+		SPLV_LOG_ERROR("error encoding frame");
+	else
+		error = _splv_encoder_write_frame_impl(encoder, frame);
+
+	for(uint32_t i = 0; i < frame->numBrickGroups; i++)
+	{
+		if(frame->brickGroupWriters[i].buf)
+			splv_buffer_writer_destroy(&frame->brickGroupWriters[i]);
+	}
+
+	memset(frame->brickGroupWriters, 0, encoder->maxBrickGroups * sizeof(SPLVbufferWriter));
+	frame->numBrickGroups = 0;
+
+	return error;
+}
+
+static SPLVerror _splv_encoder_write_frame_impl(SPLVencoder* encoder, SPLVencoderFrameInFlight* frame)
+{
+	//get frame ptr:
+	//---------------
+	long framePtr = ftell(encoder->outFile);
+	if(framePtr	== -1L)
+	{
+		SPLV_LOG_ERROR("error getting file write position");
+		return SPLV_ERROR_FILE_WRITE;
+	}
+
+	uint64_t frameTableEntry = ((uint64_t)frame->frameType << 56) | (uint64_t)framePtr;
+	SPLV_ERROR_PROPAGATE(splv_dyn_array_uint64_push(&encoder->frameTable, frameTableEntry));
+
+	//get total voxel count:
+	//---------------
+	uint64_t numVoxels = 0;
+	for(uint32_t i = 0; i < frame->numBrickGroups; i++)
+		numVoxels += frame->voxelCounts[i];
+
+	//write num bricks, num voxels, map:
+	//---------------
+	if(fwrite(&frame->numBricks, sizeof(uint32_t), 1, encoder->outFile) < 1)
+	{
+		SPLV_LOG_ERROR("error writing brick count to output file");
+		return SPLV_ERROR_FILE_WRITE;
+	}
+
+	if(fwrite(&numVoxels, sizeof(uint64_t), 1, encoder->outFile) < 1)
+	{
+		SPLV_LOG_ERROR("error writing voxel count to output file");
+		return SPLV_ERROR_FILE_WRITE;
+	}
+
+	if(fwrite(frame->mapBitmap, encoder->mapBitmapLen * sizeof(uint32_t), 1, encoder->outFile) < 1)
+	{
+		SPLV_LOG_ERROR("error writing map bitmap to output file");
+		return SPLV_ERROR_FILE_WRITE;
+	}
+
+	//write skip bitmap:
+	//---------------
+	if(frame->frameType == SPLV_FRAME_ENCODING_TYPE_P && frame->numBricks > 0)
+	{
+		//1 bit per brick, in the same order as the bricks are written
+		uint32_t skipBitmapLen = (frame->numBricks + 31) / 32;
+		memset(frame->skipBitmap, 0, skipBitmapLen * sizeof(uint32_t));
+
+		for(uint32_t i = 0; i < frame->numBricks; i++)
+		{
+			if(frame->brickSkipped[i])
+				frame->skipBitmap[i / 32] |= (1u << (i % 32));
+		}
+
+		if(fwrite(frame->skipBitmap, skipBitmapLen * sizeof(uint32_t), 1, encoder->outFile) < 1)
+		{
+			SPLV_LOG_ERROR("error writing skip bitmap to output file");
+			return SPLV_ERROR_FILE_WRITE;
+		}
+	}
+
+	//write encoded groups to output file:
+	//---------------
+	uint64_t curGroupOffset = 0;
+
+	for(uint32_t i = 0; i < frame->numBrickGroups; i++)
+	{
+		if(fwrite(&curGroupOffset, sizeof(uint64_t), 1, encoder->outFile) < 1)
+		{
+			SPLV_LOG_ERROR("failed to write group offset to output file");
+			return SPLV_ERROR_FILE_WRITE;
+		}
+
+		uint64_t numVoxelsGroup = frame->voxelCounts[i];
+		if(fwrite(&numVoxelsGroup, sizeof(uint64_t), 1, encoder->outFile) < 1)
+		{
+			SPLV_LOG_ERROR("failed to write group voxel count to output file");
+			return SPLV_ERROR_FILE_WRITE;
+		}
+
+		curGroupOffset += frame->brickGroupWriters[i].writePos;
+	}
+
+	for(uint32_t i = 0; i < frame->numBrickGroups; i++)
+	{
+		uint8_t* buf  = frame->brickGroupWriters[i].buf;
+		uint64_t size = frame->brickGroupWriters[i].writePos;
+
+		if(fwrite(buf, size, 1, encoder->outFile) < 1)
+		{
+			SPLV_LOG_ERROR("failed to write brick group to output file");
+			return SPLV_ERROR_FILE_WRITE;
+		}
+	}
 
 	return SPLV_SUCCESS;
 }
@@ -472,19 +944,68 @@ static SPLVerror _splv_encoder_encode_brick_group(void* arg)
 
 static void _splv_encoder_destroy(SPLVencoder* encoder)
 {
-	if(encoder->scratchBufMapBitmap)
-		SPLV_FREE(encoder->scratchBufMapBitmap);
-	if(encoder->scratchBufBricks)
-		SPLV_FREE(encoder->scratchBufBricks);
-	if(encoder->scratchBufBrickPositions)
-		SPLV_FREE(encoder->scratchBufBrickPositions);
-	if(encoder->scratchBufBrickGroupWriters)
-		SPLV_FREE(encoder->scratchBufBrickGroupWriters);
-	if(encoder->scratchBufVoxelCounts)
-		SPLV_FREE(encoder->scratchBufVoxelCounts);
+	splv_thread_pool_group_destroy(&encoder->threadPoolGroup);
+	if(encoder->ownsThreadPool)
+		splv_thread_pool_destroy(encoder->threadPool);
+
+	if(encoder->framesInFlight)
+	{
+		for(uint32_t i = 0; i < encoder->maxFramesInFlight; i++)
+		{
+			SPLVencoderFrameInFlight* frame = &encoder->framesInFlight[i];
+
+			if(frame->brickGroupWriters)
+			{
+				for(uint32_t j = 0; j < frame->numBrickGroups; j++)
+				{
+					if(frame->brickGroupWriters[j].buf)
+						splv_buffer_writer_destroy(&frame->brickGroupWriters[j]);
+				}
+
+				SPLV_FREE(frame->brickGroupWriters);
+			}
+
+			if(frame->mapBitmap)
+				SPLV_FREE(frame->mapBitmap);
+			if(frame->bricks)
+				SPLV_FREE(frame->bricks);
+			if(frame->brickPositions)
+				SPLV_FREE(frame->brickPositions);
+			if(frame->brickIndices)
+				SPLV_FREE(frame->brickIndices);
+			if(frame->motionVectors)
+				SPLV_FREE(frame->motionVectors);
+			if(frame->brickSkipped)
+				SPLV_FREE(frame->brickSkipped);
+			if(frame->skipBitmap)
+				SPLV_FREE(frame->skipBitmap);
+			if(frame->voxelCounts)
+				SPLV_FREE(frame->voxelCounts);
+			if(frame->brickGroupInfos)
+				SPLV_FREE(frame->brickGroupInfos);
+		}
+
+		SPLV_FREE(encoder->framesInFlight);
+
+		splv_mutex_destroy(&encoder->framesInFlightMutex);
+		splv_condition_variable_destroy(&encoder->frameEncodedCond);
+	}
+
+	if(encoder->frameCopies)
+	{
+		for(uint32_t i = 0; i < encoder->numFrameCopies; i++)
+			splv_frame_compact_destroy(&encoder->frameCopies[i]);
+
+		SPLV_FREE(encoder->frameCopies);
+	}
+
+	if(encoder->brickOrder)
+		SPLV_FREE(encoder->brickOrder);
+	if(encoder->tileStarts)
+		SPLV_FREE(encoder->tileStarts);
 
 	if(encoder->outFile)
 		fclose(encoder->outFile);
 
 	splv_dyn_array_uint64_destroy(&encoder->frameTable);
-}
\ No newline at end of file
+}
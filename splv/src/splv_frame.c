@@ -5,7 +5,14 @@
 
 //-------------------------------------------//
 
+static SPLVerror _splv_frame_allocate(SPLVframe* frame, uint32_t numBricksInitial, uint32_t minBricksCap);
+static inline uint64_t _splv_frame_get_map_alloc_size(SPLVframe* frame);
 inline uint8_t _splv_frame_get_voxel(SPLVframe* frame, int32_t x, int32_t y, int32_t z);
+static void _splv_frame_get_brick_order_untiled(uint32_t width, uint32_t height, uint32_t depth, SPLVbrickOrder order, uint32_t* outMapIndices);
+static void _splv_frame_get_brick_order_morton(uint32_t width, uint32_t height, uint32_t depth, uint32_t x, uint32_t y, uint32_t z, uint32_t size,
+                                               uint32_t* outMapIndices, uint32_t* numWritten);
+static void _splv_frame_get_brick_order_tile(uint32_t width, uint32_t height, uint32_t depth, SPLVbrickOrder order, uint32_t tileSize,
+                                             uint32_t xTile, uint32_t yTile, uint32_t zTile, uint32_t* outMapIndices, uint32_t* numWritten);
 
 //-------------------------------------------//
 
@@ -26,43 +33,52 @@ SPLVerror splv_frame_create(SPLVframe* frame, uint32_t width, uint32_t height, u
 
 	//allocate map + bricks:
 	//---------------
-	frame->map = (uint32_t*)SPLV_MALLOC(width * height * depth * sizeof(uint32_t));
+	return _splv_frame_allocate(frame, numBricksInitial, 0);
+}
+
+SPLVerror splv_frame_recreate(SPLVframe* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t numBricksInitial)
+{
+	//validate params:
+	//---------------
+	SPLV_ASSERT(width > 0 && height > 0 && depth > 0, 
+		"frame dimensions must be positive");
+
 	if(!frame->map)
-	{
-		splv_frame_destroy(frame);
+		return splv_frame_create(frame, width, height, depth, numBricksInitial);
 
-		SPLV_LOG_ERROR("failed to allocate frame map");
-		return SPLV_ERROR_OUT_OF_MEMORY;
-	}
+	//reuse existing allocation if it fits:
+	//---------------
+	uint32_t oldMapLen = frame->width * frame->height * frame->depth;
 
-	if(numBricksInitial == 0)
-	{
-		const uint32_t DEFAULT_BRICK_CAP_INITIAL = 16;
-		frame->bricksCap = DEFAULT_BRICK_CAP_INITIAL;
-	}
-	else
-		frame->bricksCap = numBricksInitial + 1;
+	frame->width  = width;
+	frame->height = height;
+	frame->depth  = depth;
 
-	frame->bricks = (SPLVbrick*)SPLV_MALLOC(frame->bricksCap * sizeof(SPLVbrick));
-	if(!frame->bricks)
+	if(width * height * depth == oldMapLen && numBricksInitial < frame->bricksCap)
 	{
-		splv_frame_destroy(frame);
-
-		SPLV_LOG_ERROR("failed tok allocate frame brick array");
-		return SPLV_ERROR_OUT_OF_MEMORY;
+		frame->bricksLen = numBricksInitial;
+		return SPLV_SUCCESS;
 	}
 
-	frame->bricksLen = numBricksInitial;
+	//otherwise reallocate, old contents dont need to be kept:
+	//---------------
+	uint32_t oldBricksCap = frame->bricksCap;
 
-	return SPLV_SUCCESS;
+	SPLV_FREE(frame->map);
+	frame->map = NULL;
+	frame->bricks = NULL;
+
+	//keep the largest capacity seen so far, so frames that grow while being built dont reallocate again
+	return _splv_frame_allocate(frame, numBricksInitial, oldBricksCap);
 }
 
 void splv_frame_destroy(SPLVframe* frame)
 {
+	//the bricks share the map's allocation
 	if(frame->map)
 		SPLV_FREE(frame->map);
-	if(frame->bricks)
-		SPLV_FREE(frame->bricks);
+
+	memset(frame, 0, sizeof(SPLVframe));
 }
 
 inline uint32_t splv_frame_get_map_idx(SPLVframe* frame, uint32_t x, uint32_t y, uint32_t z)
@@ -70,6 +86,87 @@ inline uint32_t splv_frame_get_map_idx(SPLVframe* frame, uint32_t x, uint32_t y,
 	return x + frame->width * (y + frame->height * z);
 }
 
+uint32_t splv_frame_get_num_tiles(uint32_t width, uint32_t height, uint32_t depth, uint32_t tileSize)
+{
+	if(tileSize == 0)
+		return 1;
+
+	uint32_t widthTiles  = (width  + tileSize - 1) / tileSize;
+	uint32_t heightTiles = (height + tileSize - 1) / tileSize;
+	uint32_t depthTiles  = (depth  + tileSize - 1) / tileSize;
+
+	return widthTiles * heightTiles * depthTiles;
+}
+
+void splv_frame_get_brick_order(uint32_t width, uint32_t height, uint32_t depth, SPLVbrickOrder order, uint32_t tileSize, 
+                                uint32_t* outMapIndices, uint32_t* outTileStarts)
+{
+	//an untiled map is a single tile covering all of it
+	if(tileSize == 0)
+	{
+		_splv_frame_get_brick_order_untiled(width, height, depth, order, outMapIndices);
+		if(outTileStarts)
+		{
+			outTileStarts[0] = 0;
+			outTileStarts[1] = width * height * depth;
+		}
+
+		return;
+	}
+
+	uint32_t widthTiles  = (width  + tileSize - 1) / tileSize;
+	uint32_t heightTiles = (height + tileSize - 1) / tileSize;
+	uint32_t depthTiles  = (depth  + tileSize - 1) / tileSize;
+
+	uint32_t numTiles = 0;
+	uint32_t numWritten = 0;
+
+	if(order == SPLV_BRICK_ORDER_MORTON)
+	{
+		uint32_t sizeLog2 = 0;
+		while((1u << sizeLog2) < widthTiles || (1u << sizeLog2) < heightTiles || (1u << sizeLog2) < depthTiles)
+			sizeLog2++;
+
+		//walk every morton code of the enclosing power-of-2 cube, skipping tiles outside the map
+		uint64_t numCodes = 1ull << (3 * sizeLog2);
+		for(uint64_t code = 0; code < numCodes; code++)
+		{
+			uint32_t x = 0, y = 0, z = 0;
+			for(uint32_t i = 0; i < sizeLog2; i++)
+			{
+				x |= (uint32_t)((code >> (3 * i    )) & 1) << i;
+				y |= (uint32_t)((code >> (3 * i + 1)) & 1) << i;
+				z |= (uint32_t)((code >> (3 * i + 2)) & 1) << i;
+			}
+
+			if(x >= widthTiles || y >= heightTiles || z >= depthTiles)
+				continue;
+
+			if(outTileStarts)
+				outTileStarts[numTiles] = numWritten;
+			numTiles++;
+
+			_splv_frame_get_brick_order_tile(width, height, depth, order, tileSize, x, y, z, outMapIndices, &numWritten);
+		}
+	}
+	else
+	{
+		for(uint32_t x = 0; x < widthTiles ; x++)
+		for(uint32_t y = 0; y < heightTiles; y++)
+		for(uint32_t z = 0; z < depthTiles ; z++)
+		{
+			if(outTileStarts)
+				outTileStarts[numTiles] = numWritten;
+			numTiles++;
+
+			_splv_frame_get_brick_order_tile(width, height, depth, order, tileSize, x, y, z, outMapIndices, &numWritten);
+		}
+	}
+
+	if(outTileStarts)
+		outTileStarts[numTiles] = numWritten;
+}
+
 SPLVbrick* splv_frame_get_next_brick(SPLVframe* frame)
 {
 	return &frame->bricks[frame->bricksLen];
@@ -86,16 +183,18 @@ SPLVerror splv_frame_push_next_brick(SPLVframe* frame, uint32_t x, uint32_t y, u
 	if(frame->bricksLen >= frame->bricksCap)
 	{
 		uint32_t newCap = frame->bricksCap * 2;
+		uint64_t mapSize = _splv_frame_get_map_alloc_size(frame);
 
-		SPLVbrick* newBricks = (SPLVbrick*)SPLV_REALLOC(frame->bricks, newCap * sizeof(SPLVbrick));
-		if(!newBricks)
+		uint32_t* newBlock = (uint32_t*)SPLV_REALLOC(frame->map, mapSize + newCap * sizeof(SPLVbrick));
+		if(!newBlock)
 		{
 			SPLV_LOG_ERROR("failed to reallocate frame brick array");
 			return SPLV_ERROR_OUT_OF_MEMORY;
 		}
 
 		frame->bricksCap = newCap;
-		frame->bricks = newBricks;
+		frame->map = newBlock;
+		frame->bricks = (SPLVbrick*)((uint8_t*)newBlock + mapSize);
 	}
 
 	return SPLV_SUCCESS;
@@ -207,6 +306,44 @@ uint64_t splv_frame_get_num_voxels(SPLVframe* frame)
 
 //-------------------------------------------//
 
+static SPLVerror _splv_frame_allocate(SPLVframe* frame, uint32_t numBricksInitial, uint32_t minBricksCap)
+{
+	//the map and bricks are allocated as a single block, so a frame is a single allocation + free
+	if(numBricksInitial == 0)
+	{
+		const uint32_t DEFAULT_BRICK_CAP_INITIAL = 16;
+		frame->bricksCap = DEFAULT_BRICK_CAP_INITIAL;
+	}
+	else
+		frame->bricksCap = numBricksInitial + 1;
+
+	if(frame->bricksCap < minBricksCap)
+		frame->bricksCap = minBricksCap;
+
+	uint64_t mapSize = _splv_frame_get_map_alloc_size(frame);
+
+	frame->map = (uint32_t*)SPLV_MALLOC(mapSize + frame->bricksCap * sizeof(SPLVbrick));
+	if(!frame->map)
+	{
+		splv_frame_destroy(frame);
+
+		SPLV_LOG_ERROR("failed to allocate frame map + bricks");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	frame->bricks = (SPLVbrick*)((uint8_t*)frame->map + mapSize);
+	frame->bricksLen = numBricksInitial;
+
+	return SPLV_SUCCESS;
+}
+
+static inline uint64_t _splv_frame_get_map_alloc_size(SPLVframe* frame)
+{
+	//padded so the bricks following the map start on a cache line
+	uint64_t mapSize = (uint64_t)frame->width * frame->height * frame->depth * sizeof(uint32_t);
+	return (mapSize + 63) & ~(uint64_t)63;
+}
+
 inline uint8_t _splv_frame_get_voxel(SPLVframe* frame, int32_t x, int32_t y, int32_t z)
 {
 	if(x < 0 || x >= (int32_t)frame->width  * SPLV_BRICK_SIZE ||
@@ -228,4 +365,78 @@ inline uint8_t _splv_frame_get_voxel(SPLVframe* frame, int32_t x, int32_t y, int
 	uint32_t zBrick = z % SPLV_BRICK_SIZE;
 
 	return splv_brick_get_voxel(brick, xBrick, yBrick, zBrick) != 0;
-}
\ No newline at end of file
+}
+
+static void _splv_frame_get_brick_order_untiled(uint32_t width, uint32_t height, uint32_t depth, SPLVbrickOrder order, uint32_t* outMapIndices)
+{
+	uint32_t numWritten = 0;
+
+	if(order == SPLV_BRICK_ORDER_MORTON)
+	{
+		uint32_t size = 1;
+		while(size < width || size < height || size < depth)
+			size *= 2;
+
+		_splv_frame_get_brick_order_morton(width, height, depth, 0, 0, 0, size, outMapIndices, &numWritten);
+	}
+	else
+	{
+		for(uint32_t x = 0; x < width ; x++)
+		for(uint32_t y = 0; y < height; y++)
+		for(uint32_t z = 0; z < depth ; z++)
+			outMapIndices[numWritten++] = x + width * (y + height * z);
+	}
+}
+
+static void _splv_frame_get_brick_order_morton(uint32_t width, uint32_t height, uint32_t depth, uint32_t x, uint32_t y, uint32_t z, uint32_t size,
+                                               uint32_t* outMapIndices, uint32_t* numWritten)
+{
+	//visits the octants of the cube at (x, y, z) in morton order, skipping any that lie fully outside the map
+	if(x >= width || y >= height || z >= depth)
+		return;
+
+	if(size == 1)
+	{
+		outMapIndices[(*numWritten)++] = x + width * (y + height * z);
+		return;
+	}
+
+	uint32_t half = size / 2;
+	for(uint32_t i = 0; i < 8; i++)
+	{
+		_splv_frame_get_brick_order_morton(
+			width, height, depth, 
+			x + (i & 1) * half, y + ((i >> 1) & 1) * half, z + ((i >> 2) & 1) * half, half, 
+			outMapIndices, numWritten
+		);
+	}
+}
+
+static void _splv_frame_get_brick_order_tile(uint32_t width, uint32_t height, uint32_t depth, SPLVbrickOrder order, uint32_t tileSize,
+                                             uint32_t xTile, uint32_t yTile, uint32_t zTile, uint32_t* outMapIndices, uint32_t* numWritten)
+{
+	//tiles on the far edges of the map are clipped to it
+	uint32_t xMin = xTile * tileSize;
+	uint32_t yMin = yTile * tileSize;
+	uint32_t zMin = zTile * tileSize;
+
+	uint32_t tileWidth  = width  - xMin < tileSize ? width  - xMin : tileSize;
+	uint32_t tileHeight = height - yMin < tileSize ? height - yMin : tileSize;
+	uint32_t tileDepth  = depth  - zMin < tileSize ? depth  - zMin : tileSize;
+
+	//order the tile as if it were its own map, then convert to indices into the full map
+	uint32_t* tileIndices = &outMapIndices[*numWritten];
+	_splv_frame_get_brick_order_untiled(tileWidth, tileHeight, tileDepth, order, tileIndices);
+
+	uint32_t tileLen = tileWidth * tileHeight * tileDepth;
+	for(uint32_t i = 0; i < tileLen; i++)
+	{
+		uint32_t x = xMin + tileIndices[i] % tileWidth;
+		uint32_t y = yMin + (tileIndices[i] / tileWidth) % tileHeight;
+		uint32_t z = zMin + tileIndices[i] / (tileWidth * tileHeight);
+
+		tileIndices[i] = x + width * (y + height * z);
+	}
+
+	*numWritten += tileLen;
+}
@@ -0,0 +1,317 @@
+#include "spatialstudio/splv_frame_cache.h"
+
+#include "spatialstudio/splv_log.h"
+
+//-------------------------------------------//
+
+static SPLVframeCacheEntry* _splv_frame_cache_find(SPLVframeCache* cache, uint64_t idx);
+static SPLVerror _splv_frame_cache_decode(SPLVframeCache* cache, uint64_t idx, uint64_t playhead);
+static void _splv_frame_cache_evict(SPLVframeCache* cache, uint64_t playhead, uint64_t keepIdx);
+static void _splv_frame_cache_free_entry(SPLVframeCache* cache, SPLVframeCacheEntry* entry);
+
+//-------------------------------------------//
+
+SPLVerror splv_frame_cache_create(SPLVframeCache* cache, SPLVdecoder* decoder, uint64_t memoryBudget)
+{
+	memset(cache, 0, sizeof(SPLVframeCache)); //clear any ptrs to NULL
+
+	cache->decoder = decoder;
+	cache->memoryBudget = memoryBudget;
+
+	return SPLV_SUCCESS;
+}
+
+void splv_frame_cache_destroy(SPLVframeCache* cache)
+{
+	if(cache->entries)
+	{
+		for(uint32_t i = 0; i < cache->numEntries; i++)
+		{
+			splv_frame_compact_destroy(&cache->entries[i]->frame);
+			SPLV_FREE(cache->entries[i]);
+		}
+
+		SPLV_FREE(cache->entries);
+	}
+
+	for(uint32_t i = 0; i < cache->numFreeEntries; i++)
+	{
+		splv_frame_compact_destroy(&cache->freeEntries[i]->frame);
+		SPLV_FREE(cache->freeEntries[i]);
+	}
+
+	splv_frame_destroy(&cache->unpackedFrame);
+
+	cache->entries = NULL;
+	cache->numEntries = 0;
+	cache->maxEntries = 0;
+	cache->numFreeEntries = 0;
+	cache->memoryUsed = 0;
+}
+
+SPLVerror splv_frame_cache_get_frame(SPLVframeCache* cache, uint64_t idx, SPLVframe** frame)
+{
+	SPLVframeCompact* compactFrame;
+	SPLV_ERROR_PROPAGATE(splv_frame_cache_get_frame_compact(cache, idx, &compactFrame));
+
+	//unpack into the cache's own frame, reusing its allocation:
+	//---------------
+	SPLVerror unpackError = splv_frame_compact_unpack(compactFrame, &cache->unpackedFrame);
+	if(unpackError != SPLV_SUCCESS)
+	{
+		SPLV_LOG_ERROR("failed to unpack cached frame");
+		return unpackError;
+	}
+
+	*frame = &cache->unpackedFrame;
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_frame_cache_get_frame_compact(SPLVframeCache* cache, uint64_t idx, SPLVframeCompact** frame)
+{
+	SPLV_ASSERT(idx < cache->decoder->frameCount, "out of bounds frame index");
+
+	//check if already cached:
+	//---------------
+	SPLVframeCacheEntry* entry = _splv_frame_cache_find(cache, idx);
+	if(entry)
+	{
+		*frame = &entry->frame;
+		return SPLV_SUCCESS;
+	}
+
+	//get every frame needed to decode idx:
+	//---------------
+	uint64_t numDependencies;
+	SPLV_ERROR_PROPAGATE(splv_decoder_get_frame_dependencies(cache->decoder, idx, &numDependencies, NULL, 1));
+
+	uint64_t* dependencies = NULL;
+	if(numDependencies > 0)
+	{
+		dependencies = (uint64_t*)SPLV_MALLOC(numDependencies * sizeof(uint64_t));
+		if(!dependencies)
+		{
+			SPLV_LOG_ERROR("failed to allocate frame dependencies");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+
+		SPLVerror dependencyError = splv_decoder_get_frame_dependencies(cache->decoder, idx, &numDependencies, dependencies, 1);
+		if(dependencyError != SPLV_SUCCESS)
+		{
+			SPLV_FREE(dependencies);
+			return dependencyError;
+		}
+	}
+
+	//decode everything after the last cached dependency, in order:
+	//---------------
+	uint64_t start = 0;
+	for(uint64_t i = numDependencies; i > 0; i--)
+	{
+		if(_splv_frame_cache_find(cache, dependencies[i - 1]))
+		{
+			start = i;
+			break;
+		}
+	}
+
+	for(uint64_t i = start; i <= numDependencies; i++)
+	{
+		uint64_t frameIdx = (i < numDependencies) ? dependencies[i] : idx;
+
+		SPLVerror decodeError = _splv_frame_cache_decode(cache, frameIdx, idx);
+		if(decodeError != SPLV_SUCCESS)
+		{
+			if(dependencies)
+				SPLV_FREE(dependencies);
+
+			return decodeError;
+		}
+	}
+
+	if(dependencies)
+		SPLV_FREE(dependencies);
+
+	//return:
+	//---------------
+	entry = _splv_frame_cache_find(cache, idx);
+	SPLV_ASSERT(entry != NULL, "requested frame was evicted from cache");
+
+	*frame = &entry->frame;
+	return SPLV_SUCCESS;
+}
+
+//-------------------------------------------//
+
+static SPLVframeCacheEntry* _splv_frame_cache_find(SPLVframeCache* cache, uint64_t idx)
+{
+	for(uint32_t i = 0; i < cache->numEntries; i++)
+	{
+		if(cache->entries[i]->idx == idx)
+			return cache->entries[i];
+	}
+
+	return NULL;
+}
+
+static SPLVerror _splv_frame_cache_decode(SPLVframeCache* cache, uint64_t idx, uint64_t playhead)
+{
+	//gather direct dependencies, these are always cached since frames are decoded in topological order:
+	//---------------
+	uint64_t numDependencies;
+	SPLV_ERROR_PROPAGATE(splv_decoder_get_frame_dependencies(cache->decoder, idx, &numDependencies, NULL, 0));
+
+	uint64_t* dependencies = NULL;
+	SPLVframeCompactIndexed* indexedFrames = NULL;
+	if(numDependencies > 0)
+	{
+		dependencies = (uint64_t*)SPLV_MALLOC(numDependencies * sizeof(uint64_t));
+		indexedFrames = (SPLVframeCompactIndexed*)SPLV_MALLOC(numDependencies * sizeof(SPLVframeCompactIndexed));
+		if(!dependencies || !indexedFrames)
+		{
+			if(dependencies)
+				SPLV_FREE(dependencies);
+			if(indexedFrames)
+				SPLV_FREE(indexedFrames);
+
+			SPLV_LOG_ERROR("failed to allocate frame dependencies");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+
+		splv_decoder_get_frame_dependencies(cache->decoder, idx, &numDependencies, dependencies, 0);
+		for(uint64_t i = 0; i < numDependencies; i++)
+		{
+			SPLVframeCacheEntry* dependency = _splv_frame_cache_find(cache, dependencies[i]);
+			SPLV_ASSERT(dependency != NULL, "frame dependency was evicted from cache before use");
+
+			indexedFrames[i].index = dependencies[i];
+			indexedFrames[i].frame = &dependency->frame;
+		}
+	}
+
+	//grow entry array if needed:
+	//---------------
+	if(cache->numEntries >= cache->maxEntries)
+	{
+		uint32_t newMaxEntries = cache->maxEntries > 0 ? cache->maxEntries * 2 : 8;
+		SPLVframeCacheEntry** newEntries = (SPLVframeCacheEntry**)SPLV_REALLOC(cache->entries, newMaxEntries * sizeof(SPLVframeCacheEntry*));
+		if(!newEntries)
+		{
+			if(dependencies)
+				SPLV_FREE(dependencies);
+			if(indexedFrames)
+				SPLV_FREE(indexedFrames);
+
+			SPLV_LOG_ERROR("failed to realloc frame cache entries");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+
+		cache->entries = newEntries;
+		cache->maxEntries = newMaxEntries;
+	}
+
+	//decode, reusing an evicted entry's allocation if there is one:
+	//---------------
+	SPLVframeCacheEntry* entry;
+	if(cache->numFreeEntries > 0)
+		entry = cache->freeEntries[--cache->numFreeEntries];
+	else
+	{
+		entry = (SPLVframeCacheEntry*)SPLV_MALLOC(sizeof(SPLVframeCacheEntry));
+		if(!entry)
+		{
+			if(dependencies)
+				SPLV_FREE(dependencies);
+			if(indexedFrames)
+				SPLV_FREE(indexedFrames);
+
+			SPLV_LOG_ERROR("failed to allocate frame cache entry");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+
+		memset(&entry->frame, 0, sizeof(SPLVframeCompact));
+	}
+
+	SPLVerror decodeError = splv_decoder_decode_frame_compact(cache->decoder, idx, numDependencies, indexedFrames, &entry->frame);
+
+	if(dependencies)
+		SPLV_FREE(dependencies);
+	if(indexedFrames)
+		SPLV_FREE(indexedFrames);
+
+	if(decodeError != SPLV_SUCCESS)
+	{
+		_splv_frame_cache_free_entry(cache, entry);
+		return decodeError;
+	}
+
+	//add to cache, evicting if over budget:
+	//---------------
+	entry->idx = idx;
+	entry->gopStart = (uint64_t)splv_decoder_get_prev_i_frame_idx(cache->decoder, idx);
+	entry->size = splv_frame_compact_get_size(&entry->frame);
+
+	cache->entries[cache->numEntries++] = entry;
+	cache->memoryUsed += entry->size;
+
+	_splv_frame_cache_evict(cache, playhead, idx);
+
+	return SPLV_SUCCESS;
+}
+
+static void _splv_frame_cache_evict(SPLVframeCache* cache, uint64_t playhead, uint64_t keepIdx)
+{
+	uint64_t playheadGop = (uint64_t)splv_decoder_get_prev_i_frame_idx(cache->decoder, playhead);
+
+	while(cache->memoryUsed > cache->memoryBudget)
+	{
+		//find frame in the farthest GOP from the playhead, breaking ties by distance from the playhead itself:
+		//---------------
+		int64_t victim = -1;
+		uint64_t victimGopDist = 0;
+		uint64_t victimDist = 0;
+
+		for(uint32_t i = 0; i < cache->numEntries; i++)
+		{
+			SPLVframeCacheEntry* entry = cache->entries[i];
+			if(entry->idx == keepIdx)
+				continue;
+
+			uint64_t gopDist = entry->gopStart > playheadGop ? entry->gopStart - playheadGop : playheadGop - entry->gopStart;
+			uint64_t dist = entry->idx > playhead ? entry->idx - playhead : playhead - entry->idx;
+			if(victim < 0 || gopDist > victimGopDist || (gopDist == victimGopDist && dist > victimDist))
+			{
+				victim = i;
+				victimGopDist = gopDist;
+				victimDist = dist;
+			}
+		}
+
+		if(victim < 0)
+			break;
+
+		//evict:
+		//---------------
+		SPLVframeCacheEntry* entry = cache->entries[victim];
+		cache->memoryUsed -= entry->size;
+
+		_splv_frame_cache_free_entry(cache, entry);
+
+		cache->entries[victim] = cache->entries[cache->numEntries - 1];
+		cache->numEntries--;
+	}
+}
+
+static void _splv_frame_cache_free_entry(SPLVframeCache* cache, SPLVframeCacheEntry* entry)
+{
+	//keep a few entries around so their frames can be decoded into again:
+	//---------------
+	if(cache->numFreeEntries < SPLV_FRAME_CACHE_POOL_SIZE)
+	{
+		cache->freeEntries[cache->numFreeEntries++] = entry;
+		return;
+	}
+
+	splv_frame_compact_destroy(&entry->frame);
+	SPLV_FREE(entry);
+}
@@ -2,64 +2,409 @@
 
 #include "spatialstudio/splv_log.h"
 #include "spatialstudio/splv_global.h"
+#include "splv_simd.h"
+
+//-------------------------------------------//
+
+static SPLVerror _splv_frame_compact_allocate(SPLVframeCompact* frame, uint32_t bricksCap, uint64_t voxelsCap, splv_bool_t keepContents);
+static inline uint8_t _splv_frame_compact_get_voxel(SPLVframeCompact* frame, int32_t x, int32_t y, int32_t z);
+static inline uint64_t _splv_frame_compact_align(uint64_t size);
+static inline uint64_t _splv_brick_compact_bitmap_word64(const uint32_t* bitmap, uint32_t idx);
 
 //-------------------------------------------//
 
 SPLVerror splv_frame_compact_create(SPLVframeCompact* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t numBricks, uint64_t numVoxels)
+{
+	//initialize:
+	//---------------
+	memset(frame, 0, sizeof(SPLVframeCompact)); //clear any ptrs to NULL
+
+	//allocate map, bricks, voxels:
+	//---------------
+	return splv_frame_compact_recreate(frame, width, height, depth, numBricks, numVoxels);
+}
+
+SPLVerror splv_frame_compact_recreate(SPLVframeCompact* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t numBricks, uint64_t numVoxels)
 {
 	//validate params:
 	//---------------
-	SPLV_ASSERT(width > 0 && height > 0 && depth > 0, 
+	SPLV_ASSERT(width > 0 && height > 0 && depth > 0,
 		"frame dimensions must be positive");
 
-	//initialize:
-	//---------------
-	memset(frame, 0, sizeof(SPLVframeCompact)); //clear any ptrs to NULL
+	uint32_t oldMapLen = frame->width * frame->height * frame->depth;
 
 	frame->width  = width;
 	frame->height = height;
 	frame->depth  = depth;
 
-	//allocate map, bricks, voxels:
+	frame->numBricks = numBricks;
+	frame->numVoxels = numVoxels;
+
+	//reuse existing allocation if it fits:
+	//---------------
+	if(frame->map && width * height * depth == oldMapLen && numBricks <= frame->bricksCap && numVoxels <= frame->voxelsCap)
+		return SPLV_SUCCESS;
+
+	//otherwise reallocate, keeping the largest capacities seen so far:
 	//---------------
-	frame->map = (uint32_t*)SPLV_MALLOC(width * height * depth * sizeof(uint32_t));
-	if(!frame->map)
+	uint32_t bricksCap = numBricks > frame->bricksCap ? numBricks : frame->bricksCap;
+	uint64_t voxelsCap = numVoxels > frame->voxelsCap ? numVoxels : frame->voxelsCap;
+
+	return _splv_frame_compact_allocate(frame, bricksCap, voxelsCap, SPLV_FALSE);
+}
+
+void splv_frame_compact_destroy(SPLVframeCompact* frame)
+{
+	//the bricks + voxels share the map's allocation
+	if(frame->map)
+		SPLV_FREE(frame->map);
+
+	memset(frame, 0, sizeof(SPLVframeCompact));
+}
+
+SPLVerror splv_frame_compact_reserve(SPLVframeCompact* frame, uint32_t bricksCap, uint64_t voxelsCap)
+{
+	if(bricksCap <= frame->bricksCap && voxelsCap <= frame->voxelsCap)
+		return SPLV_SUCCESS;
+
+	if(bricksCap < frame->bricksCap)
+		bricksCap = frame->bricksCap;
+	if(voxelsCap < frame->voxelsCap)
+		voxelsCap = frame->voxelsCap;
+
+	return _splv_frame_compact_allocate(frame, bricksCap, voxelsCap, SPLV_TRUE);
+}
+
+inline uint32_t splv_frame_compact_get_map_idx(SPLVframeCompact* frame, uint32_t x, uint32_t y, uint32_t z)
+{
+	return x + frame->width * (y + frame->height * z);
+}
+
+SPLVerror splv_frame_compact_push_brick(SPLVframeCompact* frame, uint32_t x, uint32_t y, uint32_t z, SPLVbrick* brick)
+{
+	SPLV_ASSERT(x < frame->width && y < frame->height && z < frame->depth, "map coordinates out of bounds");
+
+	//grow if needed:
+	//---------------
+	uint32_t numVoxelsBrick = splv_brick_get_num_voxels(brick);
+	if(frame->numVoxels + numVoxelsBrick > UINT32_MAX)
 	{
-		splv_frame_compact_destroy(frame);
+		SPLV_LOG_ERROR("too many voxels to fit in SPLVframeCompact, more than UINT32_MAX");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
 
-		SPLV_LOG_ERROR("failed to allocate frame map");
-		return SPLV_ERROR_OUT_OF_MEMORY;
+	if(frame->numBricks >= frame->bricksCap || frame->numVoxels + numVoxelsBrick > frame->voxelsCap)
+	{
+		const uint32_t DEFAULT_BRICK_CAP_INITIAL = 16;
+
+		uint32_t bricksCap = frame->bricksCap > 0 ? frame->bricksCap : DEFAULT_BRICK_CAP_INITIAL;
+		while(bricksCap <= frame->numBricks)
+			bricksCap *= 2;
+
+		uint64_t voxelsCap = frame->voxelsCap > 0 ? frame->voxelsCap : DEFAULT_BRICK_CAP_INITIAL * SPLV_BRICK_LEN / 8;
+		while(voxelsCap < frame->numVoxels + numVoxelsBrick)
+			voxelsCap *= 2;
+
+		SPLV_ERROR_PROPAGATE(_splv_frame_compact_allocate(frame, bricksCap, voxelsCap, SPLV_TRUE));
 	}
 
-	frame->numBricks = numBricks;
-	frame->bricks = (SPLVbrickCompact*)SPLV_MALLOC(numBricks * sizeof(SPLVbrickCompact));
-	if(!frame->bricks)
+	//pack bitmap + filled voxels' colors:
+	//---------------
+	SPLVbrickCompact* brickCompact = &frame->bricks[frame->numBricks];
+	memcpy(brickCompact->bitmap, brick->bitmap, sizeof(brick->bitmap));
+	brickCompact->voxelsOffset = (uint32_t)frame->numVoxels;
+
+	uint32_t* voxels = &frame->voxels[frame->numVoxels];
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
 	{
-		splv_frame_compact_destroy(frame);
+		uint64_t filled = _splv_brick_compact_bitmap_word64(brick->bitmap, i);
+		while(filled)
+		{
+			*voxels++ = brick->color[64 * i + splv_ctz64(filled)];
+			filled &= filled - 1;
+		}
+	}
 
-		SPLV_LOG_ERROR("failed to allocate frame brick array");
-		return SPLV_ERROR_OUT_OF_MEMORY;
+	//add to map:
+	//---------------
+	frame->map[splv_frame_compact_get_map_idx(frame, x, y, z)] = frame->numBricks;
+
+	frame->numBricks++;
+	frame->numVoxels += numVoxelsBrick;
+
+	return SPLV_SUCCESS;
+}
+
+void splv_frame_compact_unpack_brick(SPLVframeCompact* frame, uint32_t brickIdx, SPLVbrick* out)
+{
+	SPLV_ASSERT(brickIdx < frame->numBricks, "out of bounds brick index");
+
+	SPLVbrickCompact* brick = &frame->bricks[brickIdx];
+	memcpy(out->bitmap, brick->bitmap, sizeof(brick->bitmap));
+
+	//only filled voxels are written, the colors of empty voxels are undefined
+	const uint32_t* voxels = &frame->voxels[brick->voxelsOffset];
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+	{
+		uint64_t filled = _splv_brick_compact_bitmap_word64(brick->bitmap, i);
+		while(filled)
+		{
+			out->color[64 * i + splv_ctz64(filled)] = *voxels++;
+			filled &= filled - 1;
+		}
 	}
+}
 
-	frame->numVoxels = numVoxels;
-	frame->voxels = (uint32_t*)SPLV_MALLOC(numVoxels * sizeof(uint32_t));
-	if(!frame->voxels)
+SPLVerror splv_frame_compact_pack(SPLVframe* frame, SPLVframeCompact* compactFrame)
+{
+	//count voxels, so the compact frame is allocated once:
+	//---------------
+	uint64_t numVoxels = splv_frame_get_num_voxels(frame);
+	if(numVoxels > UINT32_MAX)
 	{
-		splv_frame_compact_destroy(frame);
+		SPLV_LOG_ERROR("too many voxels to fit in SPLVframeCompact, more than UINT32_MAX");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
 
-		SPLV_LOG_ERROR("failed to allocate frame voxel array");
-		return SPLV_ERROR_OUT_OF_MEMORY;
+	SPLV_ERROR_PROPAGATE(splv_frame_compact_recreate(compactFrame, frame->width, frame->height, frame->depth, frame->bricksLen, numVoxels));
+
+	compactFrame->numBricks = 0;
+	compactFrame->numVoxels = 0;
+
+	//pack each brick, in map order:
+	//---------------
+	uint32_t mapLen = frame->width * frame->height * frame->depth;
+	for(uint32_t i = 0; i < mapLen; i++)
+	{
+		if(frame->map[i] == SPLV_BRICK_IDX_EMPTY)
+		{
+			compactFrame->map[i] = SPLV_BRICK_IDX_EMPTY;
+			continue;
+		}
+
+		uint32_t x = i % frame->width;
+		uint32_t y = (i / frame->width) % frame->height;
+		uint32_t z = i / (frame->width * frame->height);
+
+		//capacity was reserved above, this can't fail
+		SPLV_ERROR_PROPAGATE(splv_frame_compact_push_brick(compactFrame, x, y, z, &frame->bricks[frame->map[i]]));
 	}
 
 	return SPLV_SUCCESS;
 }
 
-void splv_frame_compact_destroy(SPLVframeCompact* frame)
+SPLVerror splv_frame_compact_unpack(SPLVframeCompact* compactFrame, SPLVframe* frame)
+{
+	SPLV_ERROR_PROPAGATE(splv_frame_recreate(frame, compactFrame->width, compactFrame->height, compactFrame->depth, compactFrame->numBricks));
+
+	uint32_t mapLen = compactFrame->width * compactFrame->height * compactFrame->depth;
+	memcpy(frame->map, compactFrame->map, mapLen * sizeof(uint32_t));
+
+	for(uint32_t i = 0; i < compactFrame->numBricks; i++)
+		splv_frame_compact_unpack_brick(compactFrame, i, &frame->bricks[i]);
+
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_frame_compact_remove_nonvisible_voxels(SPLVframeCompact* frame, SPLVframeCompact* processedFrame)
+{
+	//NOTE: see splv_frame_remove_nonvisible_voxels(), voxels are considered nonvisible if all 6 of their neighbors are filled
+
+	//create new frame:
+	//---------------
+	SPLV_ERROR_PROPAGATE(splv_frame_compact_create(processedFrame, frame->width, frame->height, frame->depth, 0, 0));
+
+	//add visible voxels to new frame, visiting only filled voxels:
+	//---------------
+	SPLVbrick newBrick;
+
+	for(uint32_t zMap = 0; zMap < frame->depth ; zMap++)
+	for(uint32_t yMap = 0; yMap < frame->height; yMap++)
+	for(uint32_t xMap = 0; xMap < frame->width ; xMap++)
+	{
+		uint32_t mapIdx = splv_frame_compact_get_map_idx(frame, xMap, yMap, zMap);
+
+		processedFrame->map[mapIdx] = SPLV_BRICK_IDX_EMPTY;
+		if(frame->map[mapIdx] == SPLV_BRICK_IDX_EMPTY)
+			continue;
+
+		SPLVbrickCompact* brick = &frame->bricks[frame->map[mapIdx]];
+		const uint32_t* voxels = &frame->voxels[brick->voxelsOffset];
+
+		memset(newBrick.bitmap, 0, sizeof(newBrick.bitmap));
+		uint8_t newBrickEmpty = 1;
+
+		for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+		{
+			uint64_t filled = _splv_brick_compact_bitmap_word64(brick->bitmap, i);
+			while(filled)
+			{
+				uint32_t idx = 64 * i + splv_ctz64(filled);
+				filled &= filled - 1;
+
+				uint32_t color = *voxels++;
+
+				int32_t x = xMap * SPLV_BRICK_SIZE + (idx & (SPLV_BRICK_SIZE - 1));
+				int32_t y = yMap * SPLV_BRICK_SIZE + ((idx >> SPLV_BRICK_SIZE_LOG_2) & (SPLV_BRICK_SIZE - 1));
+				int32_t z = zMap * SPLV_BRICK_SIZE + (idx >> SPLV_BRICK_SIZE_2_LOG_2);
+
+				uint8_t visible = 0;
+				visible = visible || (_splv_frame_compact_get_voxel(frame, x - 1, y, z) == 0);
+				visible = visible || (_splv_frame_compact_get_voxel(frame, x + 1, y, z) == 0);
+				visible = visible || (_splv_frame_compact_get_voxel(frame, x, y - 1, z) == 0);
+				visible = visible || (_splv_frame_compact_get_voxel(frame, x, y + 1, z) == 0);
+				visible = visible || (_splv_frame_compact_get_voxel(frame, x, y, z - 1) == 0);
+				visible = visible || (_splv_frame_compact_get_voxel(frame, x, y, z + 1) == 0);
+
+				if(visible)
+				{
+					newBrick.bitmap[idx / 32] |= 1u << (idx % 32);
+					newBrick.color[idx] = color;
+					newBrickEmpty = 0;
+				}
+			}
+		}
+
+		if(newBrickEmpty)
+			continue;
+
+		SPLVerror pushError = splv_frame_compact_push_brick(processedFrame, xMap, yMap, zMap, &newBrick);
+		if(pushError != SPLV_SUCCESS)
+		{
+			splv_frame_compact_destroy(processedFrame);
+			return pushError;
+		}
+	}
+
+	return SPLV_SUCCESS;
+}
+
+uint64_t splv_frame_compact_get_size(SPLVframeCompact* frame)
+{
+	uint64_t mapSize = frame->width * frame->height * frame->depth * sizeof(uint32_t);
+	uint64_t bricksSize = frame->numBricks * sizeof(SPLVbrickCompact);
+	uint64_t voxelsSize = frame->numVoxels * sizeof(uint32_t);
+
+	return mapSize + bricksSize + voxelsSize;
+}
+
+splv_bool_t splv_brick_compact_get_voxel(SPLVbrickCompact* brick, uint32_t x, uint32_t y, uint32_t z)
+{
+	SPLV_ASSERT(x < SPLV_BRICK_SIZE && y < SPLV_BRICK_SIZE && z < SPLV_BRICK_SIZE, "brick coordinates out of bounds");
+
+	uint32_t idx = x | (y << SPLV_BRICK_SIZE_LOG_2) | (z << SPLV_BRICK_SIZE_2_LOG_2);
+	return (brick->bitmap[idx >> 5] & (1u << (idx & 31))) != 0;
+}
+
+splv_bool_t splv_brick_compact_get_voxel_color(SPLVbrickCompact* brick, const uint32_t* voxels, uint32_t x, uint32_t y, uint32_t z,
+                                               uint8_t* colorR, uint8_t* colorG, uint8_t* colorB)
+{
+	SPLV_ASSERT(x < SPLV_BRICK_SIZE && y < SPLV_BRICK_SIZE && z < SPLV_BRICK_SIZE, "brick coordinates out of bounds");
+
+	uint32_t idx = x | (y << SPLV_BRICK_SIZE_LOG_2) | (z << SPLV_BRICK_SIZE_2_LOG_2);
+	if((brick->bitmap[idx >> 5] & (1u << (idx & 31))) == 0)
+		return SPLV_FALSE;
+
+	uint32_t color = voxels[brick->voxelsOffset + splv_brick_compact_get_voxel_rank(brick, idx)];
+	*colorR = color >> 24;
+	*colorG = (color >> 16) & 0xFF;
+	*colorB = (color >> 8 ) & 0xFF;
+
+	return SPLV_TRUE;
+}
+
+uint32_t splv_brick_compact_get_voxel_rank(SPLVbrickCompact* brick, uint32_t idx)
 {
+	uint32_t rank = 0;
+	for(uint32_t i = 0; i < idx / 64; i++)
+		rank += splv_popcount64(_splv_brick_compact_bitmap_word64(brick->bitmap, i));
+
+	uint64_t below = (1ull << (idx % 64)) - 1;
+	return rank + splv_popcount64(_splv_brick_compact_bitmap_word64(brick->bitmap, idx / 64) & below);
+}
+
+uint32_t splv_brick_compact_get_num_voxels(SPLVbrickCompact* brick)
+{
+	uint32_t numVoxels = 0;
+	for(uint32_t i = 0; i < SPLV_BRICK_LEN / 64; i++)
+		numVoxels += splv_popcount64(_splv_brick_compact_bitmap_word64(brick->bitmap, i));
+
+	return numVoxels;
+}
+
+splv_bool_t splv_brick_compact_equals(SPLVbrickCompact* brick1, const uint32_t* voxels1, SPLVbrickCompact* brick2, const uint32_t* voxels2)
+{
+	if(memcmp(brick1->bitmap, brick2->bitmap, sizeof(brick1->bitmap)) != 0)
+		return SPLV_FALSE;
+
+	//same geometry, so both color runs have the same length + order
+	uint32_t numVoxels = splv_brick_compact_get_num_voxels(brick1);
+	return memcmp(&voxels1[brick1->voxelsOffset], &voxels2[brick2->voxelsOffset], numVoxels * sizeof(uint32_t)) == 0;
+}
+
+//-------------------------------------------//
+
+static SPLVerror _splv_frame_compact_allocate(SPLVframeCompact* frame, uint32_t bricksCap, uint64_t voxelsCap, splv_bool_t keepContents)
+{
+	//map, bricks, and voxels are allocated as a single block, so a frame is a single allocation + free
+	uint64_t mapSize    = _splv_frame_compact_align((uint64_t)frame->width * frame->height * frame->depth * sizeof(uint32_t));
+	uint64_t bricksSize = _splv_frame_compact_align((uint64_t)bricksCap * sizeof(SPLVbrickCompact));
+	uint64_t voxelsSize = voxelsCap * sizeof(uint32_t);
+
+	uint32_t* block = (uint32_t*)SPLV_MALLOC(mapSize + bricksSize + voxelsSize);
+	if(!block)
+	{
+		splv_frame_compact_destroy(frame);
+
+		SPLV_LOG_ERROR("failed to allocate compact frame map, bricks, + voxels");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	SPLVbrickCompact* bricks = (SPLVbrickCompact*)((uint8_t*)block + mapSize);
+	uint32_t* voxels = (uint32_t*)((uint8_t*)block + mapSize + bricksSize);
+
 	if(frame->map)
+	{
+		if(keepContents)
+		{
+			memcpy(block, frame->map, frame->width * frame->height * frame->depth * sizeof(uint32_t));
+			memcpy(bricks, frame->bricks, frame->numBricks * sizeof(SPLVbrickCompact));
+			memcpy(voxels, frame->voxels, frame->numVoxels * sizeof(uint32_t));
+		}
+
 		SPLV_FREE(frame->map);
-	if(frame->bricks)
-		SPLV_FREE(frame->bricks);
-	if(frame->voxels)
-		SPLV_FREE(frame->voxels);
-}
\ No newline at end of file
+	}
+
+	frame->map = block;
+	frame->bricks = bricks;
+	frame->voxels = voxels;
+	frame->bricksCap = bricksCap;
+	frame->voxelsCap = voxelsCap;
+
+	return SPLV_SUCCESS;
+}
+
+static inline uint8_t _splv_frame_compact_get_voxel(SPLVframeCompact* frame, int32_t x, int32_t y, int32_t z)
+{
+	if(x < 0 || x >= (int32_t)frame->width  * SPLV_BRICK_SIZE ||
+	   y < 0 || y >= (int32_t)frame->height * SPLV_BRICK_SIZE ||
+	   z < 0 || z >= (int32_t)frame->depth  * SPLV_BRICK_SIZE)
+		return 0;
+
+	uint32_t mapIdx = splv_frame_compact_get_map_idx(frame, x / SPLV_BRICK_SIZE, y / SPLV_BRICK_SIZE, z / SPLV_BRICK_SIZE);
+	if(frame->map[mapIdx] == SPLV_BRICK_IDX_EMPTY)
+		return 0;
+
+	SPLVbrickCompact* brick = &frame->bricks[frame->map[mapIdx]];
+	return splv_brick_compact_get_voxel(brick, x % SPLV_BRICK_SIZE, y % SPLV_BRICK_SIZE, z % SPLV_BRICK_SIZE);
+}
+
+static inline uint64_t _splv_frame_compact_align(uint64_t size)
+{
+	return (size + 63) & ~(uint64_t)63;
+}
+
+static inline uint64_t _splv_brick_compact_bitmap_word64(const uint32_t* bitmap, uint32_t idx)
+{
+	return (uint64_t)bitmap[2 * idx] | ((uint64_t)bitmap[2 * idx + 1] << 32);
+}
@@ -0,0 +1,56 @@
+#include "spatialstudio/splv_frame_pool.h"
+
+#include "spatialstudio/splv_log.h"
+#include "spatialstudio/splv_global.h"
+
+//-------------------------------------------//
+
+SPLVerror splv_frame_pool_create(SPLVframePool* pool, uint32_t maxFrames)
+{
+	memset(pool, 0, sizeof(SPLVframePool)); //clear any ptrs to NULL
+
+	pool->maxFrames = maxFrames;
+	if(maxFrames == 0)
+		return SPLV_SUCCESS;
+
+	pool->frames = (SPLVframe*)SPLV_MALLOC(maxFrames * sizeof(SPLVframe));
+	if(!pool->frames)
+	{
+		SPLV_LOG_ERROR("failed to allocate frame pool");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+void splv_frame_pool_destroy(SPLVframePool* pool)
+{
+	if(pool->frames)
+	{
+		for(uint32_t i = 0; i < pool->numFrames; i++)
+			splv_frame_destroy(&pool->frames[i]);
+
+		SPLV_FREE(pool->frames);
+	}
+
+	memset(pool, 0, sizeof(SPLVframePool));
+}
+
+void splv_frame_pool_acquire(SPLVframePool* pool, SPLVframe* frame)
+{
+	if(pool->numFrames > 0)
+		*frame = pool->frames[--pool->numFrames];
+	else
+		memset(frame, 0, sizeof(SPLVframe));
+}
+
+void splv_frame_pool_release(SPLVframePool* pool, SPLVframe* frame)
+{
+	if(frame->map && pool->numFrames < pool->maxFrames)
+	{
+		pool->frames[pool->numFrames++] = *frame;
+		memset(frame, 0, sizeof(SPLVframe));
+	}
+	else
+		splv_frame_destroy(frame);
+}
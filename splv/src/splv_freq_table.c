@@ -0,0 +1,175 @@
+#include "splv_freq_table.h"
+
+#include "spatialstudio/splv_log.h"
+#include <string.h>
+
+//----------------------------------------------------------------------//
+
+#define SPLV_FREQ_TABLE_MAX_ZERO_RUN 255
+
+//----------------------------------------------------------------------//
+
+static SPLVerror _splv_varint_write(SPLVbufferWriter* out, uint64_t val);
+static SPLVerror _splv_varint_read(SPLVbufferReader* in, uint64_t* val);
+
+//----------------------------------------------------------------------//
+
+void splv_freq_table_normalize(const uint64_t* counts, uint64_t total, uint32_t scale, uint32_t* frequencies)
+{
+	//scale, every present symbol needs a nonzero frequency:
+	//-----------------
+	uint32_t sum = 0;
+	for(uint32_t i = 0; i < SPLV_FREQ_TABLE_NUM_SYMBOLS; i++)
+	{
+		if(counts[i] == 0)
+			frequencies[i] = 0;
+		else
+		{
+			//counts are bounded by the coders' max symbol counts, so this can't overflow
+			uint64_t scaled = (counts[i] * scale) / total;
+			frequencies[i] = scaled > 0 ? (uint32_t)scaled : 1;
+		}
+
+		sum += frequencies[i];
+	}
+
+	//fix rounding errors, adjusting the most frequent symbols since that costs the least:
+	//-----------------
+	while(sum > scale)
+	{
+		uint32_t largest = 0;
+		for(uint32_t i = 1; i < SPLV_FREQ_TABLE_NUM_SYMBOLS; i++)
+		{
+			if(frequencies[i] > frequencies[largest])
+				largest = i;
+		}
+
+		//excess comes from rounding rare symbols up to 1, so the largest can always give up as many as it needs to
+		uint32_t excess = sum - scale;
+		uint32_t take = frequencies[largest] / 2 < excess ? frequencies[largest] / 2 : excess;
+
+		frequencies[largest] -= take;
+		sum -= take;
+	}
+
+	if(sum < scale)
+	{
+		uint32_t largest = 0;
+		for(uint32_t i = 1; i < SPLV_FREQ_TABLE_NUM_SYMBOLS; i++)
+		{
+			if(frequencies[i] > frequencies[largest])
+				largest = i;
+		}
+
+		frequencies[largest] += scale - sum;
+	}
+}
+
+SPLVerror splv_freq_table_write(SPLVbufferWriter* out, uint64_t numSymbols, const uint32_t* frequencies)
+{
+	SPLV_ERROR_PROPAGATE(_splv_varint_write(out, numSymbols));
+	if(numSymbols == 0)
+		return SPLV_SUCCESS;
+
+	//each frequency is a varint, a 0 is followed by a byte holding the number of additional absent symbols
+	uint32_t i = 0;
+	while(i < SPLV_FREQ_TABLE_NUM_SYMBOLS)
+	{
+		SPLV_ERROR_PROPAGATE(_splv_varint_write(out, frequencies[i]));
+
+		if(frequencies[i] == 0)
+		{
+			uint8_t run = 0;
+			while(i + run + 1 < SPLV_FREQ_TABLE_NUM_SYMBOLS && frequencies[i + run + 1] == 0 && run < SPLV_FREQ_TABLE_MAX_ZERO_RUN)
+				run++;
+
+			SPLV_ERROR_PROPAGATE(splv_buffer_writer_put(out, run));
+			i += run;
+		}
+
+		i++;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_freq_table_read(SPLVbufferReader* in, uint32_t scale, uint64_t* numSymbols, uint32_t* frequencies)
+{
+	SPLV_ERROR_PROPAGATE(_splv_varint_read(in, numSymbols));
+	if(*numSymbols == 0)
+		return SPLV_SUCCESS;
+
+	uint64_t sum = 0;
+
+	uint32_t i = 0;
+	while(i < SPLV_FREQ_TABLE_NUM_SYMBOLS)
+	{
+		uint64_t freq;
+		SPLV_ERROR_PROPAGATE(_splv_varint_read(in, &freq));
+
+		if(freq > scale)
+		{
+			SPLV_LOG_ERROR("frequency larger than table scale, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+
+		frequencies[i] = (uint32_t)freq;
+		sum += freq;
+
+		if(freq == 0)
+		{
+			uint8_t run;
+			SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(uint8_t), &run));
+
+			if(i + run >= SPLV_FREQ_TABLE_NUM_SYMBOLS)
+			{
+				SPLV_LOG_ERROR("frequency table zero run out of bounds, possibly corrupted data");
+				return SPLV_ERROR_INVALID_INPUT;
+			}
+
+			memset(&frequencies[i + 1], 0, run * sizeof(uint32_t));
+			i += run;
+		}
+
+		i++;
+	}
+
+	if(sum != scale)
+	{
+		SPLV_LOG_ERROR("frequencies are not normalized, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+//----------------------------------------------------------------------//
+
+static SPLVerror _splv_varint_write(SPLVbufferWriter* out, uint64_t val)
+{
+	//LEB128, 7 bits per byte with the high bit set on all but the last
+	while(val >= 0x80)
+	{
+		SPLV_ERROR_PROPAGATE(splv_buffer_writer_put(out, (uint8_t)(val | 0x80)));
+		val >>= 7;
+	}
+
+	return splv_buffer_writer_put(out, (uint8_t)val);
+}
+
+static SPLVerror _splv_varint_read(SPLVbufferReader* in, uint64_t* val)
+{
+	*val = 0;
+	for(uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		uint8_t byte;
+		SPLV_ERROR_PROPAGATE(splv_buffer_reader_read(in, sizeof(uint8_t), &byte));
+
+		*val |= (uint64_t)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0)
+			return SPLV_SUCCESS;
+	}
+
+	SPLV_LOG_ERROR("varint too long, possibly corrupted data");
+	return SPLV_ERROR_INVALID_INPUT;
+}
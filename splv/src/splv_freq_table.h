@@ -0,0 +1,37 @@
+/* splv_freq_table.h
+ *
+ * contains the static frequency tables shared by SPLV's entropy coders, and their compact serialization
+ */
+
+#ifndef SPLV_FREQ_TABLE_H
+#define SPLV_FREQ_TABLE_H
+
+#include <stdint.h>
+#include "spatialstudio/splv_error.h"
+#include "spatialstudio/splv_buffer_io.h"
+
+//----------------------------------------------------------------------//
+
+#define SPLV_FREQ_TABLE_NUM_SYMBOLS 256
+
+//----------------------------------------------------------------------//
+
+/**
+ * scales symbol counts to frequencies summing to exactly scale, every symbol that occurs gets a nonzero frequency.
+ * total must be nonzero, and scale must be at least SPLV_FREQ_TABLE_NUM_SYMBOLS
+ */
+void splv_freq_table_normalize(const uint64_t* counts, uint64_t total, uint32_t scale, uint32_t* frequencies);
+
+/**
+ * writes the number of coded symbols followed by their normalized frequencies, as varints with runs of absent symbols
+ * collapsed. The frequencies are omitted if numSymbols is 0
+ */
+SPLVerror splv_freq_table_write(SPLVbufferWriter* out, uint64_t numSymbols, const uint32_t* frequencies);
+
+/**
+ * reads a table written by splv_freq_table_write(), validating that the frequencies sum to scale. If numSymbols is 0,
+ * frequencies is left unmodified
+ */
+SPLVerror splv_freq_table_read(SPLVbufferReader* in, uint32_t scale, uint64_t* numSymbols, uint32_t* frequencies);
+
+#endif //#ifndef SPLV_FREQ_TABLE_H
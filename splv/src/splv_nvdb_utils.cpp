@@ -7,52 +7,26 @@
 
 //-------------------------------------------//
 
-SPLVerror splv_nvdb_load(const char* path, SPLVframe* outFrame, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis)
-{
-	//get size of region:
-	//---------------
-	uint32_t xSize = bbox->xMax - bbox->xMin + 1;
-	uint32_t ySize = bbox->yMax - bbox->yMin + 1;
-	uint32_t zSize = bbox->zMax - bbox->zMin + 1;
+static SPLVerror _splv_nvdb_open(const char* path, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis, 
+                                 uint32_t* widthMap, uint32_t* heightMap, uint32_t* depthMap, nanovdb::GridHandle<>* file, nanovdb::Vec3fGrid** grid);
 
-	uint32_t sizes[3] = {xSize, ySize, zSize};
-	uint32_t width  = sizes[(uint32_t)lrAxis];
-	uint32_t height = sizes[(uint32_t)udAxis];
-	uint32_t depth  = sizes[(uint32_t)fbAxis];
+template<typename AccessorT>
+static bool _splv_nvdb_read_brick(AccessorT& accessor, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis,
+                                  uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbrick* brick);
 
-	//validate:
-	//---------------
-	SPLV_ASSERT(xSize % SPLV_BRICK_SIZE == 0 && ySize % SPLV_BRICK_SIZE == 0 && zSize % SPLV_BRICK_SIZE == 0,
-		"frame dimensions must be a multiple of SPLV_BRICK_SIZE");
-	SPLV_ASSERT(lrAxis != udAxis && lrAxis != fbAxis && udAxis != fbAxis, "axes must be distinct");
+//-------------------------------------------//
 
+SPLVerror splv_nvdb_load(const char* path, SPLVframe* outFrame, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis)
+{
 	//open file:
 	//---------------
+	uint32_t widthMap, heightMap, depthMap;
 	nanovdb::GridHandle file;
 	nanovdb::Vec3fGrid* grid;
-
-	try
-	{
-		file = nanovdb::io::readGrid(path);
-		grid = file.grid<nanovdb::Vec3f>();
-		if(!grid)
-		{
-			SPLV_LOG_ERROR("nvdb file did not contain a vec3f grid");
-			return SPLV_ERROR_INVALID_INPUT;
-		}
-	}
-	catch(std::exception e)
-	{
-		SPLV_LOG_ERROR("failed to open nvdb file");
-		return SPLV_ERROR_FILE_OPEN;
-	}
+	SPLV_ERROR_PROPAGATE(_splv_nvdb_open(path, bbox, lrAxis, udAxis, fbAxis, &widthMap, &heightMap, &depthMap, &file, &grid));
 
 	//initialize map and bricks vector:
 	//---------------
-	uint32_t widthMap  = width  / SPLV_BRICK_SIZE;
-	uint32_t heightMap = height / SPLV_BRICK_SIZE;
-	uint32_t depthMap  = depth  / SPLV_BRICK_SIZE;
-
 	SPLV_ERROR_PROPAGATE(splv_frame_create(outFrame, widthMap, heightMap, depthMap, 0));
 
 	//generate frame:
@@ -64,51 +38,61 @@ SPLVerror splv_nvdb_load(const char* path, SPLVframe* outFrame, SPLVboundingBox*
 	for(uint32_t xMap = 0; xMap < widthMap ; xMap++)
 	{
 		SPLVbrick* brick = splv_frame_get_next_brick(outFrame);
-		bool brickCreated = false;
-
-		for(uint32_t zBrick = 0; zBrick < SPLV_BRICK_SIZE; zBrick++)
-		for(uint32_t yBrick = 0; yBrick < SPLV_BRICK_SIZE; yBrick++)
-		for(uint32_t xBrick = 0; xBrick < SPLV_BRICK_SIZE; xBrick++)
+		if(_splv_nvdb_read_brick(accessor, bbox, lrAxis, udAxis, fbAxis, xMap, yMap, zMap, brick))
 		{
-			int32_t readCoord[3];
-			readCoord[(uint32_t)lrAxis] = xMap * SPLV_BRICK_SIZE + xBrick + bbox->xMin;
-			readCoord[(uint32_t)udAxis] = yMap * SPLV_BRICK_SIZE + yBrick + bbox->yMin;
-			readCoord[(uint32_t)fbAxis] = zMap * SPLV_BRICK_SIZE + zBrick + bbox->zMin;
-
-			nanovdb::Coord readCoordNVDB(
-				readCoord[0], 
-				readCoord[1], 
-				readCoord[2]
-			);
-
-			if(!accessor.isActive(readCoordNVDB))
+			SPLVerror pushError = splv_frame_push_next_brick(outFrame, xMap, yMap, zMap);
+			if(pushError != SPLV_SUCCESS)
 			{
-				splv_brick_set_voxel_empty(brick, xBrick, yBrick, zBrick);
-				continue;
+				splv_frame_destroy(outFrame);
+				return pushError;
 			}
+		}
+		else
+		{
+			uint32_t mapIdx = splv_frame_get_map_idx(outFrame, xMap, yMap, zMap);
+			outFrame->map[mapIdx] = SPLV_BRICK_IDX_EMPTY;
+		}
+	}
 
-			brickCreated = true;
-			
-			nanovdb::Vec3f normColor = accessor.getValue(readCoordNVDB);
-			uint8_t r = (uint8_t)roundf(normColor[0] * 255.0f);
-			uint8_t g = (uint8_t)roundf(normColor[1] * 255.0f);
-			uint8_t b = (uint8_t)roundf(normColor[2] * 255.0f);
+	//return:
+	//---------------
+	return SPLV_SUCCESS;
+}
 
-			splv_brick_set_voxel_filled(brick, xBrick, yBrick, zBrick, r, g, b);
-		}
+SPLVerror splv_nvdb_load_compact(const char* path, SPLVframeCompact* outFrame, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis)
+{
+	//open file:
+	//---------------
+	uint32_t widthMap, heightMap, depthMap;
+	nanovdb::GridHandle file;
+	nanovdb::Vec3fGrid* grid;
+	SPLV_ERROR_PROPAGATE(_splv_nvdb_open(path, bbox, lrAxis, udAxis, fbAxis, &widthMap, &heightMap, &depthMap, &file, &grid));
 
-		if(brickCreated)
+	//initialize map, bricks + voxels grow as they are pushed:
+	//---------------
+	SPLV_ERROR_PROPAGATE(splv_frame_compact_create(outFrame, widthMap, heightMap, depthMap, 0, 0));
+
+	//generate frame, reading each brick to scratch then packing it:
+	//---------------
+	auto accessor = grid->getAccessor();
+	SPLVbrick brick;
+
+	for(uint32_t zMap = 0; zMap < depthMap ; zMap++)
+	for(uint32_t yMap = 0; yMap < heightMap; yMap++)
+	for(uint32_t xMap = 0; xMap < widthMap ; xMap++)
+	{
+		if(_splv_nvdb_read_brick(accessor, bbox, lrAxis, udAxis, fbAxis, xMap, yMap, zMap, &brick))
 		{
-			SPLVerror pushError = splv_frame_push_next_brick(outFrame, xMap, yMap, zMap);
+			SPLVerror pushError = splv_frame_compact_push_brick(outFrame, xMap, yMap, zMap, &brick);
 			if(pushError != SPLV_SUCCESS)
 			{
-				splv_frame_destroy(outFrame);
+				splv_frame_compact_destroy(outFrame);
 				return pushError;
 			}
 		}
 		else
 		{
-			uint32_t mapIdx = splv_frame_get_map_idx(outFrame, xMap, yMap, zMap);
+			uint32_t mapIdx = splv_frame_compact_get_map_idx(outFrame, xMap, yMap, zMap);
 			outFrame->map[mapIdx] = SPLV_BRICK_IDX_EMPTY;
 		}
 	}
@@ -177,4 +161,91 @@ SPLVerror splv_nvdb_save(SPLVframe* frame, const char* outPath)
 	}
 	
 	return SPLV_SUCCESS;
-}
\ No newline at end of file
+}
+
+//-------------------------------------------//
+
+static SPLVerror _splv_nvdb_open(const char* path, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis, 
+                                 uint32_t* widthMap, uint32_t* heightMap, uint32_t* depthMap, nanovdb::GridHandle<>* file, nanovdb::Vec3fGrid** grid)
+{
+	//get size of region:
+	//---------------
+	uint32_t xSize = bbox->xMax - bbox->xMin + 1;
+	uint32_t ySize = bbox->yMax - bbox->yMin + 1;
+	uint32_t zSize = bbox->zMax - bbox->zMin + 1;
+
+	uint32_t sizes[3] = {xSize, ySize, zSize};
+	uint32_t width  = sizes[(uint32_t)lrAxis];
+	uint32_t height = sizes[(uint32_t)udAxis];
+	uint32_t depth  = sizes[(uint32_t)fbAxis];
+
+	//validate:
+	//---------------
+	SPLV_ASSERT(xSize % SPLV_BRICK_SIZE == 0 && ySize % SPLV_BRICK_SIZE == 0 && zSize % SPLV_BRICK_SIZE == 0,
+		"frame dimensions must be a multiple of SPLV_BRICK_SIZE");
+	SPLV_ASSERT(lrAxis != udAxis && lrAxis != fbAxis && udAxis != fbAxis, "axes must be distinct");
+
+	//open file:
+	//---------------
+	try
+	{
+		*file = nanovdb::io::readGrid(path);
+		*grid = file->grid<nanovdb::Vec3f>();
+		if(!*grid)
+		{
+			SPLV_LOG_ERROR("nvdb file did not contain a vec3f grid");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+	}
+	catch(std::exception e)
+	{
+		SPLV_LOG_ERROR("failed to open nvdb file");
+		return SPLV_ERROR_FILE_OPEN;
+	}
+
+	*widthMap  = width  / SPLV_BRICK_SIZE;
+	*heightMap = height / SPLV_BRICK_SIZE;
+	*depthMap  = depth  / SPLV_BRICK_SIZE;
+
+	return SPLV_SUCCESS;
+}
+
+template<typename AccessorT>
+static bool _splv_nvdb_read_brick(AccessorT& accessor, SPLVboundingBox* bbox, SPLVaxis lrAxis, SPLVaxis udAxis, SPLVaxis fbAxis,
+                                  uint32_t xMap, uint32_t yMap, uint32_t zMap, SPLVbrick* brick)
+{
+	bool brickCreated = false;
+
+	for(uint32_t zBrick = 0; zBrick < SPLV_BRICK_SIZE; zBrick++)
+	for(uint32_t yBrick = 0; yBrick < SPLV_BRICK_SIZE; yBrick++)
+	for(uint32_t xBrick = 0; xBrick < SPLV_BRICK_SIZE; xBrick++)
+	{
+		int32_t readCoord[3];
+		readCoord[(uint32_t)lrAxis] = xMap * SPLV_BRICK_SIZE + xBrick + bbox->xMin;
+		readCoord[(uint32_t)udAxis] = yMap * SPLV_BRICK_SIZE + yBrick + bbox->yMin;
+		readCoord[(uint32_t)fbAxis] = zMap * SPLV_BRICK_SIZE + zBrick + bbox->zMin;
+
+		nanovdb::Coord readCoordNVDB(
+			readCoord[0], 
+			readCoord[1], 
+			readCoord[2]
+		);
+
+		if(!accessor.isActive(readCoordNVDB))
+		{
+			splv_brick_set_voxel_empty(brick, xBrick, yBrick, zBrick);
+			continue;
+		}
+
+		brickCreated = true;
+		
+		nanovdb::Vec3f normColor = accessor.getValue(readCoordNVDB);
+		uint8_t r = (uint8_t)roundf(normColor[0] * 255.0f);
+		uint8_t g = (uint8_t)roundf(normColor[1] * 255.0f);
+		uint8_t b = (uint8_t)roundf(normColor[2] * 255.0f);
+
+		splv_brick_set_voxel_filled(brick, xBrick, yBrick, zBrick, r, g, b);
+	}
+
+	return brickCreated;
+}
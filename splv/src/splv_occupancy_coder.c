@@ -0,0 +1,317 @@
+#include "spatialstudio/splv_occupancy_coder.h"
+
+#include "spatialstudio/splv_brick.h"
+#include <string.h>
+
+//----------------------------------------------------------------------//
+
+#define SPLV_OCCUPANCY_PROB_BITS 12
+#define SPLV_OCCUPANCY_PROB_SCALE (1u << SPLV_OCCUPANCY_PROB_BITS)
+#define SPLV_OCCUPANCY_ADAPT_SHIFT 4
+
+#define SPLV_OCCUPANCY_TOP (1u << 24)
+
+#define SPLV_OCCUPANCY_ROW_CONTEXTS_P 8
+#define SPLV_OCCUPANCY_VOXEL_CONTEXTS_P 256
+
+//the context modelling works on whole rows of voxels along x, 1 byte of the bitmap each
+#if SPLV_BRICK_SIZE != 8
+	#error "occupancy coder assumes a brick size of 8"
+#endif
+
+//----------------------------------------------------------------------//
+
+/**
+ * the context of every row in a brick, computed before any of its voxels are coded
+ */
+typedef struct SPLVoccupancyRowContext
+{
+	uint8_t pred; //the predicted row, coded with a single decision if it was right
+	uint32_t rowCtx;
+	uint64_t voxelCtxs; //context of each voxel in the row (excluding its -x neighbor), 1 per byte
+	uint32_t voxelCtxBase;
+} SPLVoccupancyRowContext;
+
+//----------------------------------------------------------------------//
+
+static inline void _splv_occupancy_model_init(SPLVoccupancyModel* model);
+static inline void _splv_occupancy_row_context(const uint32_t* bitmap, const uint32_t* refBitmap, uint32_t y, uint32_t z, SPLVoccupancyRowContext* ctx);
+static inline uint8_t _splv_occupancy_get_row(const uint32_t* bitmap, uint32_t y, uint32_t z);
+static inline uint64_t _splv_occupancy_transpose8(uint64_t x);
+
+static inline SPLVerror _splv_occupancy_encoder_shift_low(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out);
+static inline SPLVerror _splv_occupancy_encoder_encode_bit(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out, uint16_t* prob, uint32_t bit);
+
+static inline uint8_t _splv_occupancy_decoder_read_byte(SPLVoccupancyDecoder* dec);
+static inline uint32_t _splv_occupancy_decoder_decode_bit(SPLVoccupancyDecoder* dec, uint16_t* prob);
+
+//----------------------------------------------------------------------//
+
+void splv_occupancy_encoder_init(SPLVoccupancyEncoder* enc)
+{
+	enc->low = 0;
+	enc->range = 0xFFFFFFFF;
+	enc->cache = 0;
+	enc->cacheSize = 1;
+
+	_splv_occupancy_model_init(&enc->model);
+}
+
+SPLVerror splv_occupancy_encode(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out, const uint32_t* bitmap, const uint32_t* refBitmap)
+{
+	//rows are coded in bitmap order, so the -y and -z neighbors of every row are already known to the decoder
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+	{
+		SPLVoccupancyRowContext ctx;
+		_splv_occupancy_row_context(bitmap, refBitmap, y, z, &ctx);
+
+		uint8_t row = _splv_occupancy_get_row(bitmap, y, z);
+		uint8_t diff = row ^ ctx.pred;
+
+		SPLV_ERROR_PROPAGATE(_splv_occupancy_encoder_encode_bit(enc, out, &enc->model.rows[ctx.rowCtx], diff != 0));
+		if(diff == 0)
+			continue;
+
+		for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+		{
+			//the row is known to differ from the prediction, so if nothing has yet the last voxel must
+			if(x == SPLV_BRICK_SIZE - 1 && (diff & 0x7F) == 0)
+				break;
+
+			uint32_t prevBit = x > 0 ? (row >> (x - 1)) & 1 : 0;
+			uint32_t voxelCtx = ctx.voxelCtxBase + (((uint32_t)(ctx.voxelCtxs >> (8 * x)) & 0xFE) | prevBit);
+
+			SPLV_ERROR_PROPAGATE(_splv_occupancy_encoder_encode_bit(enc, out, &enc->model.voxels[voxelCtx], (row >> x) & 1));
+		}
+	}
+
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_occupancy_encoder_finish(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out)
+{
+	for(uint32_t i = 0; i < 5; i++)
+	{
+		SPLV_ERROR_PROPAGATE(_splv_occupancy_encoder_shift_low(enc, out));
+	}
+
+	return SPLV_SUCCESS;
+}
+
+void splv_occupancy_decoder_init(SPLVoccupancyDecoder* dec, uint64_t inBufLen, const uint8_t* inBuf)
+{
+	dec->inBuf = inBuf;
+	dec->inBufLen = inBufLen;
+	dec->readPos = 0;
+
+	dec->range = 0xFFFFFFFF;
+	dec->code = 0;
+	for(uint32_t i = 0; i < 5; i++)
+		dec->code = (dec->code << 8) | _splv_occupancy_decoder_read_byte(dec);
+
+	_splv_occupancy_model_init(&dec->model);
+}
+
+SPLVerror splv_occupancy_decode(SPLVoccupancyDecoder* dec, const uint32_t* refBitmap, uint32_t* bitmap)
+{
+	memset(bitmap, 0, (SPLV_BRICK_LEN / 32) * sizeof(uint32_t));
+
+	for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+	for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+	{
+		SPLVoccupancyRowContext ctx;
+		_splv_occupancy_row_context(bitmap, refBitmap, y, z, &ctx);
+
+		uint8_t row = ctx.pred;
+		if(_splv_occupancy_decoder_decode_bit(dec, &dec->model.rows[ctx.rowCtx]))
+		{
+			row = 0;
+			for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+			{
+				if(x == SPLV_BRICK_SIZE - 1 && ((row ^ ctx.pred) & 0x7F) == 0)
+				{
+					row |= (~ctx.pred) & 0x80;
+					break;
+				}
+
+				uint32_t prevBit = x > 0 ? (row >> (x - 1)) & 1 : 0;
+				uint32_t voxelCtx = ctx.voxelCtxBase + (((uint32_t)(ctx.voxelCtxs >> (8 * x)) & 0xFE) | prevBit);
+
+				row |= (uint8_t)(_splv_occupancy_decoder_decode_bit(dec, &dec->model.voxels[voxelCtx]) << x);
+			}
+		}
+
+		uint32_t rowIdx = y | (z << SPLV_BRICK_SIZE_LOG_2);
+		bitmap[rowIdx / 4] |= (uint32_t)row << (8 * (rowIdx % 4));
+	}
+
+	//reads past the end return 0 so decoding always terminates, but mean the data was corrupted
+	if(dec->readPos > dec->inBufLen)
+	{
+		SPLV_LOG_ERROR("brick occupancy extends past end of buffer, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	return SPLV_SUCCESS;
+}
+
+//----------------------------------------------------------------------//
+
+static inline void _splv_occupancy_model_init(SPLVoccupancyModel* model)
+{
+	for(uint32_t i = 0; i < SPLV_OCCUPANCY_NUM_ROW_CONTEXTS; i++)
+		model->rows[i] = SPLV_OCCUPANCY_PROB_SCALE / 2;
+
+	for(uint32_t i = 0; i < SPLV_OCCUPANCY_NUM_VOXEL_CONTEXTS; i++)
+		model->voxels[i] = SPLV_OCCUPANCY_PROB_SCALE / 2;
+}
+
+static inline void _splv_occupancy_row_context(const uint32_t* bitmap, const uint32_t* refBitmap, uint32_t y, uint32_t z, SPLVoccupancyRowContext* ctx)
+{
+	//neighbors outside the brick are treated as empty, bricks are coded independently
+	uint8_t up     = y > 0          ? _splv_occupancy_get_row(bitmap, y - 1, z    ) : 0;
+	uint8_t back   = z > 0          ? _splv_occupancy_get_row(bitmap, y,     z - 1) : 0;
+	uint8_t upBack = y > 0 && z > 0 ? _splv_occupancy_get_row(bitmap, y - 1, z - 1) : 0;
+
+	//gather each neighbor as a row aligned with the current one, then transpose so each byte holds a voxel's neighbors.
+	//Byte 0 is left empty for the -x neighbor, which is only known while coding
+	uint64_t planes;
+	if(refBitmap == NULL)
+	{
+		ctx->pred = 0;
+		ctx->rowCtx = (up == 0) | ((back == 0) << 1);
+		ctx->voxelCtxBase = 0;
+
+		planes = ((uint64_t)up                  << 8 ) |
+		         ((uint64_t)back                << 16) |
+		         ((uint64_t)(up >> 1)           << 24) |
+		         ((uint64_t)(back >> 1)         << 32) |
+		         ((uint64_t)(uint8_t)(up << 1)  << 40) |
+		         ((uint64_t)(uint8_t)(back << 1)<< 48) |
+		         ((uint64_t)upBack              << 56);
+	}
+	else
+	{
+		uint8_t ref     = _splv_occupancy_get_row(refBitmap, y, z);
+		uint8_t refUp   = y > 0                    ? _splv_occupancy_get_row(refBitmap, y - 1, z    ) : 0;
+		uint8_t refBack = z > 0                    ? _splv_occupancy_get_row(refBitmap, y,     z - 1) : 0;
+		uint8_t refNext = (y < SPLV_BRICK_SIZE - 1 ? _splv_occupancy_get_row(refBitmap, y + 1, z    ) : 0) |
+		                  (z < SPLV_BRICK_SIZE - 1 ? _splv_occupancy_get_row(refBitmap, y,     z + 1) : 0);
+
+		ctx->pred = ref;
+		ctx->rowCtx = SPLV_OCCUPANCY_ROW_CONTEXTS_P + ((up == refUp) | ((back == refBack) << 1) | ((ref == 0) << 2));
+		ctx->voxelCtxBase = SPLV_OCCUPANCY_VOXEL_CONTEXTS_P;
+
+		planes = ((uint64_t)up                  << 8 ) |
+		         ((uint64_t)back                << 16) |
+		         ((uint64_t)ref                 << 24) |
+		         ((uint64_t)(ref >> 1)          << 32) |
+		         ((uint64_t)(uint8_t)(ref << 1) << 40) |
+		         ((uint64_t)refNext             << 48) |
+		         ((uint64_t)(up >> 1)           << 56);
+	}
+
+	ctx->voxelCtxs = _splv_occupancy_transpose8(planes);
+}
+
+static inline uint8_t _splv_occupancy_get_row(const uint32_t* bitmap, uint32_t y, uint32_t z)
+{
+	uint32_t rowIdx = y | (z << SPLV_BRICK_SIZE_LOG_2);
+	return (uint8_t)(bitmap[rowIdx / 4] >> (8 * (rowIdx % 4)));
+}
+
+static inline uint64_t _splv_occupancy_transpose8(uint64_t x)
+{
+	//transposes an 8x8 bit matrix, byte i bit j -> byte j bit i
+	uint64_t t;
+	t = (x ^ (x >> 7 )) & 0x00AA00AA00AA00AAull; x = x ^ t ^ (t << 7 );
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull; x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull; x = x ^ t ^ (t << 28);
+
+	return x;
+}
+
+//----------------------------------------------------------------------//
+
+static inline SPLVerror _splv_occupancy_encoder_shift_low(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out)
+{
+	//bytes are held back while they could still be changed by a carry
+	if((uint32_t)enc->low < 0xFF000000 || (enc->low >> 32) != 0)
+	{
+		uint8_t carry = (uint8_t)(enc->low >> 32);
+		uint8_t digit = enc->cache;
+		do
+		{
+			SPLV_ERROR_PROPAGATE(splv_buffer_writer_put(out, (uint8_t)(digit + carry)));
+			digit = 0xFF;
+		} while(--enc->cacheSize != 0);
+
+		enc->cache = (uint8_t)(enc->low >> 24);
+	}
+
+	enc->cacheSize++;
+	enc->low = (enc->low & 0x00FFFFFF) << 8;
+
+	return SPLV_SUCCESS;
+}
+
+static inline SPLVerror _splv_occupancy_encoder_encode_bit(SPLVoccupancyEncoder* enc, SPLVbufferWriter* out, uint16_t* prob, uint32_t bit)
+{
+	uint32_t bound = (enc->range >> SPLV_OCCUPANCY_PROB_BITS) * (*prob);
+	if(bit == 0)
+	{
+		enc->range = bound;
+		*prob += (SPLV_OCCUPANCY_PROB_SCALE - *prob) >> SPLV_OCCUPANCY_ADAPT_SHIFT;
+	}
+	else
+	{
+		enc->low += bound;
+		enc->range -= bound;
+		*prob -= *prob >> SPLV_OCCUPANCY_ADAPT_SHIFT;
+	}
+
+	while(enc->range < SPLV_OCCUPANCY_TOP)
+	{
+		enc->range <<= 8;
+		SPLV_ERROR_PROPAGATE(_splv_occupancy_encoder_shift_low(enc, out));
+	}
+
+	return SPLV_SUCCESS;
+}
+
+//----------------------------------------------------------------------//
+
+static inline uint8_t _splv_occupancy_decoder_read_byte(SPLVoccupancyDecoder* dec)
+{
+	uint64_t pos = dec->readPos++;
+	return pos < dec->inBufLen ? dec->inBuf[pos] : 0;
+}
+
+static inline uint32_t _splv_occupancy_decoder_decode_bit(SPLVoccupancyDecoder* dec, uint16_t* prob)
+{
+	uint32_t bit;
+
+	uint32_t bound = (dec->range >> SPLV_OCCUPANCY_PROB_BITS) * (*prob);
+	if(dec->code < bound)
+	{
+		dec->range = bound;
+		*prob += (SPLV_OCCUPANCY_PROB_SCALE - *prob) >> SPLV_OCCUPANCY_ADAPT_SHIFT;
+		bit = 0;
+	}
+	else
+	{
+		dec->code -= bound;
+		dec->range -= bound;
+		*prob -= *prob >> SPLV_OCCUPANCY_ADAPT_SHIFT;
+		bit = 1;
+	}
+
+	while(dec->range < SPLV_OCCUPANCY_TOP)
+	{
+		dec->range <<= 8;
+		dec->code = (dec->code << 8) | _splv_occupancy_decoder_read_byte(dec);
+	}
+
+	return bit;
+}
@@ -1,6 +1,7 @@
 #include "spatialstudio/splv_range_coder.h"
 
 #include "spatialstudio/splv_log.h"
+#include "splv_freq_table.h"
 #include <string.h>
 
 //----------------------------------------------------------------------//
@@ -17,9 +18,12 @@
 #define SPLV_RC_NORM_SHIFT (SPLV_RC_STATE_BITS - SPLV_RC_NUM_DIGIT_BITS)
 #define SPLV_RC_NORM_MASK ((1ull << SPLV_RC_NORM_SHIFT) - 1)
 
-#define SPLV_RC_NUM_SYMBOLS 257 //256 possible bytes + EOF
+#define SPLV_RC_NUM_SYMBOLS 257 //256 possible bytes + EOF, EOF is only used by legacy streams
 #define SPLV_RC_EOF 256
 
+//frequencies are normalized to this total, so they can be stored compactly
+#define SPLV_RC_PROB_SCALE (1u << 16)
+
 //----------------------------------------------------------------------//
 
 typedef struct SPLVrcFreqTable
@@ -34,8 +38,6 @@ typedef struct SPLVrcEncoder
 {
 	uint64_t low;
 	uint64_t range;
-
-	uint64_t startWriteIdx;
 } SPLVrcEncoder;
 
 typedef struct SPLVrcDecoder
@@ -54,13 +56,12 @@ static inline void _splv_rc_freq_table_init(SPLVrcFreqTable* table);
 static inline void _splv_rc_freq_table_calculate_cdf(SPLVrcFreqTable* table);
 
 static inline void _splv_rc_encoder_init(SPLVrcEncoder* enc);
-static inline SPLVerror _splv_rc_encoder_start(SPLVrcEncoder* enc, SPLVbufferWriter* out);
 static inline SPLVerror _splv_rc_encoder_encode(SPLVrcEncoder* enc, SPLVrcFreqTable* table, SPLVbufferWriter* out, uint32_t symbol);
 static inline SPLVerror _splv_rc_encoder_finish(SPLVrcEncoder* enc, SPLVbufferWriter* out);
 
 static inline void _splv_rc_decoder_init(SPLVrcDecoder* dec);
 static inline uint8_t _splv_rc_decoder_read_digit(SPLVrcDecoder* dec, uint8_t* inBuf);
-static inline SPLVerror _splv_rc_decoder_start(SPLVrcDecoder* dec, uint64_t inBufLen, uint8_t** inBuf);
+static inline void _splv_rc_decoder_start(SPLVrcDecoder* dec, uint64_t inBufLen, uint8_t* inBuf);
 static inline uint32_t _splv_rc_decoder_decode(SPLVrcDecoder* dec, SPLVrcFreqTable* table, uint8_t* inBuf);
 
 //----------------------------------------------------------------------//
@@ -75,45 +76,95 @@ SPLVerror splv_rc_encode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* ou
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
+	if(inBufLen == 0)
+		return splv_freq_table_write(out, 0, NULL);
+
 	//generate frequency table:
 	//-----------------
+	uint64_t counts[SPLV_FREQ_TABLE_NUM_SYMBOLS] = {0};
+	for(uint64_t i = 0; i < inBufLen; i++)
+		counts[inBuf[i]]++;
+
 	SPLVrcFreqTable table;
 	_splv_rc_freq_table_init(&table);
 
-	for(uint32_t i = 0; i < inBufLen; i++)
-	{
-		uint8_t symbol = inBuf[i];
-		table.frequencies[symbol]++;
-	}
-	
-	table.frequencies[SPLV_RC_EOF] = 1;
-
+	splv_freq_table_normalize(counts, inBufLen, SPLV_RC_PROB_SCALE, table.frequencies);
 	_splv_rc_freq_table_calculate_cdf(&table);
 
-	//write frequency table:
+	//write symbol count + frequency table:
 	//-----------------
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, SPLV_RC_NUM_SYMBOLS * sizeof(uint32_t), table.frequencies));
+
+	//the decoder knows how many symbols to read, so no EOF is needed
+	SPLV_ERROR_PROPAGATE(splv_freq_table_write(out, inBufLen, table.frequencies));
 
 	//encode:
 	//-----------------
 	SPLVrcEncoder enc;
 	_splv_rc_encoder_init(&enc);
 
-	SPLV_ERROR_PROPAGATE(_splv_rc_encoder_start(&enc, out));
-
-	for(uint32_t i = 0; i < inBufLen; i++)
+	for(uint64_t i = 0; i < inBufLen; i++)
 	{
 		uint32_t symbol = (uint32_t)inBuf[i];
 		SPLV_ERROR_PROPAGATE(_splv_rc_encoder_encode(&enc, &table, out, symbol));
 	}
 
-	SPLV_ERROR_PROPAGATE(_splv_rc_encoder_encode(&enc, &table, out, SPLV_RC_EOF));
 	SPLV_ERROR_PROPAGATE(_splv_rc_encoder_finish(&enc, out));
 
 	return SPLV_SUCCESS;
 }
 
 SPLVerror splv_rc_decode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out)
+{
+	//read symbol count + frequency table:
+	//-----------------
+	SPLVbufferReader in;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_create(&in, inBuf, inBufLen));
+
+	uint64_t numSymbols;
+	SPLVrcFreqTable table;
+	_splv_rc_freq_table_init(&table);
+
+	SPLV_ERROR_PROPAGATE(splv_freq_table_read(&in, SPLV_RC_PROB_SCALE, &numSymbols, table.frequencies));
+
+	if(numSymbols == 0)
+		return SPLV_SUCCESS;
+
+	if(numSymbols > SPLV_RC_MAX_SYMBOLS)
+	{
+		SPLV_LOG_ERROR("data is too large to decode, must have size less than SPLV_RC_MAX_SYMBOLS");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	_splv_rc_freq_table_calculate_cdf(&table);
+
+	//decompress:
+	//-----------------
+	SPLVrcDecoder dec;
+	_splv_rc_decoder_init(&dec);
+	_splv_rc_decoder_start(&dec, inBufLen - in.readPos, inBuf + in.readPos);
+
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_reserve(out, numSymbols));
+
+	uint8_t* outBuf = out->buf + out->writePos;
+	for(uint64_t i = 0; i < numSymbols; i++)
+	{
+		//EOF has frequency 0, so it is only decoded from corrupted data
+		uint32_t symbol = _splv_rc_decoder_decode(&dec, &table, inBuf + in.readPos);
+		if(symbol == SPLV_RC_EOF)
+		{
+			SPLV_LOG_ERROR("invalid symbol decoded, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+
+		outBuf[i] = (uint8_t)symbol;
+	}
+
+	out->writePos += numSymbols;
+
+	return SPLV_SUCCESS;
+}
+
+SPLVerror splv_rc_decode_legacy(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out)
 {
 	//read frequency table:
 	//-----------------
@@ -137,22 +188,57 @@ SPLVerror splv_rc_decode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* ou
 		return SPLV_ERROR_INVALID_INPUT;
 	}
 
+	//the encoder always codes exactly 1 EOF, so the decoded size is known up front:
+	if(table.frequencies[SPLV_RC_EOF] != 1)
+	{
+		SPLV_LOG_ERROR("invalid EOF frequency, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	uint64_t numSymbols = table.total - 1;
+
+	//read size, legacy streams are prefixed by it:
+	//-----------------
+	uint64_t totalBytes;
+	if(inBufLen < sizeof(uint64_t))
+	{
+		SPLV_LOG_ERROR("in buffer not large enough to hold neccesary metadata for decoding");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	memcpy(&totalBytes, inBuf, sizeof(uint64_t));
+	inBuf += sizeof(uint64_t);
+	inBufLen -= sizeof(uint64_t);
+
+	if(inBufLen < totalBytes)
+	{
+		SPLV_LOG_ERROR("in buffer not large enough to hold all encoded data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
 	//decompress:
 	//-----------------
 	SPLVrcDecoder dec;
 	_splv_rc_decoder_init(&dec);
-	
-	SPLV_ERROR_PROPAGATE(_splv_rc_decoder_start(&dec, inBufLen, &inBuf));
+	_splv_rc_decoder_start(&dec, totalBytes, inBuf);
+
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_reserve(out, numSymbols));
 
-	while(1)
+	uint8_t* outBuf = out->buf + out->writePos;
+	for(uint64_t i = 0; i < numSymbols; i++)
 	{
 		uint32_t symbol = _splv_rc_decoder_decode(&dec, &table, inBuf);
 		if(symbol == SPLV_RC_EOF)
-			break;
+		{
+			SPLV_LOG_ERROR("unexpected EOF, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
 
-		splv_buffer_writer_put(out, (uint8_t)symbol);
+		outBuf[i] = (uint8_t)symbol;
 	}
 
+	out->writePos += numSymbols;
+
 	return SPLV_SUCCESS;
 }
 
@@ -185,17 +271,6 @@ static inline void _splv_rc_encoder_init(SPLVrcEncoder* enc)
 {
 	enc->low = 0;
 	enc->range = SPLV_RC_MAX_RANGE;
-	enc->startWriteIdx = 0;
-}
-
-static inline SPLVerror _splv_rc_encoder_start(SPLVrcEncoder* enc, SPLVbufferWriter* out)
-{
-	enc->startWriteIdx = out->writePos;
-
-	uint64_t dummySize = 0;
-	SPLV_ERROR_PROPAGATE(splv_buffer_writer_write(out, sizeof(uint64_t), &dummySize));
-
-	return SPLV_SUCCESS;
 }
 
 static inline SPLVerror _splv_rc_encoder_encode(SPLVrcEncoder* enc, SPLVrcFreqTable* table, SPLVbufferWriter* out, uint32_t symbol)
@@ -259,13 +334,6 @@ static inline SPLVerror _splv_rc_encoder_finish(SPLVrcEncoder* enc, SPLVbufferWr
 		code = (code << SPLV_RC_NUM_DIGIT_BITS) & SPLV_RC_STATE_MASK;
 	}
 
-	//write total compressed size:
-	//---------------
-	uint64_t curPos = out->writePos;
-	uint64_t size = curPos - enc->startWriteIdx - sizeof(uint64_t);
-
-	memcpy(&out->buf[enc->startWriteIdx], &size, sizeof(uint64_t));
-
 	return SPLV_SUCCESS;
 }
 
@@ -288,38 +356,19 @@ static inline uint8_t _splv_rc_decoder_read_digit(SPLVrcDecoder* dec, uint8_t* i
 	return (uint8_t)inBuf[dec->bytesRead++];
 }
 
-static inline SPLVerror _splv_rc_decoder_start(SPLVrcDecoder* dec, uint64_t inBufLen, uint8_t** inBuf)
+static inline void _splv_rc_decoder_start(SPLVrcDecoder* dec, uint64_t inBufLen, uint8_t* inBuf)
 {
-	//read total bytes:
-	//---------------
-	if(inBufLen < sizeof(uint64_t))
-	{
-		SPLV_LOG_ERROR("in buffer not large enough to hold neccesary metadata for decoding");
-		return SPLV_ERROR_INVALID_INPUT;
-	}
-
-	memcpy(&dec->totalBytes, *inBuf, sizeof(uint64_t));
-	*inBuf += sizeof(uint64_t);
-
-	//validate inbuf is large enough:
-	//---------------
-	if(inBufLen - sizeof(uint64_t) < dec->totalBytes)
-	{
-		SPLV_LOG_ERROR("in buffer not large enough to hold all encoded data");
-		return SPLV_ERROR_OUT_OF_MEMORY;
-	}
+	dec->totalBytes = inBufLen;
 
 	//fill code with initial digits:
 	//---------------
 	dec->code = 0;
 	for(int i = 0; i < SPLV_RC_STATE_BITS / SPLV_RC_NUM_DIGIT_BITS; i++)
 	{
-		uint8_t digit = _splv_rc_decoder_read_digit(dec, *inBuf);
+		uint8_t digit = _splv_rc_decoder_read_digit(dec, inBuf);
 			
 		dec->code = (dec->code << SPLV_RC_NUM_DIGIT_BITS) | digit;
 	}
-
-	return SPLV_SUCCESS;
 }
 
 static inline uint32_t _splv_rc_decoder_decode(SPLVrcDecoder* dec, SPLVrcFreqTable* table, uint8_t* inBuf)
@@ -354,6 +403,10 @@ static inline uint32_t _splv_rc_decoder_decode(SPLVrcDecoder* dec, SPLVrcFreqTab
 	uint32_t symHigh = table->cumulative[symbol + 1];
 	uint32_t symFreq = symHigh - symLow;
 
+	//only reachable with corrupted data, the interval would collapse and never renormalize
+	if(symFreq == 0)
+		return SPLV_RC_EOF;
+
 	//update interval:
 	//---------------
 	uint64_t newLow = dec->low + (symLow * dec->range) / table->total;
@@ -0,0 +1,299 @@
+#include "spatialstudio/splv_rans.h"
+
+#include "spatialstudio/splv_log.h"
+#include "splv_freq_table.h"
+#include "spatialstudio/splv_global.h"
+#include <string.h>
+
+//----------------------------------------------------------------------//
+
+#define SPLV_RANS_NUM_SYMBOLS SPLV_FREQ_TABLE_NUM_SYMBOLS
+
+#define SPLV_RANS_PROB_BITS 12
+#define SPLV_RANS_PROB_SCALE (1u << SPLV_RANS_PROB_BITS)
+
+//states are kept in [STATE_LOW, STATE_LOW << WORD_BITS), and renormalized a 16-bit word at a time
+#define SPLV_RANS_WORD_BITS 16
+#define SPLV_RANS_STATE_LOW (1u << 16)
+
+//the decoded size is stored in the stream and reserved up front, so it must be bounded to reject corrupted sizes
+#define SPLV_RANS_MAX_SYMBOLS ((1ull << 24) - 1)
+
+//consecutive symbols are coded with independent states, so the decoder's dependency chains can overlap
+#define SPLV_RANS_NUM_LANES 4
+
+//----------------------------------------------------------------------//
+
+typedef struct SPLVransTable
+{
+	uint32_t frequencies[SPLV_RANS_NUM_SYMBOLS];
+	uint32_t cumulative[SPLV_RANS_NUM_SYMBOLS + 1];
+} SPLVransTable;
+
+//everything needed to decode from a given slot in [0, PROB_SCALE), packed as symbol | frequency << 8 | (slot - cumulative) << 20.
+//frequencies must be < PROB_SCALE to fit, the decoder handles streams of a single symbol separately
+typedef uint32_t SPLVransDecodeEntry;
+
+//----------------------------------------------------------------------//
+
+static void _splv_rans_table_calculate_cdf(SPLVransTable* table);
+
+static inline uint8_t _splv_rans_decode_symbol(const SPLVransDecodeEntry* entries, uint32_t* state);
+static inline void _splv_rans_renormalize(uint32_t* state, const uint8_t* words, uint64_t* wordIdx);
+static inline SPLVerror _splv_rans_renormalize_checked(uint32_t* state, const uint8_t* words, uint64_t numWords, uint64_t* wordIdx);
+
+//----------------------------------------------------------------------//
+
+SPLVerror splv_rans_encode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out)
+{
+	//validate:
+	//-----------------
+	if(inBufLen > SPLV_RANS_MAX_SYMBOLS)
+	{
+		SPLV_LOG_ERROR("data is too large to encode, must have size less than SPLV_RANS_MAX_SYMBOLS");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	if(inBufLen == 0)
+		return splv_freq_table_write(out, 0, NULL);
+
+	//generate frequency table:
+	//-----------------
+	uint64_t counts[SPLV_RANS_NUM_SYMBOLS] = {0};
+	for(uint64_t i = 0; i < inBufLen; i++)
+		counts[inBuf[i]]++;
+
+	SPLVransTable table;
+	splv_freq_table_normalize(counts, inBufLen, SPLV_RANS_PROB_SCALE, table.frequencies);
+	_splv_rans_table_calculate_cdf(&table);
+
+	//write symbol count + frequency table:
+	//-----------------
+	SPLV_ERROR_PROPAGATE(splv_freq_table_write(out, inBufLen, table.frequencies));
+
+	//encode:
+	//-----------------
+
+	//rANS is LIFO, so we encode backwards into a scratch buffer, the decoder can then read forwards.
+	//each symbol emits at most 1 word
+	uint64_t maxWords = inBufLen + 2 * SPLV_RANS_NUM_LANES;
+	uint16_t* words = (uint16_t*)SPLV_MALLOC(maxWords * sizeof(uint16_t));
+	if(!words)
+	{
+		SPLV_LOG_ERROR("failed to allocate rANS scratch buffer");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	uint16_t* wordsStart = words + maxWords;
+
+	uint32_t states[SPLV_RANS_NUM_LANES];
+	for(uint32_t i = 0; i < SPLV_RANS_NUM_LANES; i++)
+		states[i] = SPLV_RANS_STATE_LOW;
+
+	for(uint64_t i = inBufLen; i > 0; i--)
+	{
+		uint8_t symbol = inBuf[i - 1];
+		uint32_t* state = &states[(i - 1) % SPLV_RANS_NUM_LANES];
+
+		uint32_t freq = table.frequencies[symbol];
+		uint64_t maxState = ((uint64_t)(SPLV_RANS_STATE_LOW >> SPLV_RANS_PROB_BITS) << SPLV_RANS_WORD_BITS) * freq;
+		if(*state >= maxState)
+		{
+			*--wordsStart = (uint16_t)*state;
+			*state >>= SPLV_RANS_WORD_BITS;
+		}
+
+		*state = ((*state / freq) << SPLV_RANS_PROB_BITS) + (*state % freq) + table.cumulative[symbol];
+	}
+
+	//flush final states, so the decoder reads lane 0 first:
+	for(int32_t i = SPLV_RANS_NUM_LANES - 1; i >= 0; i--)
+	{
+		*--wordsStart = (uint16_t)(states[i] >> SPLV_RANS_WORD_BITS);
+		*--wordsStart = (uint16_t)states[i];
+	}
+
+	//write:
+	//-----------------
+	uint64_t numWords = (uint64_t)((words + maxWords) - wordsStart);
+	SPLVerror writeError = splv_buffer_writer_write(out, numWords * sizeof(uint16_t), wordsStart);
+
+	SPLV_FREE(words);
+
+	return writeError;
+}
+
+SPLVerror splv_rans_decode(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out)
+{
+	//read symbol count + frequency table:
+	//-----------------
+	SPLVbufferReader in;
+	SPLV_ERROR_PROPAGATE(splv_buffer_reader_create(&in, inBuf, inBufLen));
+
+	uint64_t numSymbols;
+	SPLVransTable table;
+	SPLV_ERROR_PROPAGATE(splv_freq_table_read(&in, SPLV_RANS_PROB_SCALE, &numSymbols, table.frequencies));
+
+	if(numSymbols == 0)
+		return SPLV_SUCCESS;
+
+	if(numSymbols > SPLV_RANS_MAX_SYMBOLS)
+	{
+		SPLV_LOG_ERROR("data is too large to decode, must have size less than SPLV_RANS_MAX_SYMBOLS");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	_splv_rans_table_calculate_cdf(&table);
+
+	inBuf += in.readPos;
+	inBufLen -= in.readPos;
+
+	//read initial states:
+	//-----------------
+	const uint8_t* words = inBuf;
+	uint64_t numWords = inBufLen / sizeof(uint16_t);
+	uint64_t wordIdx = 0;
+
+	if(numWords < 2 * SPLV_RANS_NUM_LANES)
+	{
+		SPLV_LOG_ERROR("in buffer not large enough to hold rANS states");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	uint32_t states[SPLV_RANS_NUM_LANES];
+	for(uint32_t i = 0; i < SPLV_RANS_NUM_LANES; i++)
+	{
+		uint16_t lo, hi;
+		memcpy(&lo, &words[(wordIdx++) * sizeof(uint16_t)], sizeof(uint16_t));
+		memcpy(&hi, &words[(wordIdx++) * sizeof(uint16_t)], sizeof(uint16_t));
+
+		states[i] = ((uint32_t)hi << SPLV_RANS_WORD_BITS) | lo;
+		if(states[i] < SPLV_RANS_STATE_LOW)
+		{
+			SPLV_LOG_ERROR("invalid rANS state, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+	}
+
+	SPLV_ERROR_PROPAGATE(splv_buffer_writer_reserve(out, numSymbols));
+	uint8_t* outBuf = out->buf + out->writePos;
+
+	//a single symbol has probability 1 and never changes the states:
+	//-----------------
+	for(uint32_t i = 0; i < SPLV_RANS_NUM_SYMBOLS; i++)
+	{
+		if(table.frequencies[i] != SPLV_RANS_PROB_SCALE)
+			continue;
+
+		memset(outBuf, (int)i, numSymbols);
+		out->writePos += numSymbols;
+
+		return SPLV_SUCCESS;
+	}
+
+	//build slot lookup:
+	//-----------------
+	SPLVransDecodeEntry entries[SPLV_RANS_PROB_SCALE];
+	for(uint32_t i = 0; i < SPLV_RANS_NUM_SYMBOLS; i++)
+	{
+		for(uint32_t j = 0; j < table.frequencies[i]; j++)
+			entries[table.cumulative[i] + j] = i | (table.frequencies[i] << 8) | (j << 20);
+	}
+
+	//decode:
+	//-----------------
+	uint64_t i = 0;
+	for(; i + SPLV_RANS_NUM_LANES <= numSymbols; i += SPLV_RANS_NUM_LANES)
+	{
+		outBuf[i + 0] = _splv_rans_decode_symbol(entries, &states[0]);
+		outBuf[i + 1] = _splv_rans_decode_symbol(entries, &states[1]);
+		outBuf[i + 2] = _splv_rans_decode_symbol(entries, &states[2]);
+		outBuf[i + 3] = _splv_rans_decode_symbol(entries, &states[3]);
+
+		//each state reads at most 1 word, only need to bounds check near the end
+		if(wordIdx + SPLV_RANS_NUM_LANES <= numWords)
+		{
+			_splv_rans_renormalize(&states[0], words, &wordIdx);
+			_splv_rans_renormalize(&states[1], words, &wordIdx);
+			_splv_rans_renormalize(&states[2], words, &wordIdx);
+			_splv_rans_renormalize(&states[3], words, &wordIdx);
+		}
+		else
+		{
+			SPLV_ERROR_PROPAGATE(_splv_rans_renormalize_checked(&states[0], words, numWords, &wordIdx));
+			SPLV_ERROR_PROPAGATE(_splv_rans_renormalize_checked(&states[1], words, numWords, &wordIdx));
+			SPLV_ERROR_PROPAGATE(_splv_rans_renormalize_checked(&states[2], words, numWords, &wordIdx));
+			SPLV_ERROR_PROPAGATE(_splv_rans_renormalize_checked(&states[3], words, numWords, &wordIdx));
+		}
+	}
+
+	for(uint32_t lane = 0; i < numSymbols; i++, lane++)
+	{
+		outBuf[i] = _splv_rans_decode_symbol(entries, &states[lane]);
+		SPLV_ERROR_PROPAGATE(_splv_rans_renormalize_checked(&states[lane], words, numWords, &wordIdx));
+	}
+
+	out->writePos += numSymbols;
+
+	//every state should have returned to where the encoder started:
+	//-----------------
+	for(uint32_t i = 0; i < SPLV_RANS_NUM_LANES; i++)
+	{
+		if(states[i] != SPLV_RANS_STATE_LOW)
+		{
+			SPLV_LOG_ERROR("rANS decoding ended in an invalid state, possibly corrupted data");
+			return SPLV_ERROR_INVALID_INPUT;
+		}
+	}
+
+	return SPLV_SUCCESS;
+}
+
+//----------------------------------------------------------------------//
+
+static void _splv_rans_table_calculate_cdf(SPLVransTable* table)
+{
+	table->cumulative[0] = 0;
+	for(uint32_t i = 1; i < SPLV_RANS_NUM_SYMBOLS + 1; i++)
+		table->cumulative[i] = table->cumulative[i - 1] + table->frequencies[i - 1];
+}
+
+//----------------------------------------------------------------------//
+
+static inline uint8_t _splv_rans_decode_symbol(const SPLVransDecodeEntry* entries, uint32_t* state)
+{
+	uint32_t slot = *state & (SPLV_RANS_PROB_SCALE - 1);
+	SPLVransDecodeEntry entry = entries[slot];
+
+	*state = ((entry >> 8) & (SPLV_RANS_PROB_SCALE - 1)) * (*state >> SPLV_RANS_PROB_BITS) + (entry >> 20);
+	return (uint8_t)entry;
+}
+
+static inline void _splv_rans_renormalize(uint32_t* state, const uint8_t* words, uint64_t* wordIdx)
+{
+	if(*state >= SPLV_RANS_STATE_LOW)
+		return;
+
+	uint16_t word;
+	memcpy(&word, &words[(*wordIdx)++ * sizeof(uint16_t)], sizeof(uint16_t));
+
+	*state = (*state << SPLV_RANS_WORD_BITS) | word;
+}
+
+static inline SPLVerror _splv_rans_renormalize_checked(uint32_t* state, const uint8_t* words, uint64_t numWords, uint64_t* wordIdx)
+{
+	if(*state >= SPLV_RANS_STATE_LOW)
+		return SPLV_SUCCESS;
+
+	if(*wordIdx >= numWords)
+	{
+		SPLV_LOG_ERROR("rANS data ended unexpectedly, possibly corrupted data");
+		return SPLV_ERROR_INVALID_INPUT;
+	}
+
+	uint16_t word;
+	memcpy(&word, &words[(*wordIdx)++ * sizeof(uint16_t)], sizeof(uint16_t));
+
+	*state = (*state << SPLV_RANS_WORD_BITS) | word;
+	return SPLV_SUCCESS;
+}
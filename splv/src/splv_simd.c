@@ -0,0 +1,84 @@
+#include "splv_simd.h"
+
+#include "spatialstudio/splv_threading.h"
+
+//-------------------------------------------//
+
+#define SPLV_SIMD_LEVEL_UNKNOWN 0xFFFFFFFF
+
+//-------------------------------------------//
+
+static SPLVsimdLevel _splv_simd_detect_level(void);
+
+//-------------------------------------------//
+
+SPLVsimdLevel splv_simd_get_level(void)
+{
+	static volatile uint32_t level = SPLV_SIMD_LEVEL_UNKNOWN;
+
+	//detection is idempotent, so it doesn't matter if multiple threads race to do it
+	uint32_t cachedLevel = splv_atomic_load_u32(&level);
+	if(cachedLevel == SPLV_SIMD_LEVEL_UNKNOWN)
+	{
+		cachedLevel = (uint32_t)_splv_simd_detect_level();
+		splv_atomic_store_u32(&level, cachedLevel);
+	}
+
+	return (SPLVsimdLevel)cachedLevel;
+}
+
+//-------------------------------------------//
+
+static SPLVsimdLevel _splv_simd_detect_level(void)
+{
+#if !defined(SPLV_SIMD_X86)
+	return SPLV_SIMD_LEVEL_SCALAR;
+#elif defined(__GNUC__) || defined(__clang__)
+	__builtin_cpu_init();
+
+	//__builtin_cpu_supports also checks that the OS saves the extended register state
+	if(!__builtin_cpu_supports("popcnt"))
+		return SPLV_SIMD_LEVEL_SCALAR;
+
+	if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+		return SPLV_SIMD_LEVEL_AVX512;
+	if(__builtin_cpu_supports("avx2"))
+		return SPLV_SIMD_LEVEL_AVX2;
+	if(__builtin_cpu_supports("sse4.1"))
+		return SPLV_SIMD_LEVEL_SSE4;
+
+	return SPLV_SIMD_LEVEL_SCALAR;
+#else
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	int hasSse41   = (info[2] & (1 << 19)) != 0;
+	int hasPopcnt  = (info[2] & (1 << 23)) != 0;
+	int hasOsxsave = (info[2] & (1 << 27)) != 0;
+
+	if(!hasSse41 || !hasPopcnt)
+		return SPLV_SIMD_LEVEL_SCALAR;
+
+	if(!hasOsxsave || maxLeaf < 7)
+		return SPLV_SIMD_LEVEL_SSE4;
+
+	//check which register state the OS saves
+	uint64_t xcr0 = _xgetbv(0);
+	int osAvx    = (xcr0 & 0x06) == 0x06;
+	int osAvx512 = (xcr0 & 0xE6) == 0xE6;
+
+	__cpuidex(info, 7, 0);
+	int hasAvx2     = (info[1] & (1 << 5 )) != 0;
+	int hasAvx512f  = (info[1] & (1 << 16)) != 0;
+	int hasAvx512bw = (info[1] & (1 << 30)) != 0;
+
+	if(osAvx512 && hasAvx512f && hasAvx512bw)
+		return SPLV_SIMD_LEVEL_AVX512;
+	if(osAvx && hasAvx2)
+		return SPLV_SIMD_LEVEL_AVX2;
+
+	return SPLV_SIMD_LEVEL_SSE4;
+#endif
+}
@@ -0,0 +1,86 @@
+/* splv_simd.h
+ *
+ * contains portable bit-manipulation helpers and runtime detection of available SIMD instruction sets
+ */
+
+#ifndef SPLV_SIMD_H
+#define SPLV_SIMD_H
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+//-------------------------------------------//
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define SPLV_SIMD_X86
+#endif
+
+//marks a function as being compiled for a specific instruction set, MSVC allows intrinsics anywhere
+#if defined(SPLV_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+	#define SPLV_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define SPLV_SIMD_TARGET(isa)
+#endif
+
+//-------------------------------------------//
+
+/**
+ * the widest SIMD instruction set supported by the current CPU
+ */
+typedef enum SPLVsimdLevel
+{
+	SPLV_SIMD_LEVEL_SCALAR = 0,
+	SPLV_SIMD_LEVEL_SSE4   = 1, //SSE4.1 + POPCNT
+	SPLV_SIMD_LEVEL_AVX2   = 2, //AVX2 + POPCNT
+	SPLV_SIMD_LEVEL_AVX512 = 3  //AVX512F + AVX512BW + POPCNT
+} SPLVsimdLevel;
+
+//-------------------------------------------//
+
+/**
+ * returns the widest SIMD instruction set supported by the current CPU and OS, the result is cached after the first call
+ */
+SPLVsimdLevel splv_simd_get_level(void);
+
+//-------------------------------------------//
+
+/**
+ * returns the number of set bits in a 64-bit value
+ */
+static inline uint32_t splv_popcount64(uint64_t val)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (uint32_t)__builtin_popcountll(val);
+#else
+	val = val - ((val >> 1) & 0x5555555555555555ull);
+	val = (val & 0x3333333333333333ull) + ((val >> 2) & 0x3333333333333333ull);
+	val = (val + (val >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return (uint32_t)((val * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ * returns the number of trailing zero bits in a 64-bit value, val must be nonzero
+ */
+static inline uint32_t splv_ctz64(uint64_t val)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (uint32_t)__builtin_ctzll(val);
+#elif defined(_M_X64) || defined(_M_ARM64)
+	unsigned long idx;
+	_BitScanForward64(&idx, val);
+	return (uint32_t)idx;
+#else
+	unsigned long idx;
+	if(_BitScanForward(&idx, (unsigned long)val))
+		return (uint32_t)idx;
+
+	_BitScanForward(&idx, (unsigned long)(val >> 32));
+	return (uint32_t)idx + 32;
+#endif
+}
+
+#endif //#ifndef SPLV_SIMD_H
@@ -1,11 +1,35 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+	#define _GNU_SOURCE //for pthread_setaffinity_np
+#endif
+
 #include "spatialstudio/splv_threading.h"
 #include "spatialstudio/splv_log.h"
 #include <string.h>
 
+#ifndef _WIN32
+	#include <unistd.h>
+	#include <sched.h>
+#endif
+
+//-------------------------------------------//
+
+#define min(a,b) (((a) < (b)) ? (a) : (b))
+
 //-------------------------------------------//
 
 static void* _splv_thread_pool_thread_entry(void* arg);
 
+static void _splv_thread_pool_pin_thread(SPLVthreadPool* pool, uint32_t workerIdx);
+
+static SPLVerror _splv_thread_pool_deque_push(SPLVthreadPoolDeque* deque, SPLVthreadPoolGroup* group, void* workItems, uint32_t numItems, uint64_t itemSize);
+static uint8_t _splv_thread_pool_deque_pop(SPLVthreadPoolDeque* deque, SPLVthreadPoolTask* task);
+static uint8_t _splv_thread_pool_deque_steal(SPLVthreadPoolDeque* deque, SPLVthreadPoolTask* task);
+static uint8_t _splv_thread_pool_find_work(SPLVthreadPool* pool, uint32_t workerIdx, SPLVthreadPoolTask* task);
+
+static SPLVerror _splv_thread_pool_add_work(SPLVthreadPoolGroup* group, void* workItems, uint32_t numItems, uint64_t itemSize);
+
+static inline void _splv_cpu_relax(void);
+
 //-------------------------------------------//
 
 SPLVerror splv_thread_create(SPLVthread* thread, SPLVthreadFunc func, void* arg)
@@ -133,13 +157,23 @@ SPLVerror splv_condition_variable_signal_all(SPLVconditionVariable* cond)
 
 //-------------------------------------------//
 
-SPLVerror splv_thread_pool_create(SPLVthreadPool** p, uint32_t numThreads, SPLVthreadPoolFunc workFunc, uint64_t workSize)
+uint32_t splv_get_hardware_concurrency(void)
 {
-	//validate:
-	//-----------------
-	SPLV_ASSERT(numThreads > 0, "number of threads must be positive");
-	SPLV_ASSERT(workSize > 0, "work struct size must be positive");	
+#ifdef _WIN32
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo(&sysInfo);
+	uint32_t numCpus = (uint32_t)sysInfo.dwNumberOfProcessors;
+#else
+	long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	return numCpus > 0 ? (uint32_t)numCpus : 1;
+}
+
+//-------------------------------------------//
 
+SPLVerror splv_thread_pool_create(SPLVthreadPool** p, uint32_t numThreads, uint8_t pinThreads, uint32_t firstCpu)
+{
 	//allocate struct:
 	//-----------------
 	*p = (SPLVthreadPool*)SPLV_MALLOC(sizeof(SPLVthreadPool));
@@ -152,87 +186,81 @@ SPLVerror splv_thread_pool_create(SPLVthreadPool** p, uint32_t numThreads, SPLVt
 	SPLVthreadPool* pool = *p;
 	memset(pool, 0, sizeof(SPLVthreadPool));
 
-	pool->workFunc = workFunc;
-
-	//allocate thread array:
-	//-----------------
-	pool->numThreads = numThreads;
-	pool->threads = (SPLVthread*)SPLV_MALLOC(pool->numThreads * sizeof(SPLVthread));
-	if(!pool->threads)
-	{
-		splv_thread_pool_destroy(pool);
-
-		SPLV_LOG_ERROR("failed to allocate thread pool thread array");
-		return SPLV_ERROR_OUT_OF_MEMORY;
-	}
+	pool->pinThreads = pinThreads;
+	pool->firstCpu = firstCpu;
 
-	//create group stack:
+	//create sync primitives:
 	//-----------------
-	const uint32_t WORK_STACK_CAP_INITIAL = 8;
 
-	pool->workSize = workSize;
-	pool->workStackCap = WORK_STACK_CAP_INITIAL;
-	pool->workStackTop = -1;
-	pool->workStack = SPLV_MALLOC(pool->workStackCap * pool->workSize);
-	if(!pool->workStack)
+	//TODO: this leaks whichever one succeeded, but they can't fail except for programmer error
+	if(splv_mutex_init(&pool->sleepMutex) != SPLV_SUCCESS ||
+	   splv_condition_variable_init(&pool->workAvailableCond) != SPLV_SUCCESS)
 	{
-		splv_thread_pool_destroy(pool);
+		SPLV_FREE(pool);
+		*p = NULL;
 
-		SPLV_LOG_ERROR("failed to allocate thread pool stack");
-		return SPLV_ERROR_OUT_OF_MEMORY;
+		SPLV_LOG_ERROR("failed to create thread pool synchronization primitives");
+		return SPLV_ERROR_THREADING;
 	}
 
-	SPLVerror workMutexError = splv_mutex_init(&pool->workStackMutex);
-	if(workMutexError != SPLV_SUCCESS)
-	{
-		splv_thread_pool_destroy(pool);
+	//allocate worker arrays:
+	//-----------------
+	const uint64_t DEQUE_CAP_INITIAL = 64;
 
-		SPLV_LOG_ERROR("failed to create work stack mutex");
-		return workMutexError;
-	}
+	if(numThreads == 0)
+		numThreads = splv_get_hardware_concurrency();
 
-	SPLVerror workCondError = splv_condition_variable_init(&pool->workStackEmptyCond);
-	if(workCondError != SPLV_SUCCESS)
+	pool->numThreads = numThreads;
+	pool->workers = (SPLVthreadPoolWorker*)SPLV_MALLOC(pool->numThreads * sizeof(SPLVthreadPoolWorker));
+	pool->deques = (SPLVthreadPoolDeque*)SPLV_MALLOC(pool->numThreads * sizeof(SPLVthreadPoolDeque));
+	if(!pool->workers || !pool->deques)
 	{
+		pool->numThreads = 0;
 		splv_thread_pool_destroy(pool);
 
-		SPLV_LOG_ERROR("failed to create work stack empty condition variable");
-		return workCondError;
+		SPLV_LOG_ERROR("failed to allocate thread pool worker arrays");
+		return SPLV_ERROR_OUT_OF_MEMORY;
 	}
 
-	//create working threads cond:
-	//-----------------
-	pool->numWorkProcessing = 0;
+	memset(pool->workers, 0, pool->numThreads * sizeof(SPLVthreadPoolWorker));
+	memset(pool->deques, 0, pool->numThreads * sizeof(SPLVthreadPoolDeque));
 
-	SPLVerror workingMutexError = splv_mutex_init(&pool->workingMutex);
-	if(workingMutexError != SPLV_SUCCESS)
+	for(uint32_t i = 0; i < pool->numThreads; i++)
 	{
-		splv_thread_pool_destroy(pool);
+		SPLVthreadPoolDeque* deque = &pool->deques[i];
 
-		SPLV_LOG_ERROR("failed to create working mutex");
-		return workingMutexError;
-	}
+		deque->cap = DEQUE_CAP_INITIAL;
+		deque->tasks = (SPLVthreadPoolTask*)SPLV_MALLOC(deque->cap * sizeof(SPLVthreadPoolTask));
+		if(!deque->tasks || splv_mutex_init(&deque->mutex) != SPLV_SUCCESS)
+		{
+			if(deque->tasks)
+				SPLV_FREE(deque->tasks);
 
-	SPLVerror workingCondError = splv_condition_variable_init(&pool->workDoneCond);
-	if(workingCondError != SPLV_SUCCESS)
-	{
-		splv_thread_pool_destroy(pool);
+			pool->numThreads = i;
+			splv_thread_pool_destroy(pool);
 
-		SPLV_LOG_ERROR("failed to create work done condition variable");
-		return workingCondError;
+			SPLV_LOG_ERROR("failed to create thread pool work deque");
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
 	}
 
 	//start threads:
 	//-----------------
-	pool->threadsShouldExit = 0;
 	for(uint32_t i = 0; i < pool->numThreads; i++)
 	{
-		SPLVerror threadError = splv_thread_create(&pool->threads[i], _splv_thread_pool_thread_entry, pool);
+		pool->workers[i].pool = pool;
+		pool->workers[i].idx = i;
+
+		SPLVerror threadError = splv_thread_create(&pool->workers[i].thread, _splv_thread_pool_thread_entry, &pool->workers[i]);
 		if(threadError != SPLV_SUCCESS)
 		{
+			//only join with threads that were started
+			for(uint32_t j = i; j < pool->numThreads; j++)
+				pool->workers[j].pool = NULL;
+
 			splv_thread_pool_destroy(pool);
 
-			SPLV_LOG_ERROR("failed to create decoder thread pool thread");
+			SPLV_LOG_ERROR("failed to create thread pool thread");
 			return threadError;
 		}
 	}
@@ -245,133 +273,384 @@ void splv_thread_pool_destroy(SPLVthreadPool* pool)
 	if(!pool)
 		return;
 
-	if(pool->threads)
-	{
-		pool->threadsShouldExit = 1;
-		if(splv_condition_variable_signal_all(&pool->workStackEmptyCond) != SPLV_SUCCESS)
-			SPLV_LOG_ERROR("failed to cleanup thread pool - could not notify cond var");
+	//stop threads:
+	//-----------------
+	splv_atomic_store_u32(&pool->threadsShouldExit, 1);
+
+	splv_mutex_lock(&pool->sleepMutex);
+	if(splv_condition_variable_signal_all(&pool->workAvailableCond) != SPLV_SUCCESS)
+		SPLV_LOG_ERROR("failed to cleanup thread pool - could not notify cond var");
+	splv_mutex_unlock(&pool->sleepMutex);
 
+	if(pool->workers)
+	{
 		for(uint32_t i = 0; i < pool->numThreads; i++)
 		{
-			if(splv_thread_join(&pool->threads[i], NULL) != SPLV_SUCCESS)
+			if(pool->workers[i].pool == NULL)
+				continue;
+
+			if(splv_thread_join(&pool->workers[i].thread, NULL) != SPLV_SUCCESS)
 				SPLV_LOG_ERROR("failed to cleanup thread pool - could not join with thread");
 		}
 
-		SPLV_FREE(pool->threads);
+		SPLV_FREE(pool->workers);
 	}
 
-	if(pool->workStack)
+	//free deques:
+	//-----------------
+	if(pool->deques)
 	{
-		if(splv_mutex_destroy(&pool->workStackMutex) != SPLV_SUCCESS)
-			SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy mutex");
-		
-		if(splv_condition_variable_destroy(&pool->workStackEmptyCond) != SPLV_SUCCESS)
-			SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy cond var");
-	
-		if(splv_mutex_destroy(&pool->workingMutex) != SPLV_SUCCESS)
-			SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy mutex");
-	
-		if(splv_condition_variable_destroy(&pool->workDoneCond) != SPLV_SUCCESS)
-			SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy cond var");
+		for(uint32_t i = 0; i < pool->numThreads; i++)
+		{
+			if(splv_mutex_destroy(&pool->deques[i].mutex) != SPLV_SUCCESS)
+				SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy mutex");
 
-		SPLV_FREE(pool->workStack);
+			SPLV_FREE(pool->deques[i].tasks);
+		}
+
+		SPLV_FREE(pool->deques);
 	}
 
+	//destroy sync primitives:
+	//-----------------
+	if(splv_mutex_destroy(&pool->sleepMutex) != SPLV_SUCCESS)
+		SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy mutex");
+	
+	if(splv_condition_variable_destroy(&pool->workAvailableCond) != SPLV_SUCCESS)
+		SPLV_LOG_ERROR("failed to cleanup thread pool - could not destroy cond var");
+
 	SPLV_FREE(pool);
 }
 
-SPLVerror splv_thread_pool_add_work(SPLVthreadPool* pool, void* workItem)
+SPLVerror splv_thread_pool_group_create(SPLVthreadPoolGroup* group, SPLVthreadPool* pool, SPLVthreadPoolFunc workFunc)
 {
-	//TODO: error checking for mutex/cond vars? (dont think they can ever fail except for programmer error)
-
-	splv_mutex_lock(&pool->workStackMutex);
-	
-	if(pool->workStackTop >= (int32_t)pool->workStackCap - 1)
-	{
-		uint64_t newCap = pool->workStackCap * 2;
-		void* newStack = SPLV_REALLOC(pool->workStack, newCap * pool->workSize);
+	memset(group, 0, sizeof(SPLVthreadPoolGroup));
 
-		if(!newStack)
-		{
-			splv_mutex_unlock(&pool->workStackMutex);
+	group->pool = pool;
+	group->workFunc = workFunc;
+	group->firstError = SPLV_SUCCESS;
 
-			SPLV_LOG_ERROR("failed to realloc work stack");
-			return SPLV_ERROR_OUT_OF_MEMORY;
-		}
+	//TODO: this leaks whichever one succeeded, but they can't fail except for programmer error
+	if(splv_mutex_init(&group->workDoneMutex) != SPLV_SUCCESS ||
+	   splv_condition_variable_init(&group->workDoneCond) != SPLV_SUCCESS)
+	{
+		group->pool = NULL;
 
-		pool->workStack = newStack;
-		pool->workStackCap = newCap;
+		SPLV_LOG_ERROR("failed to create thread pool group synchronization primitives");
+		return SPLV_ERROR_THREADING;
 	}
-	
-	pool->workStackTop++;
-	void* dst = (char*)pool->workStack + pool->workStackTop * pool->workSize;
-	memcpy(dst, workItem, pool->workSize);
-	
-	splv_mutex_lock(&pool->workingMutex);
-	pool->numWorkProcessing++;
-	splv_mutex_unlock(&pool->workingMutex);
-	
-	splv_condition_variable_signal_one(&pool->workStackEmptyCond);
-	
-	splv_mutex_unlock(&pool->workStackMutex);
-	
+
 	return SPLV_SUCCESS;
 }
 
-SPLVerror splv_thread_pool_wait(SPLVthreadPool* pool)
+void splv_thread_pool_group_destroy(SPLVthreadPoolGroup* group)
 {
-	splv_mutex_lock(&pool->workingMutex);
-	
-	while(pool->numWorkProcessing > 0)
-		splv_condition_variable_wait(&pool->workDoneCond, &pool->workingMutex);
-	
-	splv_mutex_unlock(&pool->workingMutex);
-	
-	return SPLV_SUCCESS;
+	if(!group->pool)
+		return;
+
+	splv_thread_pool_wait(group);
+
+	if(splv_mutex_destroy(&group->workDoneMutex) != SPLV_SUCCESS)
+		SPLV_LOG_ERROR("failed to cleanup thread pool group - could not destroy mutex");
+
+	if(splv_condition_variable_destroy(&group->workDoneCond) != SPLV_SUCCESS)
+		SPLV_LOG_ERROR("failed to cleanup thread pool group - could not destroy cond var");
+
+	group->pool = NULL;
+}
+
+SPLVerror splv_thread_pool_add_work(SPLVthreadPoolGroup* group, void* workItem)
+{
+	return _splv_thread_pool_add_work(group, workItem, 1, 0);
+}
+
+SPLVerror splv_thread_pool_add_work_batch(SPLVthreadPoolGroup* group, void* workItems, uint32_t numItems, uint64_t itemSize)
+{
+	return _splv_thread_pool_add_work(group, workItems, numItems, itemSize);
+}
+
+SPLVerror splv_thread_pool_wait(SPLVthreadPoolGroup* group)
+{
+	//spin for a bit, work is usually short-lived:
+	//-----------------
+	uint32_t done = 0;
+	for(uint32_t i = 0; i < SPLV_THREAD_POOL_SPIN_ITERATIONS; i++)
+	{
+		if(splv_atomic_load_u32(&group->numWorkPending) == 0)
+		{
+			done = 1;
+			break;
+		}
+
+		_splv_cpu_relax();
+	}
+
+	//park until all work is done:
+	//-----------------
+	if(!done)
+	{
+		splv_mutex_lock(&group->workDoneMutex);
+		
+		while(splv_atomic_load_u32(&group->numWorkPending) > 0)
+			splv_condition_variable_wait(&group->workDoneCond, &group->workDoneMutex);
+		
+		splv_mutex_unlock(&group->workDoneMutex);
+	}
+
+	while(splv_atomic_load_u32(&group->numWorkFinishing) > 0)
+		_splv_cpu_relax();
+
+	//return first error, resetting for next batch of work:
+	//-----------------
+	return (SPLVerror)splv_atomic_exchange_u32(&group->firstError, SPLV_SUCCESS);
 }
 
 //-------------------------------------------//
 
 static void* _splv_thread_pool_thread_entry(void* arg)
 {
-	//TODO: we are not yet handling failure conditions. how to do this?
+	SPLVthreadPoolWorker* worker = (SPLVthreadPoolWorker*)arg;
+	SPLVthreadPool* pool = worker->pool;
 
-	SPLVthreadPool* pool = (SPLVthreadPool*)arg;
+	if(pool->pinThreads)
+		_splv_thread_pool_pin_thread(pool, worker->idx);
 
-	void* job = SPLV_MALLOC(pool->workSize); //for safely accessing job before it gets overwritten
-	if(!job)
+	while(1)
 	{
-		SPLV_LOG_ERROR("failed to allocate job copy on worker thread");
-		return NULL;
+		//find work, spinning for a bit before sleeping:
+		//-----------------
+		SPLVthreadPoolTask task;
+		uint8_t foundTask = 0;
+		for(uint32_t i = 0; i < SPLV_THREAD_POOL_SPIN_ITERATIONS; i++)
+		{
+			if(splv_atomic_load_u32(&pool->threadsShouldExit))
+				return NULL;
+
+			if(splv_atomic_load_u32(&pool->numWorkQueued) > 0)
+			{
+				foundTask = _splv_thread_pool_find_work(pool, worker->idx, &task);
+				if(foundTask)
+					break;
+			}
+
+			_splv_cpu_relax();
+		}
+
+		if(!foundTask)
+		{
+			splv_mutex_lock(&pool->sleepMutex);
+			splv_atomic_add_u32(&pool->numSleeping, 1);
+
+			while(splv_atomic_load_u32(&pool->numWorkQueued) == 0 && !splv_atomic_load_u32(&pool->threadsShouldExit))
+				splv_condition_variable_wait(&pool->workAvailableCond, &pool->sleepMutex);
+
+			splv_atomic_sub_u32(&pool->numSleeping, 1);
+			splv_mutex_unlock(&pool->sleepMutex);
+
+			continue;
+		}
+
+		//process work:
+		//-----------------
+		SPLVthreadPoolGroup* group = task.group;
+
+		SPLVerror workError = group->workFunc(task.item);
+		if(workError != SPLV_SUCCESS)
+			splv_atomic_compare_exchange_u32(&group->firstError, SPLV_SUCCESS, workError);
+
+		//the group may be destroyed as soon as numWorkPending hits 0, so waiters also wait for numWorkFinishing to hit 0
+		splv_atomic_add_u32(&group->numWorkFinishing, 1);
+
+		if(splv_atomic_sub_u32(&group->numWorkPending, 1) == 0)
+		{
+			splv_mutex_lock(&group->workDoneMutex);
+			splv_condition_variable_signal_all(&group->workDoneCond);
+			splv_mutex_unlock(&group->workDoneMutex);
+		}
+
+		splv_atomic_sub_u32(&group->numWorkFinishing, 1);
 	}
 
-	while(1)
+	return NULL;
+}
+
+static void _splv_thread_pool_pin_thread(SPLVthreadPool* pool, uint32_t workerIdx)
+{
+	uint32_t cpu = (pool->firstCpu + workerIdx) % splv_get_hardware_concurrency();
+
+#if defined(_WIN32)
+	if(cpu < sizeof(DWORD_PTR) * 8 && SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) == 0)
+		SPLV_LOG_WARNING("failed to set thread pool thread affinity");
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(cpu, &cpuSet);
+
+	if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) != 0)
+		SPLV_LOG_WARNING("failed to set thread pool thread affinity");
+#else
+	(void)cpu; //no affinity api, threads are left unpinned
+#endif
+}
+
+static SPLVerror _splv_thread_pool_add_work(SPLVthreadPoolGroup* group, void* workItems, uint32_t numItems, uint64_t itemSize)
+{
+	if(numItems == 0)
+		return SPLV_SUCCESS;
+
+	SPLVthreadPool* pool = group->pool;
+
+	//must be marked pending and queued before any worker can see it, otherwise a worker could decrement first and wrap the counters
+	splv_atomic_add_u32(&group->numWorkPending, numItems);
+	splv_atomic_add_u32(&pool->numWorkQueued, numItems);
+
+	//split items evenly between deques, starting from a different deque each time so small batches are spread out:
+	//-----------------
+	uint32_t numDeques = min(numItems, pool->numThreads);
+	uint32_t firstDeque = splv_atomic_add_u32(&pool->nextDeque, numDeques) - numDeques;
+
+	uint32_t baseItemsPerDeque = numItems / numDeques;
+	uint32_t itemsRemainder = numItems % numDeques;
+
+	uint32_t numPushed = 0;
+	for(uint32_t i = 0; i < numDeques; i++)
 	{
-		splv_mutex_lock(&pool->workStackMutex);
-		while(pool->workStackTop < 0 && pool->threadsShouldExit == 0)
-			splv_condition_variable_wait(&pool->workStackEmptyCond, &pool->workStackMutex);
+		uint32_t numItemsDeque = baseItemsPerDeque + (i < itemsRemainder ? 1 : 0);
+		void* itemsDeque = (uint8_t*)workItems + numPushed * itemSize;
 
-		if(pool->threadsShouldExit)
+		SPLVthreadPoolDeque* deque = &pool->deques[(firstDeque + i) % pool->numThreads];
+		SPLVerror pushError = _splv_thread_pool_deque_push(deque, group, itemsDeque, numItemsDeque, itemSize);
+		if(pushError != SPLV_SUCCESS)
 		{
-			splv_mutex_unlock(&pool->workStackMutex);
+			//items that were already pushed will still run
+			splv_atomic_sub_u32(&group->numWorkPending, numItems - numPushed);
+			splv_atomic_sub_u32(&pool->numWorkQueued, numItems - numPushed);
+			numItems = numPushed;
+
+			SPLV_LOG_ERROR("failed to push work to thread pool deque");
 			break;
 		}
 
-		memcpy(job, (char*)pool->workStack + pool->workStackTop * pool->workSize, pool->workSize);
-		pool->workStackTop--;
+		numPushed += numItemsDeque;
+	}
+
+	//wake sleeping workers:
+	//-----------------
+	if(splv_atomic_load_u32(&pool->numSleeping) > 0)
+	{
+		splv_mutex_lock(&pool->sleepMutex);
+
+		if(numPushed == 1)
+			splv_condition_variable_signal_one(&pool->workAvailableCond);
+		else
+			splv_condition_variable_signal_all(&pool->workAvailableCond);
+
+		splv_mutex_unlock(&pool->sleepMutex);
+	}
+
+	return numPushed == numItems ? SPLV_SUCCESS : SPLV_ERROR_OUT_OF_MEMORY;
+}
+
+static uint8_t _splv_thread_pool_find_work(SPLVthreadPool* pool, uint32_t workerIdx, SPLVthreadPoolTask* task)
+{
+	//check own deque first:
+	//-----------------
+	uint8_t found = _splv_thread_pool_deque_pop(&pool->deques[workerIdx], task);
+
+	//steal from other workers:
+	//-----------------
+	for(uint32_t i = 1; i < pool->numThreads && !found; i++)
+		found = _splv_thread_pool_deque_steal(&pool->deques[(workerIdx + i) % pool->numThreads], task);
+
+	if(found)
+		splv_atomic_sub_u32(&pool->numWorkQueued, 1);
+
+	return found;
+}
+
+static SPLVerror _splv_thread_pool_deque_push(SPLVthreadPoolDeque* deque, SPLVthreadPoolGroup* group, void* workItems, uint32_t numItems, uint64_t itemSize)
+{
+	splv_mutex_lock(&deque->mutex);
+
+	//grow if needed:
+	//-----------------
+	uint64_t size = deque->tail - deque->head;
+	if(size + numItems > deque->cap)
+	{
+		uint64_t newCap = deque->cap;
+		while(size + numItems > newCap)
+			newCap *= 2;
+
+		SPLVthreadPoolTask* newTasks = (SPLVthreadPoolTask*)SPLV_MALLOC(newCap * sizeof(SPLVthreadPoolTask));
+		if(!newTasks)
+		{
+			splv_mutex_unlock(&deque->mutex);
+			return SPLV_ERROR_OUT_OF_MEMORY;
+		}
+
+		for(uint64_t i = deque->head; i < deque->tail; i++)
+			newTasks[i & (newCap - 1)] = deque->tasks[i & (deque->cap - 1)];
 
-		splv_mutex_unlock(&pool->workStackMutex);
+		SPLV_FREE(deque->tasks);
+		deque->tasks = newTasks;
+		deque->cap = newCap;
+	}
 
-		SPLVerror workError = pool->workFunc(job); //TODO handle error?
+	//push:
+	//-----------------
+	for(uint32_t i = 0; i < numItems; i++)
+	{
+		SPLVthreadPoolTask* task = &deque->tasks[deque->tail & (deque->cap - 1)];
+		task->item = (uint8_t*)workItems + i * itemSize;
+		task->group = group;
 
-		splv_mutex_lock(&pool->workingMutex);
-		
-		pool->numWorkProcessing--;
-		if(pool->numWorkProcessing == 0)
-			splv_condition_variable_signal_one(&pool->workDoneCond);
+		deque->tail++;
+	}
+
+	splv_mutex_unlock(&deque->mutex);
 
-		splv_mutex_unlock(&pool->workingMutex);
+	return SPLV_SUCCESS;
+}
+
+static uint8_t _splv_thread_pool_deque_pop(SPLVthreadPoolDeque* deque, SPLVthreadPoolTask* task)
+{
+	uint8_t found = 0;
+
+	splv_mutex_lock(&deque->mutex);
+	if(deque->tail > deque->head)
+	{
+		deque->tail--;
+		*task = deque->tasks[deque->tail & (deque->cap - 1)];
+		found = 1;
 	}
+	splv_mutex_unlock(&deque->mutex);
 
-	return NULL;
-}
\ No newline at end of file
+	return found;
+}
+
+static uint8_t _splv_thread_pool_deque_steal(SPLVthreadPoolDeque* deque, SPLVthreadPoolTask* task)
+{
+	uint8_t found = 0;
+
+	splv_mutex_lock(&deque->mutex);
+	if(deque->tail > deque->head)
+	{
+		*task = deque->tasks[deque->head & (deque->cap - 1)];
+		deque->head++;
+		found = 1;
+	}
+	splv_mutex_unlock(&deque->mutex);
+
+	return found;
+}
+
+static inline void _splv_cpu_relax(void)
+{
+#if defined(_MSC_VER)
+	YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield");
+#endif
+}
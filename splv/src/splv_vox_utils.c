@@ -48,7 +48,10 @@ typedef struct SPLVvoxDict
 
 //-------------------------------------------//
 
+SPLVerror _splv_vox_load(const char* path, void*** outFrames, uint32_t* numOutFrames, SPLVboundingBox* bbox, splv_bool_t compact);
 SPLVerror _splv_vox_create_frame(FILE* file, SPLVframe** outFrame, uint64_t xyziPtr, uint32_t* palette, SPLVboundingBox* bbox);
+SPLVerror _splv_vox_create_frame_compact(FILE* file, SPLVframeCompact** outFrame, uint64_t xyziPtr, uint32_t* palette, SPLVboundingBox* bbox);
+splv_bool_t _splv_vox_get_voxel_pos(uint32_t xyzi, SPLVboundingBox* bbox, uint32_t* x, uint32_t* y, uint32_t* z);
 
 SPLVvoxChunk _splv_vox_read_chunk(FILE* file);
 SPLVerror _splv_vox_read_dict(FILE* file, SPLVvoxDict* dict);
@@ -57,6 +60,16 @@ void _splv_vox_free_dict(SPLVvoxDict dict);
 //-------------------------------------------//
 
 SPLVerror splv_vox_load(const char* path, SPLVframe*** outFrames, uint32_t* numOutFrames, SPLVboundingBox* bbox)
+{
+	return _splv_vox_load(path, (void***)outFrames, numOutFrames, bbox, SPLV_FALSE);
+}
+
+SPLVerror splv_vox_load_compact(const char* path, SPLVframeCompact*** outFrames, uint32_t* numOutFrames, SPLVboundingBox* bbox)
+{
+	return _splv_vox_load(path, (void***)outFrames, numOutFrames, bbox, SPLV_TRUE);
+}
+
+SPLVerror _splv_vox_load(const char* path, void*** outFrames, uint32_t* numOutFrames, SPLVboundingBox* bbox, splv_bool_t compact)
 {
 	//TODO: this function leaks memory on failure, add a bump allocator
 	//so we can free all memory on failure
@@ -255,14 +268,14 @@ SPLVerror splv_vox_load(const char* path, SPLVframe*** outFrames, uint32_t* numO
 	//---------------
 	uint64_t numFrames = frameIndices.arr[frameIndices.len - 1] + 1;
 	*numOutFrames = 0; //we increment this iteratively
-	*outFrames = (SPLVframe**)SPLV_MALLOC(numFrames * sizeof(SPLVframe*));
+	*outFrames = (void**)SPLV_MALLOC(numFrames * sizeof(void*));
 	if(!*outFrames)
 	{
 		SPLV_LOG_ERROR("failed to allocate output frame array for vox loader");
 		return SPLV_ERROR_OUT_OF_MEMORY;
 	}
 
-	SPLVframe* curFrame = NULL;
+	void* curFrame = NULL;
 	for(uint64_t i = 0; i < modelIndices.len; i++)
 	{
 		uint64_t frameIdx = frameIndices.arr[i];
@@ -279,7 +292,20 @@ SPLVerror splv_vox_load(const char* path, SPLVframe*** outFrames, uint32_t* numO
 			}
 		}
 
-		SPLVerror frameError = _splv_vox_create_frame(file, &curFrame, xyziPtrs.arr[modelIdx], palette, bbox);
+		SPLVerror frameError;
+		if(compact)
+		{
+			SPLVframeCompact* frame = NULL;
+			frameError = _splv_vox_create_frame_compact(file, &frame, xyziPtrs.arr[modelIdx], palette, bbox);
+			curFrame = frame;
+		}
+		else
+		{
+			SPLVframe* frame = NULL;
+			frameError = _splv_vox_create_frame(file, &frame, xyziPtrs.arr[modelIdx], palette, bbox);
+			curFrame = frame;
+		}
+
 		if(frameError != SPLV_SUCCESS)
 			return frameError;
 
@@ -331,6 +357,33 @@ void splv_vox_frames_destroy(SPLVframe** frames, uint32_t numFrames)
 	SPLV_FREE(frames);
 }
 
+void splv_vox_frames_compact_destroy(SPLVframeCompact** frames, uint32_t numFrames)
+{
+	if(frames == NULL)
+		return;
+
+	for(uint32_t i = 0; i < numFrames; i++)
+	{
+		if(frames[i] == NULL)
+			continue;
+
+		uint32_t j;
+		for(j = 0; j < i; j++)
+		{
+			if(frames[i] == frames[j])
+				break;
+		}
+
+		if(i == j)
+		{
+			splv_frame_compact_destroy(frames[i]);
+			SPLV_FREE(frames[i]);
+		}
+	}
+
+	SPLV_FREE(frames);
+}
+
 SPLVerror splv_vox_get_max_dimensions(const char* path, uint32_t* xSize, uint32_t* ySize, uint32_t* zSize)
 {
 	//open file:
@@ -447,20 +500,10 @@ SPLVerror _splv_vox_create_frame(FILE* file, SPLVframe** outFrame, uint64_t xyzi
 		uint32_t xyzi;
 		fread(&xyzi, sizeof(uint32_t), 1, file);
 
-		//we swap z and y axes, .vox files are z-up
-		uint32_t x = (xyzi & 0xFF);
-		uint32_t y = ((xyzi >> 16) & 0xFF);
-		uint32_t z = ((xyzi >>  8) & 0xFF);
-
 		//skip out of bounds voxels
-		if((int32_t)x < bbox->xMin || (int32_t)y < bbox->zMin || (int32_t)z < bbox->yMin)
+		uint32_t x, y, z;
+		if(!_splv_vox_get_voxel_pos(xyzi, bbox, &x, &y, &z))
 			continue;
-		if((int32_t)x > bbox->xMax || (int32_t)y > bbox->zMax || (int32_t)z > bbox->yMax)
-			continue;
-
-		x -= bbox->xMin;
-		y -= bbox->zMin;
-		z -= bbox->yMin;
 
 		uint32_t xMap = x / SPLV_BRICK_SIZE;
 		uint32_t yMap = y / SPLV_BRICK_SIZE;
@@ -495,6 +538,156 @@ SPLVerror _splv_vox_create_frame(FILE* file, SPLVframe** outFrame, uint64_t xyzi
 	return SPLV_SUCCESS;
 }
 
+SPLVerror _splv_vox_create_frame_compact(FILE* file, SPLVframeCompact** outFrame, uint64_t xyziPtr, uint32_t* palette, SPLVboundingBox* bbox)
+{
+	//NOTE: voxels in a .vox file are unordered, but a compact brick's colors must be stored in bitmap order. So we
+	//first find each brick's filled voxels, then write each color at its rank within its brick
+
+	//create frame:
+	//---------------
+
+	//we swap z and y axes, .vox files are z-up
+	uint32_t width  = bbox->xMax - bbox->xMin + 1;
+	uint32_t height = bbox->zMax - bbox->zMin + 1;
+	uint32_t depth  = bbox->yMax - bbox->yMin + 1;
+
+	uint32_t widthMap  = width  / SPLV_BRICK_SIZE;
+	uint32_t heightMap = height / SPLV_BRICK_SIZE;
+	uint32_t depthMap  = depth  / SPLV_BRICK_SIZE;
+
+	*outFrame = (SPLVframeCompact*)SPLV_MALLOC(sizeof(SPLVframeCompact));
+	SPLVframeCompact* frame = *outFrame;
+	if(!frame)
+	{
+		SPLV_LOG_ERROR("failed to allocate compact frame for vox loader");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	SPLVerror frameError = splv_frame_compact_create(frame, widthMap, heightMap, depthMap, 0, 0);
+	if(frameError != SPLV_SUCCESS)
+		return frameError;
+
+	uint32_t mapLen = widthMap * heightMap * depthMap;
+	for(uint32_t i = 0; i < mapLen; i++)
+		frame->map[i] = SPLV_BRICK_IDX_EMPTY;
+
+	//read voxels:
+	//---------------
+	fseek(file, (long)xyziPtr, SEEK_SET);
+
+	uint32_t numVoxels = 0;
+	fread(&numVoxels, sizeof(uint32_t), 1, file);
+
+	uint32_t* xyzis = (uint32_t*)SPLV_MALLOC(numVoxels * sizeof(uint32_t));
+	if(!xyzis && numVoxels > 0)
+	{
+		SPLV_LOG_ERROR("failed to allocate vox voxel buffer");
+		return SPLV_ERROR_OUT_OF_MEMORY;
+	}
+
+	numVoxels = (uint32_t)fread(xyzis, sizeof(uint32_t), numVoxels, file);
+
+	//assign bricks, in the order they are first touched:
+	//---------------
+	uint32_t numBricks = 0;
+	for(uint32_t i = 0; i < numVoxels; i++)
+	{
+		uint32_t x, y, z;
+		if(!_splv_vox_get_voxel_pos(xyzis[i], bbox, &x, &y, &z))
+			continue;
+
+		uint32_t idxMap = splv_frame_compact_get_map_idx(frame, x / SPLV_BRICK_SIZE, y / SPLV_BRICK_SIZE, z / SPLV_BRICK_SIZE);
+		if(frame->map[idxMap] == SPLV_BRICK_IDX_EMPTY)
+			frame->map[idxMap] = numBricks++;
+	}
+
+	SPLVerror reserveError = splv_frame_compact_reserve(frame, numBricks, 0);
+	if(reserveError != SPLV_SUCCESS)
+	{
+		SPLV_FREE(xyzis);
+		return reserveError;
+	}
+
+	frame->numBricks = numBricks;
+	memset(frame->bricks, 0, numBricks * sizeof(SPLVbrickCompact));
+
+	//set bitmaps, voxels may be repeated so bricks are counted after:
+	//---------------
+	for(uint32_t i = 0; i < numVoxels; i++)
+	{
+		uint32_t x, y, z;
+		if(!_splv_vox_get_voxel_pos(xyzis[i], bbox, &x, &y, &z))
+			continue;
+
+		uint32_t idxMap = splv_frame_compact_get_map_idx(frame, x / SPLV_BRICK_SIZE, y / SPLV_BRICK_SIZE, z / SPLV_BRICK_SIZE);
+		uint32_t idx = (x % SPLV_BRICK_SIZE) | ((y % SPLV_BRICK_SIZE) << SPLV_BRICK_SIZE_LOG_2) | ((z % SPLV_BRICK_SIZE) << SPLV_BRICK_SIZE_2_LOG_2);
+
+		frame->bricks[frame->map[idxMap]].bitmap[idx / 32] |= 1u << (idx % 32);
+	}
+
+	uint32_t numVoxelsFilled = 0;
+	for(uint32_t i = 0; i < numBricks; i++)
+	{
+		frame->bricks[i].voxelsOffset = numVoxelsFilled;
+		numVoxelsFilled += splv_brick_compact_get_num_voxels(&frame->bricks[i]);
+	}
+
+	reserveError = splv_frame_compact_reserve(frame, numBricks, numVoxelsFilled);
+	if(reserveError != SPLV_SUCCESS)
+	{
+		SPLV_FREE(xyzis);
+		return reserveError;
+	}
+
+	frame->numVoxels = numVoxelsFilled;
+
+	//write colors, at their rank within their brick:
+	//---------------
+	for(uint32_t i = 0; i < numVoxels; i++)
+	{
+		uint32_t x, y, z;
+		if(!_splv_vox_get_voxel_pos(xyzis[i], bbox, &x, &y, &z))
+			continue;
+
+		uint32_t idxMap = splv_frame_compact_get_map_idx(frame, x / SPLV_BRICK_SIZE, y / SPLV_BRICK_SIZE, z / SPLV_BRICK_SIZE);
+		uint32_t idx = (x % SPLV_BRICK_SIZE) | ((y % SPLV_BRICK_SIZE) << SPLV_BRICK_SIZE_LOG_2) | ((z % SPLV_BRICK_SIZE) << SPLV_BRICK_SIZE_2_LOG_2);
+		SPLVbrickCompact* brick = &frame->bricks[frame->map[idxMap]];
+
+		uint32_t color = palette[((xyzis[i] >> 24) & 0xFF) - 1];
+		uint8_t r = color & 0xFF;
+		uint8_t g = (color >> 8)  & 0xFF;
+		uint8_t b = (color >> 16) & 0xFF;
+
+		frame->voxels[brick->voxelsOffset + splv_brick_compact_get_voxel_rank(brick, idx)] = 
+			((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8) | 255;
+	}
+
+	//return:
+	//---------------
+	SPLV_FREE(xyzis);
+
+	return SPLV_SUCCESS;
+}
+
+splv_bool_t _splv_vox_get_voxel_pos(uint32_t xyzi, SPLVboundingBox* bbox, uint32_t* x, uint32_t* y, uint32_t* z)
+{
+	//we swap z and y axes, .vox files are z-up
+	*x = (xyzi & 0xFF);
+	*y = ((xyzi >> 16) & 0xFF);
+	*z = ((xyzi >>  8) & 0xFF);
+
+	if((int32_t)*x < bbox->xMin || (int32_t)*y < bbox->zMin || (int32_t)*z < bbox->yMin)
+		return SPLV_FALSE;
+	if((int32_t)*x > bbox->xMax || (int32_t)*y > bbox->zMax || (int32_t)*z > bbox->yMax)
+		return SPLV_FALSE;
+
+	*x -= bbox->xMin;
+	*y -= bbox->zMin;
+	*z -= bbox->yMin;
+
+	return SPLV_TRUE;
+}
+
 SPLVvoxChunk _splv_vox_read_chunk(FILE* file)
 {
 	SPLVvoxChunk chunk = {0};
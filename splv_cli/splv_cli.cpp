@@ -39,7 +39,7 @@ private:
 
 //-------------------------------------------//
 
-//all currently active frames
+//frames being encoded by the current command, the encoder copies each one so they are freed once it is done
 static std::vector<SPLVframe> g_activeFrames;
 static std::vector<std::pair<SPLVframe**, uint32_t>> g_activeVoxFrames;
 
@@ -106,16 +106,11 @@ void encode_frame(SPLVencoder* encoder, SPLVframe* frame, bool removeNonvisible)
 		std::cout << "ERROR: failed to encode frame with code " 
 			<< encodeError << " (" << splv_get_error_string(encodeError) << ")\n";
 	}
-
-	//free active frames:
-	//---------------
-	if(canRemove)
-		free_frames();
 }
 
 //-------------------------------------------//
 
-//usage: splv_encoder -d [width] [height] [depth] -f [framerate] -g [gop size] -b [max brickgroup size] -m [motion vectors] -o [output file]
+//usage: splv_encoder -d [width] [height] [depth] -f [framerate] -g [gop size] -b [max brickgroup size] -m [motion vectors] -s [motion search preset] -e [entropy coder] -c [geometry coder] -v [voxel order] -r [brick order] -t [tile size] -o [output file]
 int main(int argc, const char** argv)
 {
 	//parse and validate command line args:
@@ -129,6 +124,12 @@ int main(int argc, const char** argv)
 	int32_t gopSize = 1;
 	int32_t maxBrickGroupSize = 256;
 	splv_bool_t motionVectors = SPLV_TRUE;
+	SPLVmotionSearchPreset motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_DEFAULT;
+	SPLVentropyCoder entropyCoder = SPLV_ENTROPY_CODER_RANGE;
+	SPLVgeometryCoder geometryCoder = SPLV_GEOMETRY_CODER_RLE;
+	SPLVvoxelOrder voxelOrder = SPLV_VOXEL_ORDER_LINEAR;
+	SPLVbrickOrder brickOrder = SPLV_BRICK_ORDER_LINEAR;
+	int32_t tileSize = 0;
 
 	std::string outPath = "";
 
@@ -244,6 +245,124 @@ int main(int argc, const char** argv)
 				return -1;
 			}
 		}
+		else if(arg == "-s") //motion search preset
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-s\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "fast")
+				motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_FAST;
+			else if(option == "default")
+				motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_DEFAULT;
+			else if(option == "exhaustive")
+				motionSearchPreset = SPLV_MOTION_SEARCH_PRESET_EXHAUSTIVE;
+			else
+			{
+				std::cout << "ERROR: invalid motion search preset option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-e") //entropy coder
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-e\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "range")
+				entropyCoder = SPLV_ENTROPY_CODER_RANGE;
+			else if(option == "rans")
+				entropyCoder = SPLV_ENTROPY_CODER_RANS;
+			else
+			{
+				std::cout << "ERROR: invalid entropy coder option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-c") //geometry coder
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-c\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "rle")
+				geometryCoder = SPLV_GEOMETRY_CODER_RLE;
+			else if(option == "context")
+				geometryCoder = SPLV_GEOMETRY_CODER_CONTEXT;
+			else
+			{
+				std::cout << "ERROR: invalid geometry coder option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-v") //voxel order
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-v\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "linear")
+				voxelOrder = SPLV_VOXEL_ORDER_LINEAR;
+			else if(option == "morton")
+				voxelOrder = SPLV_VOXEL_ORDER_MORTON;
+			else
+			{
+				std::cout << "ERROR: invalid voxel order option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-r") //brick order
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-r\"" << std::endl;
+				return -1;
+			}
+
+			std::string option = std::string(argv[++i]);
+			if(option == "linear")
+				brickOrder = SPLV_BRICK_ORDER_LINEAR;
+			else if(option == "morton")
+				brickOrder = SPLV_BRICK_ORDER_MORTON;
+			else
+			{
+				std::cout << "ERROR: invalid brick order option" << std::endl;
+				return -1;
+			}
+		}
+		else if(arg == "-t") //tile size
+		{
+			if(i + 1 >= (uint32_t)argc)
+			{
+				std::cout << "ERROR: not enough arguments supplied to \"-t\"" << std::endl;
+				return -1;
+			}
+
+			try
+			{
+				tileSize = std::stoi(argv[++i]);
+
+				if(tileSize < 0 || tileSize > UINT8_MAX)
+					throw std::invalid_argument("");
+			}
+			catch(std::exception e)
+			{
+				std::cout << "ERROR: invalid tile size" << std::endl;
+				return -1;
+			}
+		}
 		else if(arg == "-o") //output file
 		{
 			if(i + 1 >= (uint32_t)argc)
@@ -257,7 +376,7 @@ int main(int argc, const char** argv)
 		else
 		{
 			std::cout << "ERROR: unrecognized command line argument \"" << arg << "\"" << std::endl;
-			std::cout << "VALID USAGE: splv_encoder -d [width] [height] [depth] -f [framerate] -o [output file] -g [gop size] -b [max brickgroup size] -m [motion vectors]" << std::endl;
+			std::cout << "VALID USAGE: splv_encoder -d [width] [height] [depth] -f [framerate] -o [output file] -g [gop size] -b [max brickgroup size] -m [motion vectors] -s [motion search preset] -e [entropy coder] -c [geometry coder] -v [voxel order] -r [brick order] -t [tile size]" << std::endl;
 			return -1;
 		}
 	}
@@ -286,6 +405,12 @@ int main(int argc, const char** argv)
 	encodingParams.gopSize = gopSize;
 	encodingParams.maxBrickGroupSize = maxBrickGroupSize;
 	encodingParams.motionVectors = motionVectors;
+	encodingParams.motionSearchPreset = (uint8_t)motionSearchPreset;
+	encodingParams.entropyCoder = (uint8_t)entropyCoder;
+	encodingParams.geometryCoder = (uint8_t)geometryCoder;
+	encodingParams.voxelOrder = (uint8_t)voxelOrder;
+	encodingParams.brickOrder = (uint8_t)brickOrder;
+	encodingParams.tileSize = (uint8_t)tileSize;
 
 	SPLVencoder encoder;
 	SPLVerror encoderError = splv_encoder_create(&encoder, width, height, depth, framerate, encodingParams, outPath.c_str());
@@ -352,6 +477,8 @@ int main(int argc, const char** argv)
 
 			g_activeFrames.push_back(frame);
 			encode_frame(&encoder, &frame, removeNonvisible);
+
+			free_frames();
 		}
 		else if(command == "e_vox")
 		{
@@ -372,10 +499,12 @@ int main(int argc, const char** argv)
 				continue;
 			}
 
+			g_activeVoxFrames.push_back({ frames, numFrames });
+
 			for(uint32_t i = 0; i < numFrames; i++)
 				encode_frame(&encoder, frames[i], removeNonvisible);
 
-			g_activeVoxFrames.push_back({ frames, numFrames });
+			free_frames();
 		}
 		else if(command == "b")
 		{
@@ -91,6 +91,9 @@ public struct SPLVframeCompact
 	public IntPtr bricks;
 	public UInt64 numVoxels;
 	public IntPtr voxels;
+
+	public UInt32 bricksCap;
+	public UInt64 voxelsCap;
 }
 
 [StructLayout(LayoutKind.Sequential)]
@@ -99,6 +102,12 @@ public struct SPLVencodingParams
 	public UInt32 gopSize;
 	public UInt32 maxBrickGroupSize;
 	public Byte motionVectors;
+	public Byte motionSearchPreset;
+	public Byte entropyCoder;
+	public Byte geometryCoder;
+	public Byte voxelOrder;
+	public Byte brickOrder;
+	public Byte tileSize;
 }
 
 [StructLayout(LayoutKind.Sequential)]
@@ -170,6 +179,13 @@ public struct SPLVframeIndexed
 	public IntPtr frame;
 }
 
+[StructLayout(LayoutKind.Sequential)]
+public struct SPLVframeCompactIndexed
+{
+	public UInt64 index;
+	public IntPtr frame;
+}
+
 //-------------------------------------------//
 
 public class SPLV
@@ -200,6 +216,9 @@ public class SPLV
 	[DllImport(LibraryName, EntryPoint = "splv_frame_create", CallingConvention = CallingConvention.Cdecl)]
 	public static extern SPLVerror FrameCreate(IntPtr frame, UInt32 width, UInt32 height, UInt32 depth, UInt32 numBricksInitial);
 
+	[DllImport(LibraryName, EntryPoint = "splv_frame_recreate", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror FrameRecreate(IntPtr frame, UInt32 width, UInt32 height, UInt32 depth, UInt32 numBricksInitial);
+
 	[DllImport(LibraryName, EntryPoint = "splv_frame_destroy", CallingConvention = CallingConvention.Cdecl)]
 	public static extern void FrameDestroy(IntPtr frame);
 
@@ -221,9 +240,18 @@ public class SPLV
 	[DllImport(LibraryName, EntryPoint = "splv_frame_compact_create", CallingConvention = CallingConvention.Cdecl)]
 	public static extern SPLVerror FrameCompactCreate(IntPtr frame, UInt32 width, UInt32 height, UInt32 depth, UInt32 numBricks, UInt64 numVoxels);
 
+	[DllImport(LibraryName, EntryPoint = "splv_frame_compact_recreate", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror FrameCompactRecreate(IntPtr frame, UInt32 width, UInt32 height, UInt32 depth, UInt32 numBricks, UInt64 numVoxels);
+
 	[DllImport(LibraryName, EntryPoint = "splv_frame_compact_destroy", CallingConvention = CallingConvention.Cdecl)]
 	public static extern void FrameCompactDestroy(IntPtr frame);	
 
+	[DllImport(LibraryName, EntryPoint = "splv_frame_compact_pack", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror FrameCompactPack(IntPtr frame, IntPtr compactFrame);
+
+	[DllImport(LibraryName, EntryPoint = "splv_frame_compact_unpack", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror FrameCompactUnpack(IntPtr compactFrame, IntPtr frame);
+
 	//-------------------------------------------//
 	//from splv_encoder.h
 
@@ -233,6 +261,9 @@ public class SPLV
 	[DllImport(LibraryName, EntryPoint = "splv_encoder_encode_frame", CallingConvention = CallingConvention.Cdecl)]
 	public static extern SPLVerror EncoderEncodeFrame(IntPtr encoder, IntPtr frame, out Byte canFree);
 
+	[DllImport(LibraryName, EntryPoint = "splv_encoder_encode_frame_compact", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror EncoderEncodeFrameCompact(IntPtr encoder, IntPtr frame);
+
 	[DllImport(LibraryName, EntryPoint = "splv_encoder_finish", CallingConvention = CallingConvention.Cdecl)]
 	public static extern SPLVerror EncoderFinish(IntPtr encoder);
 
@@ -248,11 +279,20 @@ public class SPLV
 	[DllImport(LibraryName, EntryPoint = "splv_decoder_create_from_file", CallingConvention = CallingConvention.Cdecl)]
 	public static extern SPLVerror DecoderCreateFromFile(IntPtr decoder, IntPtr path);
 
+	[DllImport(LibraryName, EntryPoint = "splv_decoder_create_from_file_mmap", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror DecoderCreateFromFileMmap(IntPtr decoder, IntPtr path);
+
 	[DllImport(LibraryName, EntryPoint = "splv_decoder_get_frame_dependencies", CallingConvention = CallingConvention.Cdecl)]
 	public static extern SPLVerror DecoderGetFrameDependencies(IntPtr decoder, UInt64 idx, out UInt64 numDependencies, IntPtr dependencies, Byte recursive);
 
 	[DllImport(LibraryName, EntryPoint = "splv_decoder_decode_frame", CallingConvention = CallingConvention.Cdecl)]
 	public static extern SPLVerror DecoderDecodeFrame(IntPtr decoder, UInt64 index, UInt64 numDependencies, IntPtr dependencies, IntPtr frame, IntPtr compactFrame);
+
+	[DllImport(LibraryName, EntryPoint = "splv_decoder_decode_frame_into", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror DecoderDecodeFrameInto(IntPtr decoder, UInt64 index, UInt64 numDependencies, IntPtr dependencies, IntPtr frame, IntPtr compactFrame);
+
+	[DllImport(LibraryName, EntryPoint = "splv_decoder_decode_frame_compact", CallingConvention = CallingConvention.Cdecl)]
+	public static extern SPLVerror DecoderDecodeFrameCompact(IntPtr decoder, UInt64 index, UInt64 numDependencies, IntPtr dependencies, IntPtr frame);
 	
 	[DllImport(LibraryName, EntryPoint = "splv_decoder_get_prev_i_frame_idx", CallingConvention = CallingConvention.Cdecl)]
 	public static extern Int64 DecoderGetPrevIFrameIdx(IntPtr decoder, UInt64 idx);
@@ -12,7 +12,9 @@
 //-------------------------------------------//
 
 PySPLVencoder::PySPLVencoder(uint32_t width, uint32_t height, uint32_t depth, float framerate, 
-							 uint32_t gopSize, uint32_t maxBrickGroupSize, bool motionVectors, std::string outPath)
+							 uint32_t gopSize, uint32_t maxBrickGroupSize, bool motionVectors, std::string outPath,
+							 std::string motionSearchPreset, std::string entropyCoder, std::string geometryCoder,
+							 std::string voxelOrder, std::string brickOrder, uint32_t tileSize)
 {
 	//validate:
 	//---------------
@@ -40,12 +42,81 @@ PySPLVencoder::PySPLVencoder(uint32_t width, uint32_t height, uint32_t depth, fl
 		throw std::runtime_error("");
 	}
 
+	SPLVmotionSearchPreset motionSearch;
+	if(motionSearchPreset == "fast")
+		motionSearch = SPLV_MOTION_SEARCH_PRESET_FAST;
+	else if(motionSearchPreset == "default")
+		motionSearch = SPLV_MOTION_SEARCH_PRESET_DEFAULT;
+	else if(motionSearchPreset == "exhaustive")
+		motionSearch = SPLV_MOTION_SEARCH_PRESET_EXHAUSTIVE;
+	else
+	{
+		std::cout << "ERROR: motion search preset must be one of \"fast\", \"default\", or \"exhaustive\"\n";
+		throw std::runtime_error("");
+	}
+
+	SPLVentropyCoder coder;
+	if(entropyCoder == "range")
+		coder = SPLV_ENTROPY_CODER_RANGE;
+	else if(entropyCoder == "rans")
+		coder = SPLV_ENTROPY_CODER_RANS;
+	else
+	{
+		std::cout << "ERROR: entropy coder must be one of \"range\" or \"rans\"\n";
+		throw std::runtime_error("");
+	}
+
+	SPLVgeometryCoder geometry;
+	if(geometryCoder == "rle")
+		geometry = SPLV_GEOMETRY_CODER_RLE;
+	else if(geometryCoder == "context")
+		geometry = SPLV_GEOMETRY_CODER_CONTEXT;
+	else
+	{
+		std::cout << "ERROR: geometry coder must be one of \"rle\" or \"context\"\n";
+		throw std::runtime_error("");
+	}
+
+	SPLVvoxelOrder order;
+	if(voxelOrder == "linear")
+		order = SPLV_VOXEL_ORDER_LINEAR;
+	else if(voxelOrder == "morton")
+		order = SPLV_VOXEL_ORDER_MORTON;
+	else
+	{
+		std::cout << "ERROR: voxel order must be one of \"linear\" or \"morton\"\n";
+		throw std::runtime_error("");
+	}
+
+	SPLVbrickOrder bricks;
+	if(brickOrder == "linear")
+		bricks = SPLV_BRICK_ORDER_LINEAR;
+	else if(brickOrder == "morton")
+		bricks = SPLV_BRICK_ORDER_MORTON;
+	else
+	{
+		std::cout << "ERROR: brick order must be one of \"linear\" or \"morton\"\n";
+		throw std::runtime_error("");
+	}
+
+	if(tileSize > UINT8_MAX)
+	{
+		std::cout << "ERROR: tile size must be at most 255\n";
+		throw std::runtime_error("");
+	}
+
 	//create encoder:
 	//---------------
 	SPLVencodingParams encodingParams = {0};
 	encodingParams.gopSize = gopSize;
 	encodingParams.maxBrickGroupSize = maxBrickGroupSize;
 	encodingParams.motionVectors = motionVectors;
+	encodingParams.motionSearchPreset = (uint8_t)motionSearch;
+	encodingParams.entropyCoder = (uint8_t)coder;
+	encodingParams.geometryCoder = (uint8_t)geometry;
+	encodingParams.voxelOrder = (uint8_t)order;
+	encodingParams.brickOrder = (uint8_t)bricks;
+	encodingParams.tileSize = (uint8_t)tileSize;
 
 	SPLVerror encoderError = splv_encoder_create(&m_encoder, width, height, depth, framerate, encodingParams, outPath.c_str());
 	if(encoderError != SPLV_SUCCESS)
@@ -84,6 +155,8 @@ void PySPLVencoder::encode_nvdb_frame(std::string path, int32_t minX, int32_t mi
 
 	m_activeFrames.push_back(frame);
 	encode_frame(&frame, removeNonvisible);
+
+	free_frames();
 }
 
 void PySPLVencoder::encode_vox_frame(std::string path, int32_t minX, int32_t minY, int32_t minZ, 
@@ -107,10 +180,12 @@ void PySPLVencoder::encode_vox_frame(std::string path, int32_t minX, int32_t min
 		throw std::runtime_error("");
 	}
 
+	m_activeVoxFrames.push_back({ frames, numFrames });
+
 	for(uint32_t i = 0; i < numFrames; i++)
 		encode_frame(frames[i], removeNonvisible);
 
-	m_activeVoxFrames.push_back({ frames, numFrames });
+	free_frames();
 }
 
 void PySPLVencoder::encode_numpy_frame_float(py::array_t<float> arr, std::string lrAxis, std::string udAxis, 
@@ -297,6 +372,8 @@ void PySPLVencoder::encode_numpy_frame(py::array_t<float>* floatArr, py::array_t
 	//---------------
 	m_activeFrames.push_back(frame);
 	encode_frame(&frame, removeNonvisible);
+
+	free_frames();
 }
 
 //-------------------------------------------//
@@ -340,11 +417,6 @@ void PySPLVencoder::encode_frame(SPLVframe* frame, bool removeNonvisible)
 			<< encodeError << " (" << splv_get_error_string(encodeError) << ")\n";
 		throw std::runtime_error("");
 	}
-
-	//free active frames:
-	//---------------
-	if(canRemove)
-		free_frames();
 }
 
 void PySPLVencoder::free_frames()
@@ -483,6 +555,25 @@ py::dict get_metadata(const std::string& path)
 	encodingParams["gopSize"] = metadata.encodingParams.gopSize;
 	encodingParams["maxBrickGroupSize"] = metadata.encodingParams.maxBrickGroupSize;
 	encodingParams["motionVectors"] = (bool)metadata.encodingParams.motionVectors;
+
+	switch(metadata.encodingParams.motionSearchPreset)
+	{
+	case SPLV_MOTION_SEARCH_PRESET_FAST:
+		encodingParams["motionSearchPreset"] = "fast";
+		break;
+	case SPLV_MOTION_SEARCH_PRESET_EXHAUSTIVE:
+		encodingParams["motionSearchPreset"] = "exhaustive";
+		break;
+	default:
+		encodingParams["motionSearchPreset"] = "default";
+		break;
+	}
+
+	encodingParams["entropyCoder"] = metadata.encodingParams.entropyCoder == SPLV_ENTROPY_CODER_RANS ? "rans" : "range";
+	encodingParams["geometryCoder"] = metadata.encodingParams.geometryCoder == SPLV_GEOMETRY_CODER_CONTEXT ? "context" : "rle";
+	encodingParams["voxelOrder"] = metadata.encodingParams.voxelOrder == SPLV_VOXEL_ORDER_MORTON ? "morton" : "linear";
+	encodingParams["brickOrder"] = metadata.encodingParams.brickOrder == SPLV_BRICK_ORDER_MORTON ? "morton" : "linear";
+	encodingParams["tileSize"] = metadata.encodingParams.tileSize;
 	
 	py::dict result;
 	result["width"] = metadata.width;
@@ -513,7 +604,7 @@ PYBIND11_MODULE(splv_encoder_py, m) {
 	m.doc() = "SPLV Encoder";
 
 	py::class_<PySPLVencoder>(m, "SPLVencoder")
-		.def(py::init<uint32_t, uint32_t, uint32_t, float, uint32_t, uint32_t, float, const std::string&>(),
+		.def(py::init<uint32_t, uint32_t, uint32_t, float, uint32_t, uint32_t, float, const std::string&, const std::string&, const std::string&, const std::string&, const std::string&, const std::string&, uint32_t>(),
 			py::arg("width"),
 			py::arg("height"),
 			py::arg("depth"),
@@ -522,6 +613,12 @@ PYBIND11_MODULE(splv_encoder_py, m) {
 			py::arg("maxBrickGroupSize"),
 			py::arg("motionVectors"),
 			py::arg("outputPath"),
+			py::arg("motionSearchPreset") = "default",
+			py::arg("entropyCoder") = "range",
+			py::arg("geometryCoder") = "rle",
+			py::arg("voxelOrder") = "linear",
+			py::arg("brickOrder") = "linear",
+			py::arg("tileSize") = 0,
 			"Create a new SPLVencoder instance")
 		.def("encode_nvdb_frame", &PySPLVencoder::encode_nvdb_frame,
 			py::arg("path"),
@@ -583,7 +680,7 @@ PYBIND11_MODULE(splv_encoder_py, m) {
 	m.def("upgrade", &upgrade,
 		py::arg("path"),
 		py::arg("outPath"),
-		"Upgrades an SPLV file from the previous version to the current one");
+		"Upgrades an SPLV file from an older version (0.2.1.0 or 0.3.0.0) to the current one");
 
 	m.def("get_metadata", &get_metadata,
 		py::arg("path"),
@@ -19,7 +19,9 @@ class PySPLVencoder
 {
 public:
 	PySPLVencoder(uint32_t width, uint32_t height, uint32_t depth, float framerate, 
-	              uint32_t gopSize, uint32_t maxBrickGroupSize, bool motionVectors, std::string outPath);
+	              uint32_t gopSize, uint32_t maxBrickGroupSize, bool motionVectors, std::string outPath,
+	              std::string motionSearchPreset = "default", std::string entropyCoder = "range", std::string geometryCoder = "rle",
+	              std::string voxelOrder = "linear", std::string brickOrder = "linear", uint32_t tileSize = 0);
 
 	void encode_nvdb_frame(std::string path, int32_t minX, int32_t minY, int32_t minZ,
 	                       int32_t maxX, int32_t maxY, int32_t maxZ, std::string lrAxis, 
@@ -37,6 +39,7 @@ public:
 private:
 	SPLVencoder m_encoder;
 
+	//frames being encoded by the current call, the encoder copies each one so they are freed once it returns
 	std::vector<SPLVframe> m_activeFrames;
 	std::vector<std::pair<SPLVframe**, uint32_t>> m_activeVoxFrames;
 
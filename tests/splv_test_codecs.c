@@ -0,0 +1,900 @@
+/* splv_test_codecs.c
+ *
+ * round-trip tests for SPLV's entropy, geometry and color coding, and the orders + tiles bricks are coded in
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "splv_test_utils.h"
+#include "spatialstudio/splv_rans.h"
+#include "spatialstudio/splv_range_coder.h"
+#include "spatialstudio/splv_occupancy_coder.h"
+#include "spatialstudio/splv_encoder.h"
+#include "spatialstudio/splv_decoder.h"
+#include "splv_freq_table.h"
+#include "splv_morton_lut.h"
+
+//-------------------------------------------//
+
+#define SPLV_TEST_PATH "splv_test_codecs.splv"
+
+#define SPLV_TEST_MAP_SIZE 4
+#define SPLV_TEST_NUM_FRAMES 8
+#define SPLV_TEST_GOP_SIZE 4
+
+//-------------------------------------------//
+
+typedef SPLVerror (*SPLVtestEntropyCoderFunc)(uint64_t inBufLen, uint8_t* inBuf, SPLVbufferWriter* out);
+
+static int _splv_test_entropy_coder(SPLVtestEntropyCoderFunc encode, SPLVtestEntropyCoderFunc decode);
+static int _splv_test_encode_decode(SPLVencodingParams encodingParams, splv_bool_t staticFrames);
+
+//-------------------------------------------//
+
+static int splv_test_skip_bitmap(void)
+{
+	//the test frames have bricks that never change, which are skipped in p-frames. They must be restored with + without motion vectors
+	for(uint32_t motionVectors = 0; motionVectors < 2; motionVectors++)
+	{
+		SPLVencodingParams encodingParams = {0};
+		encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+		encodingParams.motionVectors = (splv_bool_t)motionVectors;
+
+		if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+			return 1;
+	}
+
+	//a sequence of identical frames has every p-frame brick skipped, leaving p-frames far smaller than i-frames:
+	//---------------
+	SPLVencodingParams encodingParams = {0};
+	encodingParams.gopSize = SPLV_TEST_NUM_FRAMES;
+
+	if(_splv_test_encode_decode(encodingParams, SPLV_TRUE) != 0)
+		return 1;
+
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) == SPLV_SUCCESS, "failed to create decoder");
+
+	uint64_t offsetMask = (1ull << 56) - 1;
+	uint64_t iFrameLen = (decoder.frameTable[1] & offsetMask) - (decoder.frameTable[0] & offsetMask);
+
+	splv_bool_t allSkipped = SPLV_TRUE;
+	for(uint32_t i = 1; i < SPLV_TEST_NUM_FRAMES; i++)
+	{
+		uint64_t end = (i + 1 < SPLV_TEST_NUM_FRAMES) ? (decoder.frameTable[i + 1] & offsetMask) : decoder.frameTablePtr;
+		uint64_t pFrameLen = end - (decoder.frameTable[i] & offsetMask);
+
+		if(pFrameLen * 8 > iFrameLen)
+			allSkipped = SPLV_FALSE;
+	}
+
+	splv_decoder_destroy(&decoder);
+
+	SPLV_TEST_ASSERT(allSkipped, "unchanged bricks were not skipped");
+
+	return 0;
+}
+
+static int splv_test_rans(void)
+{
+	if(_splv_test_entropy_coder(splv_rans_encode, splv_rans_decode) != 0)
+		return 1;
+
+	//files coded with every entropy coder round-trip:
+	//---------------
+	for(uint32_t entropyCoder = 0; entropyCoder < SPLV_ENTROPY_CODER_COUNT; entropyCoder++)
+	{
+		SPLVencodingParams encodingParams = {0};
+		encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+		encodingParams.motionVectors = SPLV_TRUE;
+		encodingParams.entropyCoder = (SPLVentropyCoder)entropyCoder;
+
+		if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int splv_test_range_coder(void)
+{
+	return _splv_test_entropy_coder(splv_rc_encode, splv_rc_decode);
+}
+
+static int splv_test_brick_streams(void)
+{
+	//brick groups of any size split into streams that round-trip under every entropy coder, 0 is one group per tile:
+	uint32_t groupSizes[] = { 1, 4, 0 };
+
+	for(uint32_t i = 0; i < sizeof(groupSizes) / sizeof(groupSizes[0]); i++)
+	for(uint32_t entropyCoder = 0; entropyCoder < SPLV_ENTROPY_CODER_COUNT; entropyCoder++)
+	for(uint32_t motionVectors = 0; motionVectors < 2; motionVectors++)
+	{
+		SPLVencodingParams encodingParams = {0};
+		encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+		encodingParams.maxBrickGroupSize = groupSizes[i];
+		encodingParams.motionVectors = (splv_bool_t)motionVectors;
+		encodingParams.entropyCoder = (SPLVentropyCoder)entropyCoder;
+
+		if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int splv_test_freq_table(void)
+{
+	uint32_t randState = 1;
+	uint32_t scales[] = { SPLV_FREQ_TABLE_NUM_SYMBOLS, 1u << 12, 1u << 16 };
+
+	for(uint32_t i = 0; i < sizeof(scales) / sizeof(scales[0]); i++)
+	{
+		for(uint32_t j = 0; j < 16; j++)
+		{
+			//count symbols, leaving runs of absent ones:
+			//---------------
+			uint64_t counts[SPLV_FREQ_TABLE_NUM_SYMBOLS];
+			uint64_t total = 0;
+			for(uint32_t k = 0; k < SPLV_FREQ_TABLE_NUM_SYMBOLS; k++)
+			{
+				uint32_t r = splv_test_rand(&randState);
+				counts[k] = (r % 3 == 0) ? 0 : (r >> 8) % (1u << (j + 1));
+				total += counts[k];
+			}
+
+			if(total == 0)
+			{
+				counts[j] = 1;
+				total = 1;
+			}
+
+			//normalize:
+			//---------------
+			uint32_t frequencies[SPLV_FREQ_TABLE_NUM_SYMBOLS];
+			splv_freq_table_normalize(counts, total, scales[i], frequencies);
+
+			uint64_t sum = 0;
+			for(uint32_t k = 0; k < SPLV_FREQ_TABLE_NUM_SYMBOLS; k++)
+			{
+				SPLV_TEST_ASSERT(counts[k] == 0 || frequencies[k] > 0, "symbol that occurs was given a frequency of 0");
+				sum += frequencies[k];
+			}
+
+			SPLV_TEST_ASSERT(sum == scales[i], "normalized frequencies do not sum to scale");
+
+			//write + read back:
+			//---------------
+			SPLVbufferWriter out;
+			SPLV_TEST_ASSERT(splv_buffer_writer_create(&out, 0) == SPLV_SUCCESS, "failed to create buffer writer");
+			SPLV_TEST_ASSERT(splv_freq_table_write(&out, total, frequencies) == SPLV_SUCCESS, "failed to write frequency table");
+
+			SPLVbufferReader in;
+			splv_buffer_reader_create(&in, out.buf, out.writePos);
+
+			uint64_t numSymbolsRead;
+			uint32_t frequenciesRead[SPLV_FREQ_TABLE_NUM_SYMBOLS];
+			SPLVerror readError = splv_freq_table_read(&in, scales[i], &numSymbolsRead, frequenciesRead);
+			splv_buffer_writer_destroy(&out);
+
+			SPLV_TEST_ASSERT(readError == SPLV_SUCCESS, "failed to read frequency table");
+			SPLV_TEST_ASSERT(numSymbolsRead == total, "number of symbols did not round-trip");
+			SPLV_TEST_ASSERT(memcmp(frequencies, frequenciesRead, sizeof(frequencies)) == 0, "frequencies did not round-trip");
+		}
+	}
+
+	//an empty table doesn't touch the frequencies:
+	//---------------
+	SPLVbufferWriter out;
+	SPLV_TEST_ASSERT(splv_buffer_writer_create(&out, 0) == SPLV_SUCCESS, "failed to create buffer writer");
+	SPLV_TEST_ASSERT(splv_freq_table_write(&out, 0, NULL) == SPLV_SUCCESS, "failed to write empty frequency table");
+
+	SPLVbufferReader in;
+	splv_buffer_reader_create(&in, out.buf, out.writePos);
+
+	uint64_t numSymbolsRead;
+	uint32_t frequenciesRead[SPLV_FREQ_TABLE_NUM_SYMBOLS];
+	memset(frequenciesRead, 0xAB, sizeof(frequenciesRead));
+
+	SPLVerror readError = splv_freq_table_read(&in, 1u << 12, &numSymbolsRead, frequenciesRead);
+	splv_buffer_writer_destroy(&out);
+
+	SPLV_TEST_ASSERT(readError == SPLV_SUCCESS, "failed to read empty frequency table");
+	SPLV_TEST_ASSERT(numSymbolsRead == 0, "empty frequency table read with symbols");
+	SPLV_TEST_ASSERT(frequenciesRead[0] == 0xABABABAB, "empty frequency table modified frequencies");
+
+	//a table not summing to the scale is rejected:
+	//---------------
+	uint32_t frequencies[SPLV_FREQ_TABLE_NUM_SYMBOLS] = {0};
+	frequencies[0] = 100;
+	frequencies[7] = 200;
+
+	SPLV_TEST_ASSERT(splv_buffer_writer_create(&out, 0) == SPLV_SUCCESS, "failed to create buffer writer");
+	SPLV_TEST_ASSERT(splv_freq_table_write(&out, 300, frequencies) == SPLV_SUCCESS, "failed to write frequency table");
+
+	splv_buffer_reader_create(&in, out.buf, out.writePos);
+	readError = splv_freq_table_read(&in, 1u << 12, &numSymbolsRead, frequenciesRead);
+	splv_buffer_writer_destroy(&out);
+
+	SPLV_TEST_ASSERT(readError != SPLV_SUCCESS, "frequency table with the wrong sum was accepted");
+
+	return 0;
+}
+
+static int splv_test_occupancy_coder(void)
+{
+	uint32_t randState = 2;
+
+	#define SPLV_TEST_NUM_BITMAPS 64
+	#define SPLV_TEST_BITMAP_LEN (SPLV_BRICK_LEN / 32)
+
+	uint32_t bitmaps[SPLV_TEST_NUM_BITMAPS][SPLV_TEST_BITMAP_LEN];
+	uint32_t refBitmaps[SPLV_TEST_NUM_BITMAPS][SPLV_TEST_BITMAP_LEN];
+
+	//generate bitmaps of varying density, every other one predicted from a similar reference:
+	//---------------
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_BITMAPS; i++)
+	{
+		uint32_t density = i % 9; //out of 8, 0 is empty + 8 is full
+
+		for(uint32_t j = 0; j < SPLV_BRICK_LEN; j++)
+		{
+			if(j % 32 == 0)
+			{
+				bitmaps[i][j / 32] = 0;
+				refBitmaps[i][j / 32] = 0;
+			}
+
+			splv_bool_t filled = (splv_test_rand(&randState) % 8) < density;
+			splv_bool_t refFilled = (splv_test_rand(&randState) % 16 == 0) ? !filled : filled;
+
+			bitmaps[i][j / 32] |= (uint32_t)filled << (j % 32);
+			refBitmaps[i][j / 32] |= (uint32_t)refFilled << (j % 32);
+		}
+	}
+
+	//encode:
+	//---------------
+	SPLVbufferWriter out;
+	SPLV_TEST_ASSERT(splv_buffer_writer_create(&out, 0) == SPLV_SUCCESS, "failed to create buffer writer");
+
+	SPLVoccupancyEncoder encoder;
+	splv_occupancy_encoder_init(&encoder);
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_BITMAPS; i++)
+	{
+		const uint32_t* refBitmap = (i % 2 == 0) ? NULL : refBitmaps[i];
+		SPLV_TEST_ASSERT(splv_occupancy_encode(&encoder, &out, bitmaps[i], refBitmap) == SPLV_SUCCESS, "failed to encode occupancy");
+	}
+
+	SPLV_TEST_ASSERT(splv_occupancy_encoder_finish(&encoder, &out) == SPLV_SUCCESS, "failed to finish occupancy encoder");
+
+	//decode + compare:
+	//---------------
+	SPLVoccupancyDecoder decoder;
+	splv_occupancy_decoder_init(&decoder, out.writePos, out.buf);
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_BITMAPS; i++)
+	{
+		const uint32_t* refBitmap = (i % 2 == 0) ? NULL : refBitmaps[i];
+
+		uint32_t decoded[SPLV_TEST_BITMAP_LEN];
+		SPLVerror decodeError = splv_occupancy_decode(&decoder, refBitmap, decoded);
+		if(decodeError != SPLV_SUCCESS || memcmp(decoded, bitmaps[i], sizeof(decoded)) != 0)
+		{
+			splv_buffer_writer_destroy(&out);
+			SPLV_TEST_ASSERT(SPLV_FALSE, "occupancy bitmap did not round-trip");
+		}
+	}
+
+	splv_buffer_writer_destroy(&out);
+
+	#undef SPLV_TEST_BITMAP_LEN
+	#undef SPLV_TEST_NUM_BITMAPS
+
+	//files coded with every geometry coder round-trip:
+	//---------------
+	for(uint32_t geometryCoder = 0; geometryCoder < SPLV_GEOMETRY_CODER_COUNT; geometryCoder++)
+	for(uint32_t motionVectors = 0; motionVectors < 2; motionVectors++)
+	{
+		SPLVencodingParams encodingParams = {0};
+		encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+		encodingParams.motionVectors = (splv_bool_t)motionVectors;
+		encodingParams.geometryCoder = (SPLVgeometryCoder)geometryCoder;
+
+		if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int splv_test_color_prediction(void)
+{
+	uint32_t randState = 3;
+
+	//last frame for predictive bricks, holding a sparse version of the brick being coded:
+	//---------------
+	SPLVframe lastFrame;
+	SPLV_TEST_ASSERT(splv_frame_create(&lastFrame, 1, 1, 1, 1) == SPLV_SUCCESS, "failed to create frame");
+
+	splv_brick_clear(splv_frame_get_next_brick(&lastFrame));
+	if(splv_frame_push_next_brick(&lastFrame, 0, 0, 0) != SPLV_SUCCESS)
+	{
+		splv_frame_destroy(&lastFrame);
+		SPLV_TEST_ASSERT(SPLV_FALSE, "failed to push brick");
+	}
+
+	SPLVbrick* lastBrick = &lastFrame.bricks[lastFrame.map[0]];
+
+	SPLVbufferWriter out[SPLV_BRICK_STREAM_COUNT];
+	for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT; i++)
+		splv_buffer_writer_create(&out[i], 0);
+
+	//smooth gradients, flat colors and noise each take different predictors, intra + with newly filled voxels:
+	//---------------
+	int result = 0;
+	for(uint32_t pattern = 0; pattern < 3 && result == 0; pattern++)
+	for(uint32_t order = 0; order < SPLV_VOXEL_ORDER_COUNT && result == 0; order++)
+	for(uint32_t predictive = 0; predictive < 2 && result == 0; predictive++)
+	{
+		SPLVbrick brick;
+		splv_brick_clear(&brick);
+		splv_brick_clear(lastBrick);
+
+		for(uint32_t z = 0; z < SPLV_BRICK_SIZE; z++)
+		for(uint32_t y = 0; y < SPLV_BRICK_SIZE; y++)
+		for(uint32_t x = 0; x < SPLV_BRICK_SIZE; x++)
+		{
+			uint32_t r = splv_test_rand(&randState);
+			if(r % 3 == 0)
+				continue;
+
+			uint8_t colorR, colorG, colorB;
+			switch(pattern)
+			{
+			case 0:
+				colorR = (uint8_t)(x * 30);
+				colorG = (uint8_t)(y * 30 + x);
+				colorB = (uint8_t)(z * 30);
+				break;
+			case 1:
+				colorR = 90;
+				colorG = 140;
+				colorB = 200;
+				break;
+			default:
+				colorR = (uint8_t)(r >> 8);
+				colorG = (uint8_t)(r >> 16);
+				colorB = (uint8_t)(r >> 24);
+				break;
+			}
+
+			splv_brick_set_voxel_filled(&brick, x, y, z, colorR, colorG, colorB);
+			if(r % 2 == 0)
+				splv_brick_set_voxel_filled(lastBrick, x, y, z, colorR, colorG, colorB);
+		}
+
+		//encode + decode:
+		//---------------
+		for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT; i++)
+			splv_buffer_writer_reset(&out[i]);
+
+		uint32_t numVoxels;
+		SPLVerror encodeError;
+		if(predictive)
+			encodeError = splv_brick_encode_predictive(&brick, 0, 0, 0, out, NULL, (SPLVvoxelOrder)order, &lastFrame, &numVoxels, NULL, NULL);
+		else
+			encodeError = splv_brick_encode_intra(&brick, out, NULL, (SPLVvoxelOrder)order, &numVoxels);
+
+		if(encodeError != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to encode brick with color pattern %u\n", pattern);
+			result = 1;
+			break;
+		}
+
+		SPLVbufferReader in[SPLV_BRICK_STREAM_COUNT];
+		for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT; i++)
+			splv_buffer_reader_create(&in[i], out[i].buf, out[i].writePos);
+
+		SPLVbrick decoded;
+		uint32_t numVoxelsDecoded;
+		if(splv_brick_decode(in, NULL, (SPLVvoxelOrder)order, &decoded, NULL, 0, 0, 0, 0, &lastFrame, &numVoxelsDecoded) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode brick with color pattern %u\n", pattern);
+			result = 1;
+			break;
+		}
+
+		if(!splv_brick_equals(&brick, &decoded) || numVoxelsDecoded != numVoxels)
+		{
+			printf("FAILED: brick with color pattern %u, voxel order %u did not round-trip %s\n", pattern, order, predictive ? "predictively" : "intra");
+			result = 1;
+		}
+	}
+
+	for(uint32_t i = 0; i < SPLV_BRICK_STREAM_COUNT; i++)
+		splv_buffer_writer_destroy(&out[i]);
+	splv_frame_destroy(&lastFrame);
+
+	return result;
+}
+
+static int splv_test_voxel_order(void)
+{
+	//bit 3i of a morton code is bit i of x, then y, then z:
+	//---------------
+	uint8_t seen[SPLV_BRICK_LEN] = {0};
+	for(uint32_t code = 0; code < SPLV_BRICK_LEN; code++)
+	{
+		uint32_t x = 0, y = 0, z = 0;
+		for(uint32_t i = 0; i < 3; i++)
+		{
+			x |= ((code >> (3 * i    )) & 1) << i;
+			y |= ((code >> (3 * i + 1)) & 1) << i;
+			z |= ((code >> (3 * i + 2)) & 1) << i;
+		}
+
+		uint32_t idx = MORTON_TO_IDX[code];
+		SPLV_TEST_ASSERT(idx == x + SPLV_BRICK_SIZE * (y + SPLV_BRICK_SIZE * z), "morton lookup table entry is not the interleaved coordinate");
+		SPLV_TEST_ASSERT(!seen[idx], "morton lookup table is not a permutation");
+		seen[idx] = 1;
+	}
+
+	//every voxel order round-trips through the encoder:
+	//---------------
+	for(uint32_t voxelOrder = 0; voxelOrder < SPLV_VOXEL_ORDER_COUNT; voxelOrder++)
+	for(uint32_t motionVectors = 0; motionVectors < 2; motionVectors++)
+	{
+		SPLVencodingParams encodingParams = {0};
+		encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+		encodingParams.motionVectors = (splv_bool_t)motionVectors;
+		encodingParams.voxelOrder = (SPLVvoxelOrder)voxelOrder;
+
+		if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int splv_test_brick_order(void)
+{
+	//every order sequences each map position exactly once:
+	//---------------
+	uint32_t sizes[][3] = { { 4, 4, 4 }, { 5, 3, 2 }, { 1, 7, 3 } };
+
+	for(uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	for(uint32_t order = 0; order < SPLV_BRICK_ORDER_COUNT; order++)
+	{
+		uint32_t width = sizes[i][0], height = sizes[i][1], depth = sizes[i][2];
+		uint32_t mapLen = width * height * depth;
+
+		uint32_t mapIndices[7 * 7 * 7];
+		splv_frame_get_brick_order(width, height, depth, (SPLVbrickOrder)order, 0, mapIndices, NULL);
+
+		uint8_t seenMap[7 * 7 * 7] = {0};
+		for(uint32_t j = 0; j < mapLen; j++)
+		{
+			uint32_t mapIdx = mapIndices[j];
+			SPLV_TEST_ASSERT(mapIdx < mapLen && !seenMap[mapIdx], "brick order is not a permutation");
+			seenMap[mapIdx] = 1;
+		}
+	}
+
+	//morton brick order visits each 2x2x2 block in turn:
+	//---------------
+	uint32_t mapIndices[4 * 4 * 4];
+	splv_frame_get_brick_order(4, 4, 4, SPLV_BRICK_ORDER_MORTON, 0, mapIndices, NULL);
+
+	for(uint32_t i = 0; i < 4 * 4 * 4; i += 8)
+	{
+		uint32_t firstIdx = mapIndices[i];
+		for(uint32_t j = i; j < i + 8; j++)
+		{
+			uint32_t mapIdx = mapIndices[j];
+			SPLV_TEST_ASSERT(
+				(mapIdx % 4) / 2 == (firstIdx % 4) / 2 && ((mapIdx / 4) % 4) / 2 == ((firstIdx / 4) % 4) / 2 &&
+				(mapIdx / 16) / 2 == (firstIdx / 16) / 2,
+				"morton brick order does not keep 2x2x2 blocks together"
+			);
+		}
+	}
+
+	//every brick order round-trips through the encoder, with brick groups smaller than a frame:
+	//---------------
+	for(uint32_t brickOrder = 0; brickOrder < SPLV_BRICK_ORDER_COUNT; brickOrder++)
+	for(uint32_t voxelOrder = 0; voxelOrder < SPLV_VOXEL_ORDER_COUNT; voxelOrder++)
+	{
+		SPLVencodingParams encodingParams = {0};
+		encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+		encodingParams.maxBrickGroupSize = 8;
+		encodingParams.motionVectors = SPLV_TRUE;
+		encodingParams.voxelOrder = (SPLVvoxelOrder)voxelOrder;
+		encodingParams.brickOrder = (SPLVbrickOrder)brickOrder;
+
+		if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int splv_test_tiles(void)
+{
+	//tiled brick orders cover the map, with each tile's positions consecutive:
+	//---------------
+	uint32_t sizes[][3] = { { 4, 4, 4 }, { 5, 3, 2 }, { 1, 7, 3 } };
+	uint32_t orderTileSizes[] = { 0, 1, 2, 3 };
+
+	for(uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	for(uint32_t j = 0; j < sizeof(orderTileSizes) / sizeof(orderTileSizes[0]); j++)
+	for(uint32_t order = 0; order < SPLV_BRICK_ORDER_COUNT; order++)
+	{
+		uint32_t width = sizes[i][0], height = sizes[i][1], depth = sizes[i][2];
+		uint32_t tileSize = orderTileSizes[j];
+
+		uint32_t mapLen = width * height * depth;
+		uint32_t numTiles = splv_frame_get_num_tiles(width, height, depth, tileSize);
+
+		uint32_t mapIndices[7 * 7 * 7];
+		uint32_t tileStarts[7 * 7 * 7 + 1];
+		splv_frame_get_brick_order(width, height, depth, (SPLVbrickOrder)order, tileSize, mapIndices, tileStarts);
+
+		SPLV_TEST_ASSERT(tileStarts[0] == 0 && tileStarts[numTiles] == mapLen, "tiles do not cover the whole map");
+
+		uint8_t seenMap[7 * 7 * 7] = {0};
+		for(uint32_t tile = 0; tile < numTiles; tile++)
+		{
+			SPLV_TEST_ASSERT(tileStarts[tile] < tileStarts[tile + 1], "tile is empty");
+
+			for(uint32_t k = tileStarts[tile]; k < tileStarts[tile + 1]; k++)
+			{
+				uint32_t mapIdx = mapIndices[k];
+				SPLV_TEST_ASSERT(mapIdx < mapLen && !seenMap[mapIdx], "tiled brick order is not a permutation");
+				seenMap[mapIdx] = 1;
+
+				if(tileSize == 0)
+					continue;
+
+				uint32_t firstIdx = mapIndices[tileStarts[tile]];
+				SPLV_TEST_ASSERT(
+					(mapIdx % width) / tileSize == (firstIdx % width) / tileSize &&
+					((mapIdx / width) % height) / tileSize == ((firstIdx / width) % height) / tileSize &&
+					(mapIdx / (width * height)) / tileSize == (firstIdx / (width * height)) / tileSize,
+					"brick is sequenced in the wrong tile"
+				);
+			}
+		}
+	}
+
+	//every tile size round-trips:
+	//---------------
+	uint32_t tileSizes[] = { 1, 2, 3 };
+	for(uint32_t i = 0; i < sizeof(tileSizes) / sizeof(tileSizes[0]); i++)
+	for(uint32_t brickOrder = 0; brickOrder < SPLV_BRICK_ORDER_COUNT; brickOrder++)
+	{
+		SPLVencodingParams encodingParams = {0};
+		encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+		encodingParams.motionVectors = SPLV_TRUE;
+		encodingParams.brickOrder = (SPLVbrickOrder)brickOrder;
+		encodingParams.tileSize = tileSizes[i];
+
+		if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+			return 1;
+	}
+
+	//decoding a region only decodes the tiles it intersects, each exactly:
+	//---------------
+	uint32_t tileSize = 2;
+
+	SPLVencodingParams encodingParams = {0};
+	encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+	encodingParams.motionVectors = SPLV_TRUE;
+	encodingParams.tileSize = tileSize;
+
+	if(_splv_test_encode_decode(encodingParams, SPLV_FALSE) != 0)
+		return 1;
+
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) == SPLV_SUCCESS, "failed to create decoder");
+
+	//covers part of the first tile only
+	SPLVboundingBox region = { 1, 1, 1, SPLV_BRICK_SIZE + 2, 5, SPLV_BRICK_SIZE };
+
+	uint32_t randState = 4;
+	SPLVframe lastFrame;
+	splv_bool_t hasLastFrame = SPLV_FALSE;
+	int result = 0;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		SPLVframe frame;
+		SPLVframe decoded;
+		if(splv_test_create_frame(&frame, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, i, &randState) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to create test frame\n");
+			result = 1;
+			break;
+		}
+
+		SPLVframeIndexed dependency = { i - 1, &lastFrame };
+		uint64_t numDependencies = (i % SPLV_TEST_GOP_SIZE == 0) ? 0 : 1;
+		if(splv_decoder_decode_frame_region(&decoder, i, numDependencies, &dependency, region, &decoded, NULL) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode region of frame %u\n", i);
+			splv_frame_destroy(&frame);
+			result = 1;
+			break;
+		}
+
+		for(uint32_t j = 0; j < SPLV_TEST_MAP_SIZE * SPLV_TEST_MAP_SIZE * SPLV_TEST_MAP_SIZE; j++)
+		{
+			splv_bool_t inTile = j % SPLV_TEST_MAP_SIZE < tileSize && (j / SPLV_TEST_MAP_SIZE) % SPLV_TEST_MAP_SIZE < tileSize &&
+			                     j / (SPLV_TEST_MAP_SIZE * SPLV_TEST_MAP_SIZE) < tileSize;
+
+			uint32_t brickIdx = frame.map[j];
+			uint32_t decodedBrickIdx = decoded.map[j];
+
+			if(!inTile)
+			{
+				if(decodedBrickIdx != SPLV_BRICK_IDX_EMPTY)
+				{
+					printf("FAILED: brick outside of the region's tiles was decoded in frame %u\n", i);
+					result = 1;
+				}
+			}
+			else if((brickIdx == SPLV_BRICK_IDX_EMPTY) != (decodedBrickIdx == SPLV_BRICK_IDX_EMPTY) ||
+			        (brickIdx != SPLV_BRICK_IDX_EMPTY && !splv_brick_equals(&frame.bricks[brickIdx], &decoded.bricks[decodedBrickIdx])))
+			{
+				printf("FAILED: brick inside the region's tiles did not round-trip in frame %u\n", i);
+				result = 1;
+			}
+		}
+
+		splv_frame_destroy(&frame);
+		if(hasLastFrame)
+			splv_frame_destroy(&lastFrame);
+
+		lastFrame = decoded;
+		hasLastFrame = SPLV_TRUE;
+	}
+
+	if(hasLastFrame)
+		splv_frame_destroy(&lastFrame);
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+//-------------------------------------------//
+
+int main(void)
+{
+	uint32_t numFailed = 0;
+
+	SPLV_TEST_RUN(splv_test_skip_bitmap, numFailed);
+	SPLV_TEST_RUN(splv_test_rans, numFailed);
+	SPLV_TEST_RUN(splv_test_range_coder, numFailed);
+	SPLV_TEST_RUN(splv_test_brick_streams, numFailed);
+	SPLV_TEST_RUN(splv_test_freq_table, numFailed);
+	SPLV_TEST_RUN(splv_test_occupancy_coder, numFailed);
+	SPLV_TEST_RUN(splv_test_color_prediction, numFailed);
+	SPLV_TEST_RUN(splv_test_voxel_order, numFailed);
+	SPLV_TEST_RUN(splv_test_brick_order, numFailed);
+	SPLV_TEST_RUN(splv_test_tiles, numFailed);
+
+	remove(SPLV_TEST_PATH);
+
+	if(numFailed > 0)
+	{
+		printf("%u test(s) failed\n", numFailed);
+		return 1;
+	}
+
+	printf("all tests passed\n");
+	return 0;
+}
+
+//-------------------------------------------//
+
+static int _splv_test_entropy_coder(SPLVtestEntropyCoderFunc encode, SPLVtestEntropyCoderFunc decode)
+{
+	uint32_t randState = 5;
+
+	#define SPLV_TEST_NUM_INPUTS 7
+	#define SPLV_TEST_INPUT_LEN 100000
+
+	uint64_t lens[SPLV_TEST_NUM_INPUTS] = { 0, 1, SPLV_TEST_INPUT_LEN, SPLV_TEST_INPUT_LEN, SPLV_TEST_INPUT_LEN, SPLV_TEST_INPUT_LEN, 3 };
+
+	uint8_t* input = (uint8_t*)malloc(SPLV_TEST_INPUT_LEN);
+	SPLV_TEST_ASSERT(input != NULL, "failed to allocate input");
+
+	SPLVbufferWriter encoded;
+	SPLVbufferWriter decoded;
+	splv_buffer_writer_create(&encoded, 0);
+	splv_buffer_writer_create(&decoded, 0);
+
+	int result = 0;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_INPUTS && result == 0; i++)
+	{
+		//generate input, covering the empty, single-symbol, uniform, skewed and every-symbol cases:
+		//---------------
+		for(uint64_t j = 0; j < lens[i]; j++)
+		{
+			uint32_t r = splv_test_rand(&randState);
+			switch(i)
+			{
+			case 2:
+				input[j] = 42;
+				break;
+			case 3:
+				input[j] = (uint8_t)r;
+				break;
+			case 4:
+			{
+				//roughly geometric, like residuals
+				uint8_t symbol = 0;
+				while(symbol < 255 && (r & 3) != 0)
+				{
+					symbol++;
+					r >>= 2;
+					if(r == 0)
+						r = splv_test_rand(&randState);
+				}
+
+				input[j] = symbol;
+				break;
+			}
+			case 5:
+				input[j] = (uint8_t)j;
+				break;
+			default:
+				input[j] = (uint8_t)(r % 3);
+				break;
+			}
+		}
+
+		//encode + decode:
+		//---------------
+		splv_buffer_writer_reset(&encoded);
+		splv_buffer_writer_reset(&decoded);
+
+		if(encode(lens[i], input, &encoded) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to encode input %u\n", i);
+			result = 1;
+			break;
+		}
+
+		if(decode(encoded.writePos, encoded.buf, &decoded) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode input %u\n", i);
+			result = 1;
+			break;
+		}
+
+		if(decoded.writePos != lens[i] || (lens[i] > 0 && memcmp(decoded.buf, input, lens[i]) != 0))
+		{
+			printf("FAILED: input %u did not round-trip\n", i);
+			result = 1;
+		}
+	}
+
+	splv_buffer_writer_destroy(&encoded);
+	splv_buffer_writer_destroy(&decoded);
+	free(input);
+
+	#undef SPLV_TEST_INPUT_LEN
+	#undef SPLV_TEST_NUM_INPUTS
+
+	return result;
+}
+
+static int _splv_test_encode_decode(SPLVencodingParams encodingParams, splv_bool_t staticFrames)
+{
+	//create frames:
+	//---------------
+	uint32_t randState = 4;
+
+	SPLVframe frames[SPLV_TEST_NUM_FRAMES];
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+	{
+		if(staticFrames)
+			randState = 4;
+
+		SPLVerror frameError = splv_test_create_frame(&frames[i], SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, 
+			staticFrames ? 0 : i, &randState);
+		if(frameError != SPLV_SUCCESS)
+		{
+			for(uint32_t j = 0; j < i; j++)
+				splv_frame_destroy(&frames[j]);
+
+			SPLV_TEST_ASSERT(SPLV_FALSE, "failed to create test frame");
+		}
+	}
+
+	//encode:
+	//---------------
+	int result = 0;
+	uint32_t size = SPLV_TEST_MAP_SIZE * SPLV_BRICK_SIZE;
+
+	SPLVencoder encoder;
+	if(splv_encoder_create(&encoder, size, size, size, 30.0f, encodingParams, SPLV_TEST_PATH) != SPLV_SUCCESS)
+	{
+		printf("FAILED: failed to create encoder\n");
+		result = 1;
+	}
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		splv_bool_t canFree;
+		if(splv_encoder_encode_frame(&encoder, &frames[i], &canFree) != SPLV_SUCCESS)
+		{
+			splv_encoder_abort(&encoder);
+
+			printf("FAILED: failed to encode frame %u\n", i);
+			result = 1;
+		}
+	}
+
+	if(result == 0 && splv_encoder_finish(&encoder) != SPLV_SUCCESS)
+	{
+		printf("FAILED: failed to finish encoding\n");
+		result = 1;
+	}
+
+	//decode + compare, both full and compact frames:
+	//---------------
+	SPLVdecoder decoder;
+	if(result == 0 && splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) != SPLV_SUCCESS)
+	{
+		printf("FAILED: failed to create decoder\n");
+		result = 1;
+	}
+
+	splv_bool_t decoderCreated = result == 0;
+
+	SPLVframe lastFrame;
+	splv_bool_t hasLastFrame = SPLV_FALSE;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		SPLVframeIndexed dependency = { i - 1, &lastFrame };
+		uint64_t numDependencies = (i % encodingParams.gopSize == 0) ? 0 : 1;
+
+		SPLVframe decoded;
+		SPLVframeCompact decodedCompact;
+		if(splv_decoder_decode_frame(&decoder, i, numDependencies, &dependency, &decoded, &decodedCompact) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode frame %u\n", i);
+			result = 1;
+			break;
+		}
+
+		if(!splv_test_frames_equal(&frames[i], &decoded) || !splv_test_frames_equal_compact(&frames[i], &decodedCompact))
+		{
+			printf("FAILED: frame %u did not round-trip with voxel order %u, brick order %u, entropy coder %u, geometry coder %u, tile size %u\n",
+				i, encodingParams.voxelOrder, encodingParams.brickOrder, encodingParams.entropyCoder, encodingParams.geometryCoder, encodingParams.tileSize);
+			result = 1;
+		}
+
+		splv_frame_compact_destroy(&decodedCompact);
+		if(hasLastFrame)
+			splv_frame_destroy(&lastFrame);
+
+		lastFrame = decoded;
+		hasLastFrame = SPLV_TRUE;
+	}
+
+	//cleanup + return:
+	//---------------
+	if(hasLastFrame)
+		splv_frame_destroy(&lastFrame);
+	if(decoderCreated)
+		splv_decoder_destroy(&decoder);
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+		splv_frame_destroy(&frames[i]);
+
+	return result;
+}
@@ -0,0 +1,828 @@
+/* splv_test_decoders.c
+ *
+ * tests that every way of encoding + decoding a file produces the same frames, and that invalid files are rejected
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "splv_test_utils.h"
+#include "spatialstudio/splv_encoder.h"
+#include "spatialstudio/splv_decoder.h"
+#include "spatialstudio/splv_decoder_parallel.h"
+#include "spatialstudio/splv_frame_cache.h"
+#include "spatialstudio/splv_frame_pool.h"
+
+//-------------------------------------------//
+
+#define SPLV_TEST_PATH "splv_test_decoders.splv"
+#define SPLV_TEST_INVALID_PATH "splv_test_decoders_invalid.splv"
+#define SPLV_TEST_ENCODED_PATH "splv_test_decoders_encoded.splv"
+
+#define SPLV_TEST_MAP_SIZE 4
+#define SPLV_TEST_NUM_FRAMES 12
+#define SPLV_TEST_GOP_SIZE 4
+#define SPLV_TEST_MAX_DEPENDENCIES 4
+
+//-------------------------------------------//
+
+//decoded by the plain file decoder, every other decoder is compared against these
+static SPLVframe g_referenceFrames[SPLV_TEST_NUM_FRAMES];
+
+//-------------------------------------------//
+
+static int _splv_test_decode_all(SPLVdecoder* decoder, SPLVframe* frames);
+static int _splv_test_compare_all(SPLVdecoder* decoder, const char* name);
+static int _splv_test_expect_decode_failure(const char* path);
+static int _splv_test_read_file(const char* path, uint64_t* len, uint8_t** buf);
+static int _splv_test_write_file(const char* path, uint64_t len, uint8_t* buf);
+static int _splv_test_files_equal(const char* path1, const char* path2);
+
+//-------------------------------------------//
+
+static int splv_test_encode(void)
+{
+	uint32_t randState = 6;
+	uint32_t size = SPLV_TEST_MAP_SIZE * SPLV_BRICK_SIZE;
+
+	SPLVencodingParams encodingParams = {0};
+	encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+	encodingParams.motionVectors = SPLV_TRUE;
+	encodingParams.tileSize = 2;
+
+	SPLVencoder encoder;
+	SPLV_TEST_ASSERT(splv_encoder_create(&encoder, size, size, size, 30.0f, encodingParams, SPLV_TEST_PATH) == SPLV_SUCCESS,
+		"failed to create encoder");
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+	{
+		SPLVframe frame;
+		if(splv_test_create_frame(&frame, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, i, &randState) != SPLV_SUCCESS)
+		{
+			splv_encoder_abort(&encoder);
+			SPLV_TEST_ASSERT(SPLV_FALSE, "failed to create test frame");
+		}
+
+		splv_bool_t canFree;
+		SPLVerror encodeError = splv_encoder_encode_frame(&encoder, &frame, &canFree);
+		splv_frame_destroy(&frame);
+
+		if(encodeError != SPLV_SUCCESS)
+		{
+			splv_encoder_abort(&encoder);
+			SPLV_TEST_ASSERT(SPLV_FALSE, "failed to encode frame");
+		}
+	}
+
+	SPLV_TEST_ASSERT(splv_encoder_finish(&encoder) == SPLV_SUCCESS, "failed to finish encoding");
+
+	//decode reference frames:
+	//---------------
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) == SPLV_SUCCESS, "failed to create decoder");
+	SPLV_TEST_ASSERT(decoder.frameCount == SPLV_TEST_NUM_FRAMES, "decoder has the wrong frame count");
+
+	int result = _splv_test_decode_all(&decoder, g_referenceFrames);
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_mem_decoder(void)
+{
+	uint64_t len;
+	uint8_t* buf;
+	if(_splv_test_read_file(SPLV_TEST_PATH, &len, &buf) != 0)
+		return 1;
+
+	SPLVdecoder decoder;
+	if(splv_decoder_create_from_mem(&decoder, len, buf) != SPLV_SUCCESS)
+	{
+		free(buf);
+		SPLV_TEST_ASSERT(SPLV_FALSE, "failed to create memory decoder");
+	}
+
+	int result = _splv_test_compare_all(&decoder, "memory");
+
+	splv_decoder_destroy(&decoder);
+	free(buf);
+
+	return result;
+}
+
+static int splv_test_mmap_decoder(void)
+{
+	SPLVdecoderOptions options = {0};
+	options.readAheadFrames = 2;
+
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file_mmap_with_options(&decoder, SPLV_TEST_PATH, options) == SPLV_SUCCESS,
+		"failed to create mmap decoder");
+
+	int result = _splv_test_compare_all(&decoder, "mmap");
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_prefetch_decoder(void)
+{
+	//a budget smaller than a frame, so the prefetcher has to wait on the decoder
+	SPLVdecoderOptions options = {0};
+	options.prefetchFrames = 3;
+	options.prefetchBudget = 1;
+
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file_with_options(&decoder, SPLV_TEST_PATH, options) == SPLV_SUCCESS,
+		"failed to create prefetching decoder");
+
+	//decoded twice, so the second pass seeks back to the start:
+	int result = _splv_test_compare_all(&decoder, "prefetch");
+	if(result == 0)
+		result = _splv_test_compare_all(&decoder, "prefetch (second pass)");
+
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_frame_cache(void)
+{
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) == SPLV_SUCCESS, "failed to create decoder");
+
+	//no budget, so frames are evicted + decoded again constantly, and a budget holding everything:
+	uint64_t budgets[] = { 0, UINT64_MAX };
+
+	int result = 0;
+	for(uint32_t i = 0; i < sizeof(budgets) / sizeof(budgets[0]) && result == 0; i++)
+	{
+		SPLVframeCache cache;
+		if(splv_frame_cache_create(&cache, &decoder, budgets[i]) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to create frame cache\n");
+			result = 1;
+			break;
+		}
+
+		//random access, including scrubbing backwards:
+		//---------------
+		uint32_t randState = 7;
+		for(uint32_t j = 0; j < 4 * SPLV_TEST_NUM_FRAMES && result == 0; j++)
+		{
+			uint32_t idx = (j < SPLV_TEST_NUM_FRAMES) ? SPLV_TEST_NUM_FRAMES - 1 - j : splv_test_rand(&randState) % SPLV_TEST_NUM_FRAMES;
+
+			SPLVframe* frame;
+			if(splv_frame_cache_get_frame(&cache, idx, &frame) != SPLV_SUCCESS)
+			{
+				printf("FAILED: failed to get frame %u from cache\n", idx);
+				result = 1;
+				break;
+			}
+
+			if(!splv_test_frames_equal(frame, &g_referenceFrames[idx]))
+			{
+				printf("FAILED: cached frame %u does not match reference\n", idx);
+				result = 1;
+			}
+		}
+
+		splv_frame_cache_destroy(&cache);
+	}
+
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_parallel_decoder(void)
+{
+	//a budget smaller than a frame, so workers have to wait on the reader
+	SPLVdecoderParallelOptions options = {0};
+	options.numWorkers = 2;
+	options.memoryBudget = 1;
+
+	SPLVdecoderParallel decoder;
+	SPLV_TEST_ASSERT(splv_decoder_parallel_create(&decoder, SPLV_TEST_PATH, options) == SPLV_SUCCESS, "failed to create parallel decoder");
+
+	int result = 0;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		SPLVframe frame;
+		if(splv_decoder_parallel_next_frame(&decoder, &frame) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode parallel frame %u\n", i);
+			result = 1;
+			break;
+		}
+
+		if(!splv_test_frames_equal(&g_referenceFrames[i], &frame))
+		{
+			printf("FAILED: parallel frame %u does not match reference\n", i);
+			result = 1;
+		}
+
+		splv_frame_destroy(&frame);
+	}
+
+	splv_decoder_parallel_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_lookahead_encoder(void)
+{
+	uint32_t randState = 6;
+	uint32_t size = SPLV_TEST_MAP_SIZE * SPLV_BRICK_SIZE;
+
+	SPLVencodingParams encodingParams = {0};
+	encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+	encodingParams.motionVectors = SPLV_TRUE;
+	encodingParams.tileSize = 2;
+
+	//several GOPs in flight at once, so later GOPs start encoding before earlier ones are written
+	SPLVencoderOptions options = {0};
+	options.maxFramesInFlight = 3 * SPLV_TEST_GOP_SIZE;
+	options.numThreads = 4;
+
+	SPLVencoder encoder;
+	SPLV_TEST_ASSERT(splv_encoder_create_with_options(&encoder, size, size, size, 30.0f, encodingParams, options, SPLV_TEST_ENCODED_PATH) == SPLV_SUCCESS,
+		"failed to create encoder");
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+	{
+		SPLVframe frame;
+		if(splv_test_create_frame(&frame, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, i, &randState) != SPLV_SUCCESS)
+		{
+			splv_encoder_abort(&encoder);
+			SPLV_TEST_ASSERT(SPLV_FALSE, "failed to create test frame");
+		}
+
+		//the encoder takes ownership of the frame, even on failure
+		if(splv_encoder_submit_frame(&encoder, &frame) != SPLV_SUCCESS)
+		{
+			splv_encoder_abort(&encoder);
+			SPLV_TEST_ASSERT(SPLV_FALSE, "failed to submit frame");
+		}
+	}
+
+	SPLV_TEST_ASSERT(splv_encoder_finish(&encoder) == SPLV_SUCCESS, "failed to finish encoding");
+
+	//the file must be identical to encoding one frame at a time:
+	//---------------
+	return _splv_test_files_equal(SPLV_TEST_PATH, SPLV_TEST_ENCODED_PATH);
+}
+
+static int splv_test_encoder_owned_frames(void)
+{
+	uint32_t randState = 6;
+	uint32_t size = SPLV_TEST_MAP_SIZE * SPLV_BRICK_SIZE;
+
+	SPLVencodingParams encodingParams = {0};
+	encodingParams.gopSize = SPLV_TEST_GOP_SIZE;
+	encodingParams.motionVectors = SPLV_TRUE;
+	encodingParams.tileSize = 2;
+
+	//frames stay in flight after they are freed, so the encoder must predict from its own copies
+	SPLVencoderOptions options = {0};
+	options.maxFramesInFlight = SPLV_TEST_GOP_SIZE;
+
+	SPLVencoder encoder;
+	SPLV_TEST_ASSERT(splv_encoder_create_with_options(&encoder, size, size, size, 30.0f, encodingParams, options, SPLV_TEST_ENCODED_PATH) == SPLV_SUCCESS,
+		"failed to create encoder");
+
+	//alternate between full + compact frames, freeing + overwriting each as soon as it is encoded:
+	//---------------
+	SPLVframeCompact compactFrame;
+	memset(&compactFrame, 0, sizeof(SPLVframeCompact));
+
+	SPLVerror encodeError = SPLV_SUCCESS;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && encodeError == SPLV_SUCCESS; i++)
+	{
+		SPLVframe frame;
+		encodeError = splv_test_create_frame(&frame, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, SPLV_TEST_MAP_SIZE, i, &randState);
+		if(encodeError != SPLV_SUCCESS)
+			break;
+
+		if(i % 2 == 0)
+		{
+			splv_bool_t canFree;
+			encodeError = splv_encoder_encode_frame(&encoder, &frame, &canFree);
+		}
+		else
+		{
+			encodeError = splv_frame_compact_pack(&frame, &compactFrame);
+			if(encodeError == SPLV_SUCCESS)
+				encodeError = splv_encoder_encode_frame_compact(&encoder, &compactFrame);
+		}
+
+		splv_frame_destroy(&frame);
+	}
+
+	splv_frame_compact_destroy(&compactFrame);
+
+	if(encodeError != SPLV_SUCCESS)
+	{
+		splv_encoder_abort(&encoder);
+		SPLV_TEST_ASSERT(SPLV_FALSE, "failed to encode frame");
+	}
+
+	SPLV_TEST_ASSERT(splv_encoder_finish(&encoder) == SPLV_SUCCESS, "failed to finish encoding");
+
+	//the file must be identical to encoding frames that outlive the encoder's use of them:
+	//---------------
+	return _splv_test_files_equal(SPLV_TEST_PATH, SPLV_TEST_ENCODED_PATH);
+}
+
+static int splv_test_frame_pool(void)
+{
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) == SPLV_SUCCESS, "failed to create decoder");
+
+	SPLVframePool pool;
+	if(splv_frame_pool_create(&pool, 2) != SPLV_SUCCESS)
+	{
+		splv_decoder_destroy(&decoder);
+		SPLV_TEST_ASSERT(SPLV_FALSE, "failed to create frame pool");
+	}
+
+	//decode into recycled frames, releasing each once the next is decoded:
+	//---------------
+	int result = 0;
+	SPLVframe lastFrame;
+	splv_bool_t hasLastFrame = SPLV_FALSE;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		SPLVframeIndexed dependency = { i - 1, &lastFrame };
+		uint64_t numDependencies = (i % SPLV_TEST_GOP_SIZE == 0) ? 0 : 1;
+
+		SPLVframe frame;
+		splv_frame_pool_acquire(&pool, &frame);
+
+		if(splv_decoder_decode_frame_into(&decoder, i, numDependencies, &dependency, &frame, NULL) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode pooled frame %u\n", i);
+			splv_frame_pool_release(&pool, &frame);
+			result = 1;
+			break;
+		}
+
+		if(!splv_test_frames_equal(&frame, &g_referenceFrames[i]))
+		{
+			printf("FAILED: pooled frame %u does not match reference\n", i);
+			result = 1;
+		}
+
+		if(hasLastFrame)
+			splv_frame_pool_release(&pool, &lastFrame);
+
+		lastFrame = frame;
+		hasLastFrame = SPLV_TRUE;
+	}
+
+	if(hasLastFrame)
+		splv_frame_pool_release(&pool, &lastFrame);
+
+	splv_frame_pool_destroy(&pool);
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_compact_decoder(void)
+{
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) == SPLV_SUCCESS, "failed to create decoder");
+
+	//decode straight to compact frames, from compact dependencies:
+	//---------------
+	int result = 0;
+	SPLVframeCompact frames[2];
+	memset(frames, 0, sizeof(frames));
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		SPLVframeCompactIndexed dependency = { i - 1, &frames[(i + 1) % 2] };
+		uint64_t numDependencies = (i % SPLV_TEST_GOP_SIZE == 0) ? 0 : 1;
+
+		if(splv_decoder_decode_frame_compact(&decoder, i, numDependencies, &dependency, &frames[i % 2]) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode compact frame %u\n", i);
+			result = 1;
+			break;
+		}
+
+		if(!splv_test_frames_equal_compact(&g_referenceFrames[i], &frames[i % 2]))
+		{
+			printf("FAILED: compact frame %u does not match reference\n", i);
+			result = 1;
+		}
+	}
+
+	splv_frame_compact_destroy(&frames[0]);
+	splv_frame_compact_destroy(&frames[1]);
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_compact_frame_cache(void)
+{
+	SPLVdecoder decoder;
+	SPLV_TEST_ASSERT(splv_decoder_create_from_file(&decoder, SPLV_TEST_PATH) == SPLV_SUCCESS, "failed to create decoder");
+
+	SPLVframeCache cache;
+	if(splv_frame_cache_create(&cache, &decoder, 0) != SPLV_SUCCESS)
+	{
+		splv_decoder_destroy(&decoder);
+		SPLV_TEST_ASSERT(SPLV_FALSE, "failed to create frame cache");
+	}
+
+	//cached compact frames, requested backwards so every dependency is decoded from the cache:
+	//---------------
+	int result = 0;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		uint32_t idx = SPLV_TEST_NUM_FRAMES - 1 - i;
+
+		SPLVframeCompact* frame;
+		if(splv_frame_cache_get_frame_compact(&cache, idx, &frame) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to get compact frame %u from cache\n", idx);
+			result = 1;
+			break;
+		}
+
+		if(!splv_test_frames_equal_compact(&g_referenceFrames[idx], frame))
+		{
+			printf("FAILED: cached compact frame %u does not match reference\n", idx);
+			result = 1;
+		}
+	}
+
+	splv_frame_cache_destroy(&cache);
+	splv_decoder_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_compact_parallel_decoder(void)
+{
+	SPLVdecoderParallelOptions options = {0};
+	options.numWorkers = 2;
+
+	SPLVdecoderParallel decoder;
+	SPLV_TEST_ASSERT(splv_decoder_parallel_create(&decoder, SPLV_TEST_PATH, options) == SPLV_SUCCESS, "failed to create parallel decoder");
+
+	int result = 0;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES && result == 0; i++)
+	{
+		SPLVframeCompact frame;
+		if(splv_decoder_parallel_next_frame_compact(&decoder, &frame) != SPLV_SUCCESS)
+		{
+			printf("FAILED: failed to decode parallel compact frame %u\n", i);
+			result = 1;
+			break;
+		}
+
+		if(!splv_test_frames_equal_compact(&g_referenceFrames[i], &frame))
+		{
+			printf("FAILED: parallel compact frame %u does not match reference\n", i);
+			result = 1;
+		}
+
+		splv_frame_compact_destroy(&frame);
+	}
+
+	splv_decoder_parallel_destroy(&decoder);
+
+	return result;
+}
+
+static int splv_test_truncated_file(void)
+{
+	uint64_t len;
+	uint8_t* buf;
+	if(_splv_test_read_file(SPLV_TEST_PATH, &len, &buf) != 0)
+		return 1;
+
+	//cut inside the header, inside the frames and inside the frame table:
+	//---------------
+	uint64_t truncatedLens[] = { 0, sizeof(SPLVfileHeader) / 2, sizeof(SPLVfileHeader) + 16, len / 2, len - 1 };
+
+	int result = 0;
+	for(uint32_t i = 0; i < sizeof(truncatedLens) / sizeof(truncatedLens[0]) && result == 0; i++)
+	{
+		if(_splv_test_write_file(SPLV_TEST_INVALID_PATH, truncatedLens[i], buf) != 0)
+			result = 1;
+		else
+			result = _splv_test_expect_decode_failure(SPLV_TEST_INVALID_PATH);
+	}
+
+	//cut the frame data in half, but keep a valid frame table, so the decoders are created + must fail on the missing frames:
+	//---------------
+	SPLVfileHeader header;
+	memcpy(&header, buf, sizeof(SPLVfileHeader));
+
+	uint64_t frameTableLen = len - header.frameTablePtr;
+	uint64_t cutFrameTablePtr = (sizeof(SPLVfileHeader) + header.frameTablePtr) / 2;
+
+	if(result == 0)
+	{
+		memmove(buf + cutFrameTablePtr, buf + header.frameTablePtr, frameTableLen);
+
+		header.frameTablePtr = cutFrameTablePtr;
+		memcpy(buf, &header, sizeof(SPLVfileHeader));
+
+		if(_splv_test_write_file(SPLV_TEST_INVALID_PATH, cutFrameTablePtr + frameTableLen, buf) != 0)
+			result = 1;
+		else
+			result = _splv_test_expect_decode_failure(SPLV_TEST_INVALID_PATH);
+	}
+
+	free(buf);
+	remove(SPLV_TEST_INVALID_PATH);
+
+	return result;
+}
+
+static int splv_test_invalid_header(void)
+{
+	uint64_t len;
+	uint8_t* buf;
+	if(_splv_test_read_file(SPLV_TEST_PATH, &len, &buf) != 0)
+		return 1;
+
+	//older version, newer version + wrong magic word:
+	//---------------
+	uint32_t offsets[] = { offsetof(SPLVfileHeader, version), offsetof(SPLVfileHeader, version), offsetof(SPLVfileHeader, magicWord) };
+	uint32_t values[] = { SPLV_MAKE_VERSION(0, 3, 0, 0), SPLV_VERSION + 1, SPLV_MAGIC_WORD ^ 1 };
+
+	int result = 0;
+	for(uint32_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]) && result == 0; i++)
+	{
+		uint32_t original;
+		memcpy(&original, buf + offsets[i], sizeof(uint32_t));
+		memcpy(buf + offsets[i], &values[i], sizeof(uint32_t));
+
+		if(_splv_test_write_file(SPLV_TEST_INVALID_PATH, len, buf) != 0)
+		{
+			result = 1;
+			break;
+		}
+
+		memcpy(buf + offsets[i], &original, sizeof(uint32_t));
+
+		//every decoder must reject the file when it is created:
+		//---------------
+		SPLVdecoder decoder;
+		if(splv_decoder_create_from_file(&decoder, SPLV_TEST_INVALID_PATH) == SPLV_SUCCESS)
+		{
+			splv_decoder_destroy(&decoder);
+
+			printf("FAILED: file decoder accepted invalid header %u\n", i);
+			result = 1;
+		}
+
+		if(splv_decoder_create_from_file_mmap(&decoder, SPLV_TEST_INVALID_PATH) == SPLV_SUCCESS)
+		{
+			splv_decoder_destroy(&decoder);
+
+			printf("FAILED: mmap decoder accepted invalid header %u\n", i);
+			result = 1;
+		}
+
+		SPLVdecoderParallelOptions options = {0};
+		SPLVdecoderParallel parallelDecoder;
+		if(splv_decoder_parallel_create(&parallelDecoder, SPLV_TEST_INVALID_PATH, options) == SPLV_SUCCESS)
+		{
+			splv_decoder_parallel_destroy(&parallelDecoder);
+
+			printf("FAILED: parallel decoder accepted invalid header %u\n", i);
+			result = 1;
+		}
+	}
+
+	free(buf);
+	remove(SPLV_TEST_INVALID_PATH);
+
+	return result;
+}
+
+//-------------------------------------------//
+
+int main(void)
+{
+	uint32_t numFailed = 0;
+
+	SPLV_TEST_RUN(splv_test_encode, numFailed);
+	if(numFailed > 0)
+	{
+		printf("failed to create the test file\n");
+		return 1;
+	}
+
+	SPLV_TEST_RUN(splv_test_mem_decoder, numFailed);
+	SPLV_TEST_RUN(splv_test_mmap_decoder, numFailed);
+	SPLV_TEST_RUN(splv_test_prefetch_decoder, numFailed);
+	SPLV_TEST_RUN(splv_test_frame_cache, numFailed);
+	SPLV_TEST_RUN(splv_test_parallel_decoder, numFailed);
+	SPLV_TEST_RUN(splv_test_lookahead_encoder, numFailed);
+	SPLV_TEST_RUN(splv_test_encoder_owned_frames, numFailed);
+	SPLV_TEST_RUN(splv_test_frame_pool, numFailed);
+	SPLV_TEST_RUN(splv_test_compact_decoder, numFailed);
+	SPLV_TEST_RUN(splv_test_compact_frame_cache, numFailed);
+	SPLV_TEST_RUN(splv_test_compact_parallel_decoder, numFailed);
+	SPLV_TEST_RUN(splv_test_truncated_file, numFailed);
+	SPLV_TEST_RUN(splv_test_invalid_header, numFailed);
+
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+		splv_frame_destroy(&g_referenceFrames[i]);
+
+	remove(SPLV_TEST_PATH);
+	remove(SPLV_TEST_ENCODED_PATH);
+
+	if(numFailed > 0)
+	{
+		printf("%u test(s) failed\n", numFailed);
+		return 1;
+	}
+
+	printf("all tests passed\n");
+	return 0;
+}
+
+//-------------------------------------------//
+
+static int _splv_test_decode_all(SPLVdecoder* decoder, SPLVframe* frames)
+{
+	for(uint32_t i = 0; i < decoder->frameCount; i++)
+	{
+		//gather dependencies:
+		//---------------
+		uint64_t numDependencies;
+		uint64_t dependencies[SPLV_TEST_MAX_DEPENDENCIES];
+		SPLVframeIndexed indexedFrames[SPLV_TEST_MAX_DEPENDENCIES];
+
+		SPLVerror dependencyError = splv_decoder_get_frame_dependencies(decoder, i, &numDependencies, NULL, 0);
+		if(dependencyError == SPLV_SUCCESS && numDependencies <= SPLV_TEST_MAX_DEPENDENCIES)
+			dependencyError = splv_decoder_get_frame_dependencies(decoder, i, &numDependencies, dependencies, 0);
+
+		splv_bool_t validDependencies = dependencyError == SPLV_SUCCESS && numDependencies <= SPLV_TEST_MAX_DEPENDENCIES;
+		for(uint64_t j = 0; j < numDependencies && validDependencies; j++)
+		{
+			validDependencies = dependencies[j] < i;
+			indexedFrames[j].index = dependencies[j];
+			indexedFrames[j].frame = &frames[dependencies[j]];
+		}
+
+		//decode:
+		//---------------
+		if(!validDependencies || splv_decoder_decode_frame(decoder, i, numDependencies, indexedFrames, &frames[i], NULL) != SPLV_SUCCESS)
+		{
+			for(uint32_t j = 0; j < i; j++)
+				splv_frame_destroy(&frames[j]);
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int _splv_test_compare_all(SPLVdecoder* decoder, const char* name)
+{
+	SPLVframe frames[SPLV_TEST_NUM_FRAMES];
+	if(_splv_test_decode_all(decoder, frames) != 0)
+	{
+		printf("FAILED: failed to decode frames with %s decoder\n", name);
+		return 1;
+	}
+
+	int result = 0;
+	for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+	{
+		if(result == 0 && !splv_test_frames_equal(&frames[i], &g_referenceFrames[i]))
+		{
+			printf("FAILED: frame %u from %s decoder does not match reference\n", i, name);
+			result = 1;
+		}
+
+		splv_frame_destroy(&frames[i]);
+	}
+
+	return result;
+}
+
+static int _splv_test_expect_decode_failure(const char* path)
+{
+	//a decoder may be created if the frame table is intact, but decoding every frame must then fail cleanly
+	//---------------
+	SPLVdecoder decoder;
+	if(splv_decoder_create_from_file(&decoder, path) == SPLV_SUCCESS)
+	{
+		SPLVframe frames[SPLV_TEST_NUM_FRAMES];
+		int decodeResult = _splv_test_decode_all(&decoder, frames);
+		splv_decoder_destroy(&decoder);
+
+		if(decodeResult == 0)
+		{
+			for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+				splv_frame_destroy(&frames[i]);
+
+			SPLV_TEST_ASSERT(SPLV_FALSE, "invalid file decoded without error");
+		}
+	}
+
+	if(splv_decoder_create_from_file_mmap(&decoder, path) == SPLV_SUCCESS)
+	{
+		SPLVframe frames[SPLV_TEST_NUM_FRAMES];
+		int decodeResult = _splv_test_decode_all(&decoder, frames);
+		splv_decoder_destroy(&decoder);
+
+		if(decodeResult == 0)
+		{
+			for(uint32_t i = 0; i < SPLV_TEST_NUM_FRAMES; i++)
+				splv_frame_destroy(&frames[i]);
+
+			SPLV_TEST_ASSERT(SPLV_FALSE, "invalid file decoded from mmap without error");
+		}
+	}
+
+	SPLVdecoderParallelOptions options = {0};
+	SPLVdecoderParallel parallelDecoder;
+	if(splv_decoder_parallel_create(&parallelDecoder, path, options) == SPLV_SUCCESS)
+	{
+		SPLVerror decodeError = SPLV_SUCCESS;
+		for(uint32_t i = 0; i < parallelDecoder.frameCount && decodeError == SPLV_SUCCESS; i++)
+		{
+			SPLVframe frame;
+			decodeError = splv_decoder_parallel_next_frame(&parallelDecoder, &frame);
+			if(decodeError == SPLV_SUCCESS)
+				splv_frame_destroy(&frame);
+		}
+
+		splv_decoder_parallel_destroy(&parallelDecoder);
+
+		SPLV_TEST_ASSERT(decodeError != SPLV_SUCCESS, "invalid file decoded in parallel without error");
+	}
+
+	return 0;
+}
+
+static int _splv_test_read_file(const char* path, uint64_t* len, uint8_t** buf)
+{
+	FILE* file = fopen(path, "rb");
+	SPLV_TEST_ASSERT(file != NULL, "failed to open file");
+
+	fseek(file, 0, SEEK_END);
+	*len = (uint64_t)ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	*buf = (uint8_t*)malloc(*len);
+	if(!*buf || fread(*buf, *len, 1, file) < 1)
+	{
+		if(*buf)
+			free(*buf);
+
+		fclose(file);
+		SPLV_TEST_ASSERT(SPLV_FALSE, "failed to read file");
+	}
+
+	fclose(file);
+	return 0;
+}
+
+static int _splv_test_write_file(const char* path, uint64_t len, uint8_t* buf)
+{
+	FILE* file = fopen(path, "wb");
+	SPLV_TEST_ASSERT(file != NULL, "failed to open file");
+
+	size_t written = len > 0 ? fwrite(buf, len, 1, file) : 1;
+	fclose(file);
+
+	SPLV_TEST_ASSERT(written == 1, "failed to write file");
+	return 0;
+}
+
+static int _splv_test_files_equal(const char* path1, const char* path2)
+{
+	uint64_t len1, len2;
+	uint8_t* buf1;
+	uint8_t* buf2;
+	if(_splv_test_read_file(path1, &len1, &buf1) != 0)
+		return 1;
+
+	if(_splv_test_read_file(path2, &len2, &buf2) != 0)
+	{
+		free(buf1);
+		return 1;
+	}
+
+	splv_bool_t equal = len1 == len2 && memcmp(buf1, buf2, len1) == 0;
+	free(buf1);
+	free(buf2);
+
+	SPLV_TEST_ASSERT(equal, "encoded files differ");
+	return 0;
+}
@@ -0,0 +1,147 @@
+#include "splv_test_utils.h"
+
+//-------------------------------------------//
+
+#define min(a,b) (((a) < (b)) ? (a) : (b))
+
+//-------------------------------------------//
+
+static SPLVerror _splv_test_set_voxel(SPLVframe* frame, uint32_t x, uint32_t y, uint32_t z, uint8_t r, uint8_t g, uint8_t b);
+
+//-------------------------------------------//
+
+uint32_t splv_test_rand(uint32_t* state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+
+	return *state;
+}
+
+SPLVerror splv_test_create_frame(SPLVframe* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t t, uint32_t* randState)
+{
+	SPLV_ERROR_PROPAGATE(splv_frame_create(frame, width, height, depth, 0));
+
+	for(uint32_t i = 0; i < width * height * depth; i++)
+		frame->map[i] = SPLV_BRICK_IDX_EMPTY;
+
+	uint32_t widthVoxels  = width  * SPLV_BRICK_SIZE;
+	uint32_t heightVoxels = height * SPLV_BRICK_SIZE;
+	uint32_t depthVoxels  = depth  * SPLV_BRICK_SIZE;
+
+	float radius = (float)min(min(widthVoxels, heightVoxels), depthVoxels) * 0.3f;
+	float xCenter = (float)widthVoxels * 0.5f + (float)t * 1.5f - 4.0f;
+	float yCenter = (float)heightVoxels * 0.5f;
+	float zCenter = (float)depthVoxels * 0.5f;
+
+	SPLVerror error = SPLV_SUCCESS;
+
+	for(uint32_t z = 0; z < depthVoxels  && error == SPLV_SUCCESS; z++)
+	for(uint32_t y = 0; y < heightVoxels && error == SPLV_SUCCESS; y++)
+	for(uint32_t x = 0; x < widthVoxels  && error == SPLV_SUCCESS; x++)
+	{
+		//static block, unchanged every frame:
+		//---------------
+		if(x < SPLV_BRICK_SIZE && y < SPLV_BRICK_SIZE && z < SPLV_BRICK_SIZE / 2)
+		{
+			error = _splv_test_set_voxel(frame, x, y, z, 200, (uint8_t)(x * 8), 30);
+			continue;
+		}
+
+		//same geometry every frame, but different colors:
+		//---------------
+		if(x >= widthVoxels - SPLV_BRICK_SIZE && y < SPLV_BRICK_SIZE && z < SPLV_BRICK_SIZE && (x + y + z) % 3 == 0)
+		{
+			error = _splv_test_set_voxel(frame, x, y, z, (uint8_t)(t * 10), (uint8_t)(y * 4), (uint8_t)(z * 4 + t));
+			continue;
+		}
+
+		//moving sphere shell:
+		//---------------
+		float xDist = (float)x - xCenter;
+		float yDist = (float)y - yCenter;
+		float zDist = (float)z - zCenter;
+		float dist2 = xDist * xDist + yDist * yDist + zDist * zDist;
+
+		if(dist2 < radius * radius && dist2 > (radius - 2.0f) * (radius - 2.0f))
+			error = _splv_test_set_voxel(frame, x, y, z, (uint8_t)(x * 4), (uint8_t)(y * 3 + t), (uint8_t)(z * 2));
+		else if(splv_test_rand(randState) % 4096 == 0)
+		{
+			uint32_t color = splv_test_rand(randState);
+			error = _splv_test_set_voxel(frame, x, y, z, (uint8_t)color, (uint8_t)(color >> 8), (uint8_t)(color >> 16));
+		}
+	}
+
+	if(error != SPLV_SUCCESS)
+		splv_frame_destroy(frame);
+
+	return error;
+}
+
+splv_bool_t splv_test_frames_equal(SPLVframe* frame1, SPLVframe* frame2)
+{
+	if(frame1->width != frame2->width || frame1->height != frame2->height || frame1->depth != frame2->depth)
+		return SPLV_FALSE;
+
+	for(uint32_t i = 0; i < frame1->width * frame1->height * frame1->depth; i++)
+	{
+		uint32_t brickIdx1 = frame1->map[i];
+		uint32_t brickIdx2 = frame2->map[i];
+
+		if((brickIdx1 == SPLV_BRICK_IDX_EMPTY) != (brickIdx2 == SPLV_BRICK_IDX_EMPTY))
+			return SPLV_FALSE;
+
+		if(brickIdx1 != SPLV_BRICK_IDX_EMPTY && !splv_brick_equals(&frame1->bricks[brickIdx1], &frame2->bricks[brickIdx2]))
+			return SPLV_FALSE;
+	}
+
+	return SPLV_TRUE;
+}
+
+splv_bool_t splv_test_frames_equal_compact(SPLVframe* frame, SPLVframeCompact* compactFrame)
+{
+	if(frame->width != compactFrame->width || frame->height != compactFrame->height || frame->depth != compactFrame->depth)
+		return SPLV_FALSE;
+
+	for(uint32_t i = 0; i < frame->width * frame->height * frame->depth; i++)
+	{
+		uint32_t brickIdx = frame->map[i];
+		uint32_t compactBrickIdx = compactFrame->map[i];
+
+		if((brickIdx == SPLV_BRICK_IDX_EMPTY) != (compactBrickIdx == SPLV_BRICK_IDX_EMPTY))
+			return SPLV_FALSE;
+
+		if(brickIdx == SPLV_BRICK_IDX_EMPTY)
+			continue;
+
+		SPLVbrick unpacked;
+		splv_frame_compact_unpack_brick(compactFrame, compactBrickIdx, &unpacked);
+
+		if(!splv_brick_equals(&frame->bricks[brickIdx], &unpacked))
+			return SPLV_FALSE;
+	}
+
+	return SPLV_TRUE;
+}
+
+//-------------------------------------------//
+
+static SPLVerror _splv_test_set_voxel(SPLVframe* frame, uint32_t x, uint32_t y, uint32_t z, uint8_t r, uint8_t g, uint8_t b)
+{
+	uint32_t xMap = x / SPLV_BRICK_SIZE;
+	uint32_t yMap = y / SPLV_BRICK_SIZE;
+	uint32_t zMap = z / SPLV_BRICK_SIZE;
+
+	uint32_t mapIdx = splv_frame_get_map_idx(frame, xMap, yMap, zMap);
+	if(frame->map[mapIdx] == SPLV_BRICK_IDX_EMPTY)
+	{
+		splv_brick_clear(splv_frame_get_next_brick(frame));
+		SPLV_ERROR_PROPAGATE(splv_frame_push_next_brick(frame, xMap, yMap, zMap));
+	}
+
+	SPLVbrick* brick = &frame->bricks[frame->map[mapIdx]];
+	splv_brick_set_voxel_filled(brick, x % SPLV_BRICK_SIZE, y % SPLV_BRICK_SIZE, z % SPLV_BRICK_SIZE, r, g, b);
+
+	return SPLV_SUCCESS;
+}
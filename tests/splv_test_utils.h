@@ -0,0 +1,58 @@
+/* splv_test_utils.h
+ *
+ * contains helpers shared by SPLV's tests: assertions, deterministic random data and test frames
+ */
+
+#ifndef SPLV_TEST_UTILS_H
+#define SPLV_TEST_UTILS_H
+
+#include <stdio.h>
+#include "spatialstudio/splv_frame.h"
+#include "spatialstudio/splv_frame_compact.h"
+
+//-------------------------------------------//
+
+/**
+ * fails the current test, which must return an int, if cond is false
+ */
+#define SPLV_TEST_ASSERT(cond, msg) do {                                    \
+		if(!(cond))                                                         \
+		{                                                                   \
+			printf("FAILED: %s (%s:%d)\n", msg, __FILE__, __LINE__);        \
+			return 1;                                                       \
+		}                                                                   \
+	} while(0)
+
+/**
+ * runs a test function, counting it in numFailed if it fails
+ */
+#define SPLV_TEST_RUN(test, numFailed) do {                                 \
+		printf("running %s...\n", #test);                                   \
+		if(test() != 0)                                                     \
+			(numFailed)++;                                                  \
+	} while(0)
+
+//-------------------------------------------//
+
+/**
+ * returns the next value of a xorshift generator, so tests are reproducible
+ */
+uint32_t splv_test_rand(uint32_t* state);
+
+/**
+ * creates a test frame of the given size in bricks, for frame t of a sequence. The scene holds a static block, a brick that only
+ * changes color, a sphere shell moving along x and a few random voxels, so every brick encoding path is taken. call splv_frame_destroy() to free
+ */
+SPLVerror splv_test_create_frame(SPLVframe* frame, uint32_t width, uint32_t height, uint32_t depth, uint32_t t, uint32_t* randState);
+
+/**
+ * returns whether two frames have the same dimensions, geometry and colors of filled voxels
+ */
+splv_bool_t splv_test_frames_equal(SPLVframe* frame1, SPLVframe* frame2);
+
+/**
+ * returns whether a compact frame holds the same geometry and colors of filled voxels as a frame
+ */
+splv_bool_t splv_test_frames_equal_compact(SPLVframe* frame, SPLVframeCompact* compactFrame);
+
+#endif //#ifndef SPLV_TEST_UTILS_H